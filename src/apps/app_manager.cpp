@@ -1,6 +1,7 @@
 #include "app_manager.h"
 #include "../system/os_manager.h"
 #include "../system/event_system.h"
+#include "../system/trace_recorder.h"
 #include <esp_log.h>
 #include <algorithm>
 
@@ -62,6 +63,12 @@ os_error_t AppManager::update(uint32_t deltaTime) {
     for (auto& [appId, app] : m_runningApps) {
         if (app && app->isRunning()) {
             try {
+#if OS_ENABLE_TRACING
+                // App IDs are interned only while tracing; markers are dropped otherwise
+                TraceRecorder& tracer = TraceRecorder::getInstance();
+                TraceScope appScope(tracer.isCapturing() ? tracer.intern(appId) : nullptr);
+#endif
+                AccountScope account(ResourceAccountant::getInstance().findAccount(appId));
                 app->update(deltaTime);
                 
                 // Check if app requested exit
@@ -140,10 +147,23 @@ os_error_t AppManager::launchApp(const std::string& appId) {
         return OS_ERROR_BUSY;
     }
 
+    // Attribute the launch's allocations to call sites when profiling is on
+    AllocationProfiler& profiler = OS().getMemoryManager().getProfiler();
+    AllocationSnapshot beforeLaunch;
+    if (profiler.isEnabled()) {
+        beforeLaunch = profiler.snapshot();
+    }
+
+    // Charge construction and startup to the app; listeners and tasks it
+    // registers here keep charging it
+    ResourceAccountant& accountant = ResourceAccountant::getInstance();
+    AccountScope account(accountant.openAccount(appId));
+
     // Create application instance
     auto app = createApp(appId);
     if (!app) {
         ESP_LOGE(TAG, "Failed to create application '%s'", appId.c_str());
+        accountant.closeAccount(appId);
         return OS_ERROR_GENERIC;
     }
 
@@ -151,6 +171,7 @@ os_error_t AppManager::launchApp(const std::string& appId) {
     os_error_t result = app->initialize();
     if (result != OS_OK) {
         ESP_LOGE(TAG, "Failed to initialize application '%s': %d", appId.c_str(), result);
+        accountant.closeAccount(appId);
         return result;
     }
 
@@ -159,6 +180,7 @@ os_error_t AppManager::launchApp(const std::string& appId) {
     if (result != OS_OK) {
         ESP_LOGE(TAG, "Failed to start application '%s': %d", appId.c_str(), result);
         app->shutdown();
+        accountant.closeAccount(appId);
         return result;
     }
 
@@ -168,6 +190,10 @@ os_error_t AppManager::launchApp(const std::string& appId) {
 
     ESP_LOGI(TAG, "Launched application '%s'", appId.c_str());
 
+    if (profiler.isEnabled()) {
+        AllocationProfiler::logDiff(appId.c_str(), beforeLaunch, profiler.snapshot());
+    }
+
     // Switch to the new app
     return switchToApp(appId);
 }
@@ -182,15 +208,25 @@ os_error_t AppManager::killApp(const std::string& appId) {
         return OS_ERROR_NOT_FOUND;
     }
 
-    auto& app = it->second;
-    if (app) {
-        // Stop the application
-        app->stop();
-        app->shutdown();
+    ResourceAccountant& accountant = ResourceAccountant::getInstance();
+    {
+        // Frees during teardown balance the app's own allocations
+        AccountScope account(accountant.findAccount(appId));
+
+        auto& app = it->second;
+        if (app) {
+            // Stop the application
+            app->stop();
+            app->shutdown();
+        }
+
+        // Remove from running apps
+        m_runningApps.erase(it);
     }
+    accountant.closeAccount(appId);
 
-    // Remove from running apps
-    m_runningApps.erase(it);
+    // Drop the app's scratch memory in bulk
+    OS().getMemoryManager().releaseAppArena(appId);
     m_totalKills++;
 
     // Switch to another app if this was the current one
@@ -343,6 +379,39 @@ size_t AppManager::getTotalMemoryUsage() const {
     return total;
 }
 
+std::vector<AppResourceUsage> AppManager::getResourceUsage() const {
+    std::vector<AppResourceUsage> usage = ResourceAccountant::getInstance().getAllUsage();
+    MemoryManager& memory = OS().getMemoryManager();
+
+    for (AppResourceUsage& app : usage) {
+        BaseApp* instance = getApp(app.appId);
+        if (instance) {
+            app.reportedBytes = instance->getMemoryUsage();
+            app.paused = instance->getState() == AppState::PAUSED;
+        }
+        app.arenaBytes = memory.getAppArenaUsage(app.appId);
+        app.background = app.appId != m_currentAppId;
+    }
+    return usage;
+}
+
+void AppManager::printTop() const {
+    ESP_LOGI(TAG, "=== Application Resource Usage ===");
+    ESP_LOGI(TAG, "%-16s %6s %9s %8s %9s %9s %s",
+            "APP", "CPU%", "MEM KB", "ALLOC/s", "FRAME us", "P95 us", "STATE");
+
+    for (const AppResourceUsage& app : getResourceUsage()) {
+        ESP_LOGI(TAG, "%-16s %6.1f %9d %8.1f %9.0f %9.0f %s",
+                app.appId.c_str(),
+                app.cpuPercent,
+                (int)(app.totalBytes() / 1024),
+                app.allocationsPerSecond,
+                app.avgFrameCostUs,
+                app.p95FrameCostUs,
+                app.paused ? "paused" : app.background ? "background" : "foreground");
+    }
+}
+
 void AppManager::printStats() const {
     ESP_LOGI(TAG, "=== Application Manager Statistics ===");
     ESP_LOGI(TAG, "Registered apps: %d", m_appFactories.size());
@@ -351,6 +420,7 @@ void AppManager::printStats() const {
     ESP_LOGI(TAG, "Total launches: %d", m_totalLaunches);
     ESP_LOGI(TAG, "Total kills: %d", m_totalKills);
     ESP_LOGI(TAG, "Total memory usage: %d KB", getTotalMemoryUsage() / 1024);
+    printTop();
 
     ESP_LOGI(TAG, "=== Running Applications ===");
     for (const auto& [appId, app] : m_runningApps) {
@@ -386,6 +456,8 @@ void AppManager::cleanupStoppedApps() {
     while (it != m_runningApps.end()) {
         if (!it->second || it->second->getState() == AppState::STOPPED) {
             ESP_LOGD(TAG, "Cleaning up stopped app '%s'", it->first.c_str());
+            ResourceAccountant::getInstance().closeAccount(it->first);
+            OS().getMemoryManager().releaseAppArena(it->first);
             it = m_runningApps.erase(it);
         } else {
             ++it;
@@ -394,34 +466,61 @@ void AppManager::cleanupStoppedApps() {
 }
 
 void AppManager::enforceResourceLimits() {
-    // Check memory usage and kill apps if needed
+    std::vector<AppResourceUsage> usage = getResourceUsage();
+
+    // Background apps that may be paused or killed, heaviest first
+    std::vector<const AppResourceUsage*> candidates;
+    float appCpu = 0.0f;
+    for (const AppResourceUsage& app : usage) {
+        if (!app.paused) {
+            appCpu += app.cpuPercent;
+        }
+        BaseApp* instance = getApp(app.appId);
+        if (app.background && instance && instance->getPriority() != AppPriority::APP_SYSTEM) {
+            candidates.push_back(&app);
+        }
+    }
+
+    // CPU: pausing a background app stops its update() and its share of the frame
+    if (appCpu > OS_APP_CPU_BUDGET_PERCENT) {
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const AppResourceUsage* a, const AppResourceUsage* b) {
+                      return a->cpuPercent > b->cpuPercent;
+                  });
+
+        for (const AppResourceUsage* app : candidates) {
+            if (appCpu <= OS_APP_CPU_BUDGET_PERCENT) {
+                break;
+            }
+            if (app->paused || app->cpuPercent <= 0.0f) {
+                continue;
+            }
+            ESP_LOGW(TAG, "Pausing app '%s' (%.1f%% CPU) - apps over CPU budget (%.1f%%)",
+                    app->appId.c_str(), app->cpuPercent, appCpu);
+            pauseApp(app->appId);
+            appCpu -= app->cpuPercent;
+        }
+    }
+
+    // Memory: pausing frees nothing, so kill the heaviest background apps
     size_t totalMemory = getTotalMemoryUsage();
     size_t systemMemory = OS().getMemoryManager().getTotalAllocated();
     
     if (totalMemory > OS_APP_HEAP_SIZE || systemMemory > OS_SYSTEM_HEAP_SIZE) {
         ESP_LOGW(TAG, "Memory usage high, considering app cleanup");
-        
-        // Find lowest priority apps to kill
-        std::vector<std::pair<std::string, AppPriority>> candidates;
-        for (const auto& [appId, app] : m_runningApps) {
-            if (app && appId != m_currentAppId) {
-                candidates.push_back({appId, app->getPriority()});
-            }
-        }
-        
-        // Sort by priority (lowest first)
+
         std::sort(candidates.begin(), candidates.end(),
-                  [](const auto& a, const auto& b) {
-                      return a.second < b.second;
+                  [](const AppResourceUsage* a, const AppResourceUsage* b) {
+                      return a->totalBytes() > b->totalBytes();
                   });
-        
-        // Kill lowest priority apps until memory is acceptable
-        for (const auto& [appId, priority] : candidates) {
+
+        for (const AppResourceUsage* app : candidates) {
             if (getTotalMemoryUsage() < OS_APP_HEAP_SIZE * 0.8) {
                 break;
             }
-            ESP_LOGW(TAG, "Killing app '%s' due to memory pressure", appId.c_str());
-            killApp(appId);
+            ESP_LOGW(TAG, "Killing app '%s' (%d KB) due to memory pressure",
+                    app->appId.c_str(), (int)(app->totalBytes() / 1024));
+            killApp(app->appId);
         }
     }
 }
@@ -3,6 +3,7 @@
 
 #include "../system/os_config.h"
 #include "../system/event_system.h"
+#include "../system/resource_accountant.h"
 #include "base_app.h"
 #include <memory>
 #include <map>
@@ -156,6 +157,17 @@ public:
      */
     size_t getTotalMemoryUsage() const;
 
+    /**
+     * @brief Get measured resource usage of every running application
+     * @return Usage per app, heaviest CPU first
+     */
+    std::vector<AppResourceUsage> getResourceUsage() const;
+
+    /**
+     * @brief Print a "top"-style table of per-app CPU, memory and frame cost
+     */
+    void printTop() const;
+
     /**
      * @brief Print application statistics
      */
@@ -176,6 +188,11 @@ private:
 
     /**
      * @brief Check resource limits and cleanup if needed
+     *
+     * Pauses the heaviest background apps by CPU while apps exceed
+     * OS_APP_CPU_BUDGET_PERCENT, and kills the heaviest background apps
+     * by memory while app memory exceeds OS_APP_HEAP_SIZE. System-priority
+     * and foreground apps are never touched.
      */
     void enforceResourceLimits();
 
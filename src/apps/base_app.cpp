@@ -111,6 +111,14 @@ uint32_t BaseApp::getRuntime() const {
     return millis() - m_startTime;
 }
 
+MemoryArena& BaseApp::frameArena() const {
+    return OS().getMemoryManager().getFrameArena();
+}
+
+MemoryArena* BaseApp::appArena() const {
+    return OS().getMemoryManager().getAppArena(m_id);
+}
+
 void BaseApp::setState(AppState state) {
     if (m_state != state) {
         AppState previousState = m_state;
@@ -2,6 +2,7 @@
 #define BASE_APP_H
 
 #include "../system/os_config.h"
+#include "../system/memory_arena.h"
 #include <lvgl.h>
 #include <string>
 #include <functional>
@@ -225,6 +226,23 @@ protected:
      */
     void setMemoryUsage(size_t usage) { m_memoryUsage = usage; }
 
+    /**
+     * @brief Get the per-frame scratch arena
+     *
+     * Memory is reclaimed at the end of every OS frame; use it for
+     * temporaries built and consumed within one update().
+     * @return Frame arena
+     */
+    MemoryArena& frameArena() const;
+
+    /**
+     * @brief Get this application's scratch arena
+     *
+     * Lives until the app is stopped; the app may reset() it at any point.
+     * @return App arena or nullptr if the memory manager is unavailable
+     */
+    MemoryArena* appArena() const;
+
     /**
      * @brief Log application message
      * @param level Log level
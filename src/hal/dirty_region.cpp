@@ -0,0 +1,109 @@
+#include "dirty_region.h"
+#include <algorithm>
+
+DirtyRegion::DirtyRegion(uint16_t width, uint16_t height, uint16_t tileLines)
+    : m_width(width), m_height(height), m_tileLines(tileLines) {
+}
+
+void DirtyRegion::alignToTiles(DirtyRect& rect) const {
+    if (m_tileLines > 1) {
+        rect.y1 -= rect.y1 % m_tileLines;
+        rect.y2 += m_tileLines - 1 - rect.y2 % m_tileLines;
+    }
+
+    rect.x1 = std::max<int16_t>(rect.x1, 0);
+    rect.y1 = std::max<int16_t>(rect.y1, 0);
+    rect.x2 = std::min<int16_t>(rect.x2, m_width - 1);
+    rect.y2 = std::min<int16_t>(rect.y2, m_height - 1);
+}
+
+size_t DirtyRegion::merge(DirtyRect* rects, uint8_t* joined, size_t count) {
+    size_t remaining = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!joined[i]) {
+            remaining++;
+        }
+    }
+    m_stats.areasInvalidated += remaining;
+
+    // A merge can make its result touch areas that were already checked,
+    // so repeat until a pass changes nothing
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < count; i++) {
+            if (joined[i]) {
+                continue;
+            }
+            for (size_t j = i + 1; j < count; j++) {
+                if (joined[j] || !adjacent(rects[i], rects[j])) {
+                    continue;
+                }
+
+                DirtyRect bounds;
+                bounds.x1 = std::min(rects[i].x1, rects[j].x1);
+                bounds.y1 = std::min(rects[i].y1, rects[j].y1);
+                bounds.x2 = std::max(rects[i].x2, rects[j].x2);
+                bounds.y2 = std::max(rects[i].y2, rects[j].y2);
+
+                // Only merge when it draws no more than the two areas would
+                if (bounds.area() > rects[i].area() + rects[j].area()) {
+                    continue;
+                }
+
+                rects[j] = bounds;
+                joined[i] = 1;
+                remaining--;
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    m_stats.areasRendered += remaining;
+    return remaining;
+}
+
+void DirtyRegion::recordFlush(const DirtyRect& rect, bool lastInFrame) {
+    m_stats.flushes++;
+    m_stats.pixelsFlushed += rect.area();
+    m_framePixels += rect.area();
+
+    if (!lastInFrame) {
+        return;
+    }
+
+    uint32_t screenPixels = (uint32_t)m_width * m_height;
+    float percent = 100.0f * m_framePixels / screenPixels;
+
+    m_stats.frames++;
+    if (m_framePixels >= screenPixels) {
+        m_stats.fullFrames++;
+    }
+    m_stats.lastFramePixels = m_framePixels;
+    m_stats.lastFramePercent = percent;
+    m_stats.maxFramePercent = std::max(m_stats.maxFramePercent, percent);
+    m_percentSum += percent;
+    m_framePixels = 0;
+}
+
+PartialRefreshStats DirtyRegion::getStats() const {
+    PartialRefreshStats stats = m_stats;
+    if (stats.frames > 0) {
+        stats.averageFramePercent = m_percentSum / stats.frames;
+        stats.flushesPerFrame = (float)stats.flushes / stats.frames;
+    }
+    return stats;
+}
+
+void DirtyRegion::resetStats() {
+    m_stats = PartialRefreshStats();
+    m_framePixels = 0;
+    m_percentSum = 0.0f;
+}
+
+bool DirtyRegion::adjacent(const DirtyRect& a, const DirtyRect& b) {
+    // Overlapping, or sharing an edge with no gap
+    return a.x1 <= b.x2 + 1 && b.x1 <= a.x2 + 1 &&
+           a.y1 <= b.y2 + 1 && b.y1 <= a.y2 + 1;
+}
@@ -0,0 +1,112 @@
+#ifndef DIRTY_REGION_H
+#define DIRTY_REGION_H
+
+#include "../system/os_config.h"
+
+/**
+ * @file dirty_region.h
+ * @brief Invalidated-area merging and partial refresh statistics
+ *
+ * LVGL redraws each invalidated area separately, so a screen with many
+ * small updates (labels, icons, a cursor) pays a render and flush setup
+ * per area. DirtyRegion rounds areas out to whole draw-buffer tiles so an
+ * area never straddles two buffer fills, then merges areas that overlap
+ * or touch whenever the merged rectangle costs no more pixels than the
+ * pieces it replaces.
+ *
+ * It also counts, per refreshed frame, how many pixels were flushed
+ * against the size of the screen, which shows where partial refresh is
+ * paying off and which widgets redraw more than they need to.
+ */
+
+struct DirtyRect {
+    int16_t x1 = 0;     // Inclusive, as lv_area_t
+    int16_t y1 = 0;
+    int16_t x2 = -1;
+    int16_t y2 = -1;
+
+    int32_t width() const { return x2 - x1 + 1; }
+    int32_t height() const { return y2 - y1 + 1; }
+    int32_t area() const { return width() * height(); }
+};
+
+struct PartialRefreshStats {
+    uint32_t frames = 0;
+    uint32_t fullFrames = 0;            // Frames that flushed at least a full screen
+    uint32_t areasInvalidated = 0;      // Areas handed to merge()
+    uint32_t areasRendered = 0;         // Areas left after merge()
+    uint32_t flushes = 0;
+    uint64_t pixelsFlushed = 0;
+    uint32_t lastFramePixels = 0;
+    float lastFramePercent = 0.0f;      // Last frame's flushed pixels, % of the screen
+    float averageFramePercent = 0.0f;
+    float maxFramePercent = 0.0f;
+    float flushesPerFrame = 0.0f;
+};
+
+class DirtyRegion {
+public:
+    /**
+     * @param width Screen width in pixels
+     * @param height Screen height in pixels
+     * @param tileLines Draw buffer height in lines; 0 or 1 disables alignment
+     */
+    DirtyRegion(uint16_t width, uint16_t height, uint16_t tileLines = OS_DRAW_BUFFER_LINES);
+
+    /**
+     * @brief Change the tile height, e.g. after the draw buffers are resized
+     * @param tileLines Draw buffer height in lines
+     */
+    void setTileLines(uint16_t tileLines) { m_tileLines = tileLines; }
+    uint16_t getTileLines() const { return m_tileLines; }
+
+    /**
+     * @brief Round an area out to whole tiles, clipped to the screen
+     * @param rect Area to align in place
+     */
+    void alignToTiles(DirtyRect& rect) const;
+
+    /**
+     * @brief Merge overlapping and touching areas in place
+     *
+     * Laid out like LVGL's invalidation list: merged-away entries are
+     * flagged in joined[] rather than removed, and a merge keeps the later
+     * entry, so the last unjoined entry stays last.
+     * @param rects Areas
+     * @param joined One flag per area; non-zero entries are ignored and set ones are dropped
+     * @param count Number of areas
+     * @return Number of areas left unjoined
+     */
+    size_t merge(DirtyRect* rects, uint8_t* joined, size_t count);
+
+    /**
+     * @brief Count a flushed area
+     * @param rect Area sent to the panel
+     * @param lastInFrame Whether this was the last area of the refresh
+     */
+    void recordFlush(const DirtyRect& rect, bool lastInFrame);
+
+    /**
+     * @brief Get partial refresh statistics
+     * @return Statistics since construction or resetStats()
+     */
+    PartialRefreshStats getStats() const;
+
+    /**
+     * @brief Clear statistics
+     */
+    void resetStats();
+
+private:
+    static bool adjacent(const DirtyRect& a, const DirtyRect& b);
+
+    uint16_t m_width;
+    uint16_t m_height;
+    uint16_t m_tileLines;
+
+    PartialRefreshStats m_stats;
+    uint32_t m_framePixels = 0;
+    float m_percentSum = 0.0f;
+};
+
+#endif // DIRTY_REGION_H
@@ -0,0 +1,186 @@
+#include "display_benchmark.h"
+#include "display_hal.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdio>
+
+static const char* TAG = "DisplayBenchmark";
+
+static const draw_buffer_mode_t BENCHMARK_MODES[] = {
+    DRAW_BUFFER_PARTIAL, DRAW_BUFFER_FULL, DRAW_BUFFER_DIRECT
+};
+
+std::vector<DrawBufferBenchmarkResult> DisplayBenchmark::run(uint32_t framesPerScreen) {
+    std::vector<DrawBufferBenchmarkResult> results;
+    lv_disp_t* disp = m_display.getLVGLDisplay();
+    if (!disp || framesPerScreen == 0) {
+        return results;
+    }
+
+    draw_buffer_mode_t previousMode = m_display.getDrawBufferMode();
+    uint32_t previousLines = m_display.getDrawBufferLines();
+
+    for (draw_buffer_mode_t mode : BENCHMARK_MODES) {
+        bool supported = m_display.setDrawBufferMode(mode) == OS_OK;
+
+        for (int s = 0; s < static_cast<int>(BenchmarkScreen::COUNT); s++) {
+            BenchmarkScreen screen = static_cast<BenchmarkScreen>(s);
+            if (supported) {
+                results.push_back(measure(mode, screen, framesPerScreen));
+            } else {
+                DrawBufferBenchmarkResult skipped;
+                skipped.mode = mode;
+                skipped.screen = screen;
+                results.push_back(skipped);
+            }
+        }
+    }
+
+    m_display.setDrawBufferMode(previousMode, previousLines);
+    lv_refr_now(disp);
+    return results;
+}
+
+DrawBufferBenchmarkResult DisplayBenchmark::measure(draw_buffer_mode_t mode, BenchmarkScreen screen,
+                                                    uint32_t frames) {
+    lv_disp_t* disp = m_display.getLVGLDisplay();
+    DrawBufferBenchmarkResult result;
+    result.mode = mode;
+    result.screen = screen;
+    result.supported = true;
+    result.frames = frames;
+
+    lv_obj_t* previousScreen = lv_scr_act();
+    lv_obj_t* benchmarkScreen = buildScreen(screen);
+    lv_scr_load(benchmarkScreen);
+    lv_refr_now(disp);      // First full draw is not measured
+
+    PartialRefreshStats before = m_display.getPartialRefreshStats();
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        animate(screen, frame);
+        lv_refr_now(disp);
+    }
+
+    int64_t elapsedUs = esp_timer_get_time() - start;
+    PartialRefreshStats after = m_display.getPartialRefreshStats();
+
+    uint64_t pixels = after.pixelsFlushed - before.pixelsFlushed;
+    uint32_t flushes = after.flushes - before.flushes;
+    uint64_t psramBytes = estimatePsramBytes(mode, pixels, m_display.drawBuffersInPsram());
+
+    if (elapsedUs > 0) {
+        result.fps = frames * 1000000.0f / elapsedUs;
+        result.psramMBps = (float)psramBytes / elapsedUs;
+    }
+    result.flushesPerFrame = (float)flushes / frames;
+    result.screenPercent = 100.0f * pixels / frames /
+                           ((uint32_t)m_display.getWidth() * m_display.getHeight());
+
+    lv_scr_load(previousScreen);
+    lv_obj_del(benchmarkScreen);
+    m_screen = nullptr;
+    m_label = nullptr;
+    m_list = nullptr;
+    return result;
+}
+
+uint64_t DisplayBenchmark::estimatePsramBytes(draw_buffer_mode_t mode, uint64_t pixels,
+                                              bool buffersInPsram) {
+    uint64_t bytes = pixels * sizeof(lv_color_t);
+
+    switch (mode) {
+        case DRAW_BUFFER_FULL:
+            // Render, transfer read, framebuffer write
+            return bytes * 3;
+        case DRAW_BUFFER_DIRECT:
+            // As full, plus copying the areas into the other buffer afterwards
+            return bytes * 5;
+        case DRAW_BUFFER_PARTIAL:
+        default:
+            // Only the framebuffer write, unless the strips fell back to PSRAM
+            return buffersInPsram ? bytes * 3 : bytes;
+    }
+}
+
+void DisplayBenchmark::printResults(const std::vector<DrawBufferBenchmarkResult>& results) {
+    ESP_LOGI(TAG, "=== Draw Buffer Benchmark ===");
+    ESP_LOGI(TAG, "%-8s %-10s %7s %9s %8s %10s",
+             "MODE", "SCREEN", "FPS", "FLUSH/FR", "SCREEN%", "PSRAM MB/s");
+
+    for (const DrawBufferBenchmarkResult& result : results) {
+        if (!result.supported) {
+            ESP_LOGI(TAG, "%-8s %-10s  (buffers could not be allocated)",
+                     DisplayHAL::getDrawBufferModeName(result.mode), getScreenName(result.screen));
+            continue;
+        }
+        ESP_LOGI(TAG, "%-8s %-10s %7.1f %9.1f %8.1f %10.1f",
+                 DisplayHAL::getDrawBufferModeName(result.mode), getScreenName(result.screen),
+                 result.fps, result.flushesPerFrame, result.screenPercent, result.psramMBps);
+    }
+}
+
+const char* DisplayBenchmark::getScreenName(BenchmarkScreen screen) {
+    switch (screen) {
+        case BenchmarkScreen::LABEL: return "label";
+        case BenchmarkScreen::LIST: return "list";
+        case BenchmarkScreen::TRANSITION: return "transition";
+        default: return "unknown";
+    }
+}
+
+lv_obj_t* DisplayBenchmark::buildScreen(BenchmarkScreen screen) {
+    m_screen = lv_obj_create(nullptr);
+
+    switch (screen) {
+        case BenchmarkScreen::LABEL:
+            m_label = lv_label_create(m_screen);
+            lv_obj_align(m_label, LV_ALIGN_TOP_LEFT, 10, 12);
+            break;
+
+        case BenchmarkScreen::LIST:
+            m_list = lv_list_create(m_screen);
+            lv_obj_set_size(m_list, LV_PCT(100), LV_PCT(100));
+            for (int i = 0; i < 40; i++) {
+                char text[24];
+                snprintf(text, sizeof(text), "Item %d", i);
+                lv_list_add_btn(m_list, LV_SYMBOL_FILE, text);
+            }
+            m_scrollStep = 8;
+            break;
+
+        case BenchmarkScreen::TRANSITION:
+        default:
+            for (int i = 0; i < 12; i++) {
+                lv_obj_t* tile = lv_obj_create(m_screen);
+                lv_obj_set_size(tile, LV_PCT(23), LV_PCT(30));
+                lv_obj_align(tile, LV_ALIGN_TOP_LEFT, (i % 4) * 310 + 15, (i / 4) * 235 + 15);
+            }
+            break;
+    }
+    return m_screen;
+}
+
+void DisplayBenchmark::animate(BenchmarkScreen screen, uint32_t frame) {
+    switch (screen) {
+        case BenchmarkScreen::LABEL:
+            lv_label_set_text_fmt(m_label, "%02d:%02d", (int)(frame / 60) % 60, (int)frame % 60);
+            break;
+
+        case BenchmarkScreen::LIST:
+            // Bounce between the ends of the list
+            if (lv_obj_get_scroll_bottom(m_list) <= 0) {
+                m_scrollStep = -8;
+            } else if (lv_obj_get_scroll_top(m_list) <= 0) {
+                m_scrollStep = 8;
+            }
+            lv_obj_scroll_by(m_list, 0, -m_scrollStep, LV_ANIM_OFF);
+            break;
+
+        case BenchmarkScreen::TRANSITION:
+        default:
+            lv_obj_set_style_bg_color(m_screen, lv_color_hex(frame & 1 ? 0x2C3E50 : 0x34495E), 0);
+            break;
+    }
+}
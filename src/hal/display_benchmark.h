@@ -0,0 +1,91 @@
+#ifndef DISPLAY_BENCHMARK_H
+#define DISPLAY_BENCHMARK_H
+
+#include "../system/os_config.h"
+#include <lvgl.h>
+#include <vector>
+
+class DisplayHAL;
+
+/**
+ * @file display_benchmark.h
+ * @brief Draw buffer mode benchmark for M5Stack Tab5
+ *
+ * Renders a few typical screens in every draw buffer mode and reports
+ * the frame rate LVGL reaches when refreshing as fast as it can, how much
+ * of the screen each frame flushed, and the PSRAM traffic the mode causes
+ * at that rate.
+ *
+ * PSRAM traffic is estimated from the pixels flushed and where each mode
+ * reads and writes them (render, direct-mode sync copy, transfer, scan-out
+ * framebuffer). The panel's own scan-out reads are the same in every mode
+ * and are left out.
+ */
+
+enum class BenchmarkScreen : uint8_t {
+    LABEL,          // One label changing every frame, like a clock
+    LIST,           // A list scrolling a few pixels every frame
+    TRANSITION,     // The whole screen changing every frame
+    COUNT
+};
+
+struct DrawBufferBenchmarkResult {
+    draw_buffer_mode_t mode = DRAW_BUFFER_PARTIAL;
+    BenchmarkScreen screen = BenchmarkScreen::LABEL;
+    bool supported = false;         // Buffers for the mode could be allocated
+    uint32_t frames = 0;
+    float fps = 0.0f;
+    float flushesPerFrame = 0.0f;
+    float screenPercent = 0.0f;     // Pixels flushed per frame, % of the screen
+    float psramMBps = 0.0f;         // Estimated PSRAM traffic at the measured rate
+};
+
+class DisplayBenchmark {
+public:
+    explicit DisplayBenchmark(DisplayHAL& display) : m_display(display) {}
+
+    /**
+     * @brief Benchmark every draw buffer mode on every screen
+     *
+     * Temporarily replaces the active screen and draw buffers; both are
+     * restored afterwards. Call from the main loop.
+     * @param framesPerScreen Frames measured per mode and screen
+     * @return One result per mode and screen
+     */
+    std::vector<DrawBufferBenchmarkResult> run(uint32_t framesPerScreen = 60);
+
+    /**
+     * @brief Estimate the PSRAM bytes moved to show a number of pixels
+     * @param mode Draw buffer mode
+     * @param pixels Pixels flushed
+     * @param buffersInPsram Whether the draw buffers are in PSRAM
+     * @return Bytes read and written in PSRAM
+     */
+    static uint64_t estimatePsramBytes(draw_buffer_mode_t mode, uint64_t pixels, bool buffersInPsram);
+
+    /**
+     * @brief Log results as a table
+     * @param results Results from run()
+     */
+    static void printResults(const std::vector<DrawBufferBenchmarkResult>& results);
+
+    /**
+     * @brief Get a screen's name for logs
+     * @param screen Benchmark screen
+     * @return Screen name
+     */
+    static const char* getScreenName(BenchmarkScreen screen);
+
+private:
+    DrawBufferBenchmarkResult measure(draw_buffer_mode_t mode, BenchmarkScreen screen, uint32_t frames);
+    lv_obj_t* buildScreen(BenchmarkScreen screen);
+    void animate(BenchmarkScreen screen, uint32_t frame);
+
+    DisplayHAL& m_display;
+    lv_obj_t* m_label = nullptr;
+    lv_obj_t* m_list = nullptr;
+    lv_obj_t* m_screen = nullptr;
+    int m_scrollStep = 8;
+};
+
+#endif // DISPLAY_BENCHMARK_H
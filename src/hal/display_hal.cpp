@@ -1,6 +1,8 @@
 #include "display_hal.h"
 #include "hardware_config.h"
+#include "ppa_hal.h"
 #include "../system/os_manager.h"
+#include "../system/trace_recorder.h"
 #include <esp_log.h>
 #include <driver/gpio.h>
 #include <driver/ledc.h>
@@ -61,6 +63,12 @@ os_error_t DisplayHAL::shutdown() {
     // Disable display
     setEnabled(false);
 
+    // The transfer in flight still reads from a draw buffer
+    m_flushPipeline.shutdown();
+    delete m_framebufferBackend;
+    m_framebufferBackend = nullptr;
+    m_flushBackend = nullptr;
+
     // Clean up LVGL resources
     if (m_buffer1) {
         free(m_buffer1);
@@ -87,7 +95,10 @@ os_error_t DisplayHAL::update(uint32_t deltaTime) {
     uint32_t frameStart = esp_timer_get_time();
     
     // Handle LVGL tasks with precise timing
-    lv_timer_handler();
+    {
+        PERF_TRACE_SCOPE("lvgl");
+        lv_timer_handler();
+    }
 
     // Update FPS statistics and performance metrics
     updateFPS();
@@ -220,58 +231,157 @@ void DisplayHAL::printStats() const {
     ESP_LOGI(TAG, "Brightness: %d/255", m_brightness);
     ESP_LOGI(TAG, "Low power mode: %s", m_lowPowerMode ? "yes" : "no");
     ESP_LOGI(TAG, "FPS: %.1f", m_fps);
+    ESP_LOGI(TAG, "Draw buffers: %s, %d lines, %s", getDrawBufferModeName(m_drawBufferMode),
+             (int)m_drawBufferLines, m_drawBuffersInPsram ? "PSRAM" : "SRAM");
     ESP_LOGI(TAG, "Total flushes: %d", m_totalFlushes);
+
+    FlushStats flush = m_flushPipeline.getStats();
+    ESP_LOGI(TAG, "Flush transfers: %d (%d frames, %d timeouts)",
+             (int)flush.transfers, (int)flush.frames, (int)flush.timeouts);
+    ESP_LOGI(TAG, "Flush throughput: %.1f MB/s, render/transfer overlap %.1f%%",
+             flush.throughputMBps, flush.overlapPercent);
+
+    PartialRefreshStats partial = m_dirtyRegion.getStats();
+    ESP_LOGI(TAG, "Refreshed frames: %d (%d full screen), %.1f flushes/frame",
+             (int)partial.frames, (int)partial.fullFrames, partial.flushesPerFrame);
+    ESP_LOGI(TAG, "Pixels flushed per frame: avg %.1f%%, max %.1f%%, last %.1f%% of screen",
+             partial.averageFramePercent, partial.maxFramePercent, partial.lastFramePercent);
+    ESP_LOGI(TAG, "Invalidated areas: %d merged into %d",
+             (int)partial.areasInvalidated, (int)partial.areasRendered);
     ESP_LOGI(TAG, "Last refresh: %d ms ago", millis() - m_lastRefresh);
 }
 
 void DisplayHAL::lvglFlushCallback(lv_disp_drv_t* disp_drv, 
                                   const lv_area_t* area, 
                                   lv_color_t* color_p) {
+    PERF_TRACE_SCOPE("lvgl_flush");
     DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
     
+    if (!self) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+    self->m_totalFlushes++;
+
+#ifdef CONFIG_ESP_PPA_ACCELERATION
+    // PPA operations queued while rendering may still be writing this buffer
+    ppa_hal_wait_completion(PPA_OPERATION_TIMEOUT_MS);
+#endif
+
+    // Returns once the transfer has started; flushReady() releases the buffer
+    FlushRequest request;
+    request.x1 = area->x1;
+    request.y1 = area->y1;
+    request.x2 = area->x2;
+    request.y2 = area->y2;
+    request.pixels = color_p;
+    if (disp_drv->direct_mode) {
+        // color_p is the whole screen buffer; the area is drawn in place
+        request.pixels = color_p + area->y1 * disp_drv->hor_res + area->x1;
+        request.stride = disp_drv->hor_res;
+    }
+    request.lastInFrame = lv_disp_flush_is_last(disp_drv);
+
+    DirtyRect flushed;
+    flushed.x1 = area->x1;
+    flushed.y1 = area->y1;
+    flushed.x2 = area->x2;
+    flushed.y2 = area->y2;
+    self->m_dirtyRegion.recordFlush(flushed, request.lastInFrame);
+
+    self->m_flushPipeline.submit(request);
+}
+
+void DisplayHAL::lvglWaitCallback(lv_disp_drv_t* disp_drv) {
+    PERF_TRACE_SCOPE("lvgl_flush_wait");
+    DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
     if (self) {
-        self->m_totalFlushes++;
+        self->m_flushPipeline.waitForTransfer();
     }
+}
+
+void DisplayHAL::lvglRounderCallback(lv_disp_drv_t* disp_drv, lv_area_t* area) {
+    DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
+    if (!self) {
+        return;
+    }
+
+    DirtyRect rect;
+    rect.x1 = area->x1;
+    rect.y1 = area->y1;
+    rect.x2 = area->x2;
+    rect.y2 = area->y2;
+    self->m_dirtyRegion.alignToTiles(rect);
 
-    // TODO: Implement actual display flushing to hardware
-    // For now, just mark as ready
-    lv_disp_flush_ready(disp_drv);
+    area->x1 = rect.x1;
+    area->y1 = rect.y1;
+    area->x2 = rect.x2;
+    area->y2 = rect.y2;
 }
 
-os_error_t DisplayHAL::initializeLVGL() {
-    // Calculate buffer size (20 lines for 60Hz smooth rendering)
-    uint32_t bufferSize = OS_SCREEN_WIDTH * 20;
-    
-    // Allocate draw buffers in PSRAM for 60Hz performance
-    m_buffer1 = static_cast<lv_color_t*>(heap_caps_malloc(bufferSize * sizeof(lv_color_t), MALLOC_CAP_SPIRAM));
-    if (!m_buffer1) {
-        ESP_LOGE(TAG, "Failed to allocate primary draw buffer in PSRAM");
-        // Fallback to internal RAM
-        m_buffer1 = static_cast<lv_color_t*>(malloc(bufferSize * sizeof(lv_color_t)));
-        if (!m_buffer1) {
-            ESP_LOGE(TAG, "Failed to allocate primary draw buffer");
-            return OS_ERROR_NO_MEMORY;
-        }
+void DisplayHAL::lvglRenderStartCallback(lv_disp_drv_t* disp_drv) {
+    DisplayHAL* self = static_cast<DisplayHAL*>(disp_drv->user_data);
+    if (!self || !self->m_lvglDisplay) {
+        return;
     }
 
-    // Second buffer essential for 60Hz double buffering
-    m_buffer2 = static_cast<lv_color_t*>(heap_caps_malloc(bufferSize * sizeof(lv_color_t), MALLOC_CAP_SPIRAM));
-    if (!m_buffer2) {
-        ESP_LOGW(TAG, "Failed to allocate secondary draw buffer in PSRAM, trying internal RAM");
-        m_buffer2 = static_cast<lv_color_t*>(malloc(bufferSize * sizeof(lv_color_t)));
-        if (!m_buffer2) {
-            ESP_LOGW(TAG, "No secondary buffer - 60Hz performance may be reduced");
-        }
+    // LVGL has already joined areas whose union is smaller than the parts;
+    // this also joins the ones that merely touch, e.g. neighbouring labels
+    lv_disp_t* disp = self->m_lvglDisplay;
+    DirtyRect rects[LV_INV_BUF_SIZE];
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        rects[i].x1 = disp->inv_areas[i].x1;
+        rects[i].y1 = disp->inv_areas[i].y1;
+        rects[i].x2 = disp->inv_areas[i].x2;
+        rects[i].y2 = disp->inv_areas[i].y2;
+    }
+
+    self->m_dirtyRegion.merge(rects, disp->inv_area_joined, disp->inv_p);
+
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        disp->inv_areas[i].x1 = rects[i].x1;
+        disp->inv_areas[i].y1 = rects[i].y1;
+        disp->inv_areas[i].x2 = rects[i].x2;
+        disp->inv_areas[i].y2 = rects[i].y2;
     }
+}
+
+void DisplayHAL::flushReady(void* context) {
+    lv_disp_flush_ready(static_cast<lv_disp_drv_t*>(context));
+}
 
-    // Initialize draw buffer
-    lv_disp_draw_buf_init(&m_drawBuffer, m_buffer1, m_buffer2, bufferSize);
+os_error_t DisplayHAL::setFlushBackend(FlushBackend* backend) {
+    m_flushBackend = backend ? backend : m_framebufferBackend;
+    if (!m_lvglDisplay || !m_flushBackend) {
+        return OS_OK;
+    }
 
+    return m_flushPipeline.initialize(m_flushBackend, flushReady, &m_displayDriver,
+                                      sizeof(lv_color_t));
+}
+
+os_error_t DisplayHAL::initializeLVGL() {
     // Initialize display driver
     lv_disp_drv_init(&m_displayDriver);
+
+    // Allocate draw buffers; this also sets the driver's refresh mode flags
+    os_error_t result = allocateDrawBuffers(m_drawBufferMode, m_drawBufferLines);
+    if (result != OS_OK && m_drawBufferMode != DRAW_BUFFER_PARTIAL) {
+        ESP_LOGW(TAG, "Falling back to partial draw buffers");
+        result = allocateDrawBuffers(DRAW_BUFFER_PARTIAL, m_drawBufferLines);
+    }
+    if (result != OS_OK) {
+        return result;
+    }
+
     m_displayDriver.hor_res = OS_SCREEN_WIDTH;
     m_displayDriver.ver_res = OS_SCREEN_HEIGHT;
     m_displayDriver.flush_cb = lvglFlushCallback;
+    m_displayDriver.wait_cb = lvglWaitCallback;
+#if OS_DISPLAY_AREA_MERGING
+    m_displayDriver.rounder_cb = lvglRounderCallback;
+    m_displayDriver.render_start_cb = lvglRenderStartCallback;
+#endif
     m_displayDriver.draw_buf = &m_drawBuffer;
     m_displayDriver.user_data = this;
 
@@ -282,9 +392,151 @@ os_error_t DisplayHAL::initializeLVGL() {
         return OS_ERROR_GENERIC;
     }
 
-    ESP_LOGI(TAG, "LVGL display driver initialized (%s buffer, %d lines)",
-             m_buffer2 ? "double" : "single", bufferSize / OS_SCREEN_WIDTH);
+    // Default scan-out target until a panel driver attaches its own backend
+    if (!m_framebufferBackend) {
+        m_framebufferBackend = new FramebufferFlushBackend(OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT,
+                                                           sizeof(lv_color_t));
+        if (m_framebufferBackend->start() != OS_OK) {
+            ESP_LOGW(TAG, "No scan-out framebuffer - flushes will be dropped");
+            delete m_framebufferBackend;
+            m_framebufferBackend = nullptr;
+        }
+    }
+    setFlushBackend(m_flushBackend);
+
+    ESP_LOGI(TAG, "LVGL display driver initialized (%s, %s buffer, %d lines)",
+             getDrawBufferModeName(m_drawBufferMode), m_buffer2 ? "double" : "single",
+             (int)m_drawBufferLines);
+
+    return OS_OK;
+}
 
+os_error_t DisplayHAL::allocateDrawBuffers(draw_buffer_mode_t mode, uint32_t lines) {
+    bool fullScreen = mode != DRAW_BUFFER_PARTIAL;
+    uint32_t bufferSize = OS_SCREEN_WIDTH * (fullScreen ? OS_SCREEN_HEIGHT : lines);
+    size_t bufferBytes = bufferSize * sizeof(lv_color_t);
+    lv_color_t* buffer1 = nullptr;
+    lv_color_t* buffer2 = nullptr;
+    bool inPsram = true;
+
+    if (fullScreen) {
+        // Both screen-sized buffers come out of the PSRAM display reservation
+        if (bufferBytes * 2 > OS_DISPLAY_BUFFER_SIZE) {
+            ESP_LOGE(TAG, "Two %d byte frame buffers exceed the display reservation", (int)bufferBytes);
+            return OS_ERROR_NO_MEMORY;
+        }
+        buffer1 = static_cast<lv_color_t*>(heap_caps_malloc(bufferBytes, MALLOC_CAP_SPIRAM));
+        buffer2 = static_cast<lv_color_t*>(heap_caps_malloc(bufferBytes, MALLOC_CAP_SPIRAM));
+        if (!buffer1 || !buffer2) {
+            ESP_LOGE(TAG, "Failed to allocate full-screen draw buffers in PSRAM");
+            free(buffer1);
+            free(buffer2);
+            return OS_ERROR_NO_MEMORY;
+        }
+    } else {
+        // Strips render fastest from internal SRAM; PSRAM is the fallback
+        uint32_t internalCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+        buffer1 = static_cast<lv_color_t*>(heap_caps_malloc(bufferBytes, internalCaps));
+        if (buffer1) {
+            inPsram = false;
+        } else {
+            ESP_LOGW(TAG, "Failed to allocate primary draw buffer in SRAM, trying PSRAM");
+            buffer1 = static_cast<lv_color_t*>(heap_caps_malloc(bufferBytes, MALLOC_CAP_SPIRAM));
+            if (!buffer1) {
+                ESP_LOGE(TAG, "Failed to allocate primary draw buffer");
+                return OS_ERROR_NO_MEMORY;
+            }
+        }
+
+        // Second buffer essential for 60Hz double buffering
+        buffer2 = static_cast<lv_color_t*>(heap_caps_malloc(bufferBytes, inPsram ? MALLOC_CAP_SPIRAM : internalCaps));
+        if (!buffer2) {
+            ESP_LOGW(TAG, "No secondary buffer - 60Hz performance may be reduced");
+        }
+    }
+
+    // LVGL reads the draw buffer descriptor on the next refresh; the old
+    // buffers may still be in flight. A transfer that timed out may still
+    // be reading one, so keep them rather than free them under it
+    if (!m_flushPipeline.waitForTransfer()) {
+        free(buffer1);
+        free(buffer2);
+        return OS_ERROR_TIMEOUT;
+    }
+    lv_disp_draw_buf_init(&m_drawBuffer, buffer1, buffer2, bufferSize);
+    m_displayDriver.full_refresh = mode == DRAW_BUFFER_FULL;
+    m_displayDriver.direct_mode = mode == DRAW_BUFFER_DIRECT;
+
+    free(m_buffer1);
+    free(m_buffer2);
+    m_buffer1 = buffer1;
+    m_buffer2 = buffer2;
+    m_drawBufferMode = mode;
+    m_drawBuffersInPsram = inPsram;
+    m_drawBufferLines = lines;
+    m_dirtyRegion.setTileLines(lines);
+    return OS_OK;
+}
+
+os_error_t DisplayHAL::setDrawBufferLines(uint32_t lines) {
+    if (lines == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    return setDrawBufferMode(m_drawBufferMode, lines);
+}
+
+os_error_t DisplayHAL::setDrawBufferMode(draw_buffer_mode_t mode, uint32_t lines) {
+    if (lines == 0) {
+        lines = m_drawBufferLines;
+    }
+    if (lines > OS_SCREEN_HEIGHT) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    // Strip height only matters to partial mode
+    bool resize = mode == DRAW_BUFFER_PARTIAL && lines != m_drawBufferLines;
+    if (!m_initialized || (mode == m_drawBufferMode && !resize)) {
+        m_drawBufferMode = mode;
+        m_drawBufferLines = lines;
+        m_dirtyRegion.setTileLines(lines);
+        return OS_OK;
+    }
+
+    os_error_t result = allocateDrawBuffers(mode, lines);
+    if (result != OS_OK) {
+        ESP_LOGW(TAG, "Keeping %s draw buffers", getDrawBufferModeName(m_drawBufferMode));
+        return result;
+    }
+
+    // The new buffers start empty; redraw everything into them
+    lv_obj_invalidate(lv_scr_act());
+    ESP_LOGI(TAG, "Draw buffers switched to %s (%d lines)", getDrawBufferModeName(mode), (int)lines);
+    return OS_OK;
+}
+
+const char* DisplayHAL::getDrawBufferModeName(draw_buffer_mode_t mode) {
+    switch (mode) {
+        case DRAW_BUFFER_PARTIAL: return "partial";
+        case DRAW_BUFFER_FULL: return "full";
+        case DRAW_BUFFER_DIRECT: return "direct";
+        default: return "unknown";
+    }
+}
+
+os_error_t DisplayHAL::setRefreshPeriod(uint32_t periodMs) {
+    if (periodMs == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    m_refreshPeriodMs = periodMs;
+    if (!m_lvglDisplay) {
+        return OS_OK;
+    }
+
+    lv_timer_t* refreshTimer = _lv_disp_get_refr_timer(m_lvglDisplay);
+    if (!refreshTimer) {
+        return OS_ERROR_GENERIC;
+    }
+    lv_timer_set_period(refreshTimer, periodMs);
     return OS_OK;
 }
 
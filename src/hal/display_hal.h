@@ -2,6 +2,8 @@
 #define DISPLAY_HAL_H
 
 #include "../system/os_config.h"
+#include "flush_pipeline.h"
+#include "dirty_region.h"
 #include <lvgl.h>
 
 /**
@@ -9,6 +11,9 @@
  * @brief Display Hardware Abstraction Layer for M5Stack Tab5
  * 
  * Manages the 5-inch 1280x720 MIPI-DSI display with LVGL integration.
+ * Flushes are asynchronous: LVGL renders into one draw buffer while the
+ * other is transferred by the FlushPipeline. Invalidated areas are
+ * tile-aligned and merged by a DirtyRegion before LVGL renders them.
  */
 
 class DisplayHAL {
@@ -98,6 +103,97 @@ public:
      */
     os_error_t forceRefresh();
 
+    /**
+     * @brief Set the LVGL refresh period
+     * @param periodMs Milliseconds between display refreshes
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setRefreshPeriod(uint32_t periodMs);
+
+    /**
+     * @brief Get the LVGL refresh period
+     * @return Milliseconds between display refreshes
+     */
+    uint32_t getRefreshPeriod() const { return m_refreshPeriodMs; }
+
+    /**
+     * @brief Resize the LVGL draw buffers
+     *
+     * Taller buffers mean fewer flushes per frame at the cost of memory.
+     * The old buffers are kept if the new ones cannot be allocated. Call
+     * from the main loop, outside lv_timer_handler(). Only partial mode
+     * uses strips; in the full-screen modes the height is remembered for
+     * the next switch back.
+     * @param lines Buffer height in display lines
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setDrawBufferLines(uint32_t lines);
+
+    /**
+     * @brief Switch the draw buffer layout
+     *
+     * Partial strips in SRAM render quickly and leave PSRAM alone but
+     * flush many times per frame. Full mode redraws the whole screen into
+     * PSRAM every frame, which suits full-screen animation. Direct mode
+     * redraws only dirty areas in place, copying them into the other
+     * buffer afterwards. The old buffers are kept if the new ones cannot
+     * be allocated, or if a flush still reading them does not finish.
+     * Call from the main loop, outside lv_timer_handler().
+     * @param mode Buffer layout
+     * @param lines Strip height for partial mode, 0 to keep the current one
+     * @return OS_OK on success, OS_ERROR_TIMEOUT if a flush was stuck,
+     *         other error code on failure
+     */
+    os_error_t setDrawBufferMode(draw_buffer_mode_t mode, uint32_t lines = 0);
+
+    /**
+     * @brief Get the draw buffer layout
+     * @return Current buffer layout
+     */
+    draw_buffer_mode_t getDrawBufferMode() const { return m_drawBufferMode; }
+
+    /**
+     * @brief Check where the draw buffers live
+     * @return true if LVGL renders into PSRAM
+     */
+    bool drawBuffersInPsram() const { return m_drawBuffersInPsram; }
+
+    /**
+     * @brief Get a draw buffer layout's name for logs
+     * @param mode Buffer layout
+     * @return Mode name
+     */
+    static const char* getDrawBufferModeName(draw_buffer_mode_t mode);
+
+    /**
+     * @brief Get the LVGL draw buffer height
+     * @return Buffer height in display lines
+     */
+    uint32_t getDrawBufferLines() const { return m_drawBufferLines; }
+
+    /**
+     * @brief Route flushes to a different transfer engine
+     *
+     * By default flushes go to a PSRAM scan-out framebuffer. A panel
+     * driver attaches its own backend (e.g. DMA2D into the DPI panel's
+     * framebuffer) here; nullptr restores the default.
+     * @param backend Backend to use; must stay valid until replaced or shutdown
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t setFlushBackend(FlushBackend* backend);
+
+    /**
+     * @brief Get flush transfer and render/transfer overlap statistics
+     * @return Flush statistics
+     */
+    FlushStats getFlushStats() const { return m_flushPipeline.getStats(); }
+
+    /**
+     * @brief Get area merging and pixels-flushed-per-frame statistics
+     * @return Partial refresh statistics
+     */
+    PartialRefreshStats getPartialRefreshStats() const { return m_dirtyRegion.getStats(); }
+
     /**
      * @brief Get frame rate statistics
      * @return Current FPS
@@ -120,6 +216,31 @@ private:
                                  const lv_area_t* area, 
                                  lv_color_t* color_p);
 
+    /**
+     * @brief LVGL wait callback, called while LVGL needs the buffer in flight
+     * @param disp_drv Display driver
+     */
+    static void lvglWaitCallback(lv_disp_drv_t* disp_drv);
+
+    /**
+     * @brief LVGL rounder callback; aligns invalidated areas to buffer tiles
+     * @param disp_drv Display driver
+     * @param area Area to round in place
+     */
+    static void lvglRounderCallback(lv_disp_drv_t* disp_drv, lv_area_t* area);
+
+    /**
+     * @brief LVGL render start callback; merges the pending invalidated areas
+     * @param disp_drv Display driver
+     */
+    static void lvglRenderStartCallback(lv_disp_drv_t* disp_drv);
+
+    /**
+     * @brief Flush pipeline completion; tells LVGL the buffer is free
+     * @param context Display driver
+     */
+    static void flushReady(void* context);
+
     /**
      * @brief Initialize hardware (GPIO, PWM, MIPI-DSI)
      * @return OS_OK on success, error code on failure
@@ -132,6 +253,14 @@ private:
      */
     os_error_t initializeLVGL();
 
+    /**
+     * @brief Allocate draw buffers and hand them to LVGL, freeing the old ones
+     * @param mode Buffer layout
+     * @param lines Strip height in display lines for partial mode
+     * @return OS_OK on success, OS_ERROR_NO_MEMORY if no buffer could be allocated
+     */
+    os_error_t allocateDrawBuffers(draw_buffer_mode_t mode, uint32_t lines);
+
     /**
      * @brief Update FPS statistics
      */
@@ -149,6 +278,16 @@ private:
     lv_disp_draw_buf_t m_drawBuffer;
     lv_color_t* m_buffer1 = nullptr;
     lv_color_t* m_buffer2 = nullptr;
+    uint32_t m_drawBufferLines = OS_DRAW_BUFFER_LINES;
+    draw_buffer_mode_t m_drawBufferMode = OS_DRAW_BUFFER_MODE;
+    bool m_drawBuffersInPsram = false;
+    uint32_t m_refreshPeriodMs = 1000 / OS_UI_REFRESH_RATE;
+
+    // Flush path
+    FlushPipeline m_flushPipeline;
+    FramebufferFlushBackend* m_framebufferBackend = nullptr;
+    FlushBackend* m_flushBackend = nullptr;
+    DirtyRegion m_dirtyRegion{OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT, OS_DRAW_BUFFER_LINES};
 
     // Statistics
     uint32_t m_frameCount = 0;
@@ -0,0 +1,312 @@
+#include "flush_pipeline.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+#include <chrono>
+
+static const char* TAG = "FlushPipeline";
+
+FlushPipeline::~FlushPipeline() {
+    shutdown();
+    if (m_done) {
+        vSemaphoreDelete(m_done);
+        m_done = nullptr;
+    }
+}
+
+os_error_t FlushPipeline::initialize(FlushBackend* backend, ReadyCallback onReady, void* context,
+                                     uint8_t bytesPerPixel) {
+    if (!backend || bytesPerPixel == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    if (!m_done) {
+        m_done = xSemaphoreCreateBinary();
+        if (!m_done) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    // Let the previous backend finish with its buffer before switching
+    waitForTransfer();
+
+    m_backend = backend;
+    m_onReady = onReady;
+    m_context = context;
+    m_bytesPerPixel = bytesPerPixel;
+    resetStats();
+
+    ESP_LOGI(TAG, "Flush pipeline using %s backend", backend->getName());
+    return OS_OK;
+}
+
+void FlushPipeline::shutdown() {
+    if (m_backend) {
+        waitForTransfer();
+        m_backend = nullptr;
+    }
+
+    // A completion goes idle before giving the semaphore; let it finish
+    while (m_completing.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+os_error_t FlushPipeline::submit(const FlushRequest& request) {
+    if (!m_backend) {
+        if (m_onReady) {
+            m_onReady(m_context);
+        }
+        return OS_ERROR_NOT_INITIALIZED;
+    }
+
+    // Only one transfer in flight: the other draw buffer is LVGL's
+    if (isBusy()) {
+        waitForTransfer();
+    }
+
+    uint32_t sequence = ++m_nextSequence;
+    if (sequence == COMPLETING) {
+        sequence = m_nextSequence = 1;  // IDLE and COMPLETING are never issued
+    }
+    FlushRequest transfer = request;
+    transfer.sequence = sequence;
+
+    m_transferStartUs = esp_timer_get_time();
+    m_transferBytes = request.pixelCount() * m_bytesPerPixel;
+    m_transferLast = request.lastInFrame;
+    m_inFlight.store(sequence, std::memory_order_release);
+
+    os_error_t result = m_backend->startTransfer(transfer, *this);
+    if (result != OS_OK) {
+        ESP_LOGW(TAG, "%s backend rejected a %dx%d flush: %d",
+                 m_backend->getName(), (int)request.width(), (int)request.height(), result);
+        // Unless the backend completed it anyway, which already told LVGL
+        if (abandonTransfer(sequence) && m_onReady) {
+            m_onReady(m_context);
+        }
+    }
+    return result;
+}
+
+void IRAM_ATTR FlushPipeline::completeTransfer(uint32_t sequence) {
+    m_completing.fetch_add(1, std::memory_order_acq_rel);
+
+    // Claim the transfer so a timeout cannot abandon it while it is reported
+    uint32_t expected = sequence;
+    if (sequence == IDLE || sequence == COMPLETING ||
+        !m_inFlight.compare_exchange_strong(expected, COMPLETING, std::memory_order_acq_rel)) {
+        m_completing.fetch_sub(1, std::memory_order_release);
+        return;     // Abandoned or superseded; already reported to LVGL
+    }
+
+    uint64_t elapsed = esp_timer_get_time() - m_transferStartUs;
+    m_transferUs.fetch_add(elapsed, std::memory_order_relaxed);
+    m_bytes.fetch_add(m_transferBytes, std::memory_order_relaxed);
+    m_transfers.fetch_add(1, std::memory_order_relaxed);
+    if (m_transferLast) {
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // LVGL may reuse the buffer from here on
+    if (m_onReady) {
+        m_onReady(m_context);
+    }
+    m_inFlight.store(IDLE, std::memory_order_release);
+
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(m_done, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xSemaphoreGive(m_done);
+    }
+    m_completing.fetch_sub(1, std::memory_order_release);
+}
+
+bool FlushPipeline::waitForTransfer(uint32_t timeoutMs) {
+    if (!isBusy()) {
+        return true;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + (int64_t)timeoutMs * 1000;
+
+    // The semaphore may hold a token from a transfer nobody waited for, so
+    // the busy flag, not the take, decides when the wait is over
+    while (isBusy()) {
+        int64_t remainingUs = deadline - esp_timer_get_time();
+        if (remainingUs <= 0) {
+            break;
+        }
+        TickType_t ticks = pdMS_TO_TICKS((remainingUs + 999) / 1000);
+        xSemaphoreTake(m_done, ticks > 0 ? ticks : 1);
+    }
+
+    m_waitUs += esp_timer_get_time() - start;
+
+    if (isBusy() && abandonTransfer(m_inFlight.load(std::memory_order_acquire))) {
+        m_timeouts++;
+        ESP_LOGW(TAG, "Flush transfer on %s backend timed out after %d ms",
+                 m_backend ? m_backend->getName() : "detached", (int)timeoutMs);
+        if (m_onReady) {
+            m_onReady(m_context);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool FlushPipeline::abandonTransfer(uint32_t sequence) {
+    uint32_t expected = sequence;
+    if (sequence != COMPLETING &&
+        m_inFlight.compare_exchange_strong(expected, IDLE, std::memory_order_acq_rel)) {
+        return true;
+    }
+
+    // Lost the race to completeTransfer(); it reports to LVGL, just let it finish
+    while (m_inFlight.load(std::memory_order_acquire) == COMPLETING) {
+        std::this_thread::yield();
+    }
+    return false;
+}
+
+FlushStats FlushPipeline::getStats() const {
+    FlushStats stats;
+    stats.transfers = m_transfers.load(std::memory_order_relaxed);
+    stats.frames = m_frames.load(std::memory_order_relaxed);
+    stats.bytes = m_bytes.load(std::memory_order_relaxed);
+    stats.transferUs = m_transferUs.load(std::memory_order_relaxed);
+    stats.timeouts = m_timeouts;
+    stats.waitUs = m_waitUs;
+
+    if (stats.transferUs > 0) {
+        uint64_t hidden = stats.transferUs > stats.waitUs ? stats.transferUs - stats.waitUs : 0;
+        stats.overlapPercent = 100.0f * hidden / stats.transferUs;
+        stats.throughputMBps = (float)stats.bytes / stats.transferUs;
+    }
+    return stats;
+}
+
+void FlushPipeline::resetStats() {
+    m_transfers = 0;
+    m_frames = 0;
+    m_bytes = 0;
+    m_transferUs = 0;
+    m_timeouts = 0;
+    m_waitUs = 0;
+}
+
+FramebufferFlushBackend::FramebufferFlushBackend(uint16_t width, uint16_t height,
+                                                 uint8_t bytesPerPixel, float bandwidthMBps)
+    : m_width(width), m_height(height), m_bytesPerPixel(bytesPerPixel),
+      m_bandwidthMBps(bandwidthMBps) {
+}
+
+FramebufferFlushBackend::~FramebufferFlushBackend() {
+    stop();
+    free(m_framebuffer);
+}
+
+os_error_t FramebufferFlushBackend::start() {
+    if (m_running) {
+        return OS_OK;
+    }
+
+    if (!m_framebuffer) {
+        size_t size = (size_t)m_width * m_height * m_bytesPerPixel;
+        m_framebuffer = static_cast<uint8_t*>(heap_caps_malloc(size, MALLOC_CAP_SPIRAM));
+        if (!m_framebuffer) {
+            ESP_LOGE(TAG, "Failed to allocate %d byte framebuffer", (int)size);
+            return OS_ERROR_NO_MEMORY;
+        }
+        memset(m_framebuffer, 0, size);
+    }
+
+    m_running = true;
+    m_thread = std::thread(&FramebufferFlushBackend::transferLoop, this);
+    return OS_OK;
+}
+
+void FramebufferFlushBackend::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+os_error_t FramebufferFlushBackend::startTransfer(const FlushRequest& request, FlushPipeline& pipeline) {
+    if (!request.pixels || request.x1 < 0 || request.y1 < 0 ||
+        request.x2 >= m_width || request.y2 >= m_height || request.x2 < request.x1 ||
+        request.y2 < request.y1) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return OS_ERROR_NOT_INITIALIZED;
+        }
+        if (m_pending) {
+            return OS_ERROR_BUSY;
+        }
+        m_request = request;
+        m_pipeline = &pipeline;
+        m_pending = true;
+    }
+    m_wake.notify_one();
+    return OS_OK;
+}
+
+void FramebufferFlushBackend::transferLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_pending || !m_running; });
+        if (!m_pending) {
+            return;     // Stopped with nothing in flight
+        }
+
+        FlushRequest request = m_request;
+        FlushPipeline* pipeline = m_pipeline;
+        lock.unlock();
+
+        int64_t start = esp_timer_get_time();
+        size_t rowBytes = request.width() * m_bytesPerPixel;
+        size_t sourcePitch = request.rowPitch() * m_bytesPerPixel;
+        size_t stride = (size_t)m_width * m_bytesPerPixel;
+        const uint8_t* source = static_cast<const uint8_t*>(request.pixels);
+        uint8_t* destination = m_framebuffer + request.y1 * stride + request.x1 * m_bytesPerPixel;
+
+        for (uint32_t row = 0; row < request.height(); row++) {
+            memcpy(destination, source, rowBytes);
+            source += sourcePitch;
+            destination += stride;
+        }
+
+        // Hold the transfer for as long as the link would have taken
+        if (m_bandwidthMBps > 0.0f) {
+            int64_t linkUs = (int64_t)(rowBytes * request.height() / m_bandwidthMBps);
+            int64_t remainingUs = start + linkUs - esp_timer_get_time();
+            if (remainingUs > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(remainingUs));
+            }
+        }
+
+        lock.lock();
+        m_pending = false;
+        lock.unlock();
+
+        // Outside the lock: the ready callback may submit the next area
+        pipeline->completeTransfer(request.sequence);
+        lock.lock();
+    }
+}
@@ -0,0 +1,256 @@
+#ifndef FLUSH_PIPELINE_H
+#define FLUSH_PIPELINE_H
+
+#include "../system/os_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @file flush_pipeline.h
+ * @brief Asynchronous display flush path for M5Stack Tab5
+ *
+ * LVGL's flush callback hands a rendered area to submit(), which starts
+ * a transfer on a FlushBackend and returns at once. LVGL goes on
+ * rendering into the other draw buffer; when it needs to flush again it
+ * calls waitForTransfer() from its wait callback. The backend reports
+ * the end of the transfer with completeTransfer(), from a DMA/DSI
+ * interrupt or a stand-in thread, which tells LVGL the buffer is free
+ * again (lv_disp_flush_ready()). Each transfer carries a sequence number,
+ * so a completion that arrives after its transfer was abandoned cannot
+ * release the buffer of the transfer that replaced it.
+ *
+ * The pipeline records how long transfers took and how long LVGL was
+ * blocked waiting for one. Transfer time LVGL did not wait for was
+ * hidden behind rendering; that share is the render/transfer overlap.
+ */
+
+struct FlushRequest {
+    int16_t x1 = 0;                 // Inclusive, as lv_area_t
+    int16_t y1 = 0;
+    int16_t x2 = 0;
+    int16_t y2 = 0;
+    const void* pixels = nullptr;   // Row-major, first pixel of the area
+    uint32_t stride = 0;            // Pixels between row starts, 0 when rows are packed
+    bool lastInFrame = true;        // Last area LVGL flushes for this refresh
+    uint32_t sequence = 0;          // Set by submit(); hand back to completeTransfer()
+
+    uint32_t width() const { return x2 - x1 + 1; }
+    uint32_t height() const { return y2 - y1 + 1; }
+    uint32_t pixelCount() const { return width() * height(); }
+    uint32_t rowPitch() const { return stride ? stride : width(); }
+};
+
+struct FlushStats {
+    uint32_t transfers = 0;
+    uint32_t frames = 0;            // Transfers marked lastInFrame
+    uint32_t timeouts = 0;          // waitForTransfer() gave up
+    uint64_t bytes = 0;
+    uint64_t transferUs = 0;        // Submit to completion
+    uint64_t waitUs = 0;            // LVGL blocked on an in-flight transfer
+    float overlapPercent = 0.0f;    // Transfer time hidden behind rendering
+    float throughputMBps = 0.0f;    // Bytes over transfer time
+};
+
+class FlushPipeline;
+
+class FlushBackend {
+public:
+    virtual ~FlushBackend() = default;
+
+    /**
+     * @brief Start moving an area to the panel
+     *
+     * Must return without waiting for the transfer, and call
+     * pipeline.completeTransfer(request.sequence) exactly once when the
+     * pixels have been read, from any context including an ISR.
+     * @param request Area and pixels; the pixels stay valid until completion
+     * @param pipeline Pipeline to notify
+     * @return OS_OK if the transfer was started
+     */
+    virtual os_error_t startTransfer(const FlushRequest& request, FlushPipeline& pipeline) = 0;
+
+    /**
+     * @brief Get a short name for logs
+     * @return Backend name
+     */
+    virtual const char* getName() const = 0;
+};
+
+class FlushPipeline {
+public:
+    typedef void (*ReadyCallback)(void* context);
+
+    FlushPipeline() = default;
+    ~FlushPipeline();
+
+    FlushPipeline(const FlushPipeline&) = delete;
+    FlushPipeline& operator=(const FlushPipeline&) = delete;
+
+    /**
+     * @brief Connect a backend
+     * @param backend Transfer engine; must outlive the pipeline or a later initialize()
+     * @param onReady Called on completion, possibly from an ISR (lv_disp_flush_ready)
+     * @param context Passed to onReady
+     * @param bytesPerPixel Pixel size of submitted buffers
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(FlushBackend* backend, ReadyCallback onReady, void* context,
+                          uint8_t bytesPerPixel);
+
+    /**
+     * @brief Wait for the transfer in flight and disconnect the backend
+     */
+    void shutdown();
+
+    /**
+     * @brief Start flushing an area
+     *
+     * Waits first if a transfer is still in flight. If the backend cannot
+     * start the transfer the area is dropped and onReady is called, so
+     * LVGL never stalls on a lost flush.
+     * @param request Area and pixels
+     * @return OS_OK if the transfer was started
+     */
+    os_error_t submit(const FlushRequest& request);
+
+    /**
+     * @brief Report the end of a transfer; ISR safe
+     *
+     * Ignored unless sequence is the transfer in flight, so a completion
+     * for a transfer abandoned by a timeout is dropped.
+     * @param sequence FlushRequest::sequence of the finished transfer
+     */
+    void completeTransfer(uint32_t sequence);
+
+    /**
+     * @brief Block until no transfer is in flight
+     *
+     * On timeout the transfer is abandoned and onReady is called, so a
+     * lost completion costs one stale area rather than a stalled display.
+     * @param timeoutMs Give up after this long
+     * @return true if idle, false on timeout
+     */
+    bool waitForTransfer(uint32_t timeoutMs = OS_FLUSH_TIMEOUT_MS);
+
+    /**
+     * @brief Check whether a transfer is in flight
+     * @return true while busy
+     */
+    bool isBusy() const { return m_inFlight.load(std::memory_order_acquire) != IDLE; }
+
+    /**
+     * @brief Get transfer and overlap statistics
+     * @return Statistics since initialize() or resetStats()
+     */
+    FlushStats getStats() const;
+
+    /**
+     * @brief Clear statistics
+     */
+    void resetStats();
+
+private:
+    static constexpr uint32_t IDLE = 0;
+    static constexpr uint32_t COMPLETING = UINT32_MAX;     // Claimed by completeTransfer()
+
+    /**
+     * @brief Give up on the transfer in flight
+     * @param sequence Transfer to abandon
+     * @return false if it completed (or is completing) in the meantime
+     */
+    bool abandonTransfer(uint32_t sequence);
+
+    FlushBackend* m_backend = nullptr;
+    ReadyCallback m_onReady = nullptr;
+    void* m_context = nullptr;
+    uint8_t m_bytesPerPixel = 2;
+    SemaphoreHandle_t m_done = nullptr;     // Given by completeTransfer()
+
+    std::atomic<uint32_t> m_inFlight{IDLE}; // Sequence of the transfer in flight
+    uint32_t m_nextSequence = IDLE;
+    std::atomic<int> m_completing{0};       // completeTransfer() calls still running
+    int64_t m_transferStartUs = 0;
+    uint32_t m_transferBytes = 0;
+    bool m_transferLast = false;
+
+    // Written by completeTransfer(), read by getStats()
+    std::atomic<uint32_t> m_transfers{0};
+    std::atomic<uint32_t> m_frames{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_transferUs{0};
+
+    // Main thread only
+    uint32_t m_timeouts = 0;
+    uint64_t m_waitUs = 0;
+};
+
+/**
+ * @brief Backend that copies areas into an in-memory framebuffer
+ *
+ * A worker thread stands in for the DMA engine: it copies each area into
+ * a full-screen framebuffer and, if a bandwidth is set, holds the
+ * transfer until it would have finished at that rate. Used on the host to
+ * exercise the pipeline, and on the device as the scan-out buffer when no
+ * panel backend is attached.
+ */
+class FramebufferFlushBackend : public FlushBackend {
+public:
+    /**
+     * @param width Framebuffer width in pixels
+     * @param height Framebuffer height in pixels
+     * @param bytesPerPixel Pixel size
+     * @param bandwidthMBps Simulated transfer rate, 0 for as fast as memory allows
+     */
+    FramebufferFlushBackend(uint16_t width, uint16_t height, uint8_t bytesPerPixel,
+                            float bandwidthMBps = 0.0f);
+    ~FramebufferFlushBackend() override;
+
+    /**
+     * @brief Allocate the framebuffer and start the transfer thread
+     * @return OS_OK on success, OS_ERROR_NO_MEMORY if the framebuffer cannot be allocated
+     */
+    os_error_t start();
+
+    /**
+     * @brief Finish the transfer in flight and stop the thread
+     */
+    void stop();
+
+    os_error_t startTransfer(const FlushRequest& request, FlushPipeline& pipeline) override;
+    const char* getName() const override { return "framebuffer"; }
+
+    void setBandwidth(float bandwidthMBps) { m_bandwidthMBps = bandwidthMBps; }
+
+    /**
+     * @brief Get the framebuffer contents
+     * @return Row-major pixels, or nullptr before start()
+     */
+    const uint8_t* getFramebuffer() const { return m_framebuffer; }
+
+    uint16_t getWidth() const { return m_width; }
+    uint16_t getHeight() const { return m_height; }
+
+private:
+    void transferLoop();
+
+    uint16_t m_width;
+    uint16_t m_height;
+    uint8_t m_bytesPerPixel;
+    float m_bandwidthMBps;
+    uint8_t* m_framebuffer = nullptr;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_running = false;
+    bool m_pending = false;
+    FlushRequest m_request;
+    FlushPipeline* m_pipeline = nullptr;
+};
+
+#endif // FLUSH_PIPELINE_H
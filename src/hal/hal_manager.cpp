@@ -15,21 +15,17 @@ os_error_t HALManager::initialize() {
 
     ESP_LOGI(TAG, "Initializing HAL Manager");
 
-    // Initialize hardware components
-    os_error_t result = initializeComponents();
+    // Same stages as a parallel boot, one after another
+    BootSequencer boot;
+    os_error_t result = addBootStages(boot);
+    if (result == OS_OK) {
+        result = boot.run();
+    }
     if (result != OS_OK) {
         ESP_LOGE(TAG, "Failed to initialize hardware components: %d", result);
         return result;
     }
 
-    // Build hardware info string
-    snprintf(m_hardwareInfo, sizeof(m_hardwareInfo),
-             "M5Stack Tab5 ESP32-P4 %dx%d Display GT911 Touch",
-             OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT);
-
-    m_initialized = true;
-    ESP_LOGI(TAG, "HAL Manager initialized: %s", m_hardwareInfo);
-
     return OS_OK;
 }
 
@@ -181,47 +177,79 @@ os_error_t HALManager::setLowPowerMode(bool enabled) {
     return OS_OK;
 }
 
-os_error_t HALManager::initializeComponents() {
-    // Initialize display HAL first (others may depend on it)
-    m_displayHAL = new DisplayHAL();
-    if (!m_displayHAL || m_displayHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Display HAL");
-        return OS_ERROR_HARDWARE;
+os_error_t HALManager::addBootStages(BootSequencer& boot, const std::vector<std::string>& dependencies) {
+    if (boot.findStage("hal")) {
+        return OS_ERROR_ALREADY_EXISTS;
     }
 
-    // Initialize touch HAL
-    m_touchHAL = new TouchHAL();
-    if (!m_touchHAL || m_touchHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Touch HAL");
-        return OS_ERROR_HARDWARE;
-    }
+    // LVGL is not thread safe, so the display initializes on the main thread
+    boot.addStage("display", [this]() {
+        m_displayHAL = new DisplayHAL();
+        if (!m_displayHAL || m_displayHAL->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Display HAL");
+            return OS_ERROR_HARDWARE;
+        }
+        return OS_OK;
+    }, dependencies, BootThread::MAIN);
+
+    // GT911 probe and reset over I2C
+    boot.addStage("touch", [this]() {
+        m_touchHAL = new TouchHAL();
+        if (!m_touchHAL || m_touchHAL->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Touch HAL");
+            return OS_ERROR_HARDWARE;
+        }
+        return OS_OK;
+    }, dependencies);
 
-    // Initialize power management HAL
-    m_powerHAL = new PowerHAL();
-    if (!m_powerHAL || m_powerHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Power HAL");
-        return OS_ERROR_HARDWARE;
-    }
+    boot.addStage("power", [this]() {
+        m_powerHAL = new PowerHAL();
+        if (!m_powerHAL || m_powerHAL->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Power HAL");
+            return OS_ERROR_HARDWARE;
+        }
+        return OS_OK;
+    }, dependencies);
+
+    // SPIFFS and SD card mounts
+    boot.addStage("storage", [this]() {
+        m_storageHAL = new StorageHAL();
+        if (!m_storageHAL || m_storageHAL->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Storage HAL");
+            return OS_ERROR_HARDWARE;
+        }
+        return OS_OK;
+    }, dependencies);
 
-    // Initialize storage HAL
-    m_storageHAL = new StorageHAL();
-    if (!m_storageHAL || m_storageHAL->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Storage HAL");
-        return OS_ERROR_HARDWARE;
-    }
+    std::vector<std::string> components = {"display", "touch", "power", "storage"};
 
 #ifdef CONFIG_ESP_PPA_ACCELERATION
-    // Initialize PPA (Pixel Processing Accelerator)
-    esp_err_t ppa_result = ppa_hal_init();
-    if (ppa_result == ESP_OK) {
-        m_ppaAvailable = true;
-        ESP_LOGI(TAG, "PPA (Pixel Processing Accelerator) initialized successfully");
-    } else {
+    // Initialize PPA (Pixel Processing Accelerator); optional
+    boot.addStage("ppa", [this]() {
+        esp_err_t ppa_result = ppa_hal_init();
+        if (ppa_result == ESP_OK) {
+            m_ppaAvailable = true;
+            ESP_LOGI(TAG, "PPA (Pixel Processing Accelerator) initialized successfully");
+            return OS_OK;
+        }
+
         m_ppaAvailable = false;
         ESP_LOGW(TAG, "PPA initialization failed: %s", esp_err_to_name(ppa_result));
         ESP_LOGW(TAG, "Continuing without hardware graphics acceleration");
-    }
+        return OS_ERROR_HARDWARE;
+    }, dependencies, BootThread::WORKER, false);
+    components.push_back("ppa");
 #endif
 
-    return OS_OK;
-}
\ No newline at end of file
+    // Everything up; "ppa" only orders this after it, its failure is not fatal
+    return boot.addStage("hal", [this]() {
+        // Build hardware info string
+        snprintf(m_hardwareInfo, sizeof(m_hardwareInfo),
+                 "M5Stack Tab5 ESP32-P4 %dx%d Display GT911 Touch",
+                 OS_SCREEN_WIDTH, OS_SCREEN_HEIGHT);
+
+        m_initialized = true;
+        ESP_LOGI(TAG, "HAL Manager initialized: %s", m_hardwareInfo);
+        return OS_OK;
+    }, components, BootThread::MAIN);
+}
@@ -2,6 +2,7 @@
 #define HAL_MANAGER_H
 
 #include "../system/os_config.h"
+#include "../system/boot_sequencer.h"
 #include "display_hal.h"
 #include "touch_hal.h"
 #include "power_hal.h"
@@ -23,10 +24,26 @@ public:
 
     /**
      * @brief Initialize the HAL manager and all hardware components
+     *
+     * Runs the stages from addBootStages() one after another on the
+     * calling thread.
      * @return OS_OK on success, error code on failure
      */
     os_error_t initialize();
 
+    /**
+     * @brief Add one boot stage per hardware component
+     *
+     * Adds "display" (main thread, LVGL), "touch", "power", "storage" and
+     * the optional "ppa" as independent stages, plus "hal", which depends
+     * on all of them and marks the HAL initialized. Stages that only need
+     * the display and touch can depend on those two directly.
+     * @param boot Sequencer to add to
+     * @param dependencies Stages every component stage depends on
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t addBootStages(BootSequencer& boot, const std::vector<std::string>& dependencies = {});
+
     /**
      * @brief Shutdown the HAL manager
      * @return OS_OK on success, error code on failure
@@ -86,12 +103,6 @@ public:
     os_error_t setLowPowerMode(bool enabled);
 
 private:
-    /**
-     * @brief Initialize hardware components in order
-     * @return OS_OK on success, error code on failure
-     */
-    os_error_t initializeComponents();
-
     // Hardware component instances
     DisplayHAL* m_displayHAL = nullptr;
     TouchHAL* m_touchHAL = nullptr;
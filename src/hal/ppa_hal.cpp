@@ -1,55 +1,182 @@
 #include "ppa_hal.h"
+#include "ppa_soft.h"
+#include "ppa_queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <mutex>
 
 #ifdef CONFIG_ESP_PPA_ACCELERATION
 
-static const char* TAG = "PPA_HAL_STUB";
+static const char* TAG = "PPA_HAL";
 
 // Note: ESP32-P4 PPA driver is not yet available in Arduino ESP32 framework
-// This is a stub implementation that provides the API without hardware functionality
-// When the ESP-IDF PPA driver becomes available in Arduino framework, 
-// this can be replaced with the full implementation
+// Every operation runs on the software kernels in ppa_soft.cpp instead, on the
+// calling task, or on the command queue's worker for submitted operations. When
+// the ESP-IDF PPA driver becomes available the kernels stay as the reference to
+// validate it against
+
+// Scaled intermediates larger than this go to PSRAM
+#define PPA_SOFT_INTERNAL_BUFFER_MAX    (32 * 1024)
+
+static bool g_initialized = false;
+static PpaCommandQueue g_queue;
+
+// Performance tracking; operations run on callers' tasks and the worker
+static std::mutex g_stats_mutex;
+static uint32_t g_operation_count = 0;
+static uint64_t g_total_time_us = 0;
+static int64_t g_first_op_start = 0;
+
+static esp_err_t execute_operation(const ppa_operation_t& op);
+
+static void record_operation(int64_t start_us) {
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
+    if (g_operation_count == 0) {
+        g_first_op_start = start_us;
+    }
+    g_operation_count++;
+    g_total_time_us += esp_timer_get_time() - start_us;
+}
+
+static bool image_valid(const ppa_image_t* img) {
+    if (!img || !img->buffer || img->width == 0 || img->height == 0) {
+        return false;
+    }
+    return ppa_hal_format_supported(img->format, img->format);
+}
+
+static bool rect_inside(const ppa_image_t* img, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    return width > 0 && height > 0 && x + width <= img->width && y + height <= img->height;
+}
+
+static uint8_t* pixel_at(const ppa_image_t* img, uint32_t x, uint32_t y) {
+    return (uint8_t*)img->buffer + ((size_t)y * img->width + x) * ppa_hal_bytes_per_pixel(img->format);
+}
+
+// Whole-number upscales only repeat pixels, which nearest does exactly and without blurring
+static ppa_soft_filter_t choose_filter(uint16_t src_w, uint16_t src_h, uint16_t dst_w, uint16_t dst_h) {
+    if (dst_w % src_w == 0 && dst_h % src_h == 0) {
+        return PPA_SOFT_FILTER_NEAREST;
+    }
+    return PPA_SOFT_FILTER_BILINEAR;
+}
 
 // === Initialization ===
 
 esp_err_t ppa_hal_init(void) {
+    if (g_initialized) {
+        ESP_LOGW(TAG, "PPA HAL already initialized");
+        return ESP_OK;
+    }
+
+    esp_err_t ret = g_queue.start(execute_operation);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start command queue: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_stats_mutex);
+        g_operation_count = 0;
+        g_total_time_us = 0;
+    }
+    g_initialized = true;
+
     ESP_LOGW(TAG, "ESP32-P4 PPA driver not yet available in Arduino framework");
-    ESP_LOGI(TAG, "PPA HAL initialized in stub mode - ready for future driver integration");
-    ESP_LOGI(TAG, "Hardware acceleration will be available when ESP-IDF v5.4+ support is added");
+    ESP_LOGI(TAG, "PPA HAL initialized with software kernels");
     return ESP_OK;
 }
 
 esp_err_t ppa_hal_deinit(void) {
-    ESP_LOGI(TAG, "PPA HAL deinitialized (stub mode)");
+    // Runs whatever is still queued first
+    g_queue.stop();
+    g_initialized = false;
+    ESP_LOGI(TAG, "PPA HAL deinitialized");
     return ESP_OK;
 }
 
 bool ppa_hal_is_initialized(void) {
-    return true; // Always report as initialized in stub mode
+    return g_initialized;
 }
 
 ppa_hal_status_t ppa_hal_get_status(void) {
-    return PPA_STATUS_IDLE; // Always idle in stub mode
+    return g_queue.getPendingCount() > 0 ? PPA_STATUS_BUSY : PPA_STATUS_IDLE;
 }
 
 // === Transform Operations ===
 
-esp_err_t ppa_hal_transform_image(const ppa_image_t* src_img, 
+esp_err_t ppa_hal_transform_image(const ppa_image_t* src_img,
                                   const ppa_rect_t* src_rect,
-                                  const ppa_image_t* dst_img, 
+                                  const ppa_image_t* dst_img,
                                   uint16_t dst_x, uint16_t dst_y,
                                   const ppa_transform_t* transform,
                                   bool blocking) {
-    if (!src_img || !dst_img || !transform) {
+    if (!image_valid(src_img) || !image_valid(dst_img) || !transform ||
+        transform->scale_x <= 0.0f || transform->scale_y <= 0.0f) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Transform image operation (stub) - scale: %.2f,%.2f rotation: %d", 
-             transform->scale_x, transform->scale_y, transform->rotation);
-    
-    // In stub mode, we could implement software fallback here
-    // For now, just indicate the operation would succeed
-    return ESP_ERR_NOT_SUPPORTED;
+    if (src_img->format != dst_img->format) {
+        return ESP_ERR_NOT_SUPPORTED;   // No color conversion in software
+    }
+
+    ppa_rect_t area = {0, 0, src_img->width, src_img->height};
+    if (src_rect) {
+        area = *src_rect;
+    }
+    if (!rect_inside(src_img, area.x, area.y, area.width, area.height)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t scaled_w = (uint32_t)(area.width * transform->scale_x + 0.5f);
+    uint32_t scaled_h = (uint32_t)(area.height * transform->scale_y + 0.5f);
+    bool turned = transform->rotation & 1;
+    uint32_t out_w = turned ? scaled_h : scaled_w;
+    uint32_t out_h = turned ? scaled_w : scaled_h;
+    if (!rect_inside(dst_img, dst_x, dst_y, out_w, out_h)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ESP_LOGV(TAG, "Transform %ux%u -> %lux%lu, rotation: %d", area.width, area.height,
+             out_w, out_h, transform->rotation * 90);
+
+    int64_t start = esp_timer_get_time();
+    uint8_t bpp = ppa_hal_bytes_per_pixel(src_img->format);
+    const void* in = pixel_at(src_img, area.x, area.y);
+    uint32_t in_stride = src_img->width;
+    void* out = pixel_at(dst_img, dst_x, dst_y);
+    bool scaled = scaled_w != area.width || scaled_h != area.height;
+    bool moved = transform->rotation != PPA_SRM_ROTATION_ANGLE_0 || transform->mirror_x || transform->mirror_y;
+    void* intermediate = NULL;
+
+    if (scaled) {
+        ppa_soft_filter_t filter = choose_filter(area.width, area.height, scaled_w, scaled_h);
+        if (moved) {
+            // Scale into a scratch image, then rotate and mirror that into place
+            size_t bytes = (size_t)scaled_w * scaled_h * bpp;
+            intermediate = ppa_hal_alloc_buffer(bytes, bytes > PPA_SOFT_INTERNAL_BUFFER_MAX);
+            if (!intermediate) {
+                return ESP_ERR_NO_MEM;
+            }
+            ppa_soft_scale(intermediate, scaled_w, scaled_w, scaled_h,
+                           in, in_stride, area.width, area.height, bpp, filter);
+            in = intermediate;
+            in_stride = scaled_w;
+        } else {
+            ppa_soft_scale(out, dst_img->width, scaled_w, scaled_h,
+                           in, in_stride, area.width, area.height, bpp, filter);
+        }
+    }
+
+    if (moved) {
+        ppa_soft_rotate(out, dst_img->width, in, in_stride, scaled_w, scaled_h, bpp,
+                        transform->rotation, transform->mirror_x, transform->mirror_y);
+    } else if (!scaled) {
+        ppa_soft_copy(out, dst_img->width, in, in_stride, area.width, area.height, bpp);
+    }
+
+    ppa_hal_free_buffer(intermediate);
+    record_operation(start);
+    return ESP_OK;
 }
 
 esp_err_t ppa_hal_scale_image(const ppa_image_t* src_img,
@@ -59,9 +186,11 @@ esp_err_t ppa_hal_scale_image(const ppa_image_t* src_img,
     if (!src_img || !dst_img) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Scale image operation (stub) - scale: %.2f,%.2f", scale_x, scale_y);
-    return ESP_ERR_NOT_SUPPORTED;
+
+    ppa_transform_t transform = PPA_TRANSFORM_INIT();
+    transform.scale_x = scale_x;
+    transform.scale_y = scale_y;
+    return ppa_hal_transform_image(src_img, NULL, dst_img, 0, 0, &transform, blocking);
 }
 
 esp_err_t ppa_hal_rotate_image(const ppa_image_t* src_img,
@@ -71,9 +200,10 @@ esp_err_t ppa_hal_rotate_image(const ppa_image_t* src_img,
     if (!src_img || !dst_img) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Rotate image operation (stub) - angle: %d degrees", angle * 90);
-    return ESP_ERR_NOT_SUPPORTED;
+
+    ppa_transform_t transform = PPA_TRANSFORM_INIT();
+    transform.rotation = angle;
+    return ppa_hal_transform_image(src_img, NULL, dst_img, 0, 0, &transform, blocking);
 }
 
 // === Blend Operations ===
@@ -84,13 +214,36 @@ esp_err_t ppa_hal_blend_images(const ppa_image_t* bg_img,
                                const ppa_rect_t* blend_rect,
                                const ppa_blend_params_t* params,
                                bool blocking) {
-    if (!bg_img || !fg_img || !dst_img || !params) {
+    if (!image_valid(bg_img) || !image_valid(fg_img) || !image_valid(dst_img) || !params) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Blend images operation (stub) - alpha: bg=%d, fg=%d", 
+    if (fg_img->format != bg_img->format || dst_img->format != bg_img->format) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // The rectangle is at the same position in all three images
+    ppa_rect_t area = {0, 0, dst_img->width, dst_img->height};
+    if (blend_rect) {
+        area = *blend_rect;
+    }
+    if (!rect_inside(bg_img, area.x, area.y, area.width, area.height) ||
+        !rect_inside(fg_img, area.x, area.y, area.width, area.height) ||
+        !rect_inside(dst_img, area.x, area.y, area.width, area.height)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ESP_LOGV(TAG, "Blend %ux%u - alpha: bg=%d, fg=%d", area.width, area.height,
              params->bg_alpha, params->fg_alpha);
-    return ESP_ERR_NOT_SUPPORTED;
+
+    int64_t start = esp_timer_get_time();
+    ppa_soft_blend(pixel_at(dst_img, area.x, area.y), dst_img->width,
+                   pixel_at(bg_img, area.x, area.y), bg_img->width,
+                   pixel_at(fg_img, area.x, area.y), fg_img->width,
+                   area.width, area.height, ppa_hal_bytes_per_pixel(dst_img->format),
+                   params->fg_alpha, params->bg_alpha, params->color_key_enable,
+                   params->color_key_low, params->color_key_high, params->color_key_default);
+    record_operation(start);
+    return ESP_OK;
 }
 
 esp_err_t ppa_hal_alpha_blend(const ppa_image_t* bg_img,
@@ -98,12 +251,9 @@ esp_err_t ppa_hal_alpha_blend(const ppa_image_t* bg_img,
                               const ppa_image_t* dst_img,
                               uint8_t alpha,
                               bool blocking) {
-    if (!bg_img || !fg_img || !dst_img) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    ESP_LOGD(TAG, "Alpha blend operation (stub) - alpha: %d", alpha);
-    return ESP_ERR_NOT_SUPPORTED;
+    ppa_blend_params_t params = PPA_BLEND_PARAMS_INIT();
+    params.fg_alpha = alpha;
+    return ppa_hal_blend_images(bg_img, fg_img, dst_img, NULL, &params, blocking);
 }
 
 // === Fill Operations ===
@@ -112,73 +262,150 @@ esp_err_t ppa_hal_fill_rect(const ppa_image_t* dst_img,
                             const ppa_rect_t* fill_rect,
                             uint32_t color,
                             bool blocking) {
-    if (!dst_img) {
+    if (!image_valid(dst_img)) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Fill rectangle operation (stub) - color: 0x%08lX", color);
-    return ESP_ERR_NOT_SUPPORTED;
+
+    ppa_rect_t area = {0, 0, dst_img->width, dst_img->height};
+    if (fill_rect) {
+        area = *fill_rect;
+    }
+    if (!rect_inside(dst_img, area.x, area.y, area.width, area.height)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ESP_LOGV(TAG, "Fill %ux%u - color: 0x%08lX", area.width, area.height, color);
+
+    int64_t start = esp_timer_get_time();
+    uint8_t bpp = ppa_hal_bytes_per_pixel(dst_img->format);
+    ppa_soft_fill(pixel_at(dst_img, area.x, area.y), dst_img->width, area.width, area.height,
+                  bpp, ppa_soft_pack_color(color, bpp));
+    record_operation(start);
+    return ESP_OK;
 }
 
 esp_err_t ppa_hal_clear_image(const ppa_image_t* dst_img,
                               uint32_t color,
                               bool blocking) {
-    if (!dst_img) {
+    return ppa_hal_fill_rect(dst_img, NULL, color, blocking);
+}
+
+// === Command Queue ===
+
+static esp_err_t execute_operation(const ppa_operation_t& op) {
+    switch (op.type) {
+        case PPA_OP_FILL:
+            return ppa_hal_fill_rect(&op.dst, &op.rect, op.color, true);
+        case PPA_OP_BLIT: {
+            ppa_transform_t identity = PPA_TRANSFORM_INIT();
+            return ppa_hal_transform_image(&op.src, &op.rect, &op.dst, op.dst_x, op.dst_y, &identity, true);
+        }
+        case PPA_OP_BLEND:
+            return ppa_hal_blend_images(&op.bg, &op.src, &op.dst, &op.rect, &op.blend, true);
+        case PPA_OP_TRANSFORM:
+            return ppa_hal_transform_image(&op.src, &op.rect, &op.dst, op.dst_x, op.dst_y, &op.transform, true);
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+esp_err_t ppa_hal_submit(const ppa_operation_t* op,
+                         ppa_completion_cb_t callback, void* user_data,
+                         ppa_fence_t* fence) {
+    return ppa_hal_submit_batch(op, 1, callback, user_data, fence);
+}
+
+esp_err_t ppa_hal_submit_batch(const ppa_operation_t* ops, size_t count,
+                               ppa_completion_cb_t callback, void* user_data,
+                               ppa_fence_t* fence) {
+    if (!ops || count == 0) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGD(TAG, "Clear image operation (stub) - color: 0x%08lX", color);
-    return ESP_ERR_NOT_SUPPORTED;
+    return g_queue.submit(ops, count, callback, user_data, PPA_OPERATION_TIMEOUT_MS, fence);
+}
+
+esp_err_t ppa_hal_wait_fence(ppa_fence_t fence, uint32_t timeout_ms) {
+    return g_queue.wait(fence, timeout_ms);
+}
+
+bool ppa_hal_fence_signaled(ppa_fence_t fence) {
+    return g_queue.isSignaled(fence);
+}
+
+uint32_t ppa_hal_get_pending_count(void) {
+    return g_queue.getPendingCount();
 }
 
 // === LVGL Integration ===
 
 #ifdef PPA_ENABLE_LVGL_INTEGRATION
 esp_err_t ppa_hal_lvgl_init(void) {
-    ESP_LOGI(TAG, "LVGL PPA integration initialized (stub mode)");
-    ESP_LOGW(TAG, "Hardware acceleration not available - using software rendering");
+    ESP_LOGI(TAG, "LVGL PPA integration initialized with software kernels");
     return ESP_OK;
 }
 
-void ppa_hal_lvgl_fill(lv_disp_drv_t* disp_drv, lv_color_t* dest_buf, 
-                       lv_coord_t dest_width, const lv_area_t* fill_area, 
+void ppa_hal_lvgl_fill(lv_disp_drv_t* disp_drv, lv_color_t* dest_buf,
+                       lv_coord_t dest_width, const lv_area_t* fill_area,
                        lv_color_t color) {
-    ESP_LOGV(TAG, "LVGL fill operation (stub - no hardware acceleration)");
-    // In stub mode, just log the operation
-    // Hardware acceleration will be available when ESP-IDF PPA driver is integrated
+    if (!dest_buf || !fill_area) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    ppa_soft_fill(dest_buf + (size_t)fill_area->y1 * dest_width + fill_area->x1, dest_width,
+                  lv_area_get_width(fill_area), lv_area_get_height(fill_area),
+                  sizeof(lv_color_t), color.full);
+    record_operation(start);
 }
 
 void ppa_hal_lvgl_blend(lv_disp_drv_t* disp_drv, lv_color_t* dest_buf,
                         lv_coord_t dest_width, const lv_area_t* dest_area,
                         const lv_color_t* src_buf, lv_coord_t src_width,
                         const lv_area_t* src_area, lv_opa_t opa) {
-    ESP_LOGV(TAG, "LVGL blend operation (stub - no hardware acceleration)");
-    // In stub mode, just log the operation
-    // Hardware acceleration will be available when ESP-IDF PPA driver is integrated
+    if (opa >= LV_OPA_MAX) {
+        ppa_hal_lvgl_blit(disp_drv, dest_buf, dest_width, dest_area, src_buf, src_width, src_area);
+        return;
+    }
+    if (!dest_buf || !dest_area || !src_buf || !src_area || opa <= LV_OPA_MIN) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    lv_color_t* dest = dest_buf + (size_t)dest_area->y1 * dest_width + dest_area->x1;
+    ppa_soft_blend(dest, dest_width, dest, dest_width,
+                   src_buf + (size_t)src_area->y1 * src_width + src_area->x1, src_width,
+                   lv_area_get_width(dest_area), lv_area_get_height(dest_area),
+                   sizeof(lv_color_t), opa, LV_OPA_COVER, false, 0, 0, 0);
+    record_operation(start);
 }
 
 void ppa_hal_lvgl_blit(lv_disp_drv_t* disp_drv, lv_color_t* dest_buf,
                        lv_coord_t dest_width, const lv_area_t* dest_area,
                        const lv_color_t* src_buf, lv_coord_t src_width,
                        const lv_area_t* src_area) {
-    ESP_LOGV(TAG, "LVGL blit operation (stub - no hardware acceleration)");
-    // In stub mode, just log the operation
-    // Hardware acceleration will be available when ESP-IDF PPA driver is integrated
+    if (!dest_buf || !dest_area || !src_buf || !src_area) {
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    ppa_soft_copy(dest_buf + (size_t)dest_area->y1 * dest_width + dest_area->x1, dest_width,
+                  src_buf + (size_t)src_area->y1 * src_width + src_area->x1, src_width,
+                  lv_area_get_width(dest_area), lv_area_get_height(dest_area), sizeof(lv_color_t));
+    record_operation(start);
 }
 #endif
 
 // === Utility Functions ===
 
-bool ppa_hal_format_supported(ppa_image_format_t src_format, 
+bool ppa_hal_format_supported(ppa_image_format_t src_format,
                               ppa_image_format_t dst_format) {
-    // In stub mode, report limited format support
+    // The software kernels work within one format and do not convert
     switch (src_format) {
         case PPA_FORMAT_RGB565:
         case PPA_FORMAT_RGB888:
         case PPA_FORMAT_ARGB8888:
-            return (dst_format == PPA_FORMAT_RGB565 || 
-                    dst_format == PPA_FORMAT_RGB888 || 
-                    dst_format == PPA_FORMAT_ARGB8888);
+        case PPA_FORMAT_A8:
+            return dst_format == src_format;
         default:
             return false;
     }
@@ -209,19 +436,19 @@ size_t ppa_hal_align_size(size_t size) {
 void* ppa_hal_alloc_buffer(size_t size, bool use_psram) {
     size_t aligned_size = ppa_hal_align_size(size);
     uint32_t caps = MALLOC_CAP_DMA;
-    
+
     if (use_psram) {
         caps |= MALLOC_CAP_SPIRAM;
     } else {
         caps |= MALLOC_CAP_INTERNAL;
     }
-    
+
     void* buffer = heap_caps_aligned_alloc(PPA_CACHE_LINE_SIZE, aligned_size, caps);
     if (!buffer) {
         ESP_LOGE(TAG, "Failed to allocate %zu bytes for PPA buffer", aligned_size);
         return NULL;
     }
-    
+
     ESP_LOGD(TAG, "Allocated %zu bytes PPA buffer at %p", aligned_size, buffer);
     return buffer;
 }
@@ -233,20 +460,33 @@ void ppa_hal_free_buffer(void* buffer) {
 }
 
 esp_err_t ppa_hal_wait_completion(uint32_t timeout_ms) {
-    // In stub mode, operations complete immediately
-    return ESP_OK;
+    // Direct operations complete before returning; wait for the queued ones
+    ppa_fence_t last = g_queue.getLastFence();
+    if (last == PPA_FENCE_NONE) {
+        return ESP_OK;
+    }
+    return g_queue.wait(last, timeout_ms);
 }
 
 esp_err_t ppa_hal_get_performance_stats(uint32_t* ops_per_sec, uint32_t* avg_time_us) {
     if (!ops_per_sec || !avg_time_us) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    // Return zero stats in stub mode
+
+    std::lock_guard<std::mutex> lock(g_stats_mutex);
     *ops_per_sec = 0;
     *avg_time_us = 0;
-    
+    if (g_operation_count == 0) {
+        return ESP_OK;
+    }
+
+    int64_t elapsed_us = esp_timer_get_time() - g_first_op_start;
+    if (elapsed_us > 0) {
+        *ops_per_sec = (uint32_t)((uint64_t)g_operation_count * 1000000 / elapsed_us);
+    }
+    *avg_time_us = (uint32_t)(g_total_time_us / g_operation_count);
+
     return ESP_OK;
 }
 
-#endif // CONFIG_ESP_PPA_ACCELERATION
\ No newline at end of file
+#endif // CONFIG_ESP_PPA_ACCELERATION
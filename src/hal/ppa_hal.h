@@ -16,6 +16,12 @@
  * - LVGL integration for UI acceleration
  * - Memory-efficient operations with PSRAM optimization
  * - Thread-safe operation management
+ * 
+ * Until the PPA driver is available in the Arduino framework, every operation
+ * runs on the CPU through the software kernels in ppa_soft.h. Direct calls run
+ * on the calling task and have finished when they return, whether or not they
+ * were called as blocking; ppa_hal_submit() queues operations for the PPA
+ * worker task instead and returns a fence to wait on.
  */
 
 #include "../system/os_config.h"
@@ -41,8 +47,11 @@ typedef struct ppa_client_t* ppa_client_handle_t;
 
 // PPA Configuration
 #define PPA_MAX_CLIENTS             4
-#define PPA_MAX_PENDING_TRANS       2
+#define PPA_MAX_PENDING_TRANS       64      // Operations queued ahead of the worker
 #define PPA_OPERATION_TIMEOUT_MS    5000
+#define PPA_WORKER_STACK_SIZE       4096
+#define PPA_WORKER_PRIORITY         4
+#define PPA_WORKER_CORE             0       // LVGL renders in the Arduino loop on core 1
 #define PPA_CACHE_LINE_SIZE         32
 
 // LVGL Integration
@@ -117,6 +126,35 @@ typedef struct {
     uint32_t color_key_default; // Default color for keyed pixels
 } ppa_blend_params_t;
 
+// Queued operation type
+typedef enum {
+    PPA_OP_FILL = 0,            // Fill rect in dst with color
+    PPA_OP_BLIT,                // Copy rect of src to dst_x, dst_y
+    PPA_OP_BLEND,               // Blend src over bg into dst, rect in all three
+    PPA_OP_TRANSFORM            // Transform rect of src to dst_x, dst_y
+} ppa_op_type_t;
+
+// Queued operation; images are copied, their buffers must stay valid until the fence
+typedef struct {
+    ppa_op_type_t type;
+    ppa_image_t dst;
+    ppa_image_t src;            // Blit/transform source, blend foreground
+    ppa_image_t bg;             // Blend background
+    ppa_rect_t rect;
+    uint16_t dst_x;
+    uint16_t dst_y;
+    uint32_t color;             // Fill color (ARGB8888)
+    ppa_transform_t transform;
+    ppa_blend_params_t blend;
+} ppa_operation_t;
+
+// Fences are issued in submission order and signaled in the same order
+typedef uint32_t ppa_fence_t;
+#define PPA_FENCE_NONE              0
+
+// Called on the PPA worker when a submission has finished
+typedef void (*ppa_completion_cb_t)(ppa_fence_t fence, esp_err_t result, void* user_data);
+
 // PPA HAL Handle
 typedef struct ppa_hal_context {
     ppa_client_handle_t clients[PPA_CLIENT_TYPE_MAX];
@@ -287,6 +325,70 @@ esp_err_t ppa_hal_clear_image(const ppa_image_t* dst_img,
                               uint32_t color,
                               bool blocking);
 
+// === Command Queue ===
+
+/**
+ * @brief Queue an operation and return at once
+ * 
+ * Operations run one after another on the PPA worker, in submission
+ * order, while the caller goes on with other work. Blocks only while the
+ * queue is full, for up to PPA_OPERATION_TIMEOUT_MS.
+ * 
+ * @param op Operation to run
+ * @param callback Called on the worker when it has finished (optional)
+ * @param user_data Passed to the callback
+ * @param fence Receives the operation's fence (optional)
+ * @return esp_err_t ESP_OK if queued, ESP_ERR_TIMEOUT if the queue stayed full
+ */
+esp_err_t ppa_hal_submit(const ppa_operation_t* op,
+                         ppa_completion_cb_t callback, void* user_data,
+                         ppa_fence_t* fence);
+
+/**
+ * @brief Queue several operations as one submission
+ * 
+ * The operations are queued together and run back to back. One fence
+ * covers all of them, and the callback runs once after the last with
+ * the first error any of them returned.
+ * 
+ * @param ops Operations to run, in order
+ * @param count Number of operations (at most PPA_MAX_PENDING_TRANS)
+ * @param callback Called on the worker when the last has finished (optional)
+ * @param user_data Passed to the callback
+ * @param fence Receives the batch's fence (optional)
+ * @return esp_err_t ESP_OK if queued, ESP_ERR_TIMEOUT if the queue stayed full
+ */
+esp_err_t ppa_hal_submit_batch(const ppa_operation_t* ops, size_t count,
+                               ppa_completion_cb_t callback, void* user_data,
+                               ppa_fence_t* fence);
+
+/**
+ * @brief Wait until a submission has finished
+ * 
+ * The submission's callback has run by the time its fence is signaled,
+ * so a callback must not wait for its own fence.
+ * 
+ * @param fence Fence from ppa_hal_submit() or ppa_hal_submit_batch()
+ * @param timeout_ms Timeout in milliseconds
+ * @return esp_err_t ESP_OK if finished, ESP_ERR_TIMEOUT if timeout
+ */
+esp_err_t ppa_hal_wait_fence(ppa_fence_t fence, uint32_t timeout_ms);
+
+/**
+ * @brief Check whether a submission has finished, without waiting
+ * 
+ * @param fence Fence to check
+ * @return true if finished
+ */
+bool ppa_hal_fence_signaled(ppa_fence_t fence);
+
+/**
+ * @brief Get the number of queued operations not yet finished
+ * 
+ * @return uint32_t Pending operations
+ */
+uint32_t ppa_hal_get_pending_count(void);
+
 // === LVGL Integration ===
 
 #ifdef PPA_ENABLE_LVGL_INTEGRATION
@@ -376,7 +478,7 @@ void* ppa_hal_alloc_buffer(size_t size, bool use_psram);
 void ppa_hal_free_buffer(void* buffer);
 
 /**
- * @brief Wait for current PPA operation to complete
+ * @brief Wait for every queued PPA operation to complete
  * 
  * @param timeout_ms Timeout in milliseconds
  * @return esp_err_t ESP_OK if completed, ESP_ERR_TIMEOUT if timeout
@@ -431,6 +533,55 @@ esp_err_t ppa_hal_get_performance_stats(uint32_t* ops_per_sec, uint32_t* avg_tim
     .color_key_default = 0x000000 \
 }
 
+// Queued operation builders
+static inline ppa_operation_t ppa_fill_op(const ppa_image_t* dst, ppa_rect_t rect, uint32_t color) {
+    ppa_operation_t op = {};
+    op.type = PPA_OP_FILL;
+    op.dst = *dst;
+    op.rect = rect;
+    op.color = color;
+    return op;
+}
+
+static inline ppa_operation_t ppa_blit_op(const ppa_image_t* src, ppa_rect_t rect,
+                                          const ppa_image_t* dst, uint16_t dst_x, uint16_t dst_y) {
+    ppa_operation_t op = {};
+    op.type = PPA_OP_BLIT;
+    op.src = *src;
+    op.rect = rect;
+    op.dst = *dst;
+    op.dst_x = dst_x;
+    op.dst_y = dst_y;
+    return op;
+}
+
+static inline ppa_operation_t ppa_blend_op(const ppa_image_t* bg, const ppa_image_t* fg,
+                                           const ppa_image_t* dst, ppa_rect_t rect,
+                                           const ppa_blend_params_t* params) {
+    ppa_operation_t op = {};
+    op.type = PPA_OP_BLEND;
+    op.bg = *bg;
+    op.src = *fg;
+    op.dst = *dst;
+    op.rect = rect;
+    op.blend = *params;
+    return op;
+}
+
+static inline ppa_operation_t ppa_transform_op(const ppa_image_t* src, ppa_rect_t rect,
+                                               const ppa_image_t* dst, uint16_t dst_x, uint16_t dst_y,
+                                               const ppa_transform_t* transform) {
+    ppa_operation_t op = {};
+    op.type = PPA_OP_TRANSFORM;
+    op.src = *src;
+    op.rect = rect;
+    op.dst = *dst;
+    op.dst_x = dst_x;
+    op.dst_y = dst_y;
+    op.transform = *transform;
+    return op;
+}
+
 // Performance optimization flags
 #define PPA_OPTIMIZE_FOR_SPEED      1
 #define PPA_OPTIMIZE_FOR_MEMORY     2
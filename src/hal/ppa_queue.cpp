@@ -0,0 +1,219 @@
+#include "ppa_queue.h"
+
+#ifdef CONFIG_ESP_PPA_ACCELERATION
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#endif
+
+static const char* TAG = "PPA_QUEUE";
+
+// Fences wrap around; compare by distance so an old fence stays older
+static bool fenceReached(ppa_fence_t signaled, ppa_fence_t fence) {
+    return (int32_t)(signaled - fence) >= 0;
+}
+
+PpaCommandQueue::~PpaCommandQueue() {
+    stop();
+}
+
+esp_err_t PpaCommandQueue::start(Executor executor, size_t capacity) {
+    if (isRunning()) {
+        return ESP_OK;
+    }
+    if (!executor || capacity == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    m_executor = executor;
+    m_ring.assign(capacity, Entry());
+    m_head = 0;
+    m_count = 0;
+    m_pending = 0;
+    m_running.store(true, std::memory_order_release);
+
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t defaultConfig = esp_pthread_get_default_config();
+    esp_pthread_cfg_t config = defaultConfig;
+    config.stack_size = PPA_WORKER_STACK_SIZE;
+    config.prio = PPA_WORKER_PRIORITY;
+    config.pin_to_core = PPA_WORKER_CORE;
+    config.thread_name = "ppa_worker";
+    esp_pthread_set_cfg(&config);
+#endif
+
+    m_worker = std::thread(&PpaCommandQueue::workerLoop, this);
+
+#ifdef ESP_PLATFORM
+    esp_pthread_set_cfg(&defaultConfig);
+#endif
+
+    ESP_LOGI(TAG, "PPA command queue started (%zu operations)", capacity);
+    return ESP_OK;
+}
+
+void PpaCommandQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running.load(std::memory_order_acquire)) {
+            return;
+        }
+        m_running.store(false, std::memory_order_release);
+    }
+    m_workAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    ESP_LOGI(TAG, "PPA command queue stopped");
+}
+
+esp_err_t PpaCommandQueue::submit(const ppa_operation_t* ops, size_t count,
+                                  ppa_completion_cb_t callback, void* userData,
+                                  uint32_t timeoutMs, ppa_fence_t* fence) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!isRunning()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!ops || count == 0 || count > m_ring.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // A submission is queued whole, so wait until all of it fits
+    if (m_ring.size() - m_count < count) {
+        m_stats.fullWaits++;
+        bool room = m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+            return !isRunning() || m_ring.size() - m_count >= count;
+        });
+        if (!room) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!isRunning()) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    ppa_fence_t issued = ++m_lastFence;
+    if (issued == PPA_FENCE_NONE) {
+        issued = ++m_lastFence;     // Skip the reserved value on wrap-around
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        Entry& entry = m_ring[(m_head + m_count) % m_ring.size()];
+        entry.op = ops[i];
+        entry.callback = callback;
+        entry.userData = userData;
+        entry.fence = issued;
+        entry.first = i == 0;
+        entry.last = i == count - 1;
+        m_count++;
+    }
+    m_pending += count;
+
+    m_stats.submissions++;
+    if (m_pending > m_stats.maxPending) {
+        m_stats.maxPending = m_pending;
+    }
+
+    lock.unlock();
+    m_workAvailable.notify_one();
+
+    if (fence) {
+        *fence = issued;
+    }
+    return ESP_OK;
+}
+
+esp_err_t PpaCommandQueue::wait(ppa_fence_t fence, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (fence == PPA_FENCE_NONE || !fenceReached(m_lastFence, fence)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool signaled = m_fenceSignaled.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+        return fenceReached(m_signaledFence.load(std::memory_order_acquire), fence);
+    });
+    return signaled ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+bool PpaCommandQueue::isSignaled(ppa_fence_t fence) const {
+    return fence != PPA_FENCE_NONE && fenceReached(m_signaledFence.load(std::memory_order_acquire), fence);
+}
+
+ppa_fence_t PpaCommandQueue::getLastFence() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastFence;
+}
+
+uint32_t PpaCommandQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+PpaQueueStats PpaCommandQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void PpaCommandQueue::resetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = PpaQueueStats();
+}
+
+void PpaCommandQueue::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_workAvailable.wait(lock, [this]() {
+            return m_count > 0 || !isRunning();
+        });
+        if (m_count == 0) {
+            break;      // Stopped and drained
+        }
+
+        Entry entry = m_ring[m_head];
+        m_head = (m_head + 1) % m_ring.size();
+        m_count--;
+        lock.unlock();
+        m_spaceAvailable.notify_all();
+
+        int64_t start = esp_timer_get_time();
+        esp_err_t result = m_executor(entry.op);
+        int64_t elapsed = esp_timer_get_time() - start;
+
+        if (entry.first) {
+            m_submissionResult = ESP_OK;
+        }
+        if (result != ESP_OK) {
+            ESP_LOGW(TAG, "Operation %d of fence %lu failed: %s", entry.op.type,
+                     (unsigned long)entry.fence, esp_err_to_name(result));
+            if (m_submissionResult == ESP_OK) {
+                m_submissionResult = result;
+            }
+        }
+
+        // The callback has run by the time the fence is signaled
+        if (entry.last && entry.callback) {
+            entry.callback(entry.fence, m_submissionResult, entry.userData);
+        }
+
+        lock.lock();
+        m_pending--;
+        m_stats.operations++;
+        m_stats.busyUs += elapsed;
+        if (result != ESP_OK) {
+            m_stats.failed++;
+        }
+        if (entry.last) {
+            m_signaledFence.store(entry.fence, std::memory_order_release);
+            m_fenceSignaled.notify_all();
+        }
+    }
+}
+
+#endif // CONFIG_ESP_PPA_ACCELERATION
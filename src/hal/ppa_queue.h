@@ -0,0 +1,146 @@
+#ifndef PPA_QUEUE_H
+#define PPA_QUEUE_H
+
+#include "ppa_hal.h"
+
+#ifdef CONFIG_ESP_PPA_ACCELERATION
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/**
+ * @file ppa_queue.h
+ * @brief PPA command queue for M5Stack Tab5
+ *
+ * A ring of pending operations drained by one worker thread, so that
+ * LVGL can hand over several fills and blits per frame and keep
+ * rasterizing while they run. Every submission gets a fence; fences are
+ * issued and signaled in submission order, so a fence has been signaled
+ * once the last finished fence is at least as new as it.
+ *
+ * The worker is a std::thread (pinned through esp_pthread on the
+ * device), so the queue also runs on a Linux host for testing.
+ */
+
+struct PpaQueueStats {
+    uint32_t submissions = 0;
+    uint32_t operations = 0;
+    uint32_t failed = 0;            // Operations that returned an error
+    uint32_t fullWaits = 0;         // Submissions that had to wait for room
+    uint32_t maxPending = 0;
+    uint64_t busyUs = 0;            // Worker time spent running operations
+};
+
+class PpaCommandQueue {
+public:
+    // Runs one operation; called on the worker
+    typedef esp_err_t (*Executor)(const ppa_operation_t& op);
+
+    PpaCommandQueue() = default;
+    ~PpaCommandQueue();
+
+    PpaCommandQueue(const PpaCommandQueue&) = delete;
+    PpaCommandQueue& operator=(const PpaCommandQueue&) = delete;
+
+    /**
+     * @brief Start the worker
+     * @param executor Function that runs each operation
+     * @param capacity Operations that can be pending at once
+     * @return ESP_OK on success
+     */
+    esp_err_t start(Executor executor, size_t capacity = PPA_MAX_PENDING_TRANS);
+
+    /**
+     * @brief Run the operations still queued, then stop the worker
+     */
+    void stop();
+
+    /**
+     * @brief Check if the worker is running
+     * @return true if operations can be submitted
+     */
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Queue operations as one submission
+     * @param ops Operations, run in order
+     * @param count Number of operations, at most the capacity
+     * @param callback Called on the worker after the last operation (optional)
+     * @param userData Passed to the callback
+     * @param timeoutMs How long to wait for room in the queue
+     * @param fence Receives the submission's fence (optional)
+     * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the queue stayed full
+     */
+    esp_err_t submit(const ppa_operation_t* ops, size_t count,
+                     ppa_completion_cb_t callback, void* userData,
+                     uint32_t timeoutMs, ppa_fence_t* fence);
+
+    /**
+     * @brief Wait until a fence is signaled
+     * @param fence Fence from submit()
+     * @param timeoutMs Timeout in milliseconds
+     * @return ESP_OK if signaled, ESP_ERR_TIMEOUT if not in time,
+     *         ESP_ERR_INVALID_ARG if the fence was never issued
+     */
+    esp_err_t wait(ppa_fence_t fence, uint32_t timeoutMs);
+
+    /**
+     * @brief Check whether a fence is signaled
+     * @param fence Fence from submit()
+     * @return true if its submission has finished
+     */
+    bool isSignaled(ppa_fence_t fence) const;
+
+    /**
+     * @brief Get the fence of the latest submission
+     * @return Fence, or PPA_FENCE_NONE before the first submission
+     */
+    ppa_fence_t getLastFence() const;
+
+    /**
+     * @brief Get the number of queued or running operations
+     * @return Pending operations
+     */
+    uint32_t getPendingCount() const;
+
+    PpaQueueStats getStats() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        ppa_operation_t op;
+        ppa_completion_cb_t callback;
+        void* userData;
+        ppa_fence_t fence;
+        bool first;                 // First operation of its submission
+        bool last;                  // Last operation; signals the fence
+    };
+
+    void workerLoop();
+
+    Executor m_executor = nullptr;
+    std::vector<Entry> m_ring;
+    size_t m_head = 0;              // Next entry the worker takes
+    size_t m_count = 0;             // Entries in the ring
+    uint32_t m_pending = 0;         // Entries in the ring or running
+
+    ppa_fence_t m_lastFence = PPA_FENCE_NONE;
+    std::atomic<ppa_fence_t> m_signaledFence{PPA_FENCE_NONE};
+    esp_err_t m_submissionResult = ESP_OK;      // Worker only
+
+    std::atomic<bool> m_running{false};
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::condition_variable m_fenceSignaled;
+
+    PpaQueueStats m_stats;
+};
+
+#endif // CONFIG_ESP_PPA_ACCELERATION
+
+#endif // PPA_QUEUE_H
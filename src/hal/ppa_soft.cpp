@@ -0,0 +1,542 @@
+#include "ppa_soft.h"
+#include <string.h>
+
+namespace {
+
+struct Pixel24 {
+    uint8_t b, g, r;
+};
+
+// RGB565 with green moved to the upper half-word, leaving a gap above
+// each channel so all three can be multiplied by a 5-bit weight at once
+const uint32_t SPREAD_565_MASK = 0x07E0F81F;
+
+inline uint32_t spread565(uint16_t c) {
+    return (c | ((uint32_t)c << 16)) & SPREAD_565_MASK;
+}
+
+inline uint16_t pack565(uint32_t spread) {
+    return (uint16_t)(spread | (spread >> 16));
+}
+
+// Weight w in 0-32 on b
+inline uint32_t lerpSpread565(uint32_t a, uint32_t b, uint32_t w) {
+    return ((a * (32 - w) + b * w) >> 5) & SPREAD_565_MASK;
+}
+
+// Weight w in 0-256 on b, for two 8-bit lanes per word
+inline uint32_t lerpLanes(uint32_t a, uint32_t b, uint32_t w) {
+    return ((a * (256 - w) + b * w) >> 8) & 0x00FF00FF;
+}
+
+inline uint32_t lerp8888(uint32_t a, uint32_t b, uint32_t w) {
+    return lerpLanes(a & 0x00FF00FF, b & 0x00FF00FF, w) |
+           (lerpLanes((a >> 8) & 0x00FF00FF, (b >> 8) & 0x00FF00FF, w) << 8);
+}
+
+inline uint32_t div255(uint32_t x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+// Alpha 0-255 to a weight in 0-256, so that 255 selects the foreground exactly
+inline uint32_t alphaWeight(uint32_t alpha) {
+    return alpha + (alpha >> 7);
+}
+
+inline uint32_t rgb565ToRgb888(uint16_t c) {
+    uint32_t r = (c >> 11) & 0x1F;
+    uint32_t g = (c >> 5) & 0x3F;
+    uint32_t b = c & 0x1F;
+    return ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
+
+inline bool colorKeyed(uint32_t rgb, uint32_t low, uint32_t high) {
+    for (int shift = 0; shift <= 16; shift += 8) {
+        uint32_t c = (rgb >> shift) & 0xFF;
+        if (c < ((low >> shift) & 0xFF) || c > ((high >> shift) & 0xFF)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline uint32_t pixelRgb888(const uint8_t* p, uint8_t bpp) {
+    switch (bpp) {
+        case 2: return rgb565ToRgb888(*(const uint16_t*)p);
+        case 3: return ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+        default: return *(const uint32_t*)p & 0x00FFFFFF;
+    }
+}
+
+template <typename T>
+inline T* pixelRow(void* base, uint32_t stride, uint32_t y) {
+    return (T*)base + (size_t)stride * y;
+}
+
+template <typename T>
+inline const T* pixelRow(const void* base, uint32_t stride, uint32_t y) {
+    return (const T*)base + (size_t)stride * y;
+}
+
+// === Fill ===
+
+void fillRow565(uint16_t* row, uint16_t width, uint16_t pixel) {
+    uint32_t x = 0;
+    if (((uintptr_t)row & 2) && width > 0) {
+        row[x++] = pixel;
+    }
+    uint32_t pair = pixel | ((uint32_t)pixel << 16);
+    uint32_t* words = (uint32_t*)(row + x);
+    uint32_t wordCount = (width - x) / 2;
+    for (uint32_t i = 0; i < wordCount; i++) {
+        words[i] = pair;
+    }
+    x += wordCount * 2;
+    if (x < width) {
+        row[x] = pixel;
+    }
+}
+
+void fillRow(uint8_t* row, uint16_t width, uint8_t bpp, uint32_t pixel) {
+    switch (bpp) {
+        case 1:
+            memset(row, (uint8_t)pixel, width);
+            break;
+        case 2:
+            fillRow565((uint16_t*)row, width, (uint16_t)pixel);
+            break;
+        case 3:
+            for (uint32_t x = 0; x < width; x++) {
+                row[x * 3] = (uint8_t)pixel;
+                row[x * 3 + 1] = (uint8_t)(pixel >> 8);
+                row[x * 3 + 2] = (uint8_t)(pixel >> 16);
+            }
+            break;
+        default: {
+            uint32_t* words = (uint32_t*)row;
+            for (uint32_t x = 0; x < width; x++) {
+                words[x] = pixel;
+            }
+            break;
+        }
+    }
+}
+
+// === Blend ===
+
+void blendRow565(uint16_t* dst, const uint16_t* bg, const uint16_t* fg, uint16_t width, uint32_t alpha) {
+    uint32_t w = (alpha + 4) >> 3;
+    for (uint32_t x = 0; x < width; x++) {
+        dst[x] = pack565(lerpSpread565(spread565(bg[x]), spread565(fg[x]), w));
+    }
+}
+
+void blendRow8888(uint32_t* dst, const uint32_t* bg, const uint32_t* fg, uint16_t width,
+                  uint32_t fgAlpha, uint32_t bgAlpha) {
+    for (uint32_t x = 0; x < width; x++) {
+        uint32_t f = fg[x];
+        uint32_t b = bg[x];
+        uint32_t a = div255((f >> 24) * fgAlpha);
+        uint32_t ba = div255((b >> 24) * bgAlpha);
+        uint32_t outAlpha = a + div255(ba * (255 - a));
+        dst[x] = (lerp8888(b, f, alphaWeight(a)) & 0x00FFFFFF) | (outAlpha << 24);
+    }
+}
+
+// A8 and RGB888: every byte is a channel
+void blendBytes(uint8_t* dst, const uint8_t* bg, const uint8_t* fg, uint32_t count, uint32_t alpha) {
+    uint32_t w = alphaWeight(alpha);
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = (uint8_t)((bg[i] * (256 - w) + fg[i] * w) >> 8);
+    }
+}
+
+// Color keying needs a decision per pixel, so it runs one pixel at a time
+void blendRowKeyed(uint8_t* dst, const uint8_t* bg, const uint8_t* fg, uint16_t width, uint8_t bpp,
+                   uint32_t fgAlpha, uint32_t bgAlpha, uint32_t keyLow, uint32_t keyHigh,
+                   uint32_t keyPixel) {
+    for (uint32_t x = 0; x < width; x++) {
+        size_t offset = (size_t)x * bpp;
+        if (!colorKeyed(pixelRgb888(fg + offset, bpp), keyLow, keyHigh)) {
+            switch (bpp) {
+                case 2:
+                    blendRow565((uint16_t*)(dst + offset), (const uint16_t*)(bg + offset),
+                                (const uint16_t*)(fg + offset), 1, fgAlpha);
+                    break;
+                case 3:
+                    blendBytes(dst + offset, bg + offset, fg + offset, 3, fgAlpha);
+                    break;
+                default:
+                    blendRow8888((uint32_t*)(dst + offset), (const uint32_t*)(bg + offset),
+                                 (const uint32_t*)(fg + offset), 1, fgAlpha, bgAlpha);
+                    break;
+            }
+        } else if (colorKeyed(pixelRgb888(bg + offset, bpp), keyLow, keyHigh)) {
+            memcpy(dst + offset, &keyPixel, bpp);
+        } else if (dst != bg) {
+            memcpy(dst + offset, bg + offset, bpp);
+        }
+    }
+}
+
+// === Scale ===
+
+// Source position of a destination pixel centre, in 16.16 fixed point
+struct Axis {
+    uint32_t step;
+    int32_t start;
+
+    Axis(uint16_t srcSize, uint16_t dstSize, bool centreOnPixel) {
+        step = ((uint32_t)srcSize << 16) / dstSize;
+        start = (int32_t)(step / 2) - (centreOnPixel ? 0x8000 : 0);
+    }
+
+    int32_t at(uint32_t i) const {
+        return start + (int32_t)(i * step);
+    }
+};
+
+template <typename T>
+void scaleNearest(void* dst, uint32_t dstStride, uint16_t dstWidth, uint16_t dstHeight,
+                  const void* src, uint32_t srcStride, uint16_t srcWidth, uint16_t srcHeight) {
+    Axis ax(srcWidth, dstWidth, false);
+    Axis ay(srcHeight, dstHeight, false);
+    const T* previousSrc = nullptr;
+    T* previousDst = nullptr;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const T* s = pixelRow<T>(src, srcStride, (uint32_t)ay.at(y) >> 16);
+        T* d = pixelRow<T>(dst, dstStride, y);
+
+        // Upscaling repeats source rows; copy the finished row instead
+        if (s == previousSrc) {
+            memcpy(d, previousDst, (size_t)dstWidth * sizeof(T));
+            continue;
+        }
+
+        uint32_t position = (uint32_t)ax.start;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            d[x] = s[position >> 16];
+            position += ax.step;
+        }
+        previousSrc = s;
+        previousDst = d;
+    }
+}
+
+// Clamped neighbours and weight of one bilinear sample along an axis
+struct Tap {
+    uint32_t i0, i1, frac;
+};
+
+inline Tap tapAt(int32_t position, uint16_t size, int fracBits) {
+    Tap tap;
+    if (position <= 0) {
+        tap.i0 = tap.i1 = 0;
+        tap.frac = 0;
+        return tap;
+    }
+    tap.i0 = (uint32_t)position >> 16;
+    if (tap.i0 >= (uint32_t)size - 1) {
+        tap.i0 = tap.i1 = size - 1;
+        tap.frac = 0;
+        return tap;
+    }
+    tap.i1 = tap.i0 + 1;
+    tap.frac = ((uint32_t)position & 0xFFFF) >> (16 - fracBits);
+    return tap;
+}
+
+void scaleBilinear565(void* dst, uint32_t dstStride, uint16_t dstWidth, uint16_t dstHeight,
+                      const void* src, uint32_t srcStride, uint16_t srcWidth, uint16_t srcHeight) {
+    Axis ax(srcWidth, dstWidth, true);
+    Axis ay(srcHeight, dstHeight, true);
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        Tap ty = tapAt(ay.at(y), srcHeight, 5);
+        const uint16_t* top = pixelRow<uint16_t>(src, srcStride, ty.i0);
+        const uint16_t* bottom = pixelRow<uint16_t>(src, srcStride, ty.i1);
+        uint16_t* d = pixelRow<uint16_t>(dst, dstStride, y);
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            Tap tx = tapAt(ax.at(x), srcWidth, 5);
+            uint32_t upper = lerpSpread565(spread565(top[tx.i0]), spread565(top[tx.i1]), tx.frac);
+            uint32_t lower = lerpSpread565(spread565(bottom[tx.i0]), spread565(bottom[tx.i1]), tx.frac);
+            d[x] = pack565(lerpSpread565(upper, lower, ty.frac));
+        }
+    }
+}
+
+void scaleBilinear8888(void* dst, uint32_t dstStride, uint16_t dstWidth, uint16_t dstHeight,
+                       const void* src, uint32_t srcStride, uint16_t srcWidth, uint16_t srcHeight) {
+    Axis ax(srcWidth, dstWidth, true);
+    Axis ay(srcHeight, dstHeight, true);
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        Tap ty = tapAt(ay.at(y), srcHeight, 8);
+        const uint32_t* top = pixelRow<uint32_t>(src, srcStride, ty.i0);
+        const uint32_t* bottom = pixelRow<uint32_t>(src, srcStride, ty.i1);
+        uint32_t* d = pixelRow<uint32_t>(dst, dstStride, y);
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            Tap tx = tapAt(ax.at(x), srcWidth, 8);
+            uint32_t upper = lerp8888(top[tx.i0], top[tx.i1], tx.frac);
+            uint32_t lower = lerp8888(bottom[tx.i0], bottom[tx.i1], tx.frac);
+            d[x] = lerp8888(upper, lower, ty.frac);
+        }
+    }
+}
+
+void scaleBilinearBytes(void* dst, uint32_t dstStride, uint16_t dstWidth, uint16_t dstHeight,
+                        const void* src, uint32_t srcStride, uint16_t srcWidth, uint16_t srcHeight,
+                        uint8_t bpp) {
+    Axis ax(srcWidth, dstWidth, true);
+    Axis ay(srcHeight, dstHeight, true);
+    size_t srcPitch = (size_t)srcStride * bpp;
+    size_t dstPitch = (size_t)dstStride * bpp;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        Tap ty = tapAt(ay.at(y), srcHeight, 8);
+        const uint8_t* top = (const uint8_t*)src + srcPitch * ty.i0;
+        const uint8_t* bottom = (const uint8_t*)src + srcPitch * ty.i1;
+        uint8_t* d = (uint8_t*)dst + dstPitch * y;
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            Tap tx = tapAt(ax.at(x), srcWidth, 8);
+            for (uint32_t c = 0; c < bpp; c++) {
+                uint32_t upper = top[tx.i0 * bpp + c] * (256 - tx.frac) + top[tx.i1 * bpp + c] * tx.frac;
+                uint32_t lower = bottom[tx.i0 * bpp + c] * (256 - tx.frac) + bottom[tx.i1 * bpp + c] * tx.frac;
+                d[x * bpp + c] = (uint8_t)((upper * (256 - ty.frac) + lower * ty.frac) >> 16);
+            }
+        }
+    }
+}
+
+// === Rotate ===
+
+template <typename T>
+void rotate(void* dst, uint32_t dstStride, const void* src, uint32_t srcStride,
+            uint16_t srcWidth, uint16_t srcHeight, uint8_t quarterTurns, bool mirrorX, bool mirrorY) {
+    bool transposed = quarterTurns & 1;
+    uint32_t dstWidth = transposed ? srcHeight : srcWidth;
+    uint32_t dstHeight = transposed ? srcWidth : srcHeight;
+    ptrdiff_t ss = srcStride;
+
+    // Source index of unmirrored destination pixel (rx, ry) is
+    // origin + rx * dx + ry * dy for each rotation
+    ptrdiff_t origin, dx, dy;
+    switch (quarterTurns & 3) {
+        case 1:
+            origin = srcWidth - 1; dx = ss; dy = -1;
+            break;
+        case 2:
+            origin = (srcHeight - 1) * ss + srcWidth - 1; dx = -1; dy = -ss;
+            break;
+        case 3:
+            origin = (srcHeight - 1) * ss; dx = -ss; dy = 1;
+            break;
+        default:
+            origin = 0; dx = 1; dy = ss;
+            break;
+    }
+
+    // Mirroring walks the destination axis backwards
+    if (mirrorX) {
+        origin += (ptrdiff_t)(dstWidth - 1) * dx;
+        dx = -dx;
+    }
+    if (mirrorY) {
+        origin += (ptrdiff_t)(dstHeight - 1) * dy;
+        dy = -dy;
+    }
+
+    const T* s = (const T*)src + origin;
+
+    if (dx == 1 || dx == -1) {
+        // Rows stay rows; both sides are read sequentially
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            const T* in = s + (ptrdiff_t)y * dy;
+            T* out = pixelRow<T>(dst, dstStride, y);
+            if (dx == 1) {
+                memcpy(out, in, dstWidth * sizeof(T));
+            } else {
+                for (uint32_t x = 0; x < dstWidth; x++) {
+                    out[x] = in[-(ptrdiff_t)x];
+                }
+            }
+        }
+        return;
+    }
+
+    // Rows become columns: copy tile by tile so the column walk reuses
+    // the same few cache lines instead of touching a new one every pixel
+    for (uint32_t ty = 0; ty < dstHeight; ty += PPA_SOFT_TILE_SIZE) {
+        uint32_t tileHeight = dstHeight - ty < PPA_SOFT_TILE_SIZE ? dstHeight - ty : PPA_SOFT_TILE_SIZE;
+        for (uint32_t tx = 0; tx < dstWidth; tx += PPA_SOFT_TILE_SIZE) {
+            uint32_t tileWidth = dstWidth - tx < PPA_SOFT_TILE_SIZE ? dstWidth - tx : PPA_SOFT_TILE_SIZE;
+            for (uint32_t y = ty; y < ty + tileHeight; y++) {
+                const T* in = s + (ptrdiff_t)y * dy + (ptrdiff_t)tx * dx;
+                T* out = pixelRow<T>(dst, dstStride, y) + tx;
+                for (uint32_t x = 0; x < tileWidth; x++) {
+                    out[x] = in[(ptrdiff_t)x * dx];
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t ppa_soft_pack_color(uint32_t argb, uint8_t bpp) {
+    uint32_t r = (argb >> 16) & 0xFF;
+    uint32_t g = (argb >> 8) & 0xFF;
+    uint32_t b = argb & 0xFF;
+
+    switch (bpp) {
+        case 1: return argb >> 24;
+        case 2: return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        case 3: return argb & 0x00FFFFFF;
+        default: return argb;
+    }
+}
+
+void ppa_soft_fill(void* dst, uint32_t dst_stride, uint16_t width, uint16_t height,
+                   uint8_t bpp, uint32_t pixel) {
+    if (!dst || width == 0 || height == 0) {
+        return;
+    }
+
+    // Build the first row, then copy it; memcpy is the fastest store loop there is
+    uint8_t* first = (uint8_t*)dst;
+    size_t pitch = (size_t)dst_stride * bpp;
+    size_t rowBytes = (size_t)width * bpp;
+    fillRow(first, width, bpp, pixel);
+    for (uint32_t y = 1; y < height; y++) {
+        memcpy(first + pitch * y, first, rowBytes);
+    }
+}
+
+void ppa_soft_copy(void* dst, uint32_t dst_stride, const void* src, uint32_t src_stride,
+                   uint16_t width, uint16_t height, uint8_t bpp) {
+    if (!dst || !src || width == 0 || height == 0) {
+        return;
+    }
+
+    size_t rowBytes = (size_t)width * bpp;
+    if (dst_stride == width && src_stride == width) {
+        memmove(dst, src, rowBytes * height);
+        return;
+    }
+    for (uint32_t y = 0; y < height; y++) {
+        memmove((uint8_t*)dst + (size_t)dst_stride * bpp * y,
+                (const uint8_t*)src + (size_t)src_stride * bpp * y, rowBytes);
+    }
+}
+
+void ppa_soft_blend(void* dst, uint32_t dst_stride,
+                    const void* bg, uint32_t bg_stride,
+                    const void* fg, uint32_t fg_stride,
+                    uint16_t width, uint16_t height, uint8_t bpp,
+                    uint8_t fg_alpha, uint8_t bg_alpha,
+                    bool key_enable, uint32_t key_low, uint32_t key_high, uint32_t key_default) {
+    if (!dst || !bg || !fg || width == 0 || height == 0) {
+        return;
+    }
+
+    uint32_t keyPixel = ppa_soft_pack_color(0xFF000000 | key_default, bpp);
+
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* d = pixelRow<uint8_t>(dst, dst_stride * bpp, y);
+        const uint8_t* b = pixelRow<uint8_t>(bg, bg_stride * bpp, y);
+        const uint8_t* f = pixelRow<uint8_t>(fg, fg_stride * bpp, y);
+
+        if (key_enable && bpp >= 2) {
+            blendRowKeyed(d, b, f, width, bpp, fg_alpha, bg_alpha, key_low, key_high, keyPixel);
+            continue;
+        }
+
+        switch (bpp) {
+            case 2:
+                blendRow565((uint16_t*)d, (const uint16_t*)b, (const uint16_t*)f, width, fg_alpha);
+                break;
+            case 4:
+                blendRow8888((uint32_t*)d, (const uint32_t*)b, (const uint32_t*)f, width,
+                             fg_alpha, bg_alpha);
+                break;
+            default:
+                blendBytes(d, b, f, (uint32_t)width * bpp, fg_alpha);
+                break;
+        }
+    }
+}
+
+void ppa_soft_scale(void* dst, uint32_t dst_stride, uint16_t dst_width, uint16_t dst_height,
+                    const void* src, uint32_t src_stride, uint16_t src_width, uint16_t src_height,
+                    uint8_t bpp, ppa_soft_filter_t filter) {
+    if (!dst || !src || dst_width == 0 || dst_height == 0 || src_width == 0 || src_height == 0) {
+        return;
+    }
+
+    if (filter == PPA_SOFT_FILTER_BILINEAR) {
+        switch (bpp) {
+            case 2:
+                scaleBilinear565(dst, dst_stride, dst_width, dst_height,
+                                 src, src_stride, src_width, src_height);
+                return;
+            case 4:
+                scaleBilinear8888(dst, dst_stride, dst_width, dst_height,
+                                  src, src_stride, src_width, src_height);
+                return;
+            default:
+                scaleBilinearBytes(dst, dst_stride, dst_width, dst_height,
+                                   src, src_stride, src_width, src_height, bpp);
+                return;
+        }
+    }
+
+    switch (bpp) {
+        case 1:
+            scaleNearest<uint8_t>(dst, dst_stride, dst_width, dst_height, src, src_stride, src_width, src_height);
+            break;
+        case 2:
+            scaleNearest<uint16_t>(dst, dst_stride, dst_width, dst_height, src, src_stride, src_width, src_height);
+            break;
+        case 3:
+            scaleNearest<Pixel24>(dst, dst_stride, dst_width, dst_height, src, src_stride, src_width, src_height);
+            break;
+        default:
+            scaleNearest<uint32_t>(dst, dst_stride, dst_width, dst_height, src, src_stride, src_width, src_height);
+            break;
+    }
+}
+
+void ppa_soft_rotate(void* dst, uint32_t dst_stride,
+                     const void* src, uint32_t src_stride, uint16_t src_width, uint16_t src_height,
+                     uint8_t bpp, uint8_t quarter_turns, bool mirror_x, bool mirror_y) {
+    if (!dst || !src || src_width == 0 || src_height == 0) {
+        return;
+    }
+
+    switch (bpp) {
+        case 1:
+            rotate<uint8_t>(dst, dst_stride, src, src_stride, src_width, src_height,
+                            quarter_turns, mirror_x, mirror_y);
+            break;
+        case 2:
+            rotate<uint16_t>(dst, dst_stride, src, src_stride, src_width, src_height,
+                             quarter_turns, mirror_x, mirror_y);
+            break;
+        case 3:
+            rotate<Pixel24>(dst, dst_stride, src, src_stride, src_width, src_height,
+                            quarter_turns, mirror_x, mirror_y);
+            break;
+        default:
+            rotate<uint32_t>(dst, dst_stride, src, src_stride, src_width, src_height,
+                             quarter_turns, mirror_x, mirror_y);
+            break;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,155 @@
+#ifndef PPA_SOFT_H
+#define PPA_SOFT_H
+
+/**
+ * @file ppa_soft.h
+ * @brief Software pixel kernels behind the PPA HAL
+ *
+ * Portable implementations of the fill, blend and scale-rotate-mirror
+ * operations the ESP32-P4 PPA performs. ppa_hal_* runs them on the CPU
+ * while the PPA driver is unavailable, and they are the reference the
+ * hardware path is validated against once it is.
+ *
+ * Pixels are addressed by bytes per pixel, which fixes the format:
+ * 1 = A8, 2 = RGB565, 3 = RGB888 (stored B, G, R), 4 = ARGB8888 (stored
+ * B, G, R, A, i.e. a little-endian uint32_t). Strides are in pixels.
+ *
+ * The inner loops are branch-free over whole rows and work on several
+ * channels per 32-bit word, so the compiler can vectorise them without
+ * intrinsics. Buffers only need natural alignment for their pixel size.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PPA_SOFT_TILE_SIZE          32      // Rotation tile edge in pixels
+
+// Scaling filter
+typedef enum {
+    PPA_SOFT_FILTER_NEAREST = 0,
+    PPA_SOFT_FILTER_BILINEAR
+} ppa_soft_filter_t;
+
+extern "C" {
+
+/**
+ * @brief Convert an ARGB8888 color to a pixel value
+ *
+ * @param argb Color (0xAARRGGBB)
+ * @param bpp Bytes per pixel of the target format
+ * @return uint32_t Pixel value in the low bpp bytes
+ */
+uint32_t ppa_soft_pack_color(uint32_t argb, uint8_t bpp);
+
+/**
+ * @brief Fill a rectangle with one pixel value
+ *
+ * RGB565 rows are written two pixels per 32-bit store after aligning
+ * the first pixel.
+ *
+ * @param dst First pixel of the rectangle
+ * @param dst_stride Destination stride in pixels
+ * @param width Rectangle width
+ * @param height Rectangle height
+ * @param bpp Bytes per pixel
+ * @param pixel Pixel value from ppa_soft_pack_color()
+ */
+void ppa_soft_fill(void* dst, uint32_t dst_stride, uint16_t width, uint16_t height,
+                   uint8_t bpp, uint32_t pixel);
+
+/**
+ * @brief Copy a rectangle
+ *
+ * @param dst First destination pixel
+ * @param dst_stride Destination stride in pixels
+ * @param src First source pixel
+ * @param src_stride Source stride in pixels
+ * @param width Rectangle width
+ * @param height Rectangle height
+ * @param bpp Bytes per pixel
+ */
+void ppa_soft_copy(void* dst, uint32_t dst_stride, const void* src, uint32_t src_stride,
+                   uint16_t width, uint16_t height, uint8_t bpp);
+
+/**
+ * @brief Blend a foreground rectangle over a background rectangle
+ *
+ * dst = fg * a + bg * (1 - a), where a is fg_alpha, multiplied by the
+ * foreground pixel's own alpha for ARGB8888. ARGB8888 output alpha is
+ * a + b * (1 - a), where b is the background pixel's alpha times
+ * bg_alpha. RGB565 blends with 5-bit alpha, all channels at once in one
+ * 32-bit word. dst may alias bg.
+ *
+ * With color keying, foreground pixels whose RGB888 value lies within
+ * [key_low, key_high] on every channel are transparent; where the
+ * background is keyed as well, the pixel becomes key_default.
+ *
+ * @param dst First destination pixel
+ * @param dst_stride Destination stride in pixels
+ * @param bg First background pixel
+ * @param bg_stride Background stride in pixels
+ * @param fg First foreground pixel
+ * @param fg_stride Foreground stride in pixels
+ * @param width Rectangle width
+ * @param height Rectangle height
+ * @param bpp Bytes per pixel (color keying needs 2 or more)
+ * @param fg_alpha Foreground alpha (0-255)
+ * @param bg_alpha Background alpha (0-255), ARGB8888 only
+ * @param key_enable Enable color keying
+ * @param key_low Lowest keyed color (RGB888)
+ * @param key_high Highest keyed color (RGB888)
+ * @param key_default Color where both layers are keyed (RGB888)
+ */
+void ppa_soft_blend(void* dst, uint32_t dst_stride,
+                    const void* bg, uint32_t bg_stride,
+                    const void* fg, uint32_t fg_stride,
+                    uint16_t width, uint16_t height, uint8_t bpp,
+                    uint8_t fg_alpha, uint8_t bg_alpha,
+                    bool key_enable, uint32_t key_low, uint32_t key_high, uint32_t key_default);
+
+/**
+ * @brief Scale a rectangle to a new size
+ *
+ * Pixel centres are mapped in 16.16 fixed point; bilinear weights are
+ * 5-bit for RGB565 and 8-bit otherwise, with edges clamped.
+ *
+ * @param dst First destination pixel
+ * @param dst_stride Destination stride in pixels
+ * @param dst_width Destination width
+ * @param dst_height Destination height
+ * @param src First source pixel
+ * @param src_stride Source stride in pixels
+ * @param src_width Source width
+ * @param src_height Source height
+ * @param bpp Bytes per pixel
+ * @param filter Nearest or bilinear
+ */
+void ppa_soft_scale(void* dst, uint32_t dst_stride, uint16_t dst_width, uint16_t dst_height,
+                    const void* src, uint32_t src_stride, uint16_t src_width, uint16_t src_height,
+                    uint8_t bpp, ppa_soft_filter_t filter);
+
+/**
+ * @brief Rotate counter-clockwise, then mirror, a rectangle
+ *
+ * Quarter turns swap the destination's width and height. Transposing
+ * copies walk PPA_SOFT_TILE_SIZE square tiles so reads and writes both
+ * stay within a few cache lines.
+ *
+ * @param dst First destination pixel
+ * @param dst_stride Destination stride in pixels
+ * @param src First source pixel
+ * @param src_stride Source stride in pixels
+ * @param src_width Source width
+ * @param src_height Source height
+ * @param bpp Bytes per pixel
+ * @param quarter_turns Counter-clockwise quarter turns (0-3)
+ * @param mirror_x Mirror the result horizontally
+ * @param mirror_y Mirror the result vertically
+ */
+void ppa_soft_rotate(void* dst, uint32_t dst_stride,
+                     const void* src, uint32_t src_stride, uint16_t src_width, uint16_t src_height,
+                     uint8_t bpp, uint8_t quarter_turns, bool mirror_x, bool mirror_y);
+
+} // extern "C"
+
+#endif // PPA_SOFT_H
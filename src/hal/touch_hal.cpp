@@ -495,9 +495,9 @@ void TouchHAL::sendTouchEvent(const TouchEventData& eventData) {
         m_touchCallback(eventData);
     }
 
-    // Also publish as system event
-    PUBLISH_EVENT(EVENT_UI_TOUCH_PRESS + (int)eventData.event, 
-                  (void*)&eventData, sizeof(eventData));
+    // Also publish as system event; the point is copied inline since
+    // eventData does not outlive async delivery
+    PUBLISH_EVENT_VALUE(EVENT_UI_TOUCH_PRESS + (int)eventData.event, eventData.point);
 }
 
 GestureType TouchHAL::detectMultiTouchGesture() {
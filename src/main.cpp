@@ -199,6 +199,9 @@ void loop() {
         Serial.printf("OS update error: %d\n", result);
     }
 
-    // Small delay to prevent watchdog issues
+#if !OS_FRAME_PACING
+    // Small delay to prevent watchdog issues; with pacing, update() sleeps
+    // until the next frame boundary itself
     delay(1);
+#endif
 }
\ No newline at end of file
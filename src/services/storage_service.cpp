@@ -391,6 +391,25 @@ bool StorageService::fileExists(const std::string& path) {
     return (stat(path.c_str(), &fileStat) == 0);
 }
 
+AsyncRuntime::OffloadAwaiter<std::vector<uint8_t>> StorageService::readFileAsync(const std::string& path, size_t offset,
+                                                                                  size_t size, uint32_t timeoutMs) {
+    return OS().getAsyncRuntime().offload([path, offset, size]() {
+        std::vector<uint8_t> data;
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            ESP_LOGW(TAG, "Failed to open %s", path.c_str());
+            return data;
+        }
+
+        if (fseek(file, offset, SEEK_SET) == 0) {
+            data.resize(size);
+            data.resize(fread(data.data(), 1, size, file));
+        }
+        fclose(file);
+        return data;
+    }, timeoutMs);
+}
+
 void StorageService::printStorageStats() const {
     ESP_LOGI(TAG, "Storage Statistics:");
     
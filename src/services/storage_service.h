@@ -2,6 +2,7 @@
 #define STORAGE_SERVICE_H
 
 #include "../system/os_config.h"
+#include "../system/async_task.h"
 #include "../hal/hardware_config.h"
 #include <esp_vfs_fat.h>
 #include <driver/sdspi_host.h>
@@ -178,6 +179,19 @@ public:
      */
     bool fileExists(const std::string& path);
 
+    /**
+     * @brief Read part of a file on a worker thread
+     *
+     * For use from coroutines: co_await storage.readFileAsync(path, 0, 80).
+     * @param path File path
+     * @param offset Byte offset to start reading at
+     * @param size Maximum bytes to read
+     * @param timeoutMs Give up after this long (0 = wait forever)
+     * @return Awaitable yielding the bytes read (empty if the file cannot be read)
+     */
+    AsyncRuntime::OffloadAwaiter<std::vector<uint8_t>> readFileAsync(const std::string& path, size_t offset,
+                                                                      size_t size, uint32_t timeoutMs = 0);
+
     /**
      * @brief Get storage statistics
      */
@@ -0,0 +1,271 @@
+#include "allocation_profiler.h"
+#include <esp_log.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const char* TAG = "AllocProfiler";
+
+static const uint16_t PROFILE_FILE_VERSION = 1;
+
+AllocationProfiler::~AllocationProfiler() {
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+    }
+}
+
+os_error_t AllocationProfiler::start(uint32_t sampleRate) {
+    if (sampleRate == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    if (!m_mutex) {
+        m_mutex = xSemaphoreCreateMutex();
+        if (!m_mutex) {
+            return OS_ERROR_NO_MEMORY;
+        }
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return OS_ERROR_TIMEOUT;
+    }
+
+    m_state.reset(new (std::nothrow) State());
+    if (!m_state) {
+        xSemaphoreGive(m_mutex);
+        return OS_ERROR_NO_MEMORY;
+    }
+    m_sampleRate = sampleRate;
+    m_sampleCounter.store(0, std::memory_order_relaxed);
+    m_enabled.store(true, std::memory_order_release);
+
+    xSemaphoreGive(m_mutex);
+
+    ESP_LOGI(TAG, "Allocation profiling started (1 in %d allocations)", sampleRate);
+    return OS_OK;
+}
+
+void AllocationProfiler::stop() {
+    m_enabled.store(false, std::memory_order_release);
+    ESP_LOGI(TAG, "Allocation profiling stopped");
+}
+
+void AllocationProfiler::recordAllocation(void* ptr, size_t size, const char* file, int line) {
+    if (!ptr || !isEnabled()) {
+        return;
+    }
+    if (m_sampleCounter.fetch_add(1, std::memory_order_relaxed) % m_sampleRate != 0) {
+        return;
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        return;
+    }
+
+    AllocationSiteStats* site = m_state ? findSite(file, line) : nullptr;
+    if (site) {
+        MemoryBlock sample = {};
+        sample.ptr = ptr;
+        sample.size = size;
+        sample.file = file;
+        sample.line = line;
+        sample.inUse = true;
+
+        // Each sample stands in for sampleRate allocations
+        if (m_state->liveSamples.insert(sample)) {
+            site->allocCount += m_sampleRate;
+            site->allocBytes += (uint64_t)size * m_sampleRate;
+            site->sizeHistogram[sizeBucket(size)] += m_sampleRate;
+        } else {
+            m_state->droppedSamples++;
+        }
+    } else if (m_state) {
+        m_state->droppedSamples++;
+    }
+
+    xSemaphoreGive(m_mutex);
+}
+
+void AllocationProfiler::recordDeallocation(void* ptr) {
+    if (!ptr || !isEnabled()) {
+        return;
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        return;
+    }
+
+    MemoryBlock sample;
+    if (m_state && m_state->liveSamples.remove(ptr, &sample)) {
+        AllocationSiteStats* site = findSite(sample.file, sample.line);
+        if (site) {
+            site->freeCount += m_sampleRate;
+            site->freeBytes += (uint64_t)sample.size * m_sampleRate;
+        }
+    }
+
+    xSemaphoreGive(m_mutex);
+}
+
+AllocationSnapshot AllocationProfiler::snapshot() const {
+    AllocationSnapshot result;
+    result.timestamp = millis();
+    result.sampleRate = m_sampleRate;
+
+    if (!m_mutex || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return result;
+    }
+
+    if (m_state) {
+        result.droppedSamples = m_state->droppedSamples;
+        for (size_t i = 0; i < PROFILER_MAX_SITES; i++) {
+            if (m_state->siteUsed[i] && m_state->sites[i].allocCount > 0) {
+                result.sites.push_back(m_state->sites[i]);
+            }
+        }
+    }
+
+    xSemaphoreGive(m_mutex);
+    return result;
+}
+
+std::vector<AllocationSiteDelta> AllocationProfiler::diff(const AllocationSnapshot& before,
+                                                          const AllocationSnapshot& after) {
+    std::vector<AllocationSiteDelta> deltas;
+
+    for (const auto& site : after.sites) {
+        auto previous = std::find_if(before.sites.begin(), before.sites.end(),
+                                     [&site](const AllocationSiteStats& other) {
+                                         return other.file == site.file && other.line == site.line;
+                                     });
+
+        AllocationSiteDelta delta;
+        delta.file = site.file;
+        delta.line = site.line;
+        delta.allocCountDelta = (int32_t)site.allocCount;
+        delta.allocBytesDelta = (int64_t)site.allocBytes;
+        delta.liveBytesDelta = site.liveBytes();
+        if (previous != before.sites.end()) {
+            delta.allocCountDelta -= (int32_t)previous->allocCount;
+            delta.allocBytesDelta -= (int64_t)previous->allocBytes;
+            delta.liveBytesDelta -= previous->liveBytes();
+        }
+
+        if (delta.allocCountDelta != 0 || delta.liveBytesDelta != 0) {
+            deltas.push_back(delta);
+        }
+    }
+
+    std::sort(deltas.begin(), deltas.end(),
+              [](const AllocationSiteDelta& a, const AllocationSiteDelta& b) {
+                  return a.liveBytesDelta > b.liveBytesDelta;
+              });
+    return deltas;
+}
+
+void AllocationProfiler::logDiff(const char* label, const AllocationSnapshot& before,
+                                 const AllocationSnapshot& after, size_t maxSites) {
+    std::vector<AllocationSiteDelta> deltas = diff(before, after);
+
+    int64_t totalLive = 0;
+    for (const auto& delta : deltas) {
+        totalLive += delta.liveBytesDelta;
+    }
+
+    ESP_LOGI(TAG, "Allocations during %s: %d sites, %+lld live bytes (1:%d sampling)",
+             label ? label : "interval", deltas.size(), (long long)totalLive, after.sampleRate);
+    for (size_t i = 0; i < deltas.size() && i < maxSites; i++) {
+        const AllocationSiteDelta& delta = deltas[i];
+        ESP_LOGI(TAG, "  %s:%d  %+d allocs, %+lld bytes, %+lld live",
+                 delta.file ? delta.file : "unknown", delta.line, delta.allocCountDelta,
+                 (long long)delta.allocBytesDelta, (long long)delta.liveBytesDelta);
+    }
+}
+
+os_error_t AllocationProfiler::dumpToFile(const char* path, const AllocationSnapshot& snapshot) {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to open profile file for writing: %s", path);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    // Both the ESP32-P4 and host tools are little-endian, so fields are written natively
+    bool ok = true;
+    auto write = [&](const void* data, size_t size) {
+        ok = ok && fwrite(data, 1, size, file) == size;
+    };
+
+    uint16_t bucketCount = PROFILER_SIZE_BUCKETS;
+    uint32_t siteCount = snapshot.sites.size();
+    write("APRF", 4);
+    write(&PROFILE_FILE_VERSION, sizeof(PROFILE_FILE_VERSION));
+    write(&bucketCount, sizeof(bucketCount));
+    write(&snapshot.sampleRate, sizeof(snapshot.sampleRate));
+    write(&snapshot.timestamp, sizeof(snapshot.timestamp));
+    write(&siteCount, sizeof(siteCount));
+    write(&snapshot.droppedSamples, sizeof(snapshot.droppedSamples));
+
+    for (const auto& site : snapshot.sites) {
+        uint32_t line = site.line;
+        const char* name = site.file ? site.file : "unknown";
+        uint16_t nameLength = strlen(name);
+
+        write(&line, sizeof(line));
+        write(&site.allocCount, sizeof(site.allocCount));
+        write(&site.freeCount, sizeof(site.freeCount));
+        write(&site.allocBytes, sizeof(site.allocBytes));
+        write(&site.freeBytes, sizeof(site.freeBytes));
+        write(site.sizeHistogram, sizeof(site.sizeHistogram));
+        write(&nameLength, sizeof(nameLength));
+        write(name, nameLength);
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write profile file: %s", path);
+        return OS_ERROR_STORAGE;
+    }
+
+    ESP_LOGI(TAG, "Wrote allocation profile (%d sites) to %s", siteCount, path);
+    return OS_OK;
+}
+
+size_t AllocationProfiler::sizeBucket(size_t size) {
+    size_t bucket = 0;
+    size_t limit = 16;
+    while (bucket < PROFILER_SIZE_BUCKETS - 1 && size > limit) {
+        limit <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+AllocationSiteStats* AllocationProfiler::findSite(const char* file, int line) {
+    // Open addressing on the (file literal, line) pair
+    uintptr_t key = reinterpret_cast<uintptr_t>(file) ^ ((uintptr_t)line * 2654435761u);
+    size_t slot = (key >> 2) % PROFILER_MAX_SITES;
+
+    for (size_t probe = 0; probe < PROFILER_MAX_SITES; probe++) {
+        AllocationSiteStats& site = m_state->sites[slot];
+        if (!m_state->siteUsed[slot]) {
+            m_state->siteUsed[slot] = true;
+            site.file = file;
+            site.line = line;
+            m_state->siteCount++;
+            return &site;
+        }
+        if (site.file == file && site.line == line) {
+            return &site;
+        }
+        slot = (slot + 1) % PROFILER_MAX_SITES;
+    }
+
+    return nullptr;
+}
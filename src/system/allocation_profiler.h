@@ -0,0 +1,157 @@
+#ifndef ALLOCATION_PROFILER_H
+#define ALLOCATION_PROFILER_H
+
+#include "os_config.h"
+#include "allocation_tracker.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @file allocation_profiler.h
+ * @brief Sampling allocation profiler for MemoryManager
+ *
+ * Aggregates allocations by call site (file/line passed to
+ * MemoryManager::allocate()) and by power-of-two size bucket. Only every
+ * Nth allocation is recorded and weighted by N, so the reported counts and
+ * bytes are estimates. Snapshots can be diffed, e.g. around an app launch,
+ * and dumped to a binary file for tools/alloc_profile.py.
+ */
+
+static constexpr size_t PROFILER_SIZE_BUCKETS = 12;   // <=16B, <=32B, ... <=16KB, >16KB
+static constexpr size_t PROFILER_MAX_SITES = 128;
+static constexpr size_t PROFILER_MAX_LIVE_SAMPLES = 1024;
+
+struct AllocationSiteStats {
+    const char* file = nullptr;
+    int line = 0;
+    uint32_t allocCount = 0;
+    uint32_t freeCount = 0;
+    uint64_t allocBytes = 0;
+    uint64_t freeBytes = 0;
+    uint32_t sizeHistogram[PROFILER_SIZE_BUCKETS] = {};
+
+    int64_t liveBytes() const { return (int64_t)allocBytes - (int64_t)freeBytes; }
+    int32_t liveCount() const { return (int32_t)(allocCount - freeCount); }
+};
+
+struct AllocationSnapshot {
+    uint32_t timestamp = 0;
+    uint32_t sampleRate = 1;
+    uint32_t droppedSamples = 0;
+    std::vector<AllocationSiteStats> sites;
+};
+
+struct AllocationSiteDelta {
+    const char* file;
+    int line;
+    int32_t allocCountDelta;
+    int64_t allocBytesDelta;
+    int64_t liveBytesDelta;
+};
+
+class AllocationProfiler {
+public:
+    AllocationProfiler() = default;
+    ~AllocationProfiler();
+
+    /**
+     * @brief Start (or restart) profiling, clearing previous data
+     * @param sampleRate Record one in every sampleRate allocations (1 = all)
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t start(uint32_t sampleRate = 1);
+
+    /**
+     * @brief Stop recording; collected data remains available
+     */
+    void stop();
+
+    /**
+     * @brief Check if allocations are being recorded
+     * @return true if profiling is active
+     */
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Record an allocation (sampled)
+     * @param ptr Allocated pointer
+     * @param size Requested size in bytes
+     * @param file Call site file or nullptr
+     * @param line Call site line
+     */
+    void recordAllocation(void* ptr, size_t size, const char* file, int line);
+
+    /**
+     * @brief Record a deallocation; only affects pointers that were sampled
+     * @param ptr Pointer being freed
+     */
+    void recordDeallocation(void* ptr);
+
+    /**
+     * @brief Copy the current per-site statistics
+     * @return Snapshot (empty if never started)
+     */
+    AllocationSnapshot snapshot() const;
+
+    /**
+     * @brief Compute per-site changes between two snapshots
+     * @param before Earlier snapshot
+     * @param after Later snapshot
+     * @return Changed sites sorted by live-bytes growth, largest first
+     */
+    static std::vector<AllocationSiteDelta> diff(const AllocationSnapshot& before,
+                                                 const AllocationSnapshot& after);
+
+    /**
+     * @brief Log the top sites of a snapshot diff
+     * @param label Context for the log line (e.g. app ID)
+     * @param before Earlier snapshot
+     * @param after Later snapshot
+     * @param maxSites Maximum number of sites to log
+     */
+    static void logDiff(const char* label, const AllocationSnapshot& before,
+                        const AllocationSnapshot& after, size_t maxSites = 8);
+
+    /**
+     * @brief Write a snapshot to a binary profile file
+     *
+     * Layout (little-endian): "APRF", u16 version, u16 bucket count,
+     * u32 sample rate, u32 timestamp, u32 site count, u32 dropped samples,
+     * then per site: u32 line, u32 alloc count, u32 free count,
+     * u64 alloc bytes, u64 free bytes, u32 histogram[bucket count],
+     * u16 file name length, file name bytes.
+     * @param path Destination path (e.g. under OS_STORAGE_MOUNT_POINT)
+     * @param snapshot Snapshot to write
+     * @return OS_OK on success, error code on failure
+     */
+    static os_error_t dumpToFile(const char* path, const AllocationSnapshot& snapshot);
+
+    /**
+     * @brief Get size bucket index for an allocation size
+     * @param size Size in bytes
+     * @return Bucket index (0 = up to 16 bytes)
+     */
+    static size_t sizeBucket(size_t size);
+
+private:
+    struct State {
+        AllocationSiteStats sites[PROFILER_MAX_SITES];
+        bool siteUsed[PROFILER_MAX_SITES] = {};
+        size_t siteCount = 0;
+        AllocationTracker<true, PROFILER_MAX_LIVE_SAMPLES> liveSamples;
+        uint32_t droppedSamples = 0;
+    };
+
+    AllocationSiteStats* findSite(const char* file, int line);
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<uint32_t> m_sampleCounter{0};
+    uint32_t m_sampleRate = 1;
+    std::unique_ptr<State> m_state;
+    SemaphoreHandle_t m_mutex = nullptr;
+};
+
+#endif // ALLOCATION_PROFILER_H
@@ -0,0 +1,200 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file allocation_tracker.h
+ * @brief Fixed-capacity pointer to allocation metadata table
+ *
+ * Used by MemoryManager to track heap allocations. The table is an
+ * open-addressing hash with linear probing and backward-shift deletion,
+ * stored inline so tracking never allocates. Debug builds keep the full
+ * metadata per allocation; in release builds the disabled specialization
+ * keeps only the pointers, which is still enough to reject frees of memory
+ * the manager never handed out.
+ */
+
+struct MemoryBlock {
+    void* ptr;
+    size_t size;
+    uint32_t timestamp;
+    const char* file;
+    int line;
+    bool inUse;
+};
+
+/**
+ * @brief Open-addressing table keyed by the slot's ptr member
+ * @tparam Slot Slot type; a null ptr marks an empty slot
+ * @tparam Capacity Number of slots, must be a power of two
+ */
+template <typename Slot, size_t Capacity>
+class PointerTable {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "AllocationTracker capacity must be a power of two");
+
+    /**
+     * @brief Add an entry to the table
+     * @param block Entry (block.ptr must be non-null)
+     * @return false if the pointer is already tracked or the table is full
+     */
+    bool insert(const Slot& block) {
+        if (!block.ptr || m_count >= MAX_LOAD) {
+            return false;
+        }
+
+        size_t slot = slotFor(block.ptr);
+        while (m_slots[slot].ptr) {
+            if (m_slots[slot].ptr == block.ptr) {
+                return false;
+            }
+            slot = (slot + 1) & MASK;
+        }
+
+        m_slots[slot] = block;
+        m_count++;
+        return true;
+    }
+
+    /**
+     * @brief Remove an entry from the table
+     * @param ptr Tracked pointer
+     * @param removed Optional output for the removed entry
+     * @return true if the pointer was tracked
+     */
+    bool remove(const void* ptr, Slot* removed = nullptr) {
+        size_t slot;
+        if (!locate(ptr, slot)) {
+            return false;
+        }
+        if (removed) {
+            *removed = m_slots[slot];
+        }
+
+        // Backward-shift deletion: pull later entries of the probe run into
+        // the hole so lookups never need tombstones
+        size_t hole = slot;
+        size_t next = (hole + 1) & MASK;
+        while (m_slots[next].ptr) {
+            size_t home = slotFor(m_slots[next].ptr);
+            bool homeBetween = (hole <= next) ? (home > hole && home <= next)
+                                              : (home > hole || home <= next);
+            if (!homeBetween) {
+                m_slots[hole] = m_slots[next];
+                hole = next;
+            }
+            next = (next + 1) & MASK;
+        }
+
+        m_slots[hole].ptr = nullptr;
+        m_count--;
+        return true;
+    }
+
+    /**
+     * @brief Look up an entry
+     * @param ptr Pointer to look up
+     * @return Entry or nullptr if not tracked
+     */
+    const Slot* find(const void* ptr) const {
+        size_t slot;
+        return locate(ptr, slot) ? &m_slots[slot] : nullptr;
+    }
+
+    /**
+     * @brief Visit every entry (in table order)
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (size_t i = 0; i < Capacity; i++) {
+            if (m_slots[i].ptr) {
+                visit(m_slots[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Get number of tracked allocations
+     */
+    size_t size() const { return m_count; }
+
+    /**
+     * @brief Get maximum number of allocations that can be tracked
+     */
+    static constexpr size_t capacity() { return MAX_LOAD; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t MAX_LOAD = Capacity - Capacity / 4;  // Keep probe runs short
+
+    static constexpr uint32_t log2(size_t value) {
+        return value <= 1 ? 0 : 1 + log2(value >> 1);
+    }
+    static constexpr uint32_t HASH_SHIFT = 32 - log2(Capacity);
+
+    static size_t slotFor(const void* ptr) {
+        // Fibonacci hashing of the address with the always-zero low bits dropped
+        uint32_t key = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr) >> 2);
+        return static_cast<size_t>((key * 2654435761u) >> HASH_SHIFT);
+    }
+
+    bool locate(const void* ptr, size_t& slot) const {
+        if (!ptr) {
+            return false;
+        }
+        slot = slotFor(ptr);
+        while (m_slots[slot].ptr) {
+            if (m_slots[slot].ptr == ptr) {
+                return true;
+            }
+            slot = (slot + 1) & MASK;
+        }
+        return false;
+    }
+
+    Slot m_slots[Capacity] = {};
+    size_t m_count = 0;
+};
+
+/**
+ * @brief Allocation table with full metadata (tracking enabled)
+ * @tparam Enabled Selects the full table or the pointer-only specialization
+ * @tparam Capacity Number of slots, must be a power of two
+ */
+template <bool Enabled, size_t Capacity>
+class AllocationTracker : public PointerTable<MemoryBlock, Capacity> {
+public:
+    static constexpr bool enabled = true;
+};
+
+/**
+ * @brief Release-build tracker: pointers only, no metadata
+ *
+ * find() and forEach() have nothing to report, but remove() still fails
+ * for pointers that were never inserted.
+ */
+template <size_t Capacity>
+class AllocationTracker<false, Capacity> {
+public:
+    static constexpr bool enabled = false;
+
+    bool insert(const MemoryBlock& block) { return m_pointers.insert(TrackedPointer{block.ptr}); }
+    bool remove(const void* ptr, MemoryBlock* = nullptr) { return m_pointers.remove(ptr); }
+    const MemoryBlock* find(const void*) const { return nullptr; }
+    template <typename Visitor>
+    void forEach(Visitor&&) const {}
+    size_t size() const { return m_pointers.size(); }
+    static constexpr size_t capacity() { return PointerTable<TrackedPointer, Capacity>::capacity(); }
+
+private:
+    struct TrackedPointer {
+        void* ptr;
+    };
+
+    PointerTable<TrackedPointer, Capacity> m_pointers;
+};
+
+#endif // ALLOCATION_TRACKER_H
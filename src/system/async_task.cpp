@@ -0,0 +1,308 @@
+#include "async_task.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "AsyncRuntime";
+
+void AsyncTask::promise_type::unhandled_exception() noexcept {
+    ESP_LOGE(TAG, "Coroutine %d threw an exception", id);
+}
+
+AsyncRuntime::~AsyncRuntime() {
+    shutdown();
+}
+
+os_error_t AsyncRuntime::initialize(TaskScheduler& scheduler, EventSystem* events,
+                                    JobExecutor* executor) {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Initializing Async Runtime");
+
+    m_scheduler = &scheduler;
+    m_events = events;
+    m_executor = executor;
+    m_slots.reserve(OS_MAX_ASYNC_TASKS);
+
+    // Worker threads cannot touch the scheduler, so their wakeups are
+    // queued and turned into resume tasks here
+    m_drainTaskId = m_scheduler->schedulePeriodic([this]() { drainWakeups(); }, 1,
+                                                  OS_TASK_PRIORITY_HIGH, 0, "async_wake");
+    if (m_drainTaskId == 0) {
+        ESP_LOGE(TAG, "Failed to schedule wakeup task");
+        return OS_ERROR_GENERIC;
+    }
+
+    m_initialized = true;
+    ESP_LOGI(TAG, "Async Runtime initialized");
+    return OS_OK;
+}
+
+os_error_t AsyncRuntime::shutdown() {
+    if (!m_initialized) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Shutting down Async Runtime");
+
+    while (!m_slots.empty()) {
+        destroy(m_slots.back().id);
+    }
+    m_scheduler->cancelTask(m_drainTaskId);
+    m_drainTaskId = 0;
+
+    Wakeup wakeup;
+    while (m_wakeups.pop(wakeup)) {
+    }
+
+    m_initialized = false;
+    ESP_LOGI(TAG, "Async Runtime shutdown complete");
+    return OS_OK;
+}
+
+uint32_t AsyncRuntime::spawn(AsyncTask task, const char* name) {
+    if (!m_initialized || !task.m_handle) {
+        return 0;
+    }
+    if (m_slots.size() >= OS_MAX_ASYNC_TASKS) {
+        ESP_LOGW(TAG, "Cannot spawn '%s': %d coroutines already running",
+                name ? name : "unnamed", OS_MAX_ASYNC_TASKS);
+        return 0;
+    }
+
+    uint32_t id = ++m_nextId;
+    if (id == 0) {
+        id = ++m_nextId;
+    }
+
+    AsyncTask::Handle handle = task.release();
+    handle.promise().runtime = this;
+    handle.promise().id = id;
+
+    Slot slot;
+    slot.id = id;
+    slot.handle = handle;
+    slot.name = name;
+    slot.sequence = 0;
+    slot.resumeTaskId = 0;
+    slot.running = false;
+    slot.cancelRequested = false;
+    m_slots.push_back(std::move(slot));
+
+    // The initial suspension counts as the first wait
+    if (beginWait(handle, 0) == 0) {
+        destroy(id);
+        return 0;
+    }
+
+    #if OS_DEBUG_ENABLED >= 2
+    ESP_LOGD(TAG, "Spawned coroutine %d '%s'", id, name ? name : "unnamed");
+    #endif
+
+    return id;
+}
+
+bool AsyncRuntime::cancel(uint32_t id) {
+    Slot* slot = findSlot(id);
+    if (!slot) {
+        return false;
+    }
+
+    if (slot->running) {
+        // Cannot destroy a frame that is executing; finish at its next co_await
+        slot->cancelRequested = true;
+    } else {
+        destroy(id);
+    }
+    return true;
+}
+
+void AsyncRuntime::wakeFromAnyThread(uint32_t id, uint32_t sequence) {
+    if (!m_wakeups.push(Wakeup{id, sequence})) {
+        ESP_LOGW(TAG, "Wakeup queue full, coroutine %d not woken", id);
+    }
+}
+
+uint32_t AsyncRuntime::beginWait(AsyncTask::Handle handle, uint32_t timeoutMs) {
+    Slot* slot = findSlot(handle.promise().id);
+    if (!slot) {
+        return 0;
+    }
+
+    uint32_t sequence = ++m_nextSequence;
+    if (sequence == 0) {
+        sequence = ++m_nextSequence;
+    }
+    slot->sequence = sequence;
+
+    if (timeoutMs != WAIT_FOREVER && !scheduleResume(*slot, timeoutMs)) {
+        slot->sequence = 0;
+        return 0;
+    }
+    return sequence;
+}
+
+void AsyncRuntime::setDetach(uint32_t id, uint32_t sequence, DetachFunction detach) {
+    Slot* slot = findSlot(id);
+    if (slot && slot->sequence == sequence) {
+        slot->detach = std::move(detach);
+    }
+}
+
+bool AsyncRuntime::wake(uint32_t id, uint32_t sequence) {
+    Slot* slot = findSlot(id);
+    if (!slot || sequence == 0 || slot->sequence != sequence) {
+        return false;
+    }
+    return scheduleResume(*slot, 0);
+}
+
+bool AsyncRuntime::isWaiting(uint32_t id, uint32_t sequence) const {
+    const Slot* slot = findSlot(id);
+    return slot && sequence != 0 && slot->sequence == sequence;
+}
+
+AsyncRuntime::Slot* AsyncRuntime::findSlot(uint32_t id) {
+    for (auto& slot : m_slots) {
+        if (slot.id == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+const AsyncRuntime::Slot* AsyncRuntime::findSlot(uint32_t id) const {
+    return const_cast<AsyncRuntime*>(this)->findSlot(id);
+}
+
+bool AsyncRuntime::scheduleResume(Slot& slot, uint32_t delayMs) {
+    uint32_t id = slot.id;
+    uint32_t sequence = slot.sequence;
+    uint32_t taskId = m_scheduler->scheduleOnce([this, id, sequence]() { resume(id, sequence); },
+                                                OS_TASK_PRIORITY_NORMAL, delayMs, slot.name);
+    if (taskId == 0) {
+        // Keep the pending resume (a timeout) so the coroutine still wakes
+        ESP_LOGE(TAG, "Task table full, cannot resume coroutine %d", id);
+        return false;
+    }
+
+    if (slot.resumeTaskId) {
+        m_scheduler->cancelTask(slot.resumeTaskId);
+    }
+    slot.resumeTaskId = taskId;
+    return true;
+}
+
+void AsyncRuntime::resume(uint32_t id, uint32_t sequence) {
+    Slot* slot = findSlot(id);
+    if (!slot || slot->sequence != sequence) {
+        return;
+    }
+
+    // This is the slot's pending resume task; it is finishing now
+    slot->resumeTaskId = 0;
+    slot->sequence = 0;
+    if (slot->detach) {
+        DetachFunction detach = std::move(slot->detach);
+        detach();
+    }
+
+    AsyncTask::Handle handle = slot->handle;
+    slot->running = true;
+    uint32_t previous = m_current;
+    m_current = id;
+
+    handle.resume();
+
+    m_current = previous;
+    slot = findSlot(id);
+    if (!slot) {
+        return;  // Runtime shut down from inside the coroutine
+    }
+    slot->running = false;
+    if (handle.done() || slot->cancelRequested) {
+        destroy(id);
+    }
+}
+
+void AsyncRuntime::destroy(uint32_t id) {
+    auto it = std::find_if(m_slots.begin(), m_slots.end(),
+                          [id](const Slot& slot) { return slot.id == id; });
+    if (it == m_slots.end()) {
+        return;
+    }
+
+    if (it->resumeTaskId) {
+        m_scheduler->cancelTask(it->resumeTaskId);
+    }
+    if (it->detach) {
+        it->detach();
+    }
+    AsyncTask::Handle handle = it->handle;
+    m_slots.erase(it);
+
+    // Destroying the frame can run destructors that call back into the runtime
+    handle.destroy();
+
+    #if OS_DEBUG_ENABLED >= 2
+    ESP_LOGD(TAG, "Destroyed coroutine %d", id);
+    #endif
+}
+
+void AsyncRuntime::drainWakeups() {
+    Wakeup wakeup;
+    while (m_wakeups.pop(wakeup)) {
+        wake(wakeup.id, wakeup.sequence);
+    }
+}
+
+bool AsyncRuntime::SleepAwaiter::await_suspend(AsyncTask::Handle handle) {
+    return runtime->beginWait(handle, delayMs) != 0;
+}
+
+bool AsyncRuntime::EventAwaiter::await_suspend(AsyncTask::Handle handle) {
+    EventSystem* events = runtime->getEventSystem();
+    if (!events) {
+        result.status = AsyncStatus::FAILED;
+        return false;
+    }
+
+    uint32_t sequence = runtime->beginWait(handle, timeoutMs ? timeoutMs : WAIT_FOREVER);
+    if (sequence == 0) {
+        result.status = AsyncStatus::FAILED;
+        return false;
+    }
+    result.status = AsyncStatus::TIMEOUT;
+
+    // The listener is unsubscribed when the wait ends, so the awaiter it
+    // writes to is still suspended in the coroutine frame
+    AsyncRuntime* owner = runtime;
+    uint32_t id = handle.promise().id;
+    AsyncResult<EventData>* target = &result;
+    ListenerId listener = events->subscribe(type, [owner, id, sequence, target](const EventData& event) {
+        // The first event wins; later ones before the resume runs must not
+        // overwrite it or push the resume back
+        if (target->status == AsyncStatus::OK || !owner->isWaiting(id, sequence)) {
+            return;
+        }
+        target->value = event;
+        target->status = AsyncStatus::OK;
+
+        // With no free task slot to resume it later, resume it now rather
+        // than leave it waiting for a timeout that may never come; its
+        // pending timeout task then finds the wait over and does nothing
+        if (!owner->wake(id, sequence)) {
+            owner->resume(id, sequence);
+        }
+    }, 100, true);
+
+    if (listener == 0) {
+        result.status = AsyncStatus::FAILED;
+        runtime->wake(id, sequence);
+        return true;
+    }
+
+    runtime->setDetach(id, sequence, [events, listener]() { events->unsubscribe(listener); });
+    return true;
+}
@@ -0,0 +1,390 @@
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include "os_config.h"
+#include "task_scheduler.h"
+#include "event_system.h"
+#include "job_executor.h"
+#include "mpsc_ring.h"
+#include "inplace_function.h"
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @file async_task.h
+ * @brief C++20 coroutine tasks driven by the TaskScheduler
+ *
+ * An AsyncTask is a coroutine that can co_await sleeps, events and
+ * blocking work offloaded to the JobExecutor without stalling the main
+ * loop. Coroutines only ever run inside scheduler tasks on the main loop:
+ * every wakeup, including ones from event callbacks or worker threads, is
+ * turned into a one-shot scheduler task that resumes the coroutine.
+ *
+ * Cancelling a suspended coroutine destroys its frame at the suspension
+ * point (locals are destructed, no further code runs) and detaches it from
+ * whatever it was waiting on. Each suspension gets a sequence number, so a
+ * late wakeup from a wait that already finished or timed out is ignored.
+ *
+ * @code
+ * AsyncTask loadArticle(AsyncRuntime& async, StorageService& storage) {
+ *     auto header = co_await storage.readFileAsync(path, 0, 80);
+ *     if (!header.ok()) co_return;
+ *     co_await async.sleep(10);
+ *     auto touch = co_await async.waitEvent(EVENT_UI_TOUCH_PRESS, 5000);
+ *     if (touch.status == AsyncStatus::TIMEOUT) { ... }
+ * }
+ * async.spawn(loadArticle(async, storage), "zim_load");
+ * @endcode
+ */
+
+class AsyncRuntime;
+
+enum class AsyncStatus : uint8_t {
+    OK,
+    TIMEOUT,
+    FAILED      // The wait could not be started
+};
+
+template <typename T>
+struct AsyncResult {
+    AsyncStatus status = AsyncStatus::FAILED;
+    T value{};
+
+    bool ok() const { return status == AsyncStatus::OK; }
+};
+
+class AsyncTask {
+public:
+    struct promise_type {
+        AsyncRuntime* runtime = nullptr;
+        uint32_t id = 0;
+
+        AsyncTask get_return_object() noexcept {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }  // Started by spawn()
+        std::suspend_always final_suspend() noexcept { return {}; }    // Destroyed by the runtime
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    AsyncTask(AsyncTask&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    ~AsyncTask() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+    AsyncTask& operator=(AsyncTask&&) = delete;
+
+private:
+    friend class AsyncRuntime;
+    explicit AsyncTask(Handle handle) : m_handle(handle) {}
+
+    Handle release() {
+        Handle handle = m_handle;
+        m_handle = nullptr;
+        return handle;
+    }
+
+    Handle m_handle;
+};
+
+class AsyncRuntime {
+public:
+    typedef InplaceFunction<void(), OS_TASK_FUNCTION_CAPACITY> DetachFunction;
+
+    static constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFF;
+
+    AsyncRuntime() = default;
+    ~AsyncRuntime();
+
+    AsyncRuntime(const AsyncRuntime&) = delete;
+    AsyncRuntime& operator=(const AsyncRuntime&) = delete;
+
+    /**
+     * @brief Attach to the subsystems coroutines wait on
+     * @param scheduler Scheduler that resumes coroutines
+     * @param events Event system for waitEvent(), or nullptr
+     * @param executor Executor for offload(), or nullptr to run work inline
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(TaskScheduler& scheduler, EventSystem* events = nullptr,
+                          JobExecutor* executor = nullptr);
+
+    /**
+     * @brief Cancel all coroutines and detach from the scheduler
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t shutdown();
+
+    /**
+     * @brief Start a coroutine on the next scheduler update
+     * @param task Coroutine to run
+     * @param name Optional name for debugging
+     * @return Coroutine ID or 0 if the runtime is full or not initialized
+     */
+    uint32_t spawn(AsyncTask task, const char* name = nullptr);
+
+    /**
+     * @brief Cancel a coroutine
+     *
+     * A suspended coroutine is destroyed immediately. A coroutine that
+     * cancels itself is destroyed at its next suspension point.
+     * @param id Coroutine ID
+     * @return true if the coroutine was found
+     */
+    bool cancel(uint32_t id);
+
+    /**
+     * @brief Check if a coroutine is still alive
+     * @param id Coroutine ID
+     * @return true until it returns or is cancelled
+     */
+    bool isActive(uint32_t id) const { return findSlot(id) != nullptr; }
+
+    /**
+     * @brief Get number of live coroutines
+     * @return Coroutine count
+     */
+    size_t getActiveCount() const { return m_slots.size(); }
+
+    /**
+     * @brief Get the ID of the running coroutine
+     * @return Coroutine ID or 0 outside a coroutine
+     */
+    uint32_t current() const { return m_current; }
+
+    // Awaitables returned by sleep(), waitEvent() and offload()
+
+    struct SleepAwaiter {
+        AsyncRuntime* runtime;
+        uint32_t delayMs;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(AsyncTask::Handle handle);
+        void await_resume() const noexcept {}
+    };
+
+    struct EventAwaiter {
+        AsyncRuntime* runtime;
+        EventType type;
+        uint32_t timeoutMs;
+        AsyncResult<EventData> result;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(AsyncTask::Handle handle);
+        AsyncResult<EventData> await_resume() { return result; }
+    };
+
+    template <typename T>
+    struct OffloadAwaiter {
+        // Shared with the worker job so a cancelled or timed-out
+        // coroutine's frame is never written to
+        struct State {
+            T value{};
+            std::atomic<bool> done{false};
+        };
+
+        AsyncRuntime* runtime;
+        std::function<T()> work;
+        uint32_t timeoutMs;
+        std::shared_ptr<State> state;
+
+        bool await_ready();
+        bool await_suspend(AsyncTask::Handle handle);
+        AsyncResult<T> await_resume();
+    };
+
+    /**
+     * @brief Suspend the calling coroutine
+     * @param delayMs Delay in milliseconds (0 yields to the next update)
+     */
+    SleepAwaiter sleep(uint32_t delayMs) { return SleepAwaiter{this, delayMs}; }
+
+    /**
+     * @brief Wait for the next event of a type
+     * @param type Event type
+     * @param timeoutMs Give up after this long (0 = wait forever)
+     * @return Awaitable yielding the event, or TIMEOUT
+     */
+    EventAwaiter waitEvent(EventType type, uint32_t timeoutMs = 0) {
+        return EventAwaiter{this, type, timeoutMs, {}};
+    }
+
+    /**
+     * @brief Run blocking work on a worker and resume with its result
+     *
+     * Runs inline if no executor is running. On timeout the work still
+     * finishes on the worker but its result is dropped, so it must not
+     * reference the coroutine's locals.
+     * @param work Blocking function returning the result
+     * @param timeoutMs Give up after this long (0 = wait forever)
+     * @return Awaitable yielding the result, or TIMEOUT
+     */
+    template <typename F, typename T = decltype(std::declval<F>()())>
+    OffloadAwaiter<T> offload(F work, uint32_t timeoutMs = 0) {
+        return OffloadAwaiter<T>{this, std::function<T()>(std::move(work)), timeoutMs, nullptr};
+    }
+
+    /**
+     * @brief Wake a suspended coroutine from any thread or core
+     * @param id Coroutine ID
+     * @param sequence Suspension sequence from beginWait()
+     */
+    void wakeFromAnyThread(uint32_t id, uint32_t sequence);
+
+    /**
+     * @brief Start a wait for a suspending coroutine (used by awaitables)
+     * @param handle Coroutine being suspended
+     * @param timeoutMs Resume after this long even if not woken, or WAIT_FOREVER
+     * @return Sequence number identifying this suspension, or 0 on failure
+     */
+    uint32_t beginWait(AsyncTask::Handle handle, uint32_t timeoutMs);
+
+    /**
+     * @brief Set how to unhook a wait's callbacks (used by awaitables)
+     *
+     * Called once when the wait ends, whether woken, timed out or cancelled.
+     * @param id Coroutine ID
+     * @param sequence Suspension sequence from beginWait()
+     * @param detach Function to call
+     */
+    void setDetach(uint32_t id, uint32_t sequence, DetachFunction detach);
+
+    /**
+     * @brief Wake a suspended coroutine from the main loop (used by awaitables)
+     * @param id Coroutine ID
+     * @param sequence Suspension sequence from beginWait()
+     * @return false if the coroutine is gone or no longer in that wait
+     */
+    bool wake(uint32_t id, uint32_t sequence);
+
+    JobExecutor* getExecutor() const { return m_executor; }
+    EventSystem* getEventSystem() const { return m_events; }
+
+private:
+    struct Slot {
+        uint32_t id;
+        AsyncTask::Handle handle;
+        const char* name;
+        uint32_t sequence;       // Current suspension; 0 while running
+        uint32_t resumeTaskId;   // Pending scheduler task that resumes it
+        DetachFunction detach;
+        bool running;
+        bool cancelRequested;
+    };
+
+    struct Wakeup {
+        uint32_t id;
+        uint32_t sequence;
+    };
+
+    Slot* findSlot(uint32_t id);
+    const Slot* findSlot(uint32_t id) const;
+
+    /**
+     * @brief Check whether a coroutine is still in a given wait
+     * @param id Coroutine ID
+     * @param sequence Suspension sequence from beginWait()
+     * @return true if the wait has not ended
+     */
+    bool isWaiting(uint32_t id, uint32_t sequence) const;
+
+    /**
+     * @brief Replace the slot's pending resume task
+     * @param slot Coroutine slot
+     * @param delayMs Delay before resuming
+     * @return false if the scheduler task table is full; the pending
+     *         task is then kept
+     */
+    bool scheduleResume(Slot& slot, uint32_t delayMs);
+
+    /**
+     * @brief Resume a coroutine if it is still in the given wait
+     * @param id Coroutine ID
+     * @param sequence Suspension sequence
+     */
+    void resume(uint32_t id, uint32_t sequence);
+
+    /**
+     * @brief Destroy a coroutine and release its slot
+     * @param id Coroutine ID
+     */
+    void destroy(uint32_t id);
+
+    /**
+     * @brief Turn cross-thread wakeups into resume tasks
+     */
+    void drainWakeups();
+
+    TaskScheduler* m_scheduler = nullptr;
+    EventSystem* m_events = nullptr;
+    JobExecutor* m_executor = nullptr;
+
+    std::vector<Slot> m_slots;
+    MpscRing<Wakeup, OS_ASYNC_WAKEUP_QUEUE_SIZE> m_wakeups;
+    uint32_t m_drainTaskId = 0;
+    uint32_t m_nextId = 0;
+    uint32_t m_nextSequence = 0;
+    uint32_t m_current = 0;
+    bool m_initialized = false;
+};
+
+template <typename T>
+bool AsyncRuntime::OffloadAwaiter<T>::await_ready() {
+    state = std::make_shared<State>();
+    JobExecutor* executor = runtime->getExecutor();
+    if (executor && executor->isRunning()) {
+        return false;
+    }
+    state->value = work();
+    state->done.store(true, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool AsyncRuntime::OffloadAwaiter<T>::await_suspend(AsyncTask::Handle handle) {
+    uint32_t sequence = runtime->beginWait(handle, timeoutMs ? timeoutMs : WAIT_FOREVER);
+    if (sequence == 0) {
+        state->value = work();
+        state->done.store(true, std::memory_order_release);
+        return false;
+    }
+
+    AsyncRuntime* owner = runtime;
+    uint32_t id = handle.promise().id;
+    std::shared_ptr<State> shared = state;
+    std::function<T()> job = work;
+    bool submitted = runtime->getExecutor()->submit([owner, id, sequence, shared, job]() {
+        shared->value = job();
+        shared->done.store(true, std::memory_order_release);
+        owner->wakeFromAnyThread(id, sequence);
+    }, JobAffinity::BACKGROUND);
+
+    if (!submitted) {
+        state->value = work();
+        state->done.store(true, std::memory_order_release);
+        runtime->wake(id, sequence);
+    }
+    return true;
+}
+
+template <typename T>
+AsyncResult<T> AsyncRuntime::OffloadAwaiter<T>::await_resume() {
+    AsyncResult<T> result;
+    if (state->done.load(std::memory_order_acquire)) {
+        result.value = std::move(state->value);
+        result.status = AsyncStatus::OK;
+    } else {
+        result.status = AsyncStatus::TIMEOUT;
+    }
+    return result;
+}
+
+#endif // ASYNC_TASK_H
@@ -0,0 +1,115 @@
+#include "auto_tune_simulator.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "AutoTuneSim";
+
+TuningInputs AutoTuneSimulator::measure(const LoadSample& sample, const TuningSettings& settings) {
+    float frequency = static_cast<float>(settings.cpuFreqMhz);
+    float refreshHz = 1000.0f / settings.refreshPeriodMs;
+    uint32_t flushes = (OS_SCREEN_HEIGHT + settings.drawBufferLines - 1) / settings.drawBufferLines;
+
+    float frameMs = (sample.frameWorkMcycles + flushes * FLUSH_OVERHEAD_MCYCLES) / frequency * 1000.0f;
+    float backgroundMs = sample.backgroundMcyclesPerSec * (100 - settings.backgroundThrottle) / 100.0f /
+                         frequency * 1000.0f;
+    float available = std::max(0.0f, 1000.0f - backgroundMs);
+
+    TuningInputs inputs;
+    inputs.fps = frameMs > 0.0f ? std::min(refreshHz, available / frameMs) : refreshHz;
+    inputs.cpuLoad = std::min(100.0f, (backgroundMs + inputs.fps * frameMs) / 10.0f);
+    inputs.batteryPercent = sample.batteryPercent;
+    inputs.charging = sample.charging;
+    inputs.freeMemoryPercent = sample.freeMemoryPercent;
+    return inputs;
+}
+
+LoadSample AutoTuneSimulator::recordSample(const TuningInputs& measured, const TuningSettings& applied,
+                                           uint32_t durationMs) {
+    uint32_t flushes = (OS_SCREEN_HEIGHT + applied.drawBufferLines - 1) / applied.drawBufferLines;
+    float busyMsPerFrame = measured.cpuLoad * 10.0f / std::max(measured.fps, 1.0f);
+    float frameWork = busyMsPerFrame * applied.cpuFreqMhz / 1000.0f - flushes * FLUSH_OVERHEAD_MCYCLES;
+
+    LoadSample sample;
+    sample.durationMs = durationMs;
+    sample.frameWorkMcycles = std::max(0.0f, frameWork);
+    sample.backgroundMcyclesPerSec = 0.0f;
+    sample.batteryPercent = measured.batteryPercent;
+    sample.charging = measured.charging;
+    sample.freeMemoryPercent = measured.freeMemoryPercent;
+    return sample;
+}
+
+TuneSimReport AutoTuneSimulator::run(const std::vector<LoadSample>& trace, const AutoTuneConfig& config,
+                                     uint32_t seed, uint8_t jitterPercent) {
+    AutoTuner tuner(config);
+    uint32_t random = seed ? seed : 1;
+
+    TuneSimReport report = {};
+    report.minFps = 1000.0f;
+    float fpsSum = 0.0f;
+    float frequencySum = 0.0f;
+    uint32_t shortfalls = 0;
+    int lastLevel = tuner.getFrequencyStep() + tuner.getDegradeLevel();
+    int lastDirection = 0;
+
+    for (const LoadSample& segment : trace) {
+        for (uint32_t elapsed = 0; elapsed < segment.durationMs; elapsed += OS_AUTO_TUNE_INTERVAL_MS) {
+            LoadSample sample = segment;
+            if (jitterPercent > 0) {
+                random = random * 1664525u + 1013904223u;
+                int spread = static_cast<int>((random >> 16) % (2 * jitterPercent + 1)) - jitterPercent;
+                sample.frameWorkMcycles *= 1.0f + spread / 100.0f;
+            }
+
+            // The settings chosen last evaluation are what the device ran with
+            TuningInputs inputs = measure(sample, tuner.getSettings());
+            fpsSum += inputs.fps;
+            frequencySum += tuner.getSettings().cpuFreqMhz;
+            report.minFps = std::min(report.minFps, inputs.fps);
+            if (inputs.fps < tuner.getTargetFps() * 0.9f) {
+                shortfalls++;
+            }
+            report.evaluations++;
+
+            if (tuner.update(inputs)) {
+                report.changes++;
+
+                // Frequency and degradation both rise under pressure
+                int level = tuner.getFrequencyStep() + tuner.getDegradeLevel();
+                int direction = level > lastLevel ? 1 : (level < lastLevel ? -1 : 0);
+                if (direction != 0) {
+                    if (lastDirection != 0 && direction != lastDirection) {
+                        report.reversals++;
+                    }
+                    lastDirection = direction;
+                }
+                lastLevel = level;
+            }
+        }
+        report.durationMs += segment.durationMs;
+    }
+
+    if (report.evaluations > 0) {
+        report.meanFps = fpsSum / report.evaluations;
+        report.meanFrequencyMhz = frequencySum / report.evaluations;
+        report.shortfallPercent = shortfalls * 100.0f / report.evaluations;
+    } else {
+        report.minFps = 0.0f;
+    }
+    report.finalSettings = tuner.getSettings();
+    report.finalFrequencyStep = tuner.getFrequencyStep();
+    report.finalDegradeLevel = tuner.getDegradeLevel();
+    return report;
+}
+
+void AutoTuneSimulator::printReport(const TuneSimReport& report) {
+    ESP_LOGI(TAG, "=== Auto-tune replay, %d ms simulated (%d evaluations) ===",
+            report.durationMs, report.evaluations);
+    ESP_LOGI(TAG, "Changes: %d, reversals: %d", report.changes, report.reversals);
+    ESP_LOGI(TAG, "FPS: mean %.1f, min %.1f, below target %.1f%% of the time",
+            report.meanFps, report.minFps, report.shortfallPercent);
+    ESP_LOGI(TAG, "Mean CPU clock: %.0f MHz", report.meanFrequencyMhz);
+    ESP_LOGI(TAG, "Final: %d MHz, %d ms refresh, %d-line buffer, %d%% background throttle",
+            report.finalSettings.cpuFreqMhz, report.finalSettings.refreshPeriodMs,
+            report.finalSettings.drawBufferLines, report.finalSettings.backgroundThrottle);
+}
@@ -0,0 +1,94 @@
+#ifndef AUTO_TUNE_SIMULATOR_H
+#define AUTO_TUNE_SIMULATOR_H
+
+#include "auto_tuner.h"
+#include <vector>
+
+/**
+ * @file auto_tune_simulator.h
+ * @brief Deterministic replay of load traces through the AUTO-mode controller
+ *
+ * Runs a real AutoTuner against a simple plant model of the device. A
+ * trace is a sequence of workload segments (CPU work per rendered frame,
+ * background work per second, battery state); each controller evaluation
+ * the model turns the workload and the settings in force into the FPS and
+ * CPU load the device would measure, with seeded jitter. The report shows
+ * whether the controller settles or oscillates, how often it misses its
+ * frame-rate target and the average clock it chose. The result is the
+ * same for the same trace and seed.
+ *
+ * Plant model: a frame costs its work plus a fixed overhead per draw
+ * buffer flush, divided by the clock; background work is scaled by the
+ * throttle; the display runs as fast as the remaining time allows, up to
+ * the refresh rate.
+ */
+
+struct LoadSample {
+    uint32_t durationMs;
+    float frameWorkMcycles;           // CPU work per rendered frame
+    float backgroundMcyclesPerSec;    // Low-priority task work, reduced by throttling
+    uint8_t batteryPercent;
+    bool charging;
+    uint8_t freeMemoryPercent;
+};
+
+struct TuneSimReport {
+    uint32_t durationMs;
+    uint32_t evaluations;
+    uint32_t changes;
+    uint32_t reversals;           // Changes that undo the direction of the previous one
+    float meanFps;
+    float minFps;                 // Lowest single evaluation
+    float shortfallPercent;       // Evaluations below 90% of the target refresh rate in force
+    float meanFrequencyMhz;
+    TuningSettings finalSettings;
+    uint8_t finalFrequencyStep;
+    uint8_t finalDegradeLevel;
+};
+
+class AutoTuneSimulator {
+public:
+    static constexpr float FLUSH_OVERHEAD_MCYCLES = 0.02f;
+
+    /**
+     * @brief Replay a load trace in virtual time
+     * @param trace Workload segments, in order
+     * @param config Controller configuration
+     * @param seed Jitter seed
+     * @param jitterPercent Up to this much random variation in frame work
+     * @return Stability and frame-rate report
+     */
+    static TuneSimReport run(const std::vector<LoadSample>& trace,
+                             const AutoTuneConfig& config = AutoTuneConfig(),
+                             uint32_t seed = 1, uint8_t jitterPercent = 5);
+
+    /**
+     * @brief Compute what the device would measure
+     * @param sample Workload
+     * @param settings Settings in force
+     * @return Modelled FPS and CPU load (battery and memory copied from the sample)
+     */
+    static TuningInputs measure(const LoadSample& sample, const TuningSettings& settings);
+
+    /**
+     * @brief Turn a live measurement into a trace segment
+     *
+     * Inverts the plant model. Background work cannot be told apart from
+     * frame work on the device, so all measured busy time is attributed to
+     * frames.
+     * @param measured FPS, load, battery and memory measured on the device
+     * @param applied Settings in force while measuring
+     * @param durationMs Segment length
+     * @return Segment for run()
+     */
+    static LoadSample recordSample(const TuningInputs& measured, const TuningSettings& applied,
+                                   uint32_t durationMs);
+
+    /**
+     * @brief Log a simulation report
+     * @param report Report from run()
+     */
+    static void printReport(const TuneSimReport& report);
+};
+
+#endif // AUTO_TUNE_SIMULATOR_H
@@ -0,0 +1,164 @@
+#include "auto_tuner.h"
+
+struct DegradeStep {
+    uint32_t refreshHz;
+    bool largeBuffer;           // Twice the default draw buffer height
+    uint8_t backgroundThrottle;
+};
+
+// Cheapest, least visible measures first
+static const DegradeStep DEGRADE_STEPS[AutoTuner::DEGRADE_LEVELS] = {
+    {OS_UI_REFRESH_RATE, false, 0},     // Full quality
+    {OS_UI_REFRESH_RATE, true, 0},      // Fewer, larger flushes
+    {OS_UI_REFRESH_RATE, true, 50},     // Background tasks at half rate
+    {45, true, 50},
+    {30, true, 75},
+};
+
+AutoTuner::AutoTuner(const AutoTuneConfig& config) : m_config(config) {
+    reset();
+}
+
+void AutoTuner::reset() {
+    m_frequencyStep = 2;
+    m_degradeLevel = 0;
+    m_maxFrequencyStep = FREQUENCY_STEPS - 1;
+    m_minDegradeLevel = 0;
+    m_fps = -1.0f;
+    m_load = -1.0f;
+    m_pressureCount = 0;
+    m_headroomCount = 0;
+    m_settleCount = 0;
+    m_changes = 0;
+    rebuildSettings(100);
+}
+
+bool AutoTuner::update(const TuningInputs& inputs) {
+    TuningSettings previous = m_settings;
+
+    // Battery limits apply at once, not after a hold
+    applyBatteryLimits(inputs);
+
+    if (m_settleCount > 0) {
+        // Measurements still describe the old settings
+        m_settleCount--;
+    } else {
+        if (m_fps < 0.0f) {
+            m_fps = inputs.fps;
+            m_load = inputs.cpuLoad;
+        } else {
+            m_fps += (inputs.fps - m_fps) * m_config.smoothing;
+            m_load += (inputs.cpuLoad - m_load) * m_config.smoothing;
+        }
+
+        bool pressure = m_fps < m_targetFps * m_config.fpsPressureRatio ||
+                        m_load > m_config.loadPressure;
+        bool headroom = !pressure && m_fps >= m_targetFps * m_config.fpsHeadroomRatio &&
+                        m_load < m_config.loadHeadroom;
+
+        // Between the two bands nothing accumulates
+        m_pressureCount = pressure ? m_pressureCount + 1 : 0;
+        m_headroomCount = headroom ? m_headroomCount + 1 : 0;
+
+        if (m_pressureCount >= m_config.upHold) {
+            if (!stepUp()) {
+                // Already at the top; stay saturated rather than wrap
+                m_pressureCount = m_config.upHold;
+            }
+        } else if (m_headroomCount >= m_config.downHold) {
+            stepDown();
+            m_headroomCount = 0;
+        }
+    }
+
+    rebuildSettings(inputs.freeMemoryPercent);
+    if (m_settings == previous) {
+        return false;
+    }
+
+    m_changes++;
+    m_pressureCount = 0;
+    m_headroomCount = 0;
+    m_settleCount = m_config.settleHold;
+    m_fps = -1.0f;
+    m_load = -1.0f;
+    return true;
+}
+
+void AutoTuner::applyBatteryLimits(const TuningInputs& inputs) {
+    if (inputs.charging || inputs.batteryPercent > m_config.batteryLow) {
+        m_maxFrequencyStep = FREQUENCY_STEPS - 1;
+        m_minDegradeLevel = 0;
+    } else if (inputs.batteryPercent > m_config.batteryCritical) {
+        m_maxFrequencyStep = FREQUENCY_STEPS - 2;
+        m_minDegradeLevel = 2;
+    } else {
+        m_maxFrequencyStep = 1;
+        m_minDegradeLevel = 3;
+    }
+
+    if (m_frequencyStep > m_maxFrequencyStep) {
+        m_frequencyStep = m_maxFrequencyStep;
+    }
+    if (m_degradeLevel < m_minDegradeLevel) {
+        m_degradeLevel = m_minDegradeLevel;
+    }
+}
+
+bool AutoTuner::stepUp() {
+    if (m_frequencyStep < m_maxFrequencyStep) {
+        m_frequencyStep++;
+        return true;
+    }
+    if (m_degradeLevel < DEGRADE_LEVELS - 1) {
+        m_degradeLevel++;
+        return true;
+    }
+    return false;
+}
+
+bool AutoTuner::stepDown() {
+    // Only step down if the predicted load stays clear of the pressure band,
+    // otherwise the next evaluations would step straight back up
+    float limit = (m_config.loadPressure + m_config.loadHeadroom) / 2.0f;
+
+    if (m_degradeLevel > m_minDegradeLevel) {
+        if (predictedLoad(m_frequencyStep, m_degradeLevel - 1) < limit) {
+            m_degradeLevel--;
+            return true;
+        }
+        return false;
+    }
+    if (m_frequencyStep > 0 && predictedLoad(m_frequencyStep - 1, m_degradeLevel) < limit) {
+        m_frequencyStep--;
+        return true;
+    }
+    return false;
+}
+
+float AutoTuner::predictedLoad(uint8_t frequencyStep, uint8_t degradeLevel) const {
+    // Load scales inversely with clock and, for rendering, with the frame rate;
+    // undoing throttling is treated as free, the buffer change as neutral
+    float load = m_load;
+    load *= static_cast<float>(m_config.frequencySteps[m_frequencyStep]) /
+            m_config.frequencySteps[frequencyStep];
+    load *= static_cast<float>(DEGRADE_STEPS[degradeLevel].refreshHz) /
+            DEGRADE_STEPS[m_degradeLevel].refreshHz;
+    return load;
+}
+
+void AutoTuner::rebuildSettings(uint8_t freeMemoryPercent) {
+    const DegradeStep& step = DEGRADE_STEPS[m_degradeLevel];
+
+    m_settings.cpuFreqMhz = m_config.frequencySteps[m_frequencyStep];
+    m_settings.refreshPeriodMs = 1000 / step.refreshHz;
+    m_settings.backgroundThrottle = step.backgroundThrottle;
+    m_targetFps = static_cast<float>(step.refreshHz);
+
+    // Keep a large buffer until memory drops well below the threshold that allowed it
+    bool large = m_settings.drawBufferLines > OS_DRAW_BUFFER_LINES;
+    uint8_t threshold = m_config.largeBufferMinFreeMemory;
+    uint8_t required = large && threshold > 10 ? threshold - 10 : threshold;
+    bool useLarge = step.largeBuffer && freeMemoryPercent >= required;
+    m_settings.drawBufferLines = useLarge ? OS_DRAW_BUFFER_LINES * 2 : OS_DRAW_BUFFER_LINES;
+}
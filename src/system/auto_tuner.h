@@ -0,0 +1,147 @@
+#ifndef AUTO_TUNER_H
+#define AUTO_TUNER_H
+
+#include "os_config.h"
+
+/**
+ * @file auto_tuner.h
+ * @brief Closed-loop performance controller for M5Stack Tab5
+ *
+ * Drives the AUTO performance mode. Every OS_AUTO_TUNE_INTERVAL_MS the
+ * owner feeds in measured FPS, CPU load, battery and free memory; the
+ * tuner smooths them and moves along two ladders:
+ *
+ * - CPU frequency steps, raised first under pressure and lowered last
+ *   when there is headroom.
+ * - Degradation levels (larger draw buffer, background task throttling,
+ *   lower LVGL refresh rate), used only once the frequency is at its cap.
+ *
+ * Hysteresis comes from three places: separate pressure and headroom
+ * thresholds with a dead band between them, consecutive-evaluation hold
+ * counts (short to react, long to relax), and a step-down guard that
+ * predicts the load after the step and refuses it if that would land
+ * back in the pressure band. A low battery caps the frequency and forces
+ * a minimum degradation level unless charging.
+ *
+ * The tuner only computes settings; the owner applies them. It has no
+ * hardware dependencies, so AutoTuneSimulator can replay load traces
+ * through it on the host.
+ */
+
+struct TuningInputs {
+    float fps = 0.0f;                   // Measured display frame rate
+    float cpuLoad = 0.0f;               // Percent
+    uint8_t batteryPercent = 100;
+    bool charging = false;
+    uint8_t freeMemoryPercent = 100;    // Free PSRAM
+};
+
+struct TuningSettings {
+    uint32_t cpuFreqMhz = 240;
+    uint32_t refreshPeriodMs = 1000 / OS_UI_REFRESH_RATE;
+    uint32_t drawBufferLines = OS_DRAW_BUFFER_LINES;
+    draw_buffer_mode_t drawBufferMode = OS_DRAW_BUFFER_MODE;
+    uint8_t backgroundThrottle = 0;     // Percent of low-priority task rate withheld
+
+    bool operator==(const TuningSettings& other) const {
+        return cpuFreqMhz == other.cpuFreqMhz && refreshPeriodMs == other.refreshPeriodMs &&
+               drawBufferLines == other.drawBufferLines && drawBufferMode == other.drawBufferMode &&
+               backgroundThrottle == other.backgroundThrottle;
+    }
+    bool operator!=(const TuningSettings& other) const { return !(*this == other); }
+};
+
+struct AutoTuneConfig {
+    uint32_t frequencySteps[5] = {80, 160, 240, 320, 360};   // MHz, ascending
+    float fpsPressureRatio = 0.92f;     // Below target * ratio is pressure
+    float fpsHeadroomRatio = 0.98f;     // At or above target * ratio may relax
+    float loadPressure = 85.0f;         // CPU % treated as saturated
+    float loadHeadroom = 50.0f;         // CPU % with room to slow down
+    uint8_t upHold = 2;                 // Evaluations of pressure before stepping up
+    uint8_t downHold = 12;              // Evaluations of headroom before stepping down
+    uint8_t settleHold = 4;             // Evaluations skipped after a change while measurements catch up
+    float smoothing = 0.3f;             // Weight of the newest sample
+    uint8_t batteryLow = 20;
+    uint8_t batteryCritical = 10;
+    uint8_t largeBufferMinFreeMemory = 30;   // Free memory % needed for the large draw buffer
+};
+
+class AutoTuner {
+public:
+    static constexpr uint8_t FREQUENCY_STEPS = 5;
+    static constexpr uint8_t DEGRADE_LEVELS = 5;
+
+    explicit AutoTuner(const AutoTuneConfig& config = AutoTuneConfig());
+
+    /**
+     * @brief Restart from the default settings and forget history
+     */
+    void reset();
+
+    /**
+     * @brief Run one controller evaluation
+     * @param inputs Latest measurements
+     * @return true if the settings changed and should be applied
+     */
+    bool update(const TuningInputs& inputs);
+
+    /**
+     * @brief Get the settings to apply
+     * @return Current settings
+     */
+    const TuningSettings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Get the frequency ladder position
+     * @return Index into AutoTuneConfig::frequencySteps
+     */
+    uint8_t getFrequencyStep() const { return m_frequencyStep; }
+
+    /**
+     * @brief Get the degradation ladder position
+     * @return 0 for full quality, DEGRADE_LEVELS - 1 for the most degraded
+     */
+    uint8_t getDegradeLevel() const { return m_degradeLevel; }
+
+    /**
+     * @brief Get the refresh rate the current settings aim for
+     * @return Target FPS
+     */
+    float getTargetFps() const { return m_targetFps; }
+
+    float getSmoothedFps() const { return m_fps; }
+    float getSmoothedLoad() const { return m_load; }
+
+    /**
+     * @brief Get the number of setting changes since reset()
+     * @return Change count
+     */
+    uint32_t getChangeCount() const { return m_changes; }
+
+private:
+    void applyBatteryLimits(const TuningInputs& inputs);
+    bool stepUp();
+    bool stepDown();
+    float predictedLoad(uint8_t frequencyStep, uint8_t degradeLevel) const;
+    void rebuildSettings(uint8_t freeMemoryPercent);
+
+    AutoTuneConfig m_config;
+    TuningSettings m_settings;
+
+    uint8_t m_frequencyStep = 2;
+    uint8_t m_degradeLevel = 0;
+    uint8_t m_maxFrequencyStep = FREQUENCY_STEPS - 1;
+    uint8_t m_minDegradeLevel = 0;
+    float m_targetFps = OS_UI_REFRESH_RATE;
+
+    // Smoothed measurements; negative until the first sample
+    float m_fps = -1.0f;
+    float m_load = -1.0f;
+
+    uint8_t m_pressureCount = 0;
+    uint8_t m_headroomCount = 0;
+    uint8_t m_settleCount = 0;
+    uint32_t m_changes = 0;
+};
+
+#endif // AUTO_TUNER_H
@@ -0,0 +1,290 @@
+#include "boot_sequencer.h"
+#include "job_executor.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "BootSequencer";
+
+os_error_t BootSequencer::addStage(const std::string& name, BootStageFunction function,
+                                   std::vector<std::string> dependencies,
+                                   BootThread thread, bool required) {
+    if (name.empty() || !function) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    if (findIndex(name) >= 0) {
+        ESP_LOGE(TAG, "Boot stage '%s' already exists", name.c_str());
+        return OS_ERROR_ALREADY_EXISTS;
+    }
+
+    BootStageRecord record;
+    record.name = name;
+    record.dependencies = std::move(dependencies);
+    record.thread = thread;
+    record.required = required;
+
+    m_stages.push_back(std::move(record));
+    m_functions.push_back(std::move(function));
+    return OS_OK;
+}
+
+os_error_t BootSequencer::run(JobExecutor* executor) {
+    if (!validate()) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    bool parallel = executor && executor->isRunning();
+    std::vector<size_t> mainQueue;
+    size_t settled = 0;
+
+    for (BootStageRecord& stage : m_stages) {
+        stage.state = BootStageState::PENDING;
+        stage.result = OS_OK;
+        stage.worker = -1;
+    }
+
+    m_startUs = esp_timer_get_time();
+    ESP_LOGI(TAG, "Starting %d boot stages (%s)", m_stages.size(),
+             parallel ? "parallel" : "sequential");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_running = 0;
+
+    while (true) {
+        // Start or skip everything whose dependencies have settled; a skip can
+        // unblock further skips, so repeat until nothing changes
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            settled = 0;
+
+            for (size_t i = 0; i < m_stages.size(); i++) {
+                BootStageRecord& stage = m_stages[i];
+                if (stage.state != BootStageState::PENDING) {
+                    if (stage.state != BootStageState::RUNNING) {
+                        settled++;
+                    }
+                    continue;
+                }
+
+                bool waiting = false;
+                bool blocked = false;
+                for (const std::string& dependency : stage.dependencies) {
+                    const BootStageRecord& other = m_stages[findIndex(dependency)];
+                    if (other.state == BootStageState::SKIPPED ||
+                        (other.state == BootStageState::FAILED && other.required)) {
+                        blocked = true;
+                    } else if (other.state != BootStageState::DONE &&
+                               other.state != BootStageState::FAILED) {
+                        waiting = true;
+                    }
+                }
+
+                if (blocked) {
+                    stage.state = BootStageState::SKIPPED;
+                    stage.result = OS_ERROR_NOT_INITIALIZED;
+                    ESP_LOGW(TAG, "Boot stage '%s' skipped: a dependency failed", stage.name.c_str());
+                    settled++;
+                    changed = true;
+                    continue;
+                }
+                if (waiting) {
+                    continue;
+                }
+
+                stage.readyUs = esp_timer_get_time();
+                stage.state = BootStageState::RUNNING;
+
+                bool submitted = false;
+                if (parallel && stage.thread == BootThread::WORKER) {
+                    m_running++;
+                    submitted = executor->submit([this, i]() {
+                        runStage(i);
+
+                        // Notify under the lock: run() may return as soon as it sees the result
+                        std::lock_guard<std::mutex> guard(m_mutex);
+                        BootStageRecord& done = m_stages[i];
+                        done.state = done.result == OS_OK ? BootStageState::DONE : BootStageState::FAILED;
+                        m_running--;
+                        m_finished.notify_all();
+                    });
+                    if (!submitted) {
+                        m_running--;
+                    }
+                }
+                if (!submitted) {
+                    mainQueue.push_back(i);
+                }
+            }
+        }
+
+        if (settled == m_stages.size()) {
+            break;
+        }
+
+        if (!mainQueue.empty()) {
+            size_t index = mainQueue.front();
+            mainQueue.erase(mainQueue.begin());
+
+            lock.unlock();
+            runStage(index);
+            lock.lock();
+
+            BootStageRecord& done = m_stages[index];
+            done.state = done.result == OS_OK ? BootStageState::DONE : BootStageState::FAILED;
+            continue;
+        }
+
+        // Only worker stages are left in flight
+        m_finished.wait(lock);
+    }
+
+    lock.unlock();
+    m_endUs = esp_timer_get_time();
+
+    os_error_t result = OS_OK;
+    for (const BootStageRecord& stage : m_stages) {
+        if (stage.state == BootStageState::FAILED) {
+            if (stage.required) {
+                ESP_LOGE(TAG, "Boot stage '%s' failed: %d", stage.name.c_str(), stage.result);
+            } else {
+                ESP_LOGW(TAG, "Optional boot stage '%s' failed: %d", stage.name.c_str(), stage.result);
+            }
+        }
+        if (stage.required && stage.result != OS_OK && result == OS_OK) {
+            result = stage.result;
+        }
+    }
+
+    ESP_LOGI(TAG, "Boot stages finished in %lld ms (%lld ms of stage time)",
+             (long long)(getElapsedUs() / 1000), (long long)(getStageTimeUs() / 1000));
+    return result;
+}
+
+const BootStageRecord* BootSequencer::findStage(const std::string& name) const {
+    int index = findIndex(name);
+    return index >= 0 ? &m_stages[index] : nullptr;
+}
+
+int64_t BootSequencer::getStageTimeUs() const {
+    int64_t total = 0;
+    for (const BootStageRecord& stage : m_stages) {
+        if (stage.state == BootStageState::DONE || stage.state == BootStageState::FAILED) {
+            total += stage.durationUs();
+        }
+    }
+    return total;
+}
+
+void BootSequencer::printTimeline() const {
+    int64_t span = std::max<int64_t>(getElapsedUs(), 1);
+
+    ESP_LOGI(TAG, "=== Boot Timeline ===");
+    ESP_LOGI(TAG, "%-12s %-8s %9s %9s %8s  %s",
+             "STAGE", "THREAD", "START ms", "END ms", "DUR ms", "TIMELINE");
+
+    for (const BootStageRecord& stage : m_stages) {
+        char thread[sizeof("worker") + 11];     // Room for any int
+        if (stage.state == BootStageState::SKIPPED) {
+            snprintf(thread, sizeof(thread), "skipped");
+        } else if (stage.worker >= 0) {
+            snprintf(thread, sizeof(thread), "worker%d", stage.worker);
+        } else {
+            snprintf(thread, sizeof(thread), "main");
+        }
+
+        // Waiting for a free thread shows as '.', running as '#'
+        char bar[TIMELINE_WIDTH + 1];
+        std::fill(bar, bar + TIMELINE_WIDTH, ' ');
+        bar[TIMELINE_WIDTH] = '\0';
+        if (stage.state != BootStageState::SKIPPED) {
+            size_t ready = (stage.readyUs - m_startUs) * TIMELINE_WIDTH / span;
+            size_t start = (stage.startUs - m_startUs) * TIMELINE_WIDTH / span;
+            size_t end = (stage.endUs - m_startUs) * TIMELINE_WIDTH / span;
+            end = std::min(std::max(end, start + 1), TIMELINE_WIDTH);
+            for (size_t i = ready; i < start && i < TIMELINE_WIDTH; i++) {
+                bar[i] = '.';
+            }
+            for (size_t i = start; i < end; i++) {
+                bar[i] = '#';
+            }
+        }
+
+        ESP_LOGI(TAG, "%-12s %-8s %9.1f %9.1f %8.1f |%s|%s",
+                 stage.name.c_str(), thread,
+                 stage.startUs / 1000.0f, stage.endUs / 1000.0f, stage.durationUs() / 1000.0f,
+                 bar, stage.state == BootStageState::FAILED ? " FAILED" : "");
+    }
+
+    int64_t elapsed = getElapsedUs();
+    ESP_LOGI(TAG, "Wall %.1f ms, stage time %.1f ms (%.2fx overlap)",
+             elapsed / 1000.0f, getStageTimeUs() / 1000.0f,
+             elapsed > 0 ? (float)getStageTimeUs() / elapsed : 0.0f);
+}
+
+int BootSequencer::findIndex(const std::string& name) const {
+    for (size_t i = 0; i < m_stages.size(); i++) {
+        if (m_stages[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool BootSequencer::validate() const {
+    std::vector<size_t> unresolved(m_stages.size());
+
+    for (size_t i = 0; i < m_stages.size(); i++) {
+        for (const std::string& dependency : m_stages[i].dependencies) {
+            if (findIndex(dependency) < 0) {
+                ESP_LOGE(TAG, "Boot stage '%s' depends on unknown stage '%s'",
+                         m_stages[i].name.c_str(), dependency.c_str());
+                return false;
+            }
+        }
+        unresolved[i] = m_stages[i].dependencies.size();
+    }
+
+    // Peel off stages with no unresolved dependencies; anything left is in a cycle
+    std::vector<bool> resolved(m_stages.size(), false);
+    size_t remaining = m_stages.size();
+    bool progressed = true;
+    while (remaining > 0 && progressed) {
+        progressed = false;
+        for (size_t i = 0; i < m_stages.size(); i++) {
+            if (resolved[i] || unresolved[i] > 0) {
+                continue;
+            }
+            resolved[i] = true;
+            remaining--;
+            progressed = true;
+
+            for (size_t j = 0; j < m_stages.size(); j++) {
+                for (const std::string& dependency : m_stages[j].dependencies) {
+                    if (dependency == m_stages[i].name) {
+                        unresolved[j]--;
+                    }
+                }
+            }
+        }
+    }
+
+    if (remaining > 0) {
+        for (size_t i = 0; i < m_stages.size(); i++) {
+            if (!resolved[i]) {
+                ESP_LOGE(TAG, "Boot stage '%s' is part of a dependency cycle", m_stages[i].name.c_str());
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+void BootSequencer::runStage(size_t index) {
+    BootStageRecord& stage = m_stages[index];
+
+    stage.worker = JobExecutor::currentWorker();
+    stage.startUs = esp_timer_get_time();
+    stage.result = m_functions[index]();
+    stage.endUs = esp_timer_get_time();
+}
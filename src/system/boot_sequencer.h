@@ -0,0 +1,149 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include "os_config.h"
+#include <esp_timer.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+class JobExecutor;
+
+/**
+ * @file boot_sequencer.h
+ * @brief Dependency-graph subsystem bring-up for M5Stack Tab5
+ *
+ * Boot stages name the stages they depend on. run() starts every stage
+ * whose dependencies have finished: WORKER stages go to the JobExecutor,
+ * so independent I2C/SPI probes and mounts overlap on both cores, while
+ * MAIN stages (anything touching LVGL or subscribing to events) run on
+ * the calling thread in the order they were added. Without an executor
+ * every stage runs on the calling thread in a valid dependency order.
+ *
+ * A required stage that fails skips everything that depends on it, and
+ * run() then fails. An optional stage's failure is only logged; stages
+ * depending on it still run and must cope without it.
+ *
+ * Each stage's ready, start and end times are recorded against
+ * esp_timer_get_time() (time since reset), so the timeline shows true
+ * time-to-first-frame and which stages are on the critical path.
+ *
+ * @code
+ * BootSequencer boot;
+ * boot.addStage("display", initDisplay, {}, BootThread::MAIN);
+ * boot.addStage("touch", initTouch);
+ * boot.addStage("ui", initUI, {"display", "touch"}, BootThread::MAIN);
+ * boot.run(&executor);
+ * boot.printTimeline();
+ * @endcode
+ */
+
+enum class BootThread : uint8_t {
+    MAIN,       // Calling thread; required for LVGL
+    WORKER      // Any JobExecutor worker
+};
+
+enum class BootStageState : uint8_t {
+    PENDING,
+    RUNNING,
+    DONE,
+    FAILED,
+    SKIPPED     // A required dependency failed or was skipped
+};
+
+typedef std::function<os_error_t()> BootStageFunction;
+
+struct BootStageRecord {
+    std::string name;
+    std::vector<std::string> dependencies;
+    BootThread thread = BootThread::WORKER;
+    bool required = true;
+
+    BootStageState state = BootStageState::PENDING;
+    os_error_t result = OS_OK;
+    int worker = -1;            // JobExecutor worker that ran it, -1 for the calling thread
+    int64_t readyUs = 0;        // Dependencies finished
+    int64_t startUs = 0;
+    int64_t endUs = 0;
+
+    int64_t durationUs() const { return endUs - startUs; }
+};
+
+class BootSequencer {
+public:
+    static constexpr size_t TIMELINE_WIDTH = 40;   // Characters in the printed bar chart
+
+    BootSequencer() = default;
+    BootSequencer(const BootSequencer&) = delete;
+    BootSequencer& operator=(const BootSequencer&) = delete;
+
+    /**
+     * @brief Add a boot stage
+     * @param name Unique stage name
+     * @param function Initialization to run
+     * @param dependencies Stages that must finish first; may be added later
+     * @param thread Where the stage may run
+     * @param required Whether boot fails, and dependents are skipped, if this stage fails
+     * @return OS_OK on success, OS_ERROR_ALREADY_EXISTS for a duplicate name
+     */
+    os_error_t addStage(const std::string& name, BootStageFunction function,
+                        std::vector<std::string> dependencies = {},
+                        BootThread thread = BootThread::WORKER, bool required = true);
+
+    /**
+     * @brief Run all stages, returning once every stage has finished or been skipped
+     * @param executor Workers for WORKER stages, or nullptr to run everything here
+     * @return OS_OK, the first required stage's error, or OS_ERROR_INVALID_PARAM
+     *         for an unknown dependency or a cycle (nothing is run)
+     */
+    os_error_t run(JobExecutor* executor = nullptr);
+
+    /**
+     * @brief Get the recorded stages, in the order they were added
+     * @return Stage records
+     */
+    const std::vector<BootStageRecord>& getTimeline() const { return m_stages; }
+
+    /**
+     * @brief Find a stage's record
+     * @param name Stage name
+     * @return Record or nullptr if not found
+     */
+    const BootStageRecord* findStage(const std::string& name) const;
+
+    /**
+     * @brief Get the wall time of the last run()
+     * @return Microseconds from run() to the last stage finishing
+     */
+    int64_t getElapsedUs() const { return m_endUs - m_startUs; }
+
+    /**
+     * @brief Get the summed duration of all stages that ran
+     * @return Microseconds; above getElapsedUs() when stages overlapped
+     */
+    int64_t getStageTimeUs() const;
+
+    /**
+     * @brief Log the timeline as a table with a bar per stage
+     */
+    void printTimeline() const;
+
+private:
+    int findIndex(const std::string& name) const;
+    bool validate() const;
+    void runStage(size_t index);
+
+    std::vector<BootStageRecord> m_stages;
+    std::vector<BootStageFunction> m_functions;
+
+    std::mutex m_mutex;
+    std::condition_variable m_finished;
+    size_t m_running = 0;
+
+    int64_t m_startUs = 0;
+    int64_t m_endUs = 0;
+};
+
+#endif // BOOT_SEQUENCER_H
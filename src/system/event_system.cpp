@@ -1,6 +1,8 @@
 #include "event_system.h"
+#include "resource_accountant.h"
 #include <esp_log.h>
 #include <algorithm>
+#include <string.h>
 
 static const char* TAG = "EventSystem";
 
@@ -16,9 +18,17 @@ os_error_t EventSystem::initialize() {
     ESP_LOGI(TAG, "Initializing Event System");
     
     // Clear any existing state
-    m_listeners.clear();
+    m_lists.clear();
+    memset(m_denseIndex, 0, sizeof(m_denseIndex));
+    m_sparseIndex.clear();
+    m_pendingListeners.clear();
     clearQueue();
     
+    // High-rate state updates: one dispatch per burst, carrying the newest value
+    setCoalescePolicy(EVENT_HAL_SENSOR_UPDATE, CoalescePolicy::LATEST_WINS);
+    setCoalescePolicy(EVENT_HAL_BATTERY_CHANGE, CoalescePolicy::LATEST_WINS);
+    setCoalescePolicy(EVENT_UI_TOUCH_MOVE, CoalescePolicy::LATEST_WINS);
+    
     m_initialized = true;
     ESP_LOGI(TAG, "Event System initialized");
     
@@ -33,7 +43,10 @@ os_error_t EventSystem::shutdown() {
     ESP_LOGI(TAG, "Shutting down Event System");
     
     // Clear all listeners and queued events
-    m_listeners.clear();
+    m_lists.clear();
+    memset(m_denseIndex, 0, sizeof(m_denseIndex));
+    m_sparseIndex.clear();
+    m_pendingListeners.clear();
     clearQueue();
     
     m_initialized = false;
@@ -52,9 +65,19 @@ size_t EventSystem::processEvents() {
     // Process events in batches to avoid blocking too long
     const size_t maxEventsPerFrame = 10;
     
-    while (!m_eventQueue.empty() && eventsProcessed < maxEventsPerFrame) {
-        EventData event = m_eventQueue.front();
-        m_eventQueue.pop();
+    EventData event;
+    while (eventsProcessed < maxEventsPerFrame && m_eventQueue.pop(event)) {
+        // Clear before dispatch so publishes from listeners queue a fresh event.
+        // Taking the latest value after clearing may deliver it twice, never lose it.
+        CoalesceSlot* slot = findCoalesceSlot(event.type);
+        if (slot) {
+            slot->pending.store(false, std::memory_order_release);
+            if (slot->policy.load(std::memory_order_acquire) == CoalescePolicy::LATEST_WINS) {
+                portENTER_CRITICAL_SAFE(&slot->lock);
+                event = slot->latest;
+                portEXIT_CRITICAL_SAFE(&slot->lock);
+            }
+        }
         
         size_t listenersNotified = publishSync(event);
         
@@ -67,11 +90,6 @@ size_t EventSystem::processEvents() {
         m_eventsProcessed++;
     }
     
-    // Clean up one-shot listeners that have been called
-    if (eventsProcessed > 0) {
-        cleanupListeners();
-    }
-    
     return eventsProcessed;
 }
 
@@ -88,14 +106,16 @@ ListenerId EventSystem::subscribe(EventType eventType, EventCallback callback,
     listener.priority = priority;
     listener.oneShot = oneShot;
     listener.callCount = 0;
+    listener.removed = false;
+    listener.owner = ResourceAccountant::current();
 
-    m_listeners[eventType].push_back(listener);
-    
-    // Sort listeners by priority (higher priority first)
-    std::sort(m_listeners[eventType].begin(), m_listeners[eventType].end(),
-              [](const EventListener& a, const EventListener& b) {
-                  return a.priority > b.priority;
-              });
+    // Lists must not change shape while a publish is walking them
+    if (m_dispatchDepth > 0) {
+        m_pendingListeners.push_back(listener);
+        m_cleanupNeeded = true;
+    } else {
+        insertListener(listener);
+    }
 
     if (m_loggingEnabled) {
         ESP_LOGD(TAG, "Subscribed listener %d to event %d (priority %d, one-shot: %s)", 
@@ -110,21 +130,34 @@ bool EventSystem::unsubscribe(ListenerId listenerId) {
         return false;
     }
 
-    for (auto& [eventType, listeners] : m_listeners) {
-        auto it = std::find_if(listeners.begin(), listeners.end(),
-                              [listenerId](const EventListener& listener) {
-                                  return listener.id == listenerId;
-                              });
+    auto matches = [listenerId](const EventListener& listener) {
+        return listener.id == listenerId && !listener.removed;
+    };
+
+    for (auto& list : m_lists) {
+        auto it = std::find_if(list.listeners.begin(), list.listeners.end(), matches);
         
-        if (it != listeners.end()) {
+        if (it != list.listeners.end()) {
             if (m_loggingEnabled) {
                 ESP_LOGD(TAG, "Unsubscribed listener %d from event %d", 
-                        listenerId, eventType);
+                        listenerId, list.eventType);
             }
-            listeners.erase(it);
+            if (m_dispatchDepth > 0) {
+                it->removed = true;
+                m_cleanupNeeded = true;
+            } else {
+                list.listeners.erase(it);
+            }
+            list.activeCount--;
             return true;
         }
     }
+
+    auto pending = std::find_if(m_pendingListeners.begin(), m_pendingListeners.end(), matches);
+    if (pending != m_pendingListeners.end()) {
+        m_pendingListeners.erase(pending);
+        return true;
+    }
     
     return false;
 }
@@ -134,19 +167,33 @@ size_t EventSystem::unsubscribeAll(EventType eventType) {
         return 0;
     }
 
-    auto it = m_listeners.find(eventType);
-    if (it != m_listeners.end()) {
-        size_t count = it->second.size();
-        m_listeners.erase(it);
-        
-        if (m_loggingEnabled) {
-            ESP_LOGD(TAG, "Unsubscribed all %d listeners from event %d", count, eventType);
+    size_t count = 0;
+    ListenerList* list = findList(eventType);
+    if (list) {
+        count = list->activeCount;
+        if (m_dispatchDepth > 0) {
+            for (auto& listener : list->listeners) {
+                listener.removed = true;
+            }
+            m_cleanupNeeded = true;
+        } else {
+            list->listeners.clear();
         }
-        
-        return count;
+        list->activeCount = 0;
+    }
+
+    auto pendingEnd = std::remove_if(m_pendingListeners.begin(), m_pendingListeners.end(),
+                                     [eventType](const EventListener& listener) {
+                                         return listener.eventType == eventType;
+                                     });
+    count += m_pendingListeners.end() - pendingEnd;
+    m_pendingListeners.erase(pendingEnd, m_pendingListeners.end());
+
+    if (m_loggingEnabled && count > 0) {
+        ESP_LOGD(TAG, "Unsubscribed all %d listeners from event %d", count, eventType);
     }
     
-    return 0;
+    return count;
 }
 
 size_t EventSystem::publishSync(const EventData& event) {
@@ -154,21 +201,46 @@ size_t EventSystem::publishSync(const EventData& event) {
         return 0;
     }
 
-    auto listeners = findListeners(event.type);
+    ListenerList* list = findList(event.type);
+    if (!list || list->activeCount == 0) {
+        return 0;
+    }
+
     size_t notified = 0;
+    m_dispatchDepth++;
+
+    // Walk the list in place; callbacks that (un)subscribe only mark entries,
+    // so indices stay valid until the outermost dispatch returns
+    for (size_t i = 0; i < list->listeners.size(); i++) {
+        EventListener& listener = list->listeners[i];
+        if (listener.removed) {
+            continue;
+        }
+        if (listener.oneShot) {
+            listener.removed = true;
+            list->activeCount--;
+            m_cleanupNeeded = true;
+        }
 
-    for (auto* listener : listeners) {
         try {
-            listener->callback(event);
-            listener->callCount++;
+            AccountScope account(listener.owner);
+            if (listener.owner) {
+                listener.owner->eventCallbacks++;
+            }
+            listener.callback(event);
+            listener.callCount++;
             notified++;
             m_listenersNotified++;
         } catch (...) {
             ESP_LOGE(TAG, "Exception in event listener %d for event %d", 
-                    listener->id, event.type);
+                    listener.id, event.type);
         }
     }
 
+    if (--m_dispatchDepth == 0 && m_cleanupNeeded) {
+        cleanupListeners();
+    }
+
     if (m_loggingEnabled && notified > 0) {
         ESP_LOGD(TAG, "Published event %d synchronously, notified %d listeners", 
                 event.type, notified);
@@ -182,14 +254,15 @@ bool EventSystem::publishAsync(const EventData& event) {
         return false;
     }
 
-    if (m_eventQueue.size() >= OS_EVENT_QUEUE_SIZE) {
-        ESP_LOGW(TAG, "Event queue full, dropping event %d", event.type);
+    if (!enqueue(event)) {
+        // Back off logging under sustained overflow (1st, 2nd, 4th, 8th... drop)
+        uint32_t dropped = getDroppedEventCount();
+        if ((dropped & (dropped - 1)) == 0) {
+            ESP_LOGW(TAG, "Event queue full, dropping event %d (%d dropped)", event.type, dropped);
+        }
         return false;
     }
 
-    m_eventQueue.push(event);
-    m_eventsPublished++;
-
     if (m_loggingEnabled) {
         ESP_LOGD(TAG, "Queued async event %d", event.type);
     }
@@ -197,6 +270,107 @@ bool EventSystem::publishAsync(const EventData& event) {
     return true;
 }
 
+bool IRAM_ATTR EventSystem::publishFromISR(EventType eventType, void* data, size_t dataSize,
+                                           uint32_t senderId) {
+    if (!m_initialized) {
+        return false;
+    }
+    return enqueue(EventData(eventType, data, dataSize, senderId));
+}
+
+bool IRAM_ATTR EventSystem::publishFromISR(const EventData& event) {
+    if (!m_initialized) {
+        return false;
+    }
+    return enqueue(event);
+}
+
+bool IRAM_ATTR EventSystem::enqueue(const EventData& event) {
+    CoalesceSlot* slot = findCoalesceSlot(event.type);
+    if (slot) {
+        if (slot->policy.load(std::memory_order_acquire) == CoalescePolicy::LATEST_WINS) {
+            portENTER_CRITICAL_SAFE(&slot->lock);
+            slot->latest = event;
+            portEXIT_CRITICAL_SAFE(&slot->lock);
+        }
+        if (slot->pending.exchange(true, std::memory_order_acq_rel)) {
+            // An event of this type is still waiting; it will carry the update
+            m_eventsCoalesced.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    if (!m_eventQueue.push(event)) {
+        if (slot) {
+            slot->pending.store(false, std::memory_order_release);
+        }
+        m_eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_eventsPublished.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = m_eventQueue.size();
+    size_t highWater = m_queueHighWater.load(std::memory_order_relaxed);
+    while (depth > highWater &&
+           !m_queueHighWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+bool EventSystem::setCoalescePolicy(EventType eventType, CoalescePolicy policy) {
+    if (eventType == 0) {
+        return false;
+    }
+
+    CoalesceSlot* slot = findCoalesceSlot(eventType);
+    if (policy == CoalescePolicy::NONE) {
+        if (slot) {
+            slot->policy.store(CoalescePolicy::NONE, std::memory_order_release);
+            slot->eventType.store(0, std::memory_order_release);
+        }
+        return true;
+    }
+    if (slot) {
+        slot->policy.store(policy, std::memory_order_release);
+        return true;
+    }
+
+    for (auto& candidate : m_coalesce) {
+        EventType expected = 0;
+        if (candidate.eventType.compare_exchange_strong(expected, eventType,
+                                                        std::memory_order_acq_rel)) {
+            candidate.pending.store(false, std::memory_order_release);
+            candidate.policy.store(policy, std::memory_order_release);
+            return true;
+        }
+    }
+
+    ESP_LOGW(TAG, "No coalescing slot left for event %d", eventType);
+    return false;
+}
+
+CoalescePolicy EventSystem::getCoalescePolicy(EventType eventType) const {
+    const CoalesceSlot* slot = findCoalesceSlot(eventType);
+    return slot ? slot->policy.load(std::memory_order_acquire) : CoalescePolicy::NONE;
+}
+
+EventSystem::CoalesceSlot* IRAM_ATTR EventSystem::findCoalesceSlot(EventType eventType) {
+    return const_cast<CoalesceSlot*>(static_cast<const EventSystem*>(this)->findCoalesceSlot(eventType));
+}
+
+const EventSystem::CoalesceSlot* IRAM_ATTR EventSystem::findCoalesceSlot(EventType eventType) const {
+    if (eventType == 0) {
+        return nullptr;  // 0 marks a free slot
+    }
+    for (auto& slot : m_coalesce) {
+        if (slot.eventType.load(std::memory_order_acquire) == eventType) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
 size_t EventSystem::publish(EventType eventType, void* data, size_t dataSize,
                            uint32_t senderId, bool async) {
     EventData event(eventType, data, dataSize, senderId);
@@ -209,34 +383,51 @@ size_t EventSystem::publish(EventType eventType, void* data, size_t dataSize,
 }
 
 bool EventSystem::hasListeners(EventType eventType) const {
-    auto it = m_listeners.find(eventType);
-    return it != m_listeners.end() && !it->second.empty();
+    const ListenerList* list = findList(eventType);
+    return list && list->activeCount > 0;
 }
 
 size_t EventSystem::getListenerCount(EventType eventType) const {
-    auto it = m_listeners.find(eventType);
-    return (it != m_listeners.end()) ? it->second.size() : 0;
+    const ListenerList* list = findList(eventType);
+    return list ? list->activeCount : 0;
 }
 
 void EventSystem::clearQueue() {
-    while (!m_eventQueue.empty()) {
-        m_eventQueue.pop();
+    EventData event;
+    while (m_eventQueue.pop(event)) {
+    }
+    for (auto& slot : m_coalesce) {
+        slot.pending.store(false, std::memory_order_release);
     }
 }
 
 void EventSystem::printStats() const {
     ESP_LOGI(TAG, "=== Event System Statistics ===");
-    ESP_LOGI(TAG, "Events published: %d", m_eventsPublished);
+    ESP_LOGI(TAG, "Events published: %d", m_eventsPublished.load());
     ESP_LOGI(TAG, "Events processed: %d", m_eventsProcessed);
     ESP_LOGI(TAG, "Listeners notified: %d", m_listenersNotified);
-    ESP_LOGI(TAG, "Queued events: %d/%d", m_eventQueue.size(), OS_EVENT_QUEUE_SIZE);
-    ESP_LOGI(TAG, "Event types with listeners: %d", m_listeners.size());
+    ESP_LOGI(TAG, "Queued events: %d/%d (high water %d)", m_eventQueue.size(),
+             OS_EVENT_QUEUE_SIZE, m_queueHighWater.load());
+    ESP_LOGI(TAG, "Events dropped: %d, coalesced: %d", getDroppedEventCount(),
+             getCoalescedEventCount());
+    size_t typesWithListeners = std::count_if(m_lists.begin(), m_lists.end(),
+                                              [](const ListenerList& list) {
+                                                  return list.activeCount > 0;
+                                              });
+    ESP_LOGI(TAG, "Event types with listeners: %d (%d tables, %d hashed)",
+             typesWithListeners, m_lists.size(), m_sparseIndex.size());
 
     ESP_LOGI(TAG, "=== Event Type Statistics ===");
-    for (const auto& [eventType, listeners] : m_listeners) {
-        ESP_LOGI(TAG, "Event %d: %d listeners", eventType, listeners.size());
+    for (const auto& list : m_lists) {
+        if (list.activeCount == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "Event %d: %d listeners", list.eventType, list.activeCount);
         
-        for (const auto& listener : listeners) {
+        for (const auto& listener : list.listeners) {
+            if (listener.removed) {
+                continue;
+            }
             ESP_LOGI(TAG, "  Listener %d: priority %d, calls %d, one-shot: %s",
                     listener.id, listener.priority, listener.callCount,
                     listener.oneShot ? "yes" : "no");
@@ -244,26 +435,82 @@ void EventSystem::printStats() const {
     }
 }
 
-std::vector<EventListener*> EventSystem::findListeners(EventType eventType) {
-    std::vector<EventListener*> result;
-    
-    auto it = m_listeners.find(eventType);
-    if (it != m_listeners.end()) {
-        for (auto& listener : it->second) {
-            result.push_back(&listener);
+size_t EventSystem::denseSlot(EventType eventType) {
+    const size_t notDense = EVENT_DENSE_RANGES * EVENT_DENSE_RANGE_SLOTS;
+    if (eventType < EVENT_DENSE_RANGE_BASE) {
+        return notDense;
+    }
+
+    size_t range = eventType / EVENT_DENSE_RANGE_BASE - 1;
+    size_t offset = eventType % EVENT_DENSE_RANGE_BASE;
+    if (range >= EVENT_DENSE_RANGES || offset >= EVENT_DENSE_RANGE_SLOTS) {
+        return notDense;
+    }
+    return range * EVENT_DENSE_RANGE_SLOTS + offset;
+}
+
+EventSystem::ListenerList* EventSystem::findList(EventType eventType) {
+    return const_cast<ListenerList*>(static_cast<const EventSystem*>(this)->findList(eventType));
+}
+
+const EventSystem::ListenerList* EventSystem::findList(EventType eventType) const {
+    uint16_t index = 0;
+    size_t slot = denseSlot(eventType);
+    if (slot < EVENT_DENSE_RANGES * EVENT_DENSE_RANGE_SLOTS) {
+        index = m_denseIndex[slot];
+    } else {
+        auto it = m_sparseIndex.find(eventType);
+        if (it != m_sparseIndex.end()) {
+            index = it->second;
         }
     }
-    
-    return result;
+    return index ? &m_lists[index - 1] : nullptr;
+}
+
+EventSystem::ListenerList& EventSystem::getOrCreateList(EventType eventType) {
+    ListenerList* existing = findList(eventType);
+    if (existing) {
+        return *existing;
+    }
+
+    // Lists are kept once created, so indices never need remapping
+    m_lists.push_back({eventType, {}, 0});
+    uint16_t index = static_cast<uint16_t>(m_lists.size());
+
+    size_t slot = denseSlot(eventType);
+    if (slot < EVENT_DENSE_RANGES * EVENT_DENSE_RANGE_SLOTS) {
+        m_denseIndex[slot] = index;
+    } else {
+        m_sparseIndex[eventType] = index;
+    }
+    return m_lists.back();
+}
+
+void EventSystem::insertListener(const EventListener& listener) {
+    ListenerList& list = getOrCreateList(listener.eventType);
+
+    // Higher priority first; equal priorities keep subscription order
+    auto position = std::upper_bound(list.listeners.begin(), list.listeners.end(), listener.priority,
+                                     [](uint8_t priority, const EventListener& other) {
+                                         return priority > other.priority;
+                                     });
+    list.listeners.insert(position, listener);
+    list.activeCount++;
 }
 
 void EventSystem::cleanupListeners() {
-    for (auto& [eventType, listeners] : m_listeners) {
-        listeners.erase(
-            std::remove_if(listeners.begin(), listeners.end(),
+    for (auto& list : m_lists) {
+        list.listeners.erase(
+            std::remove_if(list.listeners.begin(), list.listeners.end(),
                           [](const EventListener& listener) {
-                              return listener.oneShot && listener.callCount > 0;
+                              return listener.removed;
                           }),
-            listeners.end());
+            list.listeners.end());
     }
-}
\ No newline at end of file
+
+    for (const auto& listener : m_pendingListeners) {
+        insertListener(listener);
+    }
+    m_pendingListeners.clear();
+    m_cleanupNeeded = false;
+}
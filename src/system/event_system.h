@@ -2,10 +2,14 @@
 #define EVENT_SYSTEM_H
 
 #include "os_config.h"
+#include "mpsc_ring.h"
+#include <freertos/FreeRTOS.h>
 #include <functional>
 #include <vector>
-#include <queue>
-#include <map>
+#include <atomic>
+#include <unordered_map>
+#include <type_traits>
+#include <string.h>
 
 /**
  * @file event_system.h
@@ -13,6 +17,16 @@
  * 
  * Provides a publish-subscribe event system for loose coupling
  * between system components and applications.
+ *
+ * Listeners live in a flat table of per-type lists kept sorted by
+ * priority. The SystemEvents ranges map to a dense index; other types
+ * (user-defined and input events) go through a hash lookup. Publishing
+ * walks the list in place and does not allocate.
+ *
+ * Asynchronous events go through a preallocated lock-free ring, so
+ * publishAsync() and publishFromISR() may be called from any task or
+ * interrupt; processEvents() must only be called from one task (the OS
+ * main loop). Listener registration and publishSync() are main-loop only.
  */
 
 typedef uint32_t EventType;
@@ -48,21 +62,117 @@ enum SystemEvents : EventType {
     EVENT_USER_DEFINED = 10000
 };
 
+// Payloads up to this size are copied into the event itself
+static constexpr size_t EVENT_INLINE_PAYLOAD_SIZE = 32;
+
+/**
+ * Event record. A payload is either borrowed (data points at caller-owned
+ * memory, which must outlive async delivery) or inline (copied into
+ * payload by setPayload(); data then points at the event's own copy and is
+ * re-pointed whenever the event is copied).
+ */
 struct EventData {
     EventType type;
     void* data;
     size_t dataSize;
     uint32_t timestamp;
     uint32_t senderId;
+    bool inlinePayload;
+    alignas(8) uint8_t payload[EVENT_INLINE_PAYLOAD_SIZE];
     
-    EventData() : type(0), data(nullptr), dataSize(0), timestamp(0), senderId(0) {}
+    EventData() : type(0), data(nullptr), dataSize(0), timestamp(0), senderId(0),
+                  inlinePayload(false) {}
     
     EventData(EventType t, void* d = nullptr, size_t size = 0, uint32_t sender = 0)
-        : type(t), data(d), dataSize(size), timestamp(millis()), senderId(sender) {}
+        : type(t), data(d), dataSize(size), timestamp(millis()), senderId(sender),
+          inlinePayload(false) {}
+
+    EventData(const EventData& other) : inlinePayload(false) { *this = other; }
+
+    EventData& operator=(const EventData& other) {
+        type = other.type;
+        dataSize = other.dataSize;
+        timestamp = other.timestamp;
+        senderId = other.senderId;
+        inlinePayload = other.inlinePayload;
+        if (inlinePayload) {
+            if (this != &other) {
+                memcpy(payload, other.payload, dataSize);
+            }
+            data = payload;
+        } else {
+            data = other.data;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Copy a value into the inline payload
+     * @param value Trivially copyable value of at most EVENT_INLINE_PAYLOAD_SIZE bytes
+     */
+    template <typename T>
+    void setPayload(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Inline payloads are copied bytewise");
+        static_assert(sizeof(T) <= EVENT_INLINE_PAYLOAD_SIZE, "Payload too large to store inline");
+        static_assert(alignof(T) <= 8, "Inline payload is 8-byte aligned");
+        memcpy(payload, &value, sizeof(T));
+        data = payload;
+        dataSize = sizeof(T);
+        inlinePayload = true;
+    }
+
+    /**
+     * @brief Copy raw bytes into the inline payload
+     * @param bytes Source bytes
+     * @param size Byte count
+     * @return false if size exceeds EVENT_INLINE_PAYLOAD_SIZE (event unchanged)
+     */
+    bool setPayload(const void* bytes, size_t size) {
+        if (size > EVENT_INLINE_PAYLOAD_SIZE || (size > 0 && !bytes)) {
+            return false;
+        }
+        memcpy(payload, bytes, size);
+        data = payload;
+        dataSize = size;
+        inlinePayload = true;
+        return true;
+    }
+
+    /**
+     * @brief Typed view of the payload (inline or borrowed)
+     * @return Pointer to the payload, or nullptr if its size does not match T
+     */
+    template <typename T>
+    const T* payloadAs() const {
+        return (data && dataSize == sizeof(T)) ? static_cast<const T*>(data) : nullptr;
+    }
+
+    /**
+     * @brief Build an event carrying a value in the inline payload
+     * @param t Event type
+     * @param value Payload value
+     * @param sender Optional sender ID
+     * @return Event
+     */
+    template <typename T>
+    static EventData withPayload(EventType t, const T& value, uint32_t sender = 0) {
+        EventData event(t, nullptr, 0, sender);
+        event.setPayload(value);
+        return event;
+    }
+};
+
+// How async publishes of one type are merged while an event of that type is queued
+enum class CoalescePolicy : uint8_t {
+    NONE,          // Queue every event
+    FIRST_WINS,    // Keep the queued event, drop later ones
+    LATEST_WINS    // Deliver the most recently published event in the queued slot
 };
 
 typedef std::function<void(const EventData&)> EventCallback;
 
+struct AppAccount;
+
 struct EventListener {
     ListenerId id;
     EventType eventType;
@@ -70,8 +180,15 @@ struct EventListener {
     uint8_t priority;
     bool oneShot;
     uint32_t callCount;
+    bool removed;       // Unsubscribed or fired one-shot, erased after dispatch
+    AppAccount* owner;  // App charged for the callback, nullptr for system listeners
 };
 
+// Dense dispatch index covering the SystemEvents ranges 1000-5999
+static constexpr EventType EVENT_DENSE_RANGE_BASE = 1000;
+static constexpr size_t EVENT_DENSE_RANGES = 5;
+static constexpr size_t EVENT_DENSE_RANGE_SLOTS = 32;
+
 class EventSystem {
 public:
     EventSystem() = default;
@@ -97,6 +214,9 @@ public:
 
     /**
      * @brief Subscribe to an event type
+     *
+     * Not thread-safe: call from the main thread (boot stages that
+     * subscribe run as BootThread::MAIN).
      * @param eventType Event type to listen for
      * @param callback Callback function to invoke
      * @param priority Listener priority (higher = called first)
@@ -134,6 +254,44 @@ public:
      */
     bool publishAsync(const EventData& event);
 
+    /**
+     * @brief Queue an event from an interrupt handler
+     *
+     * Lock-free and non-blocking. The event is delivered by the next
+     * processEvents(); data must stay valid until then.
+     * @param eventType Event type
+     * @param data Optional data pointer
+     * @param dataSize Size of data in bytes
+     * @param senderId Optional sender ID
+     * @return true if event was queued or coalesced, false if queue is full
+     */
+    bool publishFromISR(EventType eventType, void* data = nullptr, size_t dataSize = 0,
+                        uint32_t senderId = 0);
+
+    /**
+     * @brief Queue a prepared event from an interrupt handler
+     * @param event Event data to queue (inline payloads are copied)
+     * @return true if event was queued or coalesced, false if queue is full
+     */
+    bool publishFromISR(const EventData& event);
+
+    /**
+     * @brief Publish an event carrying a copy of a small value
+     *
+     * The value is stored inline, so it need not outlive the call.
+     * @param eventType Event type
+     * @param value Trivially copyable value of at most EVENT_INLINE_PAYLOAD_SIZE bytes
+     * @param senderId Optional sender ID
+     * @param async True to queue async, false to publish immediately
+     * @return Number of listeners notified (sync) or true/false (async)
+     */
+    template <typename T>
+    size_t publishValue(EventType eventType, const T& value, uint32_t senderId = 0,
+                        bool async = true) {
+        EventData event = EventData::withPayload(eventType, value, senderId);
+        return async ? (publishAsync(event) ? 1 : 0) : publishSync(event);
+    }
+
     /**
      * @brief Publish an event with simple data
      * @param eventType Event type
@@ -160,12 +318,50 @@ public:
      */
     size_t getListenerCount(EventType eventType) const;
 
+    /**
+     * @brief Set how queued events of one type are coalesced
+     *
+     * While an event of a coalescing type is waiting in the queue, further
+     * async publishes of that type are folded into it instead of queued, so
+     * a burst is dispatched once. initialize() applies LATEST_WINS to
+     * EVENT_HAL_SENSOR_UPDATE, EVENT_HAL_BATTERY_CHANGE and EVENT_UI_TOUCH_MOVE.
+     * @param eventType Event type
+     * @param policy Coalescing policy (NONE to queue every event)
+     * @return false if all OS_EVENT_COALESCE_SLOTS are in use
+     */
+    bool setCoalescePolicy(EventType eventType, CoalescePolicy policy);
+
+    /**
+     * @brief Get the coalescing policy of an event type
+     * @param eventType Event type
+     * @return Policy (NONE if not coalesced)
+     */
+    CoalescePolicy getCoalescePolicy(EventType eventType) const;
+
     /**
      * @brief Get number of queued events
      * @return Number of events in queue
      */
     size_t getQueuedEventCount() const { return m_eventQueue.size(); }
 
+    /**
+     * @brief Get number of async events dropped because the queue was full
+     * @return Dropped event count
+     */
+    uint32_t getDroppedEventCount() const { return m_eventsDropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get number of async events folded into an already queued event
+     * @return Coalesced event count
+     */
+    uint32_t getCoalescedEventCount() const { return m_eventsCoalesced.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the highest queue depth seen
+     * @return Queue high-water mark
+     */
+    size_t getQueueHighWater() const { return m_queueHighWater.load(std::memory_order_relaxed); }
+
     /**
      * @brief Clear all queued events
      */
@@ -183,32 +379,93 @@ public:
     void setLoggingEnabled(bool enabled) { m_loggingEnabled = enabled; }
 
 private:
+    struct ListenerList {
+        EventType eventType;
+        std::vector<EventListener> listeners;  // Highest priority first
+        size_t activeCount;
+    };
+
     /**
      * @brief Generate unique listener ID
      * @return Unique listener ID
      */
     ListenerId generateListenerId() { return ++m_nextListenerId; }
 
+    struct CoalesceSlot {
+        std::atomic<EventType> eventType{0};
+        std::atomic<bool> pending{false};
+        std::atomic<CoalescePolicy> policy{CoalescePolicy::NONE};
+        EventData latest;                   // LATEST_WINS: newest publish, guarded by lock
+        portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    };
+
+    /**
+     * @brief Push an event into the async ring (any context)
+     * @param event Event data to queue
+     * @return true if queued or coalesced, false if the ring is full
+     */
+    bool enqueue(const EventData& event);
+
+    /**
+     * @brief Find the coalescing slot for an event type
+     * @param eventType Event type
+     * @return Slot or nullptr if the type is not coalesced
+     */
+    CoalesceSlot* findCoalesceSlot(EventType eventType);
+    const CoalesceSlot* findCoalesceSlot(EventType eventType) const;
+
     /**
-     * @brief Find listeners for an event type
+     * @brief Get dense index slot for an event type
+     * @param eventType Event type
+     * @return Slot index or EVENT_DENSE_RANGES * EVENT_DENSE_RANGE_SLOTS if not dense
+     */
+    static size_t denseSlot(EventType eventType);
+
+    /**
+     * @brief Find the listener list for an event type
      * @param eventType Event type to find
-     * @return Vector of listeners (sorted by priority)
+     * @return List or nullptr if the type never had listeners
+     */
+    ListenerList* findList(EventType eventType);
+    const ListenerList* findList(EventType eventType) const;
+
+    /**
+     * @brief Find or create the listener list for an event type
+     * @param eventType Event type
+     * @return List
      */
-    std::vector<EventListener*> findListeners(EventType eventType);
+    ListenerList& getOrCreateList(EventType eventType);
 
     /**
-     * @brief Remove one-shot listeners that have been called
+     * @brief Insert a listener after existing ones of equal or higher priority
+     * @param listener Listener to insert
+     */
+    void insertListener(const EventListener& listener);
+
+    /**
+     * @brief Erase removed and fired one-shot listeners, apply deferred subscriptions
      */
     void cleanupListeners();
 
-    // Event listeners organized by type
-    std::map<EventType, std::vector<EventListener>> m_listeners;
+    // Listener lists, indexed by m_denseIndex or m_sparseIndex (stored as index + 1)
+    std::vector<ListenerList> m_lists;
+    uint16_t m_denseIndex[EVENT_DENSE_RANGES * EVENT_DENSE_RANGE_SLOTS] = {};
+    std::unordered_map<EventType, uint16_t> m_sparseIndex;
+
+    // Subscriptions made from inside a callback, inserted once dispatch unwinds
+    std::vector<EventListener> m_pendingListeners;
+    uint32_t m_dispatchDepth = 0;
+    bool m_cleanupNeeded = false;
     
-    // Event queue for async processing
-    std::queue<EventData> m_eventQueue;
+    // Event queue for async processing (multi-producer, main loop consumer)
+    MpscRing<EventData, OS_EVENT_QUEUE_SIZE> m_eventQueue;
+    CoalesceSlot m_coalesce[OS_EVENT_COALESCE_SLOTS];
     
     // Statistics
-    uint32_t m_eventsPublished = 0;
+    std::atomic<uint32_t> m_eventsPublished{0};
+    std::atomic<uint32_t> m_eventsDropped{0};
+    std::atomic<uint32_t> m_eventsCoalesced{0};
+    std::atomic<size_t> m_queueHighWater{0};
     uint32_t m_eventsProcessed = 0;
     uint32_t m_listenersNotified = 0;
     
@@ -221,6 +478,7 @@ private:
 // Convenience macros for event publishing
 #define PUBLISH_EVENT(type, ...) OS().getEventSystem().publish(type, ##__VA_ARGS__)
 #define PUBLISH_EVENT_SYNC(event) OS().getEventSystem().publishSync(event)
+#define PUBLISH_EVENT_VALUE(type, value, ...) OS().getEventSystem().publishValue(type, value, ##__VA_ARGS__)
 #define SUBSCRIBE_EVENT(type, callback, ...) OS().getEventSystem().subscribe(type, callback, ##__VA_ARGS__)
 
 #endif // EVENT_SYSTEM_H
\ No newline at end of file
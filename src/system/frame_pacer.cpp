@@ -0,0 +1,200 @@
+#include "frame_pacer.h"
+#include <esp_log.h>
+
+static const char* TAG = "FramePacer";
+
+struct PhaseBudget {
+    const char* name;
+    uint32_t budgetUs;
+    bool deferrable;
+    uint8_t maxDeferFrames;
+};
+
+// Sums to just under one 60 Hz frame; HAL includes the LVGL timer handler
+static const PhaseBudget DEFAULT_BUDGETS[FramePacer::PHASE_COUNT] = {
+    {"scheduler", 2000, false, 0},
+    {"events",    1000, false, 0},
+    {"hal",       8000, false, 0},
+    {"ui",        2000, false, 0},
+    {"apps",      2500, true,  2},     // Foreground app input lags at most two frames
+    {"services",  1000, true,  OS_FRAME_MAX_DEFER},
+};
+
+FramePacer::FramePacer(uint32_t framePeriodUs) : m_framePeriodUs(framePeriodUs ? framePeriodUs : 1) {
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+        m_phases[i].name = DEFAULT_BUDGETS[i].name;
+        m_phases[i].budgetUs = DEFAULT_BUDGETS[i].budgetUs;
+        m_phases[i].deferrable = DEFAULT_BUDGETS[i].deferrable;
+        m_phases[i].maxDeferFrames = DEFAULT_BUDGETS[i].maxDeferFrames;
+    }
+}
+
+void FramePacer::setFramePeriod(uint32_t framePeriodUs) {
+    if (framePeriodUs == 0 || framePeriodUs == m_framePeriodUs) {
+        return;
+    }
+
+    // The frame in progress keeps its deadline; the new period starts from it
+    m_framePeriodUs = framePeriodUs;
+}
+
+void FramePacer::setPhaseBudget(FramePhase phase, uint32_t budgetUs, bool deferrable,
+                                uint8_t maxDeferFrames) {
+    if (phase >= FramePhase::COUNT) {
+        return;
+    }
+
+    Phase& p = m_phases[static_cast<size_t>(phase)];
+    p.budgetUs = budgetUs;
+    p.deferrable = deferrable;
+    p.maxDeferFrames = maxDeferFrames;
+}
+
+void FramePacer::beginFrame(uint32_t deltaTime) {
+    int64_t now = esp_timer_get_time();
+
+    if (m_nextDeadlineUs == 0) {
+        m_nextDeadlineUs = now;
+    } else {
+        m_frameInterval.push(static_cast<uint32_t>(now - m_frameStartUs));
+
+        // A full period or more behind: start a new schedule from now rather
+        // than running frames back to back to catch up
+        if (now - m_nextDeadlineUs >= m_framePeriodUs) {
+            m_missedDeadlines++;
+            m_nextDeadlineUs = now;
+        }
+    }
+
+    m_frameStartUs = now;
+    m_nextDeadlineUs += m_framePeriodUs;
+    m_frames++;
+
+    for (Phase& p : m_phases) {
+        p.pendingDelta += deltaTime;
+    }
+}
+
+bool FramePacer::beginPhase(FramePhase phase, uint32_t& deltaTime) {
+    if (phase >= FramePhase::COUNT) {
+        return false;
+    }
+
+    Phase& p = m_phases[static_cast<size_t>(phase)];
+
+    if (p.deferrable && !p.timing.empty() && p.timing.percentile(95) > getRemainingUs()) {
+        if (p.deferredFrames < p.maxDeferFrames) {
+            p.deferredFrames++;
+            p.deferrals++;
+            return false;
+        }
+        p.forcedRuns++;
+    }
+
+    deltaTime = p.pendingDelta;
+    p.pendingDelta = 0;
+    p.deferredFrames = 0;
+    p.startUs = esp_timer_get_time();
+    return true;
+}
+
+void FramePacer::endPhase(FramePhase phase) {
+    if (phase >= FramePhase::COUNT) {
+        return;
+    }
+
+    Phase& p = m_phases[static_cast<size_t>(phase)];
+    uint32_t elapsed = static_cast<uint32_t>(esp_timer_get_time() - p.startUs);
+
+    p.timing.push(elapsed);
+    p.runs++;
+    if (elapsed > p.budgetUs) {
+        p.overruns++;
+    }
+}
+
+uint32_t FramePacer::endFrame() {
+    int64_t now = esp_timer_get_time();
+    uint32_t work = static_cast<uint32_t>(now - m_frameStartUs);
+
+    m_workTime.push(work);
+    if (work > m_framePeriodUs) {
+        m_overBudgetFrames++;
+    }
+
+    return now < m_nextDeadlineUs ? static_cast<uint32_t>(m_nextDeadlineUs - now) : 0;
+}
+
+uint32_t FramePacer::getRemainingUs() const {
+    int64_t now = esp_timer_get_time();
+    return now < m_nextDeadlineUs ? static_cast<uint32_t>(m_nextDeadlineUs - now) : 0;
+}
+
+FramePhaseStats FramePacer::getPhaseStats(FramePhase phase) const {
+    FramePhaseStats stats;
+    if (phase >= FramePhase::COUNT) {
+        return stats;
+    }
+
+    const Phase& p = m_phases[static_cast<size_t>(phase)];
+    stats.name = p.name;
+    stats.budgetUs = p.budgetUs;
+    stats.deferrable = p.deferrable;
+    stats.maxDeferFrames = p.maxDeferFrames;
+    stats.runs = p.runs;
+    stats.deferrals = p.deferrals;
+    stats.forcedRuns = p.forcedRuns;
+    stats.overruns = p.overruns;
+    stats.timing = p.timing.stats();
+    return stats;
+}
+
+FramePacerStats FramePacer::getStats() const {
+    FramePacerStats stats;
+    stats.frames = m_frames;
+    stats.overBudgetFrames = m_overBudgetFrames;
+    stats.missedDeadlines = m_missedDeadlines;
+    stats.framePeriodUs = m_framePeriodUs;
+    stats.workTime = m_workTime.stats();
+    stats.frameInterval = m_frameInterval.stats();
+    return stats;
+}
+
+void FramePacer::resetStats() {
+    m_frames = 0;
+    m_overBudgetFrames = 0;
+    m_missedDeadlines = 0;
+    m_workTime.clear();
+    m_frameInterval.clear();
+
+    for (Phase& p : m_phases) {
+        p.runs = 0;
+        p.deferrals = 0;
+        p.forcedRuns = 0;
+        p.overruns = 0;
+        p.timing.clear();
+    }
+}
+
+void FramePacer::printStats() const {
+    FramePacerStats stats = getStats();
+
+    ESP_LOGI(TAG, "=== Frame Pacing ===");
+    ESP_LOGI(TAG, "Frames: %lu, period %lu us, over budget %lu, missed deadlines %lu",
+             (unsigned long)stats.frames, (unsigned long)stats.framePeriodUs,
+             (unsigned long)stats.overBudgetFrames, (unsigned long)stats.missedDeadlines);
+    ESP_LOGI(TAG, "Work: p50 %.0f us, p95 %.0f us, max %.0f us; interval p50 %.0f us, p95 %.0f us",
+             stats.workTime.p50, stats.workTime.p95, stats.workTime.max,
+             stats.frameInterval.p50, stats.frameInterval.p95);
+
+    ESP_LOGI(TAG, "%-10s %7s %7s %7s %7s %8s %6s %6s %6s",
+             "PHASE", "BUDGET", "P50", "P95", "MAX", "RUNS", "DEFER", "FORCED", "OVER");
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+        FramePhaseStats phase = getPhaseStats(static_cast<FramePhase>(i));
+        ESP_LOGI(TAG, "%-10s %7lu %7.0f %7.0f %7.0f %8lu %6lu %6lu %6lu",
+                 phase.name, (unsigned long)phase.budgetUs,
+                 phase.timing.p50, phase.timing.p95, phase.timing.max,
+                 (unsigned long)phase.runs, (unsigned long)phase.deferrals,
+                 (unsigned long)phase.forcedRuns, (unsigned long)phase.overruns);
+    }
+}
@@ -0,0 +1,183 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include "os_config.h"
+#include "stats_ring.h"
+#include <esp_timer.h>
+
+/**
+ * @file frame_pacer.h
+ * @brief Main-loop frame budget and pacing for M5Stack Tab5
+ *
+ * OSManager::update() runs its subsystems as a fixed sequence of phases
+ * inside one frame period (16.67 ms at 60 Hz). Each phase has a nominal
+ * budget, and each phase's duration is recorded every frame.
+ *
+ * Critical phases (scheduler, events, HAL/LVGL, UI) always run.
+ * Deferrable phases (apps, services) run only if their typical cost (p95
+ * of recent runs) still fits in what is left of the frame; otherwise they
+ * are skipped and their elapsed time carries over, so the next run sees
+ * the full delta. A deferrable phase is never skipped more than its
+ * maxDeferFrames in a row.
+ *
+ * Frames are aligned to absolute deadlines: endFrame() returns how long to
+ * sleep until the next frame boundary, so a short frame does not make the
+ * next one early and a late frame does not cause a burst of catch-up
+ * frames.
+ *
+ * @code
+ * uint32_t phaseDelta;
+ * if (pacer.beginPhase(FramePhase::SERVICES, phaseDelta)) {
+ *     m_serviceManager->update(phaseDelta);
+ *     pacer.endPhase(FramePhase::SERVICES);
+ * }
+ * @endcode
+ */
+
+enum class FramePhase : uint8_t {
+    SCHEDULER = 0,
+    EVENTS,
+    HAL,
+    UI,
+    APPS,
+    SERVICES,
+    COUNT
+};
+
+struct FramePhaseStats {
+    const char* name = nullptr;
+    uint32_t budgetUs = 0;
+    bool deferrable = false;
+    uint8_t maxDeferFrames = 0;
+
+    uint32_t runs = 0;
+    uint32_t deferrals = 0;             // Frames skipped for lack of time
+    uint32_t forcedRuns = 0;            // Runs despite lack of time, after maxDeferFrames
+    uint32_t overruns = 0;              // Runs longer than budgetUs
+    HistoryStats timing;                // us per run
+};
+
+struct FramePacerStats {
+    uint32_t frames = 0;
+    uint32_t overBudgetFrames = 0;      // Work took longer than the frame period
+    uint32_t missedDeadlines = 0;       // Started a full period or more late; schedule reset
+    uint32_t framePeriodUs = 0;
+    HistoryStats workTime;              // us of work per frame
+    HistoryStats frameInterval;         // us between frame starts
+};
+
+class FramePacer {
+public:
+    static constexpr size_t PHASE_COUNT = static_cast<size_t>(FramePhase::COUNT);
+
+    /**
+     * @brief Create a pacer with the default phase budgets
+     * @param framePeriodUs Frame period in microseconds
+     */
+    explicit FramePacer(uint32_t framePeriodUs = OS_FRAME_PERIOD_US);
+
+    /**
+     * @brief Change the frame period, e.g. when the refresh rate is lowered
+     * @param framePeriodUs Frame period in microseconds
+     */
+    void setFramePeriod(uint32_t framePeriodUs);
+
+    uint32_t getFramePeriod() const { return m_framePeriodUs; }
+
+    /**
+     * @brief Override a phase's budget and deferral policy
+     * @param phase Phase
+     * @param budgetUs Nominal duration; longer runs count as overruns
+     * @param deferrable Whether the phase may be skipped when the frame is full
+     * @param maxDeferFrames Consecutive skips before the phase is forced to run
+     */
+    void setPhaseBudget(FramePhase phase, uint32_t budgetUs, bool deferrable,
+                        uint8_t maxDeferFrames = OS_FRAME_MAX_DEFER);
+
+    /**
+     * @brief Start a frame
+     * @param deltaTime Milliseconds since the previous frame
+     */
+    void beginFrame(uint32_t deltaTime);
+
+    /**
+     * @brief Decide whether a phase runs this frame
+     * @param phase Phase
+     * @param deltaTime Set to the milliseconds the phase should advance by,
+     *                  including frames it was deferred for
+     * @return true if the phase should run; call endPhase() afterwards
+     */
+    bool beginPhase(FramePhase phase, uint32_t& deltaTime);
+
+    /**
+     * @brief Record the end of a phase started with beginPhase()
+     * @param phase Phase
+     */
+    void endPhase(FramePhase phase);
+
+    /**
+     * @brief Finish the frame
+     * @return Microseconds until the next frame should start
+     */
+    uint32_t endFrame();
+
+    /**
+     * @brief Get the time left in the current frame
+     * @return Microseconds, 0 when over budget
+     */
+    uint32_t getRemainingUs() const;
+
+    /**
+     * @brief Get one phase's policy and timing
+     * @param phase Phase
+     * @return Phase statistics
+     */
+    FramePhaseStats getPhaseStats(FramePhase phase) const;
+
+    /**
+     * @brief Get frame-level statistics
+     * @return Frame statistics
+     */
+    FramePacerStats getStats() const;
+
+    /**
+     * @brief Clear counters and timing history, keeping budgets
+     */
+    void resetStats();
+
+    /**
+     * @brief Log the per-phase budget table
+     */
+    void printStats() const;
+
+private:
+    struct Phase {
+        const char* name;
+        uint32_t budgetUs;
+        bool deferrable;
+        uint8_t maxDeferFrames;
+
+        uint8_t deferredFrames = 0;
+        uint32_t pendingDelta = 0;
+        int64_t startUs = 0;
+        uint32_t runs = 0;
+        uint32_t deferrals = 0;
+        uint32_t forcedRuns = 0;
+        uint32_t overruns = 0;
+        StatsRing<uint32_t, OS_FRAME_HISTORY_SIZE> timing;
+    };
+
+    Phase m_phases[PHASE_COUNT];
+    uint32_t m_framePeriodUs;
+
+    int64_t m_frameStartUs = 0;
+    int64_t m_nextDeadlineUs = 0;      // Start of the next frame; 0 before the first frame
+
+    uint32_t m_frames = 0;
+    uint32_t m_overBudgetFrames = 0;
+    uint32_t m_missedDeadlines = 0;
+    StatsRing<uint32_t, OS_FRAME_HISTORY_SIZE> m_workTime;
+    StatsRing<uint32_t, OS_FRAME_HISTORY_SIZE> m_frameInterval;
+};
+
+#endif // FRAME_PACER_H
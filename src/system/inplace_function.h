@@ -0,0 +1,140 @@
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @file inplace_function.h
+ * @brief Fixed-capacity std::function replacement that never allocates
+ *
+ * The callable is stored in an in-object buffer of Capacity bytes. A
+ * callable that does not fit is a compile error rather than a silent heap
+ * allocation, so capture a pointer to larger state instead. Copy, move and
+ * destroy go through a static per-type operations table.
+ */
+
+template <typename Signature, size_t Capacity>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+    InplaceFunction() noexcept = default;
+    InplaceFunction(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename Callable = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Callable, InplaceFunction>::value>::type>
+    InplaceFunction(F&& callable) {
+        static_assert(sizeof(Callable) <= Capacity,
+                      "Callable too large for InplaceFunction; capture less or raise the capacity");
+        static_assert(alignof(Callable) <= alignof(Storage),
+                      "Callable alignment exceeds InplaceFunction storage");
+        static_assert(std::is_copy_constructible<Callable>::value,
+                      "InplaceFunction callables must be copyable");
+
+        new (&m_storage) Callable(std::forward<F>(callable));
+        m_ops = &Operations<Callable>::table;
+    }
+
+    InplaceFunction(const InplaceFunction& other) : m_ops(other.m_ops) {
+        if (m_ops) {
+            m_ops->copy(&m_storage, &other.m_storage);
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept : m_ops(other.m_ops) {
+        if (m_ops) {
+            m_ops->move(&m_storage, &other.m_storage);
+            other.reset();
+        }
+    }
+
+    ~InplaceFunction() { reset(); }
+
+    InplaceFunction& operator=(const InplaceFunction& other) {
+        if (this != &other) {
+            reset();
+            if (other.m_ops) {
+                other.m_ops->copy(&m_storage, &other.m_storage);
+                m_ops = other.m_ops;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.m_ops) {
+                other.m_ops->move(&m_storage, &other.m_storage);
+                m_ops = other.m_ops;
+                other.reset();
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the stored callable
+     */
+    void reset() noexcept {
+        if (m_ops) {
+            m_ops->destroy(&m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    R operator()(Args... args) const {
+        return m_ops->invoke(const_cast<Storage*>(&m_storage), std::forward<Args>(args)...);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    typedef typename std::aligned_storage<Capacity, alignof(max_align_t)>::type Storage;
+
+    struct OperationTable {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*copy)(void* destination, const void* source);
+        void (*move)(void* destination, void* source);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename Callable>
+    struct Operations {
+        static R invoke(void* storage, Args&&... args) {
+            return (*static_cast<Callable*>(storage))(std::forward<Args>(args)...);
+        }
+        static void copy(void* destination, const void* source) {
+            new (destination) Callable(*static_cast<const Callable*>(source));
+        }
+        static void move(void* destination, void* source) {
+            new (destination) Callable(std::move(*static_cast<Callable*>(source)));
+        }
+        static void destroy(void* storage) {
+            static_cast<Callable*>(storage)->~Callable();
+        }
+        static constexpr OperationTable table = {invoke, copy, move, destroy};
+    };
+
+    Storage m_storage;
+    const OperationTable* m_ops = nullptr;
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename Callable>
+constexpr typename InplaceFunction<R(Args...), Capacity>::OperationTable
+    InplaceFunction<R(Args...), Capacity>::Operations<Callable>::table;
+
+#endif // INPLACE_FUNCTION_H
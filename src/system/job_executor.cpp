@@ -0,0 +1,332 @@
+#include "job_executor.h"
+#include "trace_recorder.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#endif
+
+static const char* TAG = "JobExecutor";
+
+static thread_local int t_workerIndex = -1;
+
+JobExecutor::~JobExecutor() {
+    shutdown();
+}
+
+os_error_t JobExecutor::initialize(size_t workerCount) {
+    if (m_initialized) {
+        return OS_OK;
+    }
+    if (workerCount == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    ESP_LOGI(TAG, "Initializing Job Executor with %d workers", workerCount);
+
+    m_workers.clear();
+    for (size_t i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(new Worker());
+        m_workers.back()->core = static_cast<int>(i);
+    }
+
+    m_startTimeUs = esp_timer_get_time();
+    m_running.store(true, std::memory_order_release);
+
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t defaultConfig = esp_pthread_get_default_config();
+#endif
+
+    for (size_t i = 0; i < workerCount; i++) {
+#ifdef ESP_PLATFORM
+        // Pin each worker to its own core
+        esp_pthread_cfg_t config = defaultConfig;
+        config.stack_size = OS_EXECUTOR_STACK_SIZE;
+        config.prio = OS_EXECUTOR_PRIORITY;
+        config.pin_to_core = m_workers[i]->core;
+        config.thread_name = i == 0 ? "job_rt" : "job_bg";
+        esp_pthread_set_cfg(&config);
+#endif
+        m_workers[i]->thread = std::thread(&JobExecutor::workerLoop, this, i);
+    }
+
+#ifdef ESP_PLATFORM
+    esp_pthread_set_cfg(&defaultConfig);
+#endif
+
+    m_initialized = true;
+    ESP_LOGI(TAG, "Job Executor initialized");
+    return OS_OK;
+}
+
+os_error_t JobExecutor::shutdown() {
+    if (!m_initialized) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Shutting down Job Executor");
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running.store(false, std::memory_order_release);
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    m_workers.clear();
+    m_stealableJobs.store(0, std::memory_order_relaxed);
+
+    m_initialized = false;
+    ESP_LOGI(TAG, "Job Executor shutdown complete");
+    return OS_OK;
+}
+
+bool JobExecutor::submit(JobFunction job, JobAffinity affinity) {
+    if (!job || !isRunning()) {
+        return false;
+    }
+
+    size_t count = m_workers.size();
+    bool queued = false;
+
+    if (affinity == JobAffinity::REALTIME) {
+        queued = m_workers[0]->pinned.pushBack(std::move(job));
+    } else {
+        size_t target;
+        if (affinity == JobAffinity::BACKGROUND) {
+            target = count - 1;
+        } else if (t_workerIndex >= 0 && static_cast<size_t>(t_workerIndex) < count) {
+            // Keep spawned work local; idle workers will steal it if needed
+            target = t_workerIndex;
+        } else {
+            target = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % count;
+        }
+
+        // Counted before the push so a fast pop never takes the count below zero
+        m_stealableJobs.fetch_add(1, std::memory_order_release);
+
+        // Fall back to the other deques if the preferred one is full
+        for (size_t attempt = 0; attempt < count && !queued; attempt++) {
+            queued = m_workers[(target + attempt) % count]->deque.pushBack(std::move(job));
+        }
+        if (!queued) {
+            m_stealableJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!queued) {
+        m_jobsRejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_jobsSubmitted.fetch_add(1, std::memory_order_relaxed);
+    wakeWorkers();
+    return true;
+}
+
+void JobExecutor::parallelFor(size_t begin, size_t end, size_t grain,
+                              const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin || !body) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (end - begin + grain - 1) / grain;
+    m_parallelForCalls.fetch_add(1, std::memory_order_relaxed);
+
+    if (chunks == 1 || !isRunning()) {
+        body(begin, end);
+        return;
+    }
+
+    // Helpers that start after the last chunk is claimed only touch the
+    // shared counters, which the shared_ptr keeps alive past our return
+    struct Range {
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> doneChunks{0};
+        size_t begin;
+        size_t end;
+        size_t grain;
+        size_t chunks;
+        const std::function<void(size_t, size_t)>* body;
+    };
+    auto range = std::make_shared<Range>();
+    range->begin = begin;
+    range->end = end;
+    range->grain = grain;
+    range->chunks = chunks;
+    range->body = &body;
+
+    auto work = [range]() {
+        size_t chunk;
+        while ((chunk = range->nextChunk.fetch_add(1, std::memory_order_relaxed)) < range->chunks) {
+            size_t chunkBegin = range->begin + chunk * range->grain;
+            size_t chunkEnd = std::min(chunkBegin + range->grain, range->end);
+            (*range->body)(chunkBegin, chunkEnd);
+            range->doneChunks.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    size_t helpers = std::min(chunks - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        if (!submit(work, JobAffinity::ANY)) {
+            break;
+        }
+    }
+
+    work();
+    while (range->doneChunks.load(std::memory_order_acquire) < chunks) {
+        std::this_thread::yield();
+    }
+}
+
+int JobExecutor::currentWorker() {
+    return t_workerIndex;
+}
+
+ExecutorStats JobExecutor::getStats() const {
+    ExecutorStats stats;
+    stats.jobsSubmitted = m_jobsSubmitted.load(std::memory_order_relaxed);
+    stats.jobsRejected = m_jobsRejected.load(std::memory_order_relaxed);
+    stats.parallelForCalls = m_parallelForCalls.load(std::memory_order_relaxed);
+
+    int64_t elapsedUs = esp_timer_get_time() - m_startTimeUs;
+    for (const auto& worker : m_workers) {
+        ExecutorWorkerStats workerStats;
+        workerStats.core = worker->core;
+        workerStats.jobsExecuted = worker->jobsExecuted.load(std::memory_order_relaxed);
+        workerStats.jobsStolen = worker->jobsStolen.load(std::memory_order_relaxed);
+        workerStats.busyUs = worker->busyUs.load(std::memory_order_relaxed);
+        workerStats.utilization = elapsedUs > 0 ?
+            static_cast<uint8_t>(std::min<int64_t>(100, workerStats.busyUs * 100 / elapsedUs)) : 0;
+        stats.workers.push_back(workerStats);
+    }
+    return stats;
+}
+
+void JobExecutor::printStats() const {
+    ExecutorStats stats = getStats();
+
+    ESP_LOGI(TAG, "=== Job Executor Statistics ===");
+    ESP_LOGI(TAG, "Jobs submitted: %d, rejected: %d", stats.jobsSubmitted, stats.jobsRejected);
+    ESP_LOGI(TAG, "Parallel-for calls: %d", stats.parallelForCalls);
+    for (size_t i = 0; i < stats.workers.size(); i++) {
+        const ExecutorWorkerStats& worker = stats.workers[i];
+        ESP_LOGI(TAG, "Worker %d (core %d): %d jobs, %d stolen, %d%% busy", i, worker.core,
+                 worker.jobsExecuted, worker.jobsStolen, worker.utilization);
+    }
+}
+
+void JobExecutor::workerLoop(size_t index) {
+    t_workerIndex = static_cast<int>(index);
+    Worker& worker = *m_workers[index];
+    JobFunction job;
+
+    for (;;) {
+        if (worker.pinned.popFront(job)) {
+            runJob(worker, job);
+            continue;
+        }
+        if (worker.deque.popFront(job)) {
+            m_stealableJobs.fetch_sub(1, std::memory_order_relaxed);
+            runJob(worker, job);
+            continue;
+        }
+        if (steal(index, job)) {
+            m_stealableJobs.fetch_sub(1, std::memory_order_relaxed);
+            worker.jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            runJob(worker, job);
+            continue;
+        }
+
+        // Queues are drained before exiting
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (!m_running.load(std::memory_order_acquire)) {
+            break;
+        }
+        m_wakeCondition.wait(lock, [this, &worker]() {
+            return !m_running.load(std::memory_order_acquire) ||
+                   m_stealableJobs.load(std::memory_order_acquire) > 0 ||
+                   worker.pinned.size() > 0;
+        });
+    }
+
+    t_workerIndex = -1;
+}
+
+bool JobExecutor::steal(size_t thief, JobFunction& job) {
+    size_t count = m_workers.size();
+    for (size_t offset = 1; offset < count; offset++) {
+        if (m_workers[(thief + offset) % count]->deque.popBack(job)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobExecutor::runJob(Worker& worker, JobFunction& job) {
+    int64_t start = esp_timer_get_time();
+    try {
+        PERF_TRACE_SCOPE("job");
+        job();
+    } catch (...) {
+        ESP_LOGE(TAG, "Job threw an exception on worker %d", t_workerIndex);
+    }
+    job = nullptr;
+
+    worker.busyUs.fetch_add(esp_timer_get_time() - start, std::memory_order_relaxed);
+    worker.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobExecutor::wakeWorkers() {
+    {
+        // Pairs with the predicate check so a worker cannot miss the wakeup
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wakeCondition.notify_all();
+}
+
+bool JobExecutor::JobDeque::pushBack(JobFunction&& job) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = m_count.load(std::memory_order_relaxed);
+    if (count == OS_EXECUTOR_QUEUE_DEPTH) {
+        return false;
+    }
+    m_jobs[(m_head + count) % OS_EXECUTOR_QUEUE_DEPTH] = std::move(job);
+    m_count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+bool JobExecutor::JobDeque::popFront(JobFunction& job) {
+    if (m_count.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = m_count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return false;
+    }
+    job = std::move(m_jobs[m_head]);
+    m_head = (m_head + 1) % OS_EXECUTOR_QUEUE_DEPTH;
+    m_count.store(count - 1, std::memory_order_release);
+    return true;
+}
+
+bool JobExecutor::JobDeque::popBack(JobFunction& job) {
+    if (m_count.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = m_count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return false;
+    }
+    job = std::move(m_jobs[(m_head + count - 1) % OS_EXECUTOR_QUEUE_DEPTH]);
+    m_count.store(count - 1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,189 @@
+#ifndef JOB_EXECUTOR_H
+#define JOB_EXECUTOR_H
+
+#include "os_config.h"
+#include "inplace_function.h"
+#include <functional>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @file job_executor.h
+ * @brief Work-stealing job executor for M5Stack Tab5
+ *
+ * Runs jobs on one worker thread per core, each with its own deque.
+ * Idle workers steal from the tail of other workers' deques, so a burst
+ * submitted to one core spreads to the other. Workers are std::threads
+ * (pinned through esp_pthread on the device), so the executor also runs on
+ * a Linux host for testing.
+ */
+
+// Stored inline in the deques, so submitting a job never allocates
+typedef InplaceFunction<void(), OS_JOB_FUNCTION_CAPACITY> JobFunction;
+
+enum class JobAffinity : uint8_t {
+    ANY,          // Any worker (round-robin, or the submitting worker's own deque)
+    REALTIME,     // Worker 0 only, ahead of its stealable jobs; never stolen
+    BACKGROUND    // Last worker's deque; may be stolen
+};
+
+struct ExecutorWorkerStats {
+    int core;
+    uint32_t jobsExecuted;
+    uint32_t jobsStolen;      // Jobs this worker took from another worker's deque
+    uint64_t busyUs;
+    uint8_t utilization;      // Busy time since initialize(), percent
+};
+
+struct ExecutorStats {
+    std::vector<ExecutorWorkerStats> workers;
+    uint32_t jobsSubmitted;
+    uint32_t jobsRejected;
+    uint32_t parallelForCalls;
+};
+
+class JobExecutor {
+public:
+    JobExecutor() = default;
+    ~JobExecutor();
+
+    JobExecutor(const JobExecutor&) = delete;
+    JobExecutor& operator=(const JobExecutor&) = delete;
+
+    /**
+     * @brief Start the worker threads
+     * @param workerCount Number of workers (one per core on the device)
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t initialize(size_t workerCount = OS_EXECUTOR_WORKERS);
+
+    /**
+     * @brief Run the remaining queued jobs and stop the workers
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t shutdown();
+
+    /**
+     * @brief Check if workers are running
+     * @return true if jobs can be submitted
+     */
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Queue a job
+     * @param job Job to run
+     * @param affinity Placement hint
+     * @return false if not running or the target deque is full
+     */
+    bool submit(JobFunction job, JobAffinity affinity = JobAffinity::ANY);
+
+    /**
+     * @brief Run body over [begin, end) split into chunks across all workers
+     *
+     * The calling thread works on chunks too and returns once every chunk
+     * has finished, so this may also be called from inside a job.
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Minimum indices per chunk
+     * @param body Called as body(chunkBegin, chunkEnd)
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief Get number of workers
+     * @return Worker count
+     */
+    size_t getWorkerCount() const { return m_workers.size(); }
+
+    /**
+     * @brief Get the worker index of the calling thread
+     * @return Worker index or -1 if not called from a worker
+     */
+    static int currentWorker();
+
+    /**
+     * @brief Get executor statistics
+     * @return Per-worker job, steal and utilization counters
+     */
+    ExecutorStats getStats() const;
+
+    /**
+     * @brief Print executor statistics
+     */
+    void printStats() const;
+
+private:
+    // Bounded deque; the owner takes from the head (submission order),
+    // thieves take from the tail
+    class JobDeque {
+    public:
+        bool pushBack(JobFunction&& job);
+        bool popFront(JobFunction& job);
+        bool popBack(JobFunction& job);
+        size_t size() const { return m_count.load(std::memory_order_relaxed); }
+
+    private:
+        JobFunction m_jobs[OS_EXECUTOR_QUEUE_DEPTH];
+        size_t m_head = 0;
+        std::atomic<size_t> m_count{0};
+        std::mutex m_mutex;
+    };
+
+    struct Worker {
+        std::thread thread;
+        int core = 0;
+        JobDeque deque;      // Stealable jobs
+        JobDeque pinned;     // REALTIME jobs, owner only
+        std::atomic<uint32_t> jobsExecuted{0};
+        std::atomic<uint32_t> jobsStolen{0};
+        std::atomic<uint64_t> busyUs{0};
+    };
+
+    /**
+     * @brief Worker thread main loop
+     * @param index Worker index
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * @brief Take a job from another worker's deque
+     * @param thief Index of the stealing worker
+     * @param job Receives the job
+     * @return true if a job was stolen
+     */
+    bool steal(size_t thief, JobFunction& job);
+
+    /**
+     * @brief Run a job with timing and exception guard
+     * @param worker Worker running the job
+     * @param job Job to run
+     */
+    void runJob(Worker& worker, JobFunction& job);
+
+    /**
+     * @brief Wake sleeping workers after a submit
+     */
+    void wakeWorkers();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running{false};
+    std::atomic<size_t> m_stealableJobs{0};
+    std::atomic<size_t> m_nextWorker{0};
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+
+    std::atomic<uint32_t> m_jobsSubmitted{0};
+    std::atomic<uint32_t> m_jobsRejected{0};
+    std::atomic<uint32_t> m_parallelForCalls{0};
+    int64_t m_startTimeUs = 0;
+
+    bool m_initialized = false;
+};
+
+#endif // JOB_EXECUTOR_H
@@ -0,0 +1,111 @@
+#include "memory_arena.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+
+static const char* TAG = "MemoryArena";
+
+MemoryArena::MemoryArena(const char* name, size_t chunkSize, uint32_t caps)
+    : m_name(name), m_chunkSize(chunkSize), m_caps(caps) {
+}
+
+MemoryArena::~MemoryArena() {
+    release();
+}
+
+void* MemoryArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    uintptr_t mask = alignment - 1;
+    uint8_t* start = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(m_cursor) + mask) & ~mask);
+
+    if (!m_cursor || start + size > m_end) {
+        // Move on to the next chunk that fits, growing the arena if none does
+        Chunk* chunk = m_current ? m_current->next : m_head;
+        while (chunk && chunk->size < size + alignment) {
+            chunk = chunk->next;
+        }
+
+        if (!chunk) {
+            size_t chunkSize = size + alignment > m_chunkSize ? size + alignment : m_chunkSize;
+            chunk = allocateChunk(chunkSize);
+            if (!chunk) {
+                ESP_LOGW(TAG, "Arena '%s' failed to grow by %d bytes", m_name, chunkSize);
+                return nullptr;
+            }
+            if (m_current) {
+                chunk->next = m_current->next;
+                m_current->next = chunk;
+            } else {
+                chunk->next = m_head;
+                m_head = chunk;
+            }
+        }
+
+        m_current = chunk;
+        m_cursor = chunkData(chunk);
+        m_end = m_cursor + chunk->size;
+        start = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(m_cursor) + mask) & ~mask);
+    }
+
+    m_stats.used += (start + size) - m_cursor;
+    m_cursor = start + size;
+    m_stats.allocationCount++;
+    if (m_stats.used > m_stats.peakUsed) {
+        m_stats.peakUsed = m_stats.used;
+    }
+
+    return start;
+}
+
+void MemoryArena::reset() {
+    // Merge a grown arena into one chunk so next frame stays in a single chunk
+    if (m_head && m_head->next) {
+        size_t total = m_stats.capacity;
+        release();
+        Chunk* merged = allocateChunk(total);
+        if (merged) {
+            merged->next = nullptr;
+            m_head = merged;
+        }
+    }
+
+    m_current = m_head;
+    m_cursor = m_head ? chunkData(m_head) : nullptr;
+    m_end = m_head ? m_cursor + m_head->size : nullptr;
+    m_stats.used = 0;
+    m_stats.resetCount++;
+}
+
+void MemoryArena::release() {
+    Chunk* chunk = m_head;
+    while (chunk) {
+        Chunk* next = chunk->next;
+        heap_caps_free(chunk);
+        chunk = next;
+    }
+
+    m_head = nullptr;
+    m_current = nullptr;
+    m_cursor = nullptr;
+    m_end = nullptr;
+    m_stats.used = 0;
+    m_stats.capacity = 0;
+}
+
+MemoryArena::Chunk* MemoryArena::allocateChunk(size_t size) {
+    Chunk* chunk = static_cast<Chunk*>(heap_caps_malloc(sizeof(Chunk) + size, m_caps));
+    if (!chunk) {
+        chunk = static_cast<Chunk*>(heap_caps_malloc(sizeof(Chunk) + size, MALLOC_CAP_DEFAULT));
+    }
+    if (!chunk) {
+        return nullptr;
+    }
+
+    chunk->next = nullptr;
+    chunk->size = size;
+    m_stats.capacity += size;
+    m_stats.chunkAllocations++;
+    return chunk;
+}
@@ -0,0 +1,163 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @file memory_arena.h
+ * @brief Bump-pointer arena allocator for per-frame and per-app scratch memory
+ *
+ * Allocations are carved sequentially out of large chunks and are never
+ * freed individually; the whole arena is rewound with reset(). Arenas are
+ * not thread-safe - each one belongs to a single task (the frame arena to
+ * the main loop that drives OSManager::update()).
+ */
+
+struct ArenaStats {
+    size_t used = 0;              // Bytes handed out since the last reset
+    size_t peakUsed = 0;          // Highest 'used' seen between resets
+    size_t capacity = 0;          // Bytes reserved in chunks
+    uint32_t allocationCount = 0; // Allocations since creation
+    uint32_t resetCount = 0;
+    uint32_t chunkAllocations = 0; // Heap allocations made to grow the arena
+};
+
+class MemoryArena {
+public:
+    /**
+     * @brief Constructor
+     * @param name Arena name for logging
+     * @param chunkSize Default chunk size in bytes (first chunk is allocated lazily)
+     * @param caps heap_caps flags for chunk memory
+     */
+    MemoryArena(const char* name, size_t chunkSize, uint32_t caps);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    /**
+     * @brief Allocate scratch memory
+     * @param size Size in bytes
+     * @param alignment Alignment (power of two)
+     * @return Pointer valid until the next reset(), or nullptr if out of memory
+     */
+    void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+    /**
+     * @brief Construct a trivially destructible object in the arena
+     * @return Pointer to the object or nullptr if out of memory
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena objects are never destroyed, use trivially destructible types");
+        void* ptr = allocate(sizeof(T), alignof(T));
+        return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * @brief Rewind the arena, invalidating every allocation
+     *
+     * If the arena had to grow, its chunks are merged into a single chunk
+     * of the combined size so the steady state needs no chunk hopping.
+     */
+    void reset();
+
+    /**
+     * @brief Free all chunks back to the heap
+     */
+    void release();
+
+    /**
+     * @brief Get arena name
+     * @return Name string
+     */
+    const char* getName() const { return m_name; }
+
+    /**
+     * @brief Get bytes handed out since the last reset
+     * @return Used bytes including alignment padding
+     */
+    size_t getUsed() const { return m_stats.used; }
+
+    /**
+     * @brief Get arena statistics
+     * @return Statistics structure
+     */
+    const ArenaStats& getStats() const { return m_stats; }
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;     // Usable bytes after the header
+    };
+
+    Chunk* allocateChunk(size_t size);
+    uint8_t* chunkData(Chunk* chunk) const { return reinterpret_cast<uint8_t*>(chunk + 1); }
+
+    const char* m_name;
+    size_t m_chunkSize;
+    uint32_t m_caps;
+
+    Chunk* m_head = nullptr;
+    Chunk* m_current = nullptr;
+    uint8_t* m_cursor = nullptr;
+    uint8_t* m_end = nullptr;
+
+    ArenaStats m_stats;
+};
+
+/**
+ * @brief std-compatible allocator drawing from a MemoryArena
+ *
+ * deallocate() is a no-op; memory comes back when the arena is reset, so
+ * containers using it must not outlive the arena's reset point.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MemoryArena& arena) noexcept : m_arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(size_t count) {
+        void* ptr = m_arena->allocate(count * sizeof(T), alignof(T));
+        if (!ptr) {
+            #if defined(__cpp_exceptions)
+            throw std::bad_alloc();
+            #else
+            abort();
+            #endif
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    MemoryArena* arena() const noexcept { return m_arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_arena == other.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_arena != other.arena(); }
+
+private:
+    MemoryArena* m_arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+#endif // MEMORY_ARENA_H
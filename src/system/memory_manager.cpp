@@ -1,4 +1,5 @@
 #include "memory_manager.h"
+#include "resource_accountant.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
 #include <esp_cache.h>
@@ -6,14 +7,16 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include <algorithm>
 
 static const char* TAG = "MemoryManager";
 
 // MemoryPool Implementation with PSRAM optimization
 MemoryPool::MemoryPool(size_t blockSize, size_t blockCount) 
-    : m_blockSize(blockSize), m_totalBlocks(blockCount), m_freeBlocks(blockCount) {
+    : m_blockSize(std::max(blockSize, sizeof(FreeNode))), m_totalBlocks(blockCount),
+      m_freeBlocks(blockCount), m_memory(nullptr), m_memoryType(0) {
     
-    size_t totalSize = blockSize * blockCount;
+    size_t totalSize = m_blockSize * blockCount;
     
     // Use PSRAM for large allocations, internal RAM for small/frequent ones
     uint32_t caps = (totalSize > 32768) ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
@@ -24,7 +27,7 @@ MemoryPool::MemoryPool(size_t blockSize, size_t blockCount)
     m_memory = heap_caps_aligned_alloc(32, totalSize, caps); // 32-byte alignment for DMA
     
     if (m_memory) {
-        m_blockUsed.resize(blockCount, false);
+        m_usedBitmap.reset(new std::atomic<uint32_t>[(blockCount + 31) / 32]());
         m_memoryType = caps;
         
         // Pre-touch memory pages to avoid cache misses
@@ -34,9 +37,18 @@ MemoryPool::MemoryPool(size_t blockSize, size_t blockCount)
                 ptr[i] = 0;
             }
         }
+
+        // Thread every block onto the free list in address order so the
+        // first allocations come out of the lowest addresses
+        char* base = static_cast<char*>(m_memory);
+        for (size_t i = blockCount; i > 0; i--) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(base + (i - 1) * m_blockSize);
+            node->next = m_freeList;
+            m_freeList = node;
+        }
         
         ESP_LOGI(TAG, "Created memory pool: %d blocks of %d bytes (%s)", 
-                blockCount, blockSize, (caps & MALLOC_CAP_SPIRAM) ? "PSRAM" : "Internal");
+                blockCount, m_blockSize, (caps & MALLOC_CAP_SPIRAM) ? "PSRAM" : "Internal");
     } else {
         ESP_LOGE(TAG, "Failed to allocate memory pool");
         m_totalBlocks = 0;
@@ -51,54 +63,111 @@ MemoryPool::~MemoryPool() {
 }
 
 void* MemoryPool::allocate() {
-    if (m_freeBlocks == 0) {
+    FreeNode* node = m_freeList;
+    if (!node) {
         return nullptr;
     }
 
-    for (size_t i = 0; i < m_totalBlocks; i++) {
-        if (!m_blockUsed[i]) {
-            m_blockUsed[i] = true;
-            m_freeBlocks--;
-            return static_cast<char*>(m_memory) + (i * m_blockSize);
-        }
+    m_freeList = node->next;
+    m_freeBlocks--;
+    markUsed(node);
+    return node;
+}
+
+bool MemoryPool::deallocate(void* ptr) {
+    if (!markFree(ptr)) {
+        return false; // Double free or not one of our blocks
     }
 
-    return nullptr;
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next = m_freeList;
+    m_freeList = node;
+    m_freeBlocks++;
+    return true;
 }
 
-bool MemoryPool::deallocate(void* ptr) {
-    if (!ptr || !m_memory) {
-        return false;
+size_t MemoryPool::takeBatch(void** blocks, size_t maxCount) {
+    size_t taken = 0;
+    while (taken < maxCount && m_freeList) {
+        blocks[taken++] = m_freeList;
+        m_freeList = m_freeList->next;
     }
+    m_freeBlocks -= taken;
+    return taken;
+}
 
-    char* charPtr = static_cast<char*>(ptr);
-    char* basePtr = static_cast<char*>(m_memory);
-    
-    if (charPtr < basePtr) {
+void MemoryPool::returnBatch(void* const* blocks, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        FreeNode* node = static_cast<FreeNode*>(blocks[i]);
+        node->next = m_freeList;
+        m_freeList = node;
+    }
+    m_freeBlocks += count;
+}
+
+bool MemoryPool::markUsed(void* ptr) {
+    size_t index = blockIndex(ptr);
+    if (index == SIZE_MAX) {
         return false;
     }
 
-    size_t offset = charPtr - basePtr;
-    if (offset % m_blockSize != 0) {
+    uint32_t bit = 1u << (index & 31);
+    if (m_usedBitmap[index >> 5].fetch_or(bit, std::memory_order_acq_rel) & bit) {
         return false;
     }
+    m_usedBlocks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
 
-    size_t blockIndex = offset / m_blockSize;
-    if (blockIndex >= m_totalBlocks) {
+bool MemoryPool::markFree(void* ptr) {
+    size_t index = blockIndex(ptr);
+    if (index == SIZE_MAX) {
         return false;
     }
 
-    if (!m_blockUsed[blockIndex]) {
+    uint32_t bit = 1u << (index & 31);
+    if (!(m_usedBitmap[index >> 5].fetch_and(~bit, std::memory_order_acq_rel) & bit)) {
         return false; // Double free
     }
-
-    m_blockUsed[blockIndex] = false;
-    m_freeBlocks++;
+    m_usedBlocks.fetch_sub(1, std::memory_order_relaxed);
     return true;
 }
 
+bool MemoryPool::owns(const void* ptr) const {
+    if (!ptr || !m_memory) {
+        return false;
+    }
+
+    const char* charPtr = static_cast<const char*>(ptr);
+    const char* basePtr = static_cast<const char*>(m_memory);
+    return charPtr >= basePtr && charPtr < basePtr + m_blockSize * m_totalBlocks;
+}
+
+size_t MemoryPool::blockIndex(const void* ptr) const {
+    if (!owns(ptr)) {
+        return SIZE_MAX;
+    }
+
+    size_t offset = static_cast<const char*>(ptr) - static_cast<const char*>(m_memory);
+    if (offset % m_blockSize != 0) {
+        return SIZE_MAX;
+    }
+
+    return offset / m_blockSize;
+}
+
 // MemoryManager Implementation
+static std::atomic<uint32_t> s_nextInstanceId{0};
+
+MemoryManager::ThreadCache::~ThreadCache() {
+    // Hand cached blocks back on thread exit unless the manager is already gone
+    if (owner && ownerAlive.lock()) {
+        owner->flushCache(*this);
+    }
+}
+
 MemoryManager::~MemoryManager() {
+    m_lifetimeToken.reset();
     if (m_initialized) {
         checkLeaks();
         if (m_mutex) {
@@ -129,8 +198,20 @@ os_error_t MemoryManager::initialize() {
         return OS_ERROR_NO_MEMORY;
     }
 
-    // Reserve space for tracking allocations
-    m_activeBlocks.reserve(256);
+    // Size thread caches so a handful of threads cannot drain a pool:
+    // the 16 KB pool (4 blocks) stays uncached and always goes through the mutex
+    for (size_t i = 0; i < m_pools.size() && i < MAX_SIZE_CLASSES; i++) {
+        m_cacheDepth[i] = std::min(THREAD_CACHE_MAX_DEPTH, m_pools[i]->getTotalBlocks() / 8);
+    }
+    // Movable blocks live in their own region so compaction is deterministic
+    m_relocatableHeap = std::make_unique<RelocatableHeap>(OS_RELOCATABLE_HEAP_SIZE, OS_RELOCATABLE_MAX_HANDLES,
+                                                          MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!m_relocatableHeap->isValid()) {
+        ESP_LOGW(TAG, "Relocatable heap unavailable");
+    }
+
+    m_instanceId = ++s_nextInstanceId;
+    m_lifetimeToken = std::make_shared<uint32_t>(m_instanceId);
 
     m_initialized = true;
     ESP_LOGI(TAG, "Memory Manager initialized with %d pools", m_pools.size());
@@ -146,6 +227,22 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
         return nullptr;
     }
 
+    // Small-object fast path: served from the size-class caches without the mutex
+    size_t classIndex = findSizeClass(size);
+    if (classIndex < m_pools.size()) {
+        void* ptr = allocatePooled(classIndex);
+        if (ptr) {
+            if (m_profiler.isEnabled()) {
+                m_profiler.recordAllocation(ptr, size, file, line);
+            }
+            #if OS_DEBUG_ENABLED >= 3
+            ESP_LOGD(TAG, "Allocated %d bytes at %p from pool %d (%s:%d)", size, ptr,
+                    classIndex, file ? file : "unknown", line);
+            #endif
+            return ptr;
+        }
+    }
+
     // Thread safety
     if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
         ESP_LOGW(TAG, "Failed to acquire memory mutex");
@@ -154,42 +251,28 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
 
     void* ptr = nullptr;
 
-    // Try to allocate from pools first for small allocations
-    if (size <= 16384) {
-        for (auto& pool : m_pools) {
-            if (size <= pool->getBlockSize() && pool->getFreeBlocks() > 0) {
-                ptr = pool->allocate();
-                if (ptr) {
-                    break;
-                }
-            }
-        }
-    }
-
     // Fall back to optimized heap allocation
+    uint32_t caps = MALLOC_CAP_DEFAULT;
+    
+    // Use PSRAM for large allocations
+    if (size > 1024) {
+        caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_32BIT;
+    }
+    // Use internal RAM for small, frequent allocations
+    else if (size <= 256) {
+        caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    }
+    
+    // Try aligned allocation for better performance
+    if (size >= 32) {
+        ptr = heap_caps_aligned_alloc(32, size, caps);
+    } else {
+        ptr = heap_caps_malloc(size, caps);
+    }
+    
+    // Fallback to any available memory
     if (!ptr) {
-        uint32_t caps = MALLOC_CAP_DEFAULT;
-        
-        // Use PSRAM for large allocations
-        if (size > 1024) {
-            caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_32BIT;
-        }
-        // Use internal RAM for small, frequent allocations
-        else if (size <= 256) {
-            caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
-        }
-        
-        // Try aligned allocation for better performance
-        if (size >= 32) {
-            ptr = heap_caps_aligned_alloc(32, size, caps);
-        } else {
-            ptr = heap_caps_malloc(size, caps);
-        }
-        
-        // Fallback to any available memory
-        if (!ptr) {
-            ptr = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
-        }
+        ptr = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
     }
 
     if (ptr) {
@@ -202,14 +285,8 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
         block.line = line;
         block.inUse = true;
 
-        m_activeBlocks.push_back(block);
-        m_totalAllocated += size;
-        m_allocationCount++;
+        trackHeapBlock(block);
 
-        if (m_totalAllocated > m_peakAllocated) {
-            m_peakAllocated = m_totalAllocated;
-        }
-        
         // Update fragmentation tracking
         updateFragmentationStats();
 
@@ -223,6 +300,10 @@ void* MemoryManager::allocate(size_t size, const char* file, int line) {
     }
 
     xSemaphoreGive(m_mutex);
+
+    if (ptr && m_profiler.isEnabled()) {
+        m_profiler.recordAllocation(ptr, size, file, line);
+    }
     return ptr;
 }
 
@@ -231,39 +312,34 @@ bool MemoryManager::deallocate(void* ptr) {
         return false;
     }
 
+    // Must precede the free, before another thread can be handed the same address
+    if (m_profiler.isEnabled()) {
+        m_profiler.recordDeallocation(ptr);
+    }
+
+    // Pool blocks are identified by address and never touch the mutex
+    size_t poolIndex = findOwningPool(ptr);
+    if (poolIndex < m_pools.size()) {
+        return deallocatePooled(ptr, poolIndex);
+    }
+
     // Thread safety
     if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
         ESP_LOGW(TAG, "Failed to acquire memory mutex for deallocation");
         return false;
     }
 
-    auto it = findBlock(ptr);
-    if (it == m_activeBlocks.end()) {
+    size_t size;
+    if (!untrackHeapBlock(ptr, size)) {
         ESP_LOGW(TAG, "Attempt to free untracked pointer %p", ptr);
         xSemaphoreGive(m_mutex);
         return false;
     }
 
-    size_t size = it->size;
-    bool freedFromPool = false;
-
-    // Try to free from pools first
-    for (auto& pool : m_pools) {
-        if (pool->deallocate(ptr)) {
-            freedFromPool = true;
-            break;
-        }
-    }
-
-    // Fall back to heap deallocation
-    if (!freedFromPool) {
-        heap_caps_free(ptr);
-    }
+    heap_caps_free(ptr);
 
     // Update tracking
-    m_totalAllocated -= size;
-    m_deallocationCount++;
-    m_activeBlocks.erase(it);
+    recordDeallocation(size);
     
     // Update fragmentation tracking
     updateFragmentationStats();
@@ -281,7 +357,13 @@ void* MemoryManager::allocateFromPool(size_t poolIndex) {
         return nullptr;
     }
 
-    return m_pools[poolIndex]->allocate();
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return nullptr;
+    }
+    void* ptr = m_pools[poolIndex]->allocate();
+    xSemaphoreGive(m_mutex);
+
+    return ptr;
 }
 
 bool MemoryManager::deallocateFromPool(void* ptr, size_t poolIndex) {
@@ -289,20 +371,205 @@ bool MemoryManager::deallocateFromPool(void* ptr, size_t poolIndex) {
         return false;
     }
 
-    return m_pools[poolIndex]->deallocate(ptr);
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    bool result = m_pools[poolIndex]->deallocate(ptr);
+    xSemaphoreGive(m_mutex);
+
+    return result;
+}
+
+void MemoryManager::flushThreadCache() {
+    if (!m_initialized) {
+        return;
+    }
+
+    flushCache(threadCache());
+}
+
+size_t MemoryManager::getActiveAllocations() const {
+    size_t active = m_heapBlocks.size() + m_untrackedBlocks.size();
+    for (const auto& pool : m_pools) {
+        active += pool->getUsedBlocks();
+    }
+    return active;
+}
+
+MemoryManager::ThreadCache& MemoryManager::threadCache() {
+    static thread_local ThreadCache cache;
+
+    if (cache.ownerId != m_instanceId) {
+        // First use on this thread, or still bound to another manager instance
+        if (cache.owner && cache.ownerAlive.lock()) {
+            cache.owner->flushCache(cache);
+        }
+        for (auto& sizeClass : cache.classes) {
+            sizeClass.count = 0;
+        }
+        cache.owner = this;
+        cache.ownerId = m_instanceId;
+        cache.ownerAlive = m_lifetimeToken;
+    }
+
+    return cache;
+}
+
+void MemoryManager::flushCache(ThreadCache& cache) {
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Failed to acquire memory mutex for cache flush");
+        return;
+    }
+
+    for (size_t i = 0; i < m_pools.size() && i < MAX_SIZE_CLASSES; i++) {
+        SizeClassCache& sizeClass = cache.classes[i];
+        m_pools[i]->returnBatch(sizeClass.blocks, sizeClass.count);
+        sizeClass.count = 0;
+    }
+
+    xSemaphoreGive(m_mutex);
+}
+
+void* MemoryManager::allocatePooled(size_t classIndex) {
+    for (size_t i = classIndex; i < m_pools.size(); i++) {
+        MemoryPool& pool = *m_pools[i];
+        void* ptr = nullptr;
+
+        if (m_threadCacheEnabled && m_cacheDepth[i] > 0) {
+            SizeClassCache& sizeClass = threadCache().classes[i];
+            if (sizeClass.count == 0) {
+                // Refill half the cache in one locked batch
+                if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+                    return nullptr;
+                }
+                sizeClass.count = pool.takeBatch(sizeClass.blocks, std::max<size_t>(1, m_cacheDepth[i] / 2));
+                xSemaphoreGive(m_mutex);
+            }
+            if (sizeClass.count > 0) {
+                ptr = sizeClass.blocks[--sizeClass.count];
+                pool.markUsed(ptr);
+            }
+        } else if (pool.getFreeBlocks() > 0) {
+            if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+                return nullptr;
+            }
+            ptr = pool.allocate();
+            xSemaphoreGive(m_mutex);
+        }
+
+        if (ptr) {
+            recordAllocation(pool.getBlockSize());
+            return ptr;
+        }
+    }
+
+    return nullptr;
+}
+
+bool MemoryManager::deallocatePooled(void* ptr, size_t poolIndex) {
+    MemoryPool& pool = *m_pools[poolIndex];
+
+    if (!pool.markFree(ptr)) {
+        ESP_LOGW(TAG, "Double free or misaligned pool pointer %p", ptr);
+        return false;
+    }
+
+    size_t depth = m_cacheDepth[poolIndex];
+    if (m_threadCacheEnabled && depth > 0) {
+        SizeClassCache& sizeClass = threadCache().classes[poolIndex];
+        if (sizeClass.count >= depth) {
+            // Flush the older half in one locked batch, keep the recently freed (cache-hot) half
+            size_t batch = std::max<size_t>(1, depth / 2);
+            if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                pool.returnBatch(sizeClass.blocks, batch);
+                xSemaphoreGive(m_mutex);
+                sizeClass.count -= batch;
+                memmove(sizeClass.blocks, sizeClass.blocks + batch, sizeClass.count * sizeof(void*));
+            }
+        }
+        if (sizeClass.count < depth) {
+            sizeClass.blocks[sizeClass.count++] = ptr;
+            recordDeallocation(pool.getBlockSize());
+            return true;
+        }
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        ESP_LOGW(TAG, "Failed to acquire memory mutex for deallocation");
+        pool.markUsed(ptr); // Still owned by the caller
+        return false;
+    }
+    pool.returnBatch(&ptr, 1);
+    xSemaphoreGive(m_mutex);
+
+    recordDeallocation(pool.getBlockSize());
+    return true;
+}
+
+size_t MemoryManager::findSizeClass(size_t size) const {
+    size_t index = 0;
+    while (index < m_pools.size() && size > m_pools[index]->getBlockSize()) {
+        index++;
+    }
+    return index;
+}
+
+size_t MemoryManager::findOwningPool(const void* ptr) const {
+    size_t index = 0;
+    while (index < m_pools.size() && !m_pools[index]->owns(ptr)) {
+        index++;
+    }
+    return index;
+}
+
+void MemoryManager::recordAllocation(size_t size) {
+    size_t total = m_totalAllocated.fetch_add(size, std::memory_order_relaxed) + size;
+    m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    ResourceAccountant::chargeAllocation(size);
+
+    size_t peak = m_peakAllocated.load(std::memory_order_relaxed);
+    while (total > peak &&
+           !m_peakAllocated.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryManager::recordDeallocation(size_t size) {
+    m_totalAllocated.fetch_sub(size, std::memory_order_relaxed);
+    m_deallocationCount.fetch_add(1, std::memory_order_relaxed);
+    ResourceAccountant::chargeDeallocation(size);
 }
 
 size_t MemoryManager::checkLeaks() {
     size_t leakCount = 0;
     uint32_t currentTime = millis();
 
-    for (const auto& block : m_activeBlocks) {
+    m_heapBlocks.forEach([&](const MemoryBlock& block) {
         if (block.inUse) {
             leakCount++;
             ESP_LOGW(TAG, "Memory leak: %d bytes at %p, allocated %d ms ago (%s:%d)",
                     block.size, block.ptr, currentTime - block.timestamp,
                     block.file ? block.file : "unknown", block.line);
         }
+    });
+
+    // Without the tracking table only the number of live heap blocks is known
+    if (!HeapTracker::enabled && m_heapBlocks.size() > 0) {
+        leakCount += m_heapBlocks.size();
+        ESP_LOGW(TAG, "Memory leak: %d heap blocks still allocated", m_heapBlocks.size());
+    }
+    if (!m_untrackedBlocks.empty()) {
+        leakCount += m_untrackedBlocks.size();
+        ESP_LOGW(TAG, "Memory leak: %d overflow heap blocks still allocated", m_untrackedBlocks.size());
+    }
+
+    // Pool blocks are not individually tracked; report outstanding counts per pool
+    for (size_t i = 0; i < m_pools.size(); i++) {
+        size_t used = m_pools[i]->getUsedBlocks();
+        if (used > 0) {
+            leakCount += used;
+            ESP_LOGW(TAG, "Memory leak: %d blocks of %d bytes still in use in pool %d",
+                    used, m_pools[i]->getBlockSize(), i);
+        }
     }
 
     if (leakCount > 0) {
@@ -314,24 +581,43 @@ size_t MemoryManager::checkLeaks() {
 
 void MemoryManager::printStats() {
     ESP_LOGI(TAG, "=== Memory Statistics ===");
-    ESP_LOGI(TAG, "Total allocated: %d bytes", m_totalAllocated);
-    ESP_LOGI(TAG, "Peak allocated: %d bytes", m_peakAllocated);
-    ESP_LOGI(TAG, "Active allocations: %d", m_activeBlocks.size());
-    ESP_LOGI(TAG, "Total allocations: %d", m_allocationCount);
-    ESP_LOGI(TAG, "Total deallocations: %d", m_deallocationCount);
+    ESP_LOGI(TAG, "Total allocated: %d bytes", getTotalAllocated());
+    ESP_LOGI(TAG, "Peak allocated: %d bytes", getPeakAllocated());
+    ESP_LOGI(TAG, "Active allocations: %d", getActiveAllocations());
+    if (m_trackingOverflows > 0) {
+        ESP_LOGI(TAG, "Tracking table overflows: %d", m_trackingOverflows);
+    }
+    ESP_LOGI(TAG, "Total allocations: %d", m_allocationCount.load());
+    ESP_LOGI(TAG, "Total deallocations: %d", m_deallocationCount.load());
+    ESP_LOGI(TAG, "Thread caches: %s", m_threadCacheEnabled ? "enabled" : "disabled");
+
+    ArenaStats arenaStats = getArenaStats();
+    ESP_LOGI(TAG, "Arenas: %d/%d bytes used, peak %d bytes, %d app arenas",
+            arenaStats.used, arenaStats.capacity, arenaStats.peakUsed, m_appArenas.size());
+
+    if (m_relocatableHeap) {
+        RelocatableHeapStats relocStats = m_relocatableHeap->getStats();
+        ESP_LOGI(TAG, "Relocatable heap: %d/%d bytes free, largest %d, %d blocks (%d pinned), %d bytes moved",
+                relocStats.freeBytes, relocStats.capacity, relocStats.largestFreeBlock,
+                relocStats.liveBlocks, relocStats.pinnedBlocks, relocStats.bytesMoved);
+    }
     ESP_LOGI(TAG, "Free heap: %d bytes", getFreeHeap());
     ESP_LOGI(TAG, "Largest free block: %d bytes", getLargestFreeBlock());
 
     ESP_LOGI(TAG, "=== Pool Statistics ===");
     for (size_t i = 0; i < m_pools.size(); i++) {
         auto& pool = m_pools[i];
-        ESP_LOGI(TAG, "Pool %d: %d/%d blocks free (%d bytes each)", 
-                i, pool->getFreeBlocks(), pool->getTotalBlocks(), pool->getBlockSize());
+        ESP_LOGI(TAG, "Pool %d: %d/%d blocks in use, %d on free list (%d bytes each, cache depth %d)",
+                i, pool->getUsedBlocks(), pool->getTotalBlocks(), pool->getFreeBlocks(),
+                pool->getBlockSize(), i < MAX_SIZE_CLASSES ? m_cacheDepth[i] : 0);
     }
 }
 
 void MemoryManager::garbageCollect() {
     ESP_LOGI(TAG, "Starting garbage collection...");
+
+    // Return this thread's cached blocks first - flushing takes the mutex itself
+    flushThreadCache();
     
     // Thread safety
     if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
@@ -346,17 +632,21 @@ void MemoryManager::garbageCollect() {
     uint32_t currentTime = millis();
     size_t reclaimedMemory = 0;
     
-    auto it = m_activeBlocks.begin();
-    while (it != m_activeBlocks.end()) {
+    m_heapBlocks.forEach([&](const MemoryBlock& block) {
         // Check for very old allocations that might be leaks
-        if (currentTime - it->timestamp > 300000) { // 5 minutes
+        if (currentTime - block.timestamp > 300000) { // 5 minutes
             ESP_LOGW(TAG, "Potential leak: %d bytes at %p, age %d ms (%s:%d)",
-                    it->size, it->ptr, currentTime - it->timestamp,
-                    it->file ? it->file : "unknown", it->line);
+                    block.size, block.ptr, currentTime - block.timestamp,
+                    block.file ? block.file : "unknown", block.line);
         }
-        ++it;
-    }
+    });
     
+    // Close the holes in the relocatable heap (guarded by its own mutex)
+    size_t compacted = compactRelocatable(0);
+    if (compacted > 0) {
+        ESP_LOGI(TAG, "Compacted relocatable heap: %d bytes moved", compacted);
+    }
+
     // Force heap compaction if available
     #ifdef CONFIG_HEAP_TASK_TRACKING
     heap_caps_check_integrity_all(true);
@@ -434,9 +724,7 @@ void* MemoryManager::allocateDMA(size_t size, size_t alignment) {
         block.inUse = true;
         
         if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            m_activeBlocks.push_back(block);
-            m_totalAllocated += size;
-            m_allocationCount++;
+            trackHeapBlock(block);
             xSemaphoreGive(m_mutex);
         }
         
@@ -446,26 +734,61 @@ void* MemoryManager::allocateDMA(size_t size, size_t alignment) {
     return ptr;
 }
 
-std::vector<MemoryBlock>::iterator MemoryManager::findBlock(void* ptr) {
-    return std::find_if(m_activeBlocks.begin(), m_activeBlocks.end(),
-                       [ptr](const MemoryBlock& block) {
-                           return block.ptr == ptr;
-                       });
+size_t MemoryManager::trackedSize(void* ptr, size_t requested) const {
+    // Release builds keep no per-pointer size, so both sides of the
+    // accounting use the heap's own view of the block
+    if (HeapTracker::enabled) {
+        return requested;
+    }
+    return heap_caps_get_allocated_size(ptr);
+}
+
+void MemoryManager::trackHeapBlock(const MemoryBlock& block) {
+    if (m_heapBlocks.insert(block)) {
+        recordAllocation(trackedSize(block.ptr, block.size));
+        return;
+    }
+
+    // Overflow blocks carry no metadata, so both sides of their
+    // accounting use the heap's own view of the block
+    if (m_trackingOverflows++ == 0) {
+        ESP_LOGW(TAG, "Allocation tracking table full (%d entries), tracking overflow blocks by pointer only",
+                HeapTracker::capacity());
+    }
+    m_untrackedBlocks.insert(block.ptr);
+    recordAllocation(heap_caps_get_allocated_size(block.ptr));
+}
+
+bool MemoryManager::untrackHeapBlock(void* ptr, size_t& size) {
+    MemoryBlock block;
+    if (m_heapBlocks.remove(ptr, &block)) {
+        size = HeapTracker::enabled ? block.size : trackedSize(ptr, 0);
+        return true;
+    }
+    if (m_untrackedBlocks.erase(ptr) > 0) {
+        size = heap_caps_get_allocated_size(ptr);
+        return true;
+    }
+    return false;
 }
 
 void MemoryManager::optimizeForRealtime() {
     ESP_LOGI(TAG, "Optimizing memory manager for real-time performance");
     
     // Pre-allocate pools to avoid allocation during runtime
+    std::vector<void*> blocks;
     for (auto& pool : m_pools) {
-        // Pre-touch all pool memory
-        for (size_t i = 0; i < pool->getTotalBlocks(); i++) {
-            void* ptr = pool->allocate();
-            if (ptr) {
-                // Touch the memory to ensure it's mapped
-                memset(ptr, 0, pool->getBlockSize());
-                pool->deallocate(ptr);
-            }
+        // Drain the pool so every block gets touched, not just the free-list head
+        blocks.clear();
+        blocks.reserve(pool->getTotalBlocks());
+        while (void* ptr = pool->allocate()) {
+            // Touch the memory to ensure it's mapped
+            memset(ptr, 0, pool->getBlockSize());
+            blocks.push_back(ptr);
+        }
+        // Return in reverse so the free list is rebuilt in address order
+        for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+            pool->deallocate(*it);
         }
     }
     
@@ -473,4 +796,102 @@ void MemoryManager::optimizeForRealtime() {
     garbageCollect();
     
     ESP_LOGI(TAG, "Real-time optimization complete");
-}
\ No newline at end of file
+}
+
+MemoryArena* MemoryManager::getAppArena(const std::string& appId) {
+    if (!m_initialized) {
+        return nullptr;
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return nullptr;
+    }
+
+    auto& arena = m_appArenas[appId];
+    if (!arena) {
+        // Arena names must outlive the arena; the map key does
+        auto it = m_appArenas.find(appId);
+        arena = std::make_unique<MemoryArena>(it->first.c_str(), OS_APP_ARENA_CHUNK_SIZE,
+                                              MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        ESP_LOGD(TAG, "Created arena for app '%s'", appId.c_str());
+    }
+    MemoryArena* result = arena.get();
+
+    xSemaphoreGive(m_mutex);
+    return result;
+}
+
+size_t MemoryManager::getAppArenaUsage(const std::string& appId) {
+    if (!m_initialized) {
+        return 0;
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+
+    // Look up only; reporting must not create arenas
+    auto it = m_appArenas.find(appId);
+    size_t used = it != m_appArenas.end() ? it->second->getUsed() : 0;
+
+    xSemaphoreGive(m_mutex);
+    return used;
+}
+
+void MemoryManager::releaseAppArena(const std::string& appId) {
+    if (!m_initialized) {
+        return;
+    }
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+
+    auto it = m_appArenas.find(appId);
+    if (it != m_appArenas.end()) {
+        const ArenaStats& stats = it->second->getStats();
+        ESP_LOGD(TAG, "Releasing arena for app '%s' (peak %d bytes)", appId.c_str(), stats.peakUsed);
+
+        m_releasedArenaStats.allocationCount += stats.allocationCount;
+        m_releasedArenaStats.resetCount += stats.resetCount;
+        m_releasedArenaStats.chunkAllocations += stats.chunkAllocations;
+        m_appArenas.erase(it);
+    }
+
+    xSemaphoreGive(m_mutex);
+}
+
+size_t MemoryManager::compactRelocatable(uint32_t budgetUs) {
+    if (!m_relocatableHeap || !m_relocatableHeap->isFragmented()) {
+        return 0;
+    }
+    return m_relocatableHeap->compact(budgetUs);
+}
+
+void MemoryManager::endFrame() {
+    m_frameArena.reset();
+}
+
+ArenaStats MemoryManager::getArenaStats() const {
+    ArenaStats total = m_releasedArenaStats;
+
+    auto accumulate = [&total](const ArenaStats& stats) {
+        total.used += stats.used;
+        total.peakUsed += stats.peakUsed;
+        total.capacity += stats.capacity;
+        total.allocationCount += stats.allocationCount;
+        total.resetCount += stats.resetCount;
+        total.chunkAllocations += stats.chunkAllocations;
+    };
+
+    accumulate(m_frameArena.getStats());
+
+    if (m_mutex && xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (const auto& entry : m_appArenas) {
+            accumulate(entry.second->getStats());
+        }
+        xSemaphoreGive(m_mutex);
+    }
+
+    return total;
+}
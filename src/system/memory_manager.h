@@ -2,10 +2,19 @@
 #define MEMORY_MANAGER_H
 
 #include "os_config.h"
+#include "allocation_tracker.h"
+#include "memory_arena.h"
+#include "relocatable_heap.h"
+#include "allocation_profiler.h"
 #include <vector>
+#include <map>
+#include <unordered_set>
+#include <string>
 #include <memory>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <esp_heap_caps.h>
 
 /**
  * @file memory_manager.h
@@ -15,35 +24,99 @@
  * with debugging and leak detection capabilities.
  */
 
-struct MemoryBlock {
-    void* ptr;
-    size_t size;
-    uint32_t timestamp;
-    const char* file;
-    int line;
-    bool inUse;
-};
-
+/**
+ * @brief Fixed-size block pool with O(1) allocate/deallocate
+ *
+ * Free blocks are chained through an intrusive singly linked list stored
+ * in the blocks themselves, so allocation pops the head and deallocation
+ * pushes it back. A one-bit-per-block bitmap is kept alongside the list
+ * to reject double frees and foreign pointers without scanning.
+ *
+ * The free list itself is not thread-safe and must be guarded by the
+ * owner. The bitmap is updated atomically so markUsed()/markFree() can be
+ * called lock-free by per-thread caches that hold blocks outside the list.
+ */
 class MemoryPool {
 public:
     MemoryPool(size_t blockSize, size_t blockCount);
     ~MemoryPool();
 
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
     void* allocate();
     bool deallocate(void* ptr);
+
+    /**
+     * @brief Pop up to maxCount blocks off the free list without marking them used
+     * @param blocks Output array for block pointers
+     * @param maxCount Maximum number of blocks to take
+     * @return Number of blocks taken
+     */
+    size_t takeBatch(void** blocks, size_t maxCount);
+
+    /**
+     * @brief Push blocks previously taken with takeBatch() back on the free list
+     * @param blocks Block pointers (must be marked free)
+     * @param count Number of blocks
+     */
+    void returnBatch(void* const* blocks, size_t count);
+
+    /**
+     * @brief Atomically mark a block as handed out to a caller
+     * @param ptr Block pointer
+     * @return false if the block was already marked used
+     */
+    bool markUsed(void* ptr);
+
+    /**
+     * @brief Atomically mark a block as released by its caller
+     * @param ptr Block pointer
+     * @return false on double free, misaligned or foreign pointer
+     */
+    bool markFree(void* ptr);
+
+    /**
+     * @brief Check whether a pointer lies inside this pool's storage
+     * @param ptr Pointer to check
+     * @return true if ptr points into the pool's block range
+     */
+    bool owns(const void* ptr) const;
+
     size_t getBlockSize() const { return m_blockSize; }
     size_t getFreeBlocks() const { return m_freeBlocks; }
     size_t getTotalBlocks() const { return m_totalBlocks; }
+    size_t getUsedBlocks() const { return m_usedBlocks.load(std::memory_order_relaxed); }
 
 private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    /**
+     * @brief Map a pointer to its block index
+     * @return Block index or SIZE_MAX if ptr is not a block start
+     */
+    size_t blockIndex(const void* ptr) const;
+
     size_t m_blockSize;
     size_t m_totalBlocks;
     size_t m_freeBlocks;
     void* m_memory;
-    std::vector<bool> m_blockUsed;
+    FreeNode* m_freeList = nullptr;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_usedBitmap; // Double-free detection, 1 bit per block
+    std::atomic<size_t> m_usedBlocks{0};
     uint32_t m_memoryType; // Memory capability flags
 };
 
+/**
+ * @brief System memory manager
+ *
+ * Requests that fit one of the fixed-size pools are served from
+ * per-thread size-class caches without touching the mutex; caches are
+ * refilled from and flushed to the shared pools in batches. Larger
+ * requests go to the heap under the mutex and are tracked per block.
+ */
 class MemoryManager {
 public:
     MemoryManager() = default;
@@ -86,23 +159,50 @@ public:
      */
     bool deallocateFromPool(void* ptr, size_t poolIndex);
 
+    /**
+     * @brief Return the calling thread's cached pool blocks to the shared pools
+     *
+     * Thread caches are flushed automatically when a pthread exits, but
+     * FreeRTOS tasks created with xTaskCreate() do not run thread_local
+     * destructors, so such tasks should call this before deleting themselves.
+     */
+    void flushThreadCache();
+
+    /**
+     * @brief Enable/disable per-thread size-class caches
+     * @param enabled false routes every pool allocation through the mutex
+     */
+    void setThreadCacheEnabled(bool enabled) { m_threadCacheEnabled = enabled; }
+
+    /**
+     * @brief Check if per-thread size-class caches are enabled
+     * @return true if enabled
+     */
+    bool isThreadCacheEnabled() const { return m_threadCacheEnabled; }
+
     /**
      * @brief Get total allocated memory
      * @return Total allocated memory in bytes
      */
-    size_t getTotalAllocated() const { return m_totalAllocated; }
+    size_t getTotalAllocated() const { return m_totalAllocated.load(std::memory_order_relaxed); }
 
     /**
      * @brief Get peak allocated memory
      * @return Peak allocated memory in bytes
      */
-    size_t getPeakAllocated() const { return m_peakAllocated; }
+    size_t getPeakAllocated() const { return m_peakAllocated.load(std::memory_order_relaxed); }
 
     /**
      * @brief Get number of active allocations
-     * @return Number of active allocations
+     * @return Number of active allocations (pool blocks and heap blocks)
+     */
+    size_t getActiveAllocations() const;
+
+    /**
+     * @brief Get number of heap allocations made while the tracking table was full
+     * @return Overflow allocations since initialization
      */
-    size_t getActiveAllocations() const { return m_activeBlocks.size(); }
+    uint32_t getTrackingOverflows() const { return m_trackingOverflows; }
 
     /**
      * @brief Check for memory leaks
@@ -169,13 +269,156 @@ public:
      */
     void optimizeForRealtime();
 
+    /**
+     * @brief Get the per-frame scratch arena
+     *
+     * Reset by endFrame() at the end of every OSManager::update(); only
+     * use it from the main loop and never keep pointers across frames.
+     * @return Frame arena
+     */
+    MemoryArena& getFrameArena() { return m_frameArena; }
+
+    /**
+     * @brief Get (creating on first use) the scratch arena of an application
+     * @param appId Application identifier
+     * @return App arena or nullptr if not initialized
+     */
+    MemoryArena* getAppArena(const std::string& appId);
+
+    /**
+     * @brief Get the bytes in use in an application's arena
+     * @param appId Application identifier
+     * @return Bytes in use, 0 if the app has no arena
+     */
+    size_t getAppArenaUsage(const std::string& appId);
+
+    /**
+     * @brief Free an application's arena (called when the app is stopped)
+     * @param appId Application identifier
+     */
+    void releaseAppArena(const std::string& appId);
+
+    /**
+     * @brief Reset the frame arena, invalidating this frame's scratch memory
+     */
+    void endFrame();
+
+    /**
+     * @brief Get the relocatable (compactable) PSRAM heap
+     *
+     * For large long-lived buffers that can tolerate being moved while
+     * unpinned; see RelocatableHeap and PinnedBlock.
+     * @return Relocatable heap or nullptr if not initialized
+     */
+    RelocatableHeap* getRelocatableHeap() { return m_relocatableHeap.get(); }
+
+    /**
+     * @brief Run one compaction slice on the relocatable heap
+     * @param budgetUs Time budget in microseconds (0 = run to completion)
+     * @return Bytes moved
+     */
+    size_t compactRelocatable(uint32_t budgetUs);
+
+    /**
+     * @brief Get the sampling allocation profiler (off until started)
+     * @return Allocation profiler
+     */
+    AllocationProfiler& getProfiler() { return m_profiler; }
+
+    /**
+     * @brief Get combined statistics of the frame arena and all app arenas
+     * @return Aggregated arena statistics (peak is the sum of per-arena peaks)
+     */
+    ArenaStats getArenaStats() const;
+
 private:
+    static constexpr size_t MAX_SIZE_CLASSES = 8;
+    static constexpr size_t THREAD_CACHE_MAX_DEPTH = 16;
+
+    struct SizeClassCache {
+        void* blocks[THREAD_CACHE_MAX_DEPTH];
+        uint8_t count = 0;
+    };
+
+    struct ThreadCache {
+        MemoryManager* owner = nullptr;
+        uint32_t ownerId = 0;
+        std::weak_ptr<void> ownerAlive;
+        SizeClassCache classes[MAX_SIZE_CLASSES];
+        ~ThreadCache();
+    };
+
+    /**
+     * @brief Get the calling thread's cache, rebinding it to this manager if needed
+     */
+    ThreadCache& threadCache();
+
+    /**
+     * @brief Return every block held by a thread cache to the shared pools
+     * @param cache Cache to flush (must not be called with m_mutex held)
+     */
+    void flushCache(ThreadCache& cache);
+
+    /**
+     * @brief Allocate a block from the given size class or a larger one
+     * @param classIndex Smallest pool index whose block size fits the request
+     * @return Block pointer or nullptr if all fitting pools are exhausted
+     */
+    void* allocatePooled(size_t classIndex);
+
     /**
-     * @brief Find memory block by pointer
-     * @param ptr Pointer to find
-     * @return Iterator to block or end() if not found
+     * @brief Release a pool block to the calling thread's cache or its pool
+     * @param ptr Block pointer
+     * @param poolIndex Owning pool index
+     * @return false on double free or invalid pointer
      */
-    std::vector<MemoryBlock>::iterator findBlock(void* ptr);
+    bool deallocatePooled(void* ptr, size_t poolIndex);
+
+    /**
+     * @brief Find the smallest pool whose block size fits a request
+     * @return Pool index or m_pools.size() if none fits
+     */
+    size_t findSizeClass(size_t size) const;
+
+    /**
+     * @brief Find the pool whose storage contains a pointer
+     * @return Pool index or m_pools.size() if ptr is not pool memory
+     */
+    size_t findOwningPool(const void* ptr) const;
+
+    /**
+     * @brief Account for an allocation in the global counters
+     */
+    void recordAllocation(size_t size);
+
+    /**
+     * @brief Account for a deallocation in the global counters
+     */
+    void recordDeallocation(size_t size);
+
+    /**
+     * @brief Size used for heap accounting of a block
+     * @param ptr Heap block
+     * @param requested Requested size (used when the tracking table is enabled)
+     * @return Requested size, or the heap's allocated size when tracking is compiled out
+     */
+    size_t trackedSize(void* ptr, size_t requested) const;
+
+    /**
+     * @brief Record a new heap block in the tracking table (mutex held)
+     *
+     * If the table is full the block is kept in the overflow set instead,
+     * so the caller still gets its memory.
+     */
+    void trackHeapBlock(const MemoryBlock& block);
+
+    /**
+     * @brief Remove a heap block from tracking (mutex held)
+     * @param ptr Heap block
+     * @param size Receives the accounted size of the block
+     * @return false if the manager did not allocate ptr
+     */
+    bool untrackHeapBlock(void* ptr, size_t& size);
 
     /**
      * @brief Update memory statistics
@@ -187,17 +430,38 @@ private:
      */
     void updateFragmentationStats();
 
-    // Memory tracking
-    std::vector<MemoryBlock> m_activeBlocks;
-    size_t m_totalAllocated = 0;
-    size_t m_peakAllocated = 0;
-    uint32_t m_allocationCount = 0;
-    uint32_t m_deallocationCount = 0;
+    // Heap allocation tracking (pool blocks are counted by their pool);
+    // compiled down to a counter when OS_ALLOCATION_TRACKING is off
+    using HeapTracker = AllocationTracker<OS_ALLOCATION_TRACKING != 0, OS_MAX_TRACKED_ALLOCATIONS>;
+    HeapTracker m_heapBlocks;
+    std::unordered_set<void*> m_untrackedBlocks; // Heap blocks that did not fit in the table
+    uint32_t m_trackingOverflows = 0;
+    std::atomic<size_t> m_totalAllocated{0};
+    std::atomic<size_t> m_peakAllocated{0};
+    std::atomic<uint32_t> m_allocationCount{0};
+    std::atomic<uint32_t> m_deallocationCount{0};
 
     // Memory pools for common sizes
     std::vector<std::unique_ptr<MemoryPool>> m_pools;
     bool m_initialized = false;
+
+    // Per-thread size-class caches
+    size_t m_cacheDepth[MAX_SIZE_CLASSES] = {};
+    bool m_threadCacheEnabled = true;
+    uint32_t m_instanceId = 0;
+    std::shared_ptr<void> m_lifetimeToken; // Lets exiting threads detect a destroyed manager
     
+    // Call-site profiling
+    AllocationProfiler m_profiler;
+
+    // Movable large blocks
+    std::unique_ptr<RelocatableHeap> m_relocatableHeap;
+
+    // Scratch arenas
+    MemoryArena m_frameArena{"frame", OS_FRAME_ARENA_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT};
+    std::map<std::string, std::unique_ptr<MemoryArena>> m_appArenas;
+    ArenaStats m_releasedArenaStats; // Counters of app arenas that have been released
+
     // Thread safety
     SemaphoreHandle_t m_mutex = nullptr;
     
@@ -0,0 +1,119 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @file mpsc_ring.h
+ * @brief Bounded lock-free multi-producer/single-consumer ring buffer
+ *
+ * Each cell carries a sequence number that tells producers whether the
+ * slot is free for the current lap and tells the consumer whether the
+ * value has been published. Producers claim a slot with a single CAS and
+ * never wait for each other, so push() is safe from ISRs and from tasks
+ * on either core. Storage is a fixed array of preconstructed cells that
+ * are copy-assigned in place; nothing is allocated after construction, so
+ * element copies must not allocate either.
+ */
+
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscRing capacity must be a power of two");
+    static_assert(std::is_default_constructible<T>::value && std::is_copy_assignable<T>::value,
+                  "MpscRing elements are assigned into preconstructed cells");
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < Capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * @brief Append an element (any producer, ISR-safe)
+     *
+     * Always inlined so an IRAM_ATTR caller keeps the whole ISR path in IRAM.
+     * @param value Element to copy in
+     * @return false if the ring is full
+     */
+    __attribute__((always_inline)) inline bool push(const T& value) {
+        size_t position = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell = &m_cells[position & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (lap == 0) {
+                if (m_enqueuePos.compare_exchange_weak(position, position + 1,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lap < 0) {
+                return false;  // Consumer has not released this slot yet
+            } else {
+                position = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (single consumer only)
+     *
+     * Returns false if the next slot is claimed but not yet published,
+     * even when later slots are ready; ordering is preserved.
+     * @param value Receives the element
+     * @return false if nothing is ready
+     */
+    bool pop(T& value) {
+        size_t position = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[position & (Capacity - 1)];
+
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(position + Capacity, std::memory_order_release);
+        m_dequeuePos.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued elements
+     * @return Claimed but not yet consumed slots
+     */
+    size_t size() const {
+        size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Cell m_cells[Capacity];
+    std::atomic<size_t> m_enqueuePos{0};
+    std::atomic<size_t> m_dequeuePos{0};
+};
+
+#endif // MPSC_RING_H
@@ -23,9 +23,15 @@
 #define OS_APP_STACK_SIZE       32768  // Increased for complex apps
 #define OS_SYSTEM_HEAP_SIZE     (3 * 1024 * 1024)   // 3MB for system
 #define OS_APP_HEAP_SIZE        (6 * 1024 * 1024)   // 6MB for apps
+#define OS_APP_CPU_BUDGET_PERCENT 60   // Main-loop CPU all apps may use before background apps are paused
+#define OS_ACCOUNTING_WINDOW_MS  1000  // Per-app CPU% and allocations/s window
 #define OS_BUFFER_POOL_SIZE     (2 * 1024 * 1024)   // 2MB for buffers
 #define OS_AUDIO_BUFFER_SIZE    (512 * 1024)        // 512KB for audio
 #define OS_GRAPHICS_BUFFER_SIZE (4 * 1024 * 1024)   // 4MB for graphics
+#define OS_FRAME_ARENA_SIZE     (64 * 1024)         // 64KB per-frame scratch - Internal RAM
+#define OS_APP_ARENA_CHUNK_SIZE (128 * 1024)        // 128KB per-app scratch chunks - PSRAM
+#define OS_RELOCATABLE_HEAP_SIZE (4 * 1024 * 1024)  // 4MB movable blocks (tiles, canvases) - PSRAM
+#define OS_RELOCATABLE_MAX_HANDLES 512
 
 // PSRAM Configuration
 #define OS_PSRAM_HEAP_SIZE      (16 * 1024 * 1024)  // 16MB PSRAM heap
@@ -39,15 +45,33 @@
 #define OS_TASK_PRIORITY_NORMAL 2         // Normal priority tasks
 #define OS_TASK_PRIORITY_LOW    1         // Low priority tasks
 #define OS_TASK_PRIORITY_IDLE   0         // Idle tasks
+#define OS_TASK_FUNCTION_CAPACITY (8 * sizeof(void*))  // Inline capture space per task callable
 
 // Real-time task configuration
 #define OS_REALTIME_TASK_MAX_RUNTIME 5    // 5ms max for RT tasks
 #define OS_FRAME_TIME_BUDGET_US  13000    // 13ms frame budget (60Hz)
+#define OS_IDLE_SLICE_MIN_US     500      // Skip idle work with less slack than this
+#define OS_IDLE_SLICE_MAX_US     2000     // Cap on idle work per frame
 #define OS_TASK_WATCHDOG_TIMEOUT 30000    // 30s watchdog timeout
+#define OS_EDF_UTILIZATION_BOUND 70       // Percent of the main loop admitted to EDF tasks
+#define OS_EDF_OVERRUN_BUDGET    3        // Consecutive overruns before an EDF task is demoted
+
+// Work-stealing executor - one worker per core
+#define OS_EXECUTOR_WORKERS      2
+#define OS_EXECUTOR_QUEUE_DEPTH  128      // Jobs per worker deque
+#define OS_EXECUTOR_STACK_SIZE   8192
+#define OS_EXECUTOR_PRIORITY     5        // FreeRTOS priority of worker threads
+#define OS_JOB_FUNCTION_CAPACITY (OS_TASK_FUNCTION_CAPACITY + 8 * sizeof(void*))  // Inline capture space per job
+#define OS_OFFLOAD_DRAIN_TIMEOUT_MS 1000  // Scheduler shutdown wait for offloaded task runs
+
+// Coroutine tasks
+#define OS_MAX_ASYNC_TASKS       16
+#define OS_ASYNC_WAKEUP_QUEUE_SIZE 32     // Must be a power of two (lock-free ring)
 
 // Event System Configuration - Increased for HD display
 #define OS_MAX_EVENT_LISTENERS  64
-#define OS_EVENT_QUEUE_SIZE     128
+#define OS_EVENT_QUEUE_SIZE     128      // Must be a power of two (lock-free ring)
+#define OS_EVENT_COALESCE_SLOTS 16       // Event types that can be coalesced
 
 // Touch Configuration
 #define OS_TOUCH_THRESHOLD      10
@@ -92,6 +116,12 @@
 #define OS_LOG_LEVEL            1
 #endif
 
+// Per-allocation file/line tracking follows the debug build unless overridden
+#ifndef OS_ALLOCATION_TRACKING
+#define OS_ALLOCATION_TRACKING  OS_DEBUG_ENABLED
+#endif
+#define OS_MAX_TRACKED_ALLOCATIONS 1024  // Tracking table slots (power of two)
+
 // Version Information
 #define OS_VERSION_MAJOR        1
 #define OS_VERSION_MINOR        0
@@ -158,6 +188,13 @@ typedef struct {
     void* data;                 // Additional event data
 } input_event_t;
 
+// LVGL draw buffer layouts (DisplayHAL::setDrawBufferMode)
+typedef enum {
+    DRAW_BUFFER_PARTIAL,        // Strips of OS_DRAW_BUFFER_LINES lines in internal SRAM
+    DRAW_BUFFER_FULL,           // Two full-screen PSRAM buffers, whole screen redrawn every frame
+    DRAW_BUFFER_DIRECT          // Two full-screen PSRAM buffers, dirty areas redrawn in place
+} draw_buffer_mode_t;
+
 // Forward declarations
 class OSManager;
 class AppManager;
@@ -175,6 +212,24 @@ class PowerManager;
 #define OS_ENABLE_MEMORY_TRACKING       1
 #define OS_ENABLE_TASK_PROFILING        1
 #define OS_ENABLE_POWER_MONITORING      1
+#define OS_ENABLE_TRACING               1    // Compile in PERF_TRACE_* markers
+#define OS_PERF_HISTORY_SIZE            60   // Monitor samples kept (1 minute at 1Hz)
+#define OS_FRAME_HISTORY_SIZE           120  // Scheduler frame times kept (2s at 60Hz)
+
+// Trace capture
+#define OS_TRACE_CORES                  2
+#define OS_TRACE_EVENTS_PER_CORE        512  // Must be a power of two (lock-free ring), drained every frame
+#define OS_TRACE_CAPTURE_EVENTS         16384 // Default capture length (~0.5 MB in PSRAM)
+
+// Closed-loop tuning (PerformanceIntegration AUTO mode)
+#define OS_AUTO_TUNE_INTERVAL_MS        250  // Controller evaluation period
+#define OS_DRAW_BUFFER_LINES            20   // Default LVGL draw buffer height
+#define OS_MAX_BACKGROUND_THROTTLE      90   // Percent; low-priority tasks always make some progress
+
+// Frame pacing (OSManager::update)
+#define OS_FRAME_PACING                 1    // Sleep to the next frame boundary instead of running flat out
+#define OS_FRAME_PERIOD_US              (1000000 / OS_UI_REFRESH_RATE)
+#define OS_FRAME_MAX_DEFER              8    // Frames a deferrable phase may be skipped before it is forced
 
 // Audio performance configuration
 #define OS_AUDIO_SAMPLE_RATE            44100
@@ -188,6 +243,9 @@ class PowerManager;
 #define OS_DISPLAY_DMA_ENABLED          1    // DMA acceleration
 #define OS_DISPLAY_CACHE_ENABLED        1    // Display caching
 #define OS_DISPLAY_VSYNC_TIMEOUT        20   // VSync timeout ms
+#define OS_FLUSH_TIMEOUT_MS             100  // Longest LVGL waits for a flush transfer before giving up
+#define OS_DISPLAY_AREA_MERGING         1    // Tile-align and merge invalidated areas before rendering
+#define OS_DRAW_BUFFER_MODE             DRAW_BUFFER_PARTIAL  // Layout at boot; full-screen modes use OS_DISPLAY_BUFFER_SIZE
 
 // ESP32-P4 PPA (Pixel Processing Accelerator) Configuration
 #define CONFIG_ESP_PPA_ACCELERATION         1       // Enable PPA hardware acceleration
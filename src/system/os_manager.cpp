@@ -1,4 +1,7 @@
 #include "os_manager.h"
+#include "trace_recorder.h"
+#include "resource_accountant.h"
+#include "boot_sequencer.h"
 #include <esp_log.h>
 #include <esp_task_wdt.h>
 
@@ -60,6 +63,10 @@ os_error_t OSManager::shutdown() {
     m_running = false;
 
     // Shutdown subsystems in reverse order
+    if (m_performanceIntegration) {
+        g_performanceIntegration = nullptr;
+        m_performanceIntegration->shutdown();
+    }
     if (m_serviceManager) {
         m_serviceManager->shutdown();
     }
@@ -69,12 +76,21 @@ os_error_t OSManager::shutdown() {
     if (m_uiManager) {
         m_uiManager->shutdown();
     }
+    if (m_powerManager) {
+        m_powerManager->shutdown();
+    }
     if (m_halManager) {
         m_halManager->shutdown();
     }
+    if (m_asyncRuntime) {
+        m_asyncRuntime->shutdown();
+    }
     if (m_taskScheduler) {
         m_taskScheduler->shutdown();
     }
+    if (m_jobExecutor) {
+        m_jobExecutor->shutdown();
+    }
 
     ESP_LOGI(TAG, "OS shutdown complete");
     return OS_OK;
@@ -98,30 +114,88 @@ os_error_t OSManager::update() {
     // Feed watchdog
     feedWatchdog();
 
-    // Update subsystems
-    if (m_taskScheduler) {
-        m_taskScheduler->update(deltaTime);
+    m_framePacer.beginFrame(deltaTime);
+    uint32_t phaseDelta = 0;
+
+    {
+        PERF_TRACE_SCOPE("frame");
+
+        // Critical phases always run; apps and services are deferred to a
+        // later frame when what is left of this one would not fit them
+        if (m_taskScheduler && m_framePacer.beginPhase(FramePhase::SCHEDULER, phaseDelta)) {
+            PERF_TRACE_SCOPE("scheduler");
+            m_taskScheduler->update(phaseDelta);
+            m_framePacer.endPhase(FramePhase::SCHEDULER);
+        }
+
+        if (m_eventSystem && m_framePacer.beginPhase(FramePhase::EVENTS, phaseDelta)) {
+            PERF_TRACE_SCOPE("events");
+            m_eventSystem->processEvents();
+            m_framePacer.endPhase(FramePhase::EVENTS);
+        }
+
+        if (m_halManager && m_framePacer.beginPhase(FramePhase::HAL, phaseDelta)) {
+            PERF_TRACE_SCOPE("hal");
+            m_halManager->update(phaseDelta);
+            if (m_powerManager) {
+                m_powerManager->update(phaseDelta);
+            }
+            m_framePacer.endPhase(FramePhase::HAL);
+        }
+
+        if (m_uiManager && m_framePacer.beginPhase(FramePhase::UI, phaseDelta)) {
+            PERF_TRACE_SCOPE("ui");
+            m_uiManager->update(phaseDelta);
+            m_framePacer.endPhase(FramePhase::UI);
+        }
+
+        if (m_appManager && m_framePacer.beginPhase(FramePhase::APPS, phaseDelta)) {
+            PERF_TRACE_SCOPE("apps");
+            m_appManager->update(phaseDelta);
+            m_framePacer.endPhase(FramePhase::APPS);
+        }
+
+        if (m_serviceManager && m_framePacer.beginPhase(FramePhase::SERVICES, phaseDelta)) {
+            PERF_TRACE_SCOPE("services");
+            m_serviceManager->update(phaseDelta);
+            m_framePacer.endPhase(FramePhase::SERVICES);
+        }
+
+        // Performance mode and AUTO tuning; update() rate-limits itself
+        if (m_performanceIntegration) {
+            m_performanceIntegration->update(deltaTime);
+        }
+
+        // Frame scratch memory is only valid for the frame that allocated it
+        if (m_memoryManager) {
+            m_memoryManager->endFrame();
+        }
+
+        // Per-app frame costs and CPU/allocation rates
+        ResourceAccountant::getInstance().endFrame();
     }
 
-    if (m_eventSystem) {
-        m_eventSystem->processEvents();
+    // Move this frame's trace markers out of the per-core rings
+    TraceRecorder& tracer = TraceRecorder::getInstance();
+    if (tracer.isCapturing()) {
+        tracer.collect();
     }
 
-    if (m_halManager) {
-        m_halManager->update(deltaTime);
-    }
-
-    if (m_uiManager) {
-        m_uiManager->update(deltaTime);
-    }
+    uint32_t sleepUs = m_framePacer.endFrame();
 
-    if (m_appManager) {
-        m_appManager->update(deltaTime);
+    // Background work (heap compaction) only gets what the frame left over
+    if (m_taskScheduler && m_taskScheduler->runIdle(sleepUs) > 0) {
+        sleepUs = m_framePacer.getRemainingUs();
     }
 
-    if (m_serviceManager) {
-        m_serviceManager->update(deltaTime);
-    }
+#if OS_FRAME_PACING
+    // Whole ticks only, the remainder is absorbed by the next frame's deadline;
+    // always yield at least one tick so the idle task can feed the watchdog
+    TickType_t sleepTicks = sleepUs / (portTICK_PERIOD_MS * 1000);
+    vTaskDelay(sleepTicks > 0 ? sleepTicks : 1);
+#else
+    (void)sleepUs;
+#endif
 
     return OS_OK;
 }
@@ -136,46 +210,135 @@ os_error_t OSManager::initializeSubsystems() {
         return OS_ERROR_GENERIC;
     }
 
-    // Task Scheduler
-    m_taskScheduler = new TaskScheduler();
-    if (!m_taskScheduler || m_taskScheduler->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Task Scheduler");
+    // Job Executor (one worker per core; runs the boot stages below)
+    m_jobExecutor = new JobExecutor();
+    if (!m_jobExecutor || m_jobExecutor->initialize() != OS_OK) {
+        ESP_LOGE(TAG, "Failed to initialize Job Executor");
         return OS_ERROR_GENERIC;
     }
 
-    // Event System
-    m_eventSystem = new EventSystem();
-    if (!m_eventSystem || m_eventSystem->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Event System");
-        return OS_ERROR_GENERIC;
-    }
+    // Everything else comes up as a dependency graph: stages whose
+    // dependencies are done run concurrently on the executor's workers,
+    // LVGL stages on this thread, and the UI is drawn as soon as the
+    // display and touch are ready rather than after storage and services
+    BootSequencer boot;
+
+    // Task Scheduler
+    boot.addStage("scheduler", [this]() {
+        m_taskScheduler = new TaskScheduler();
+        if (!m_taskScheduler || m_taskScheduler->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Task Scheduler");
+            return OS_ERROR_GENERIC;
+        }
+        m_taskScheduler->setExecutor(m_jobExecutor);
+
+        // Defragment relocatable PSRAM blocks in the slack after each frame
+        m_taskScheduler->addIdleHandler([this](uint32_t budgetUs) {
+            m_memoryManager->compactRelocatable(budgetUs);
+        }, "mem_compact");
+        return OS_OK;
+    });
+
+    // Event System (HAL drivers publish while initializing)
+    boot.addStage("events", [this]() {
+        m_eventSystem = new EventSystem();
+        if (!m_eventSystem || m_eventSystem->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Event System");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {}, BootThread::MAIN);
+
+    // Coroutine runtime (resumed by the scheduler, waits on events and workers)
+    boot.addStage("async", [this]() {
+        m_asyncRuntime = new AsyncRuntime();
+        if (!m_asyncRuntime ||
+            m_asyncRuntime->initialize(*m_taskScheduler, m_eventSystem, m_jobExecutor) != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Async Runtime");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"scheduler", "events"});
 
-    // Hardware Abstraction Layer
+    // Hardware Abstraction Layer: one stage per component, then "hal"
     m_halManager = new HALManager();
-    if (!m_halManager || m_halManager->initialize() != OS_OK) {
+    if (!m_halManager || m_halManager->addBootStages(boot, {"events"}) != OS_OK) {
         ESP_LOGE(TAG, "Failed to initialize HAL Manager");
         return OS_ERROR_GENERIC;
     }
 
+    // Power Manager (power button, 5V outputs, CPU clock)
+    boot.addStage("power_manager", [this]() {
+        m_powerManager = new PowerManager();
+        if (!m_powerManager || m_powerManager->initialize(m_eventSystem) != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Power Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"events"});
+
     // UI Manager
-    m_uiManager = new UIManager();
-    if (!m_uiManager || m_uiManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize UI Manager");
-        return OS_ERROR_GENERIC;
-    }
+    boot.addStage("ui", [this]() {
+        m_uiManager = new UIManager();
+        if (!m_uiManager || m_uiManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize UI Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"display", "touch", "events"}, BootThread::MAIN);
+
+    // Push the system UI to the panel while the remaining stages finish
+    boot.addStage("first_frame", [this]() {
+        return m_halManager->getDisplay().forceRefresh();
+    }, {"ui"}, BootThread::MAIN, false);
+
+    // Application Manager. It subscribes to events, and subscribe() is not
+    // thread-safe, so it runs on the main thread like "ui"
+    boot.addStage("apps", [this]() {
+        m_appManager = new AppManager();
+        if (!m_appManager || m_appManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize App Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"events"}, BootThread::MAIN);
+
+    // Performance modes and AUTO tuning. Applying a mode resizes the LVGL
+    // draw buffers, so it runs on the main thread, after the first frame;
+    // it waits for "async" so nothing else is adding scheduler tasks
+    boot.addStage("performance", [this]() {
+        m_performanceIntegration = new PerformanceIntegration();
+        if (!m_performanceIntegration ||
+            m_performanceIntegration->initialize(m_memoryManager, m_taskScheduler,
+                                                 m_powerManager, nullptr) != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Performance Integration");
+            return OS_ERROR_GENERIC;
+        }
+        g_performanceIntegration = m_performanceIntegration;
+        return OS_OK;
+    }, {"async", "display", "power_manager"}, BootThread::MAIN);
 
-    // Application Manager
-    m_appManager = new AppManager();
-    if (!m_appManager || m_appManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize App Manager");
-        return OS_ERROR_GENERIC;
+    // Service Manager
+    boot.addStage("services", [this]() {
+        m_serviceManager = new ServiceManager();
+        if (!m_serviceManager || m_serviceManager->initialize() != OS_OK) {
+            ESP_LOGE(TAG, "Failed to initialize Service Manager");
+            return OS_ERROR_GENERIC;
+        }
+        return OS_OK;
+    }, {"events", "hal"});
+
+    os_error_t result = boot.run(m_jobExecutor);
+    boot.printTimeline();
+    if (result != OS_OK) {
+        ESP_LOGE(TAG, "Boot failed: %d", result);
+        return result;
     }
 
-    // Service Manager
-    m_serviceManager = new ServiceManager();
-    if (!m_serviceManager || m_serviceManager->initialize() != OS_OK) {
-        ESP_LOGE(TAG, "Failed to initialize Service Manager");
-        return OS_ERROR_GENERIC;
+    const BootStageRecord* firstFrame = boot.findStage("first_frame");
+    if (firstFrame && firstFrame->state == BootStageState::DONE) {
+        m_timeToFirstFrameMs = static_cast<uint32_t>(firstFrame->endUs / 1000);
+        ESP_LOGI(TAG, "Time to first frame: %lu ms", (unsigned long)m_timeToFirstFrameMs);
     }
 
     ESP_LOGI(TAG, "All subsystems initialized successfully");
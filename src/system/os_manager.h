@@ -4,7 +4,12 @@
 #include "os_config.h"
 #include "memory_manager.h"
 #include "task_scheduler.h"
+#include "job_executor.h"
 #include "event_system.h"
+#include "async_task.h"
+#include "frame_pacer.h"
+#include "power_manager.h"
+#include "performance_integration.h"
 #include "../hal/hal_manager.h"
 #include "../ui/ui_manager.h"
 #include "../apps/app_manager.h"
@@ -86,14 +91,30 @@ public:
      */
     uint8_t getCPUUsage() const { return m_cpuUsage; }
 
+    /**
+     * @brief Get the main-loop frame pacer
+     * @return Frame pacer with per-phase budgets and timings
+     */
+    FramePacer& getFramePacer() { return m_framePacer; }
+
+    /**
+     * @brief Get the time from reset until the system UI was first drawn
+     * @return Milliseconds, 0 if the first frame was not drawn during boot
+     */
+    uint32_t getTimeToFirstFrame() const { return m_timeToFirstFrameMs; }
+
     // Subsystem accessors
     MemoryManager& getMemoryManager() { return *m_memoryManager; }
     TaskScheduler& getTaskScheduler() { return *m_taskScheduler; }
+    JobExecutor& getJobExecutor() { return *m_jobExecutor; }
     EventSystem& getEventSystem() { return *m_eventSystem; }
+    AsyncRuntime& getAsyncRuntime() { return *m_asyncRuntime; }
     HALManager& getHALManager() { return *m_halManager; }
     UIManager& getUIManager() { return *m_uiManager; }
     AppManager& getAppManager() { return *m_appManager; }
     ServiceManager& getServiceManager() { return *m_serviceManager; }
+    PowerManager& getPowerManager() { return *m_powerManager; }
+    PerformanceIntegration& getPerformanceIntegration() { return *m_performanceIntegration; }
 
 private:
     OSManager() = default;
@@ -124,15 +145,21 @@ private:
     uint32_t m_lastUpdate = 0;
     uint32_t m_lastCPUCheck = 0;
     uint8_t m_cpuUsage = 0;
+    uint32_t m_timeToFirstFrameMs = 0;
+    FramePacer m_framePacer;
 
     // Subsystem managers
     MemoryManager* m_memoryManager = nullptr;
     TaskScheduler* m_taskScheduler = nullptr;
+    JobExecutor* m_jobExecutor = nullptr;
     EventSystem* m_eventSystem = nullptr;
+    AsyncRuntime* m_asyncRuntime = nullptr;
     HALManager* m_halManager = nullptr;
     UIManager* m_uiManager = nullptr;
     AppManager* m_appManager = nullptr;
     ServiceManager* m_serviceManager = nullptr;
+    PowerManager* m_powerManager = nullptr;
+    PerformanceIntegration* m_performanceIntegration = nullptr;
 };
 
 // Global accessor macro
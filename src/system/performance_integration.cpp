@@ -0,0 +1,194 @@
+#include "performance_integration.h"
+#include "os_manager.h"
+#include "../hal/display_hal.h"
+#include "../hal/power_hal.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+
+PerformanceIntegration* g_performanceIntegration = nullptr;
+
+os_error_t PerformanceIntegration::initialize(MemoryManager* memoryMgr,
+                                              TaskScheduler* taskScheduler,
+                                              PowerManager* powerMgr,
+                                              PerformanceMonitor* perfMonitor) {
+    if (m_initialized) {
+        return OS_OK;
+    }
+
+    if (!memoryMgr || !taskScheduler) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    ESP_LOGI(TAG, "Initializing Performance Integration");
+
+    m_memoryManager = memoryMgr;
+    m_taskScheduler = taskScheduler;
+    m_powerManager = powerMgr;
+    m_performanceMonitor = perfMonitor;
+    m_initialized = true;
+
+    setPerformanceMode(m_currentMode);
+
+    ESP_LOGI(TAG, "Performance Integration initialized (%s mode)",
+             getPerformanceModeString(m_currentMode));
+    return OS_OK;
+}
+
+os_error_t PerformanceIntegration::shutdown() {
+    if (!m_initialized) {
+        return OS_OK;
+    }
+
+    ESP_LOGI(TAG, "Shutting down Performance Integration");
+
+    m_memoryManager = nullptr;
+    m_taskScheduler = nullptr;
+    m_powerManager = nullptr;
+    m_performanceMonitor = nullptr;
+    m_initialized = false;
+    return OS_OK;
+}
+
+os_error_t PerformanceIntegration::update(uint32_t deltaTime) {
+    if (!m_initialized) {
+        return OS_ERROR_GENERIC;
+    }
+
+    uint32_t now = millis();
+    if (m_currentMode == SystemPerformanceMode::AUTO && m_autoTuningEnabled &&
+        now - m_lastTuningTime >= m_tuningIntervalMs) {
+        m_lastTuningTime = now;
+        performAutoTuning();
+    }
+
+    return OS_OK;
+}
+
+os_error_t PerformanceIntegration::setPerformanceMode(SystemPerformanceMode mode) {
+    if (!m_initialized) {
+        m_currentMode = mode;
+        return OS_OK;
+    }
+
+    switch (mode) {
+        case SystemPerformanceMode::POWER_SAVE:
+            applyPowerSaveOptimizations();
+            break;
+        case SystemPerformanceMode::BALANCED:
+            applyBalancedOptimizations();
+            break;
+        case SystemPerformanceMode::PERFORMANCE:
+            applyPerformanceOptimizations();
+            break;
+        case SystemPerformanceMode::REAL_TIME:
+            applyRealTimeOptimizations();
+            break;
+        case SystemPerformanceMode::AUTO:
+            // Start from the middle of the ladders and let measurements steer
+            m_autoTuner.reset();
+            applyTuning(m_autoTuner.getSettings());
+            m_lastTuningTime = millis();
+            break;
+    }
+
+    m_currentMode = mode;
+    ESP_LOGI(TAG, "Performance mode: %s", getPerformanceModeString(mode));
+    return OS_OK;
+}
+
+void PerformanceIntegration::applyPowerSaveOptimizations() {
+    TuningSettings settings;
+    settings.cpuFreqMhz = 160;
+    settings.refreshPeriodMs = 1000 / 30;
+    settings.backgroundThrottle = 50;
+    m_currentProfile.powerMode = PerformanceMode::POWER_SAVE;
+    applyTuning(settings);
+}
+
+void PerformanceIntegration::applyBalancedOptimizations() {
+    TuningSettings settings;
+    m_currentProfile.powerMode = PerformanceMode::BALANCED;
+    applyTuning(settings);
+}
+
+void PerformanceIntegration::applyPerformanceOptimizations() {
+    TuningSettings settings;
+    settings.cpuFreqMhz = 360;
+    settings.drawBufferLines = OS_DRAW_BUFFER_LINES * 2;
+    settings.drawBufferMode = DRAW_BUFFER_DIRECT;
+    m_currentProfile.powerMode = PerformanceMode::PERFORMANCE;
+    applyTuning(settings);
+}
+
+void PerformanceIntegration::applyRealTimeOptimizations() {
+    // Background work yields to the frame and real-time tasks
+    TuningSettings settings;
+    settings.cpuFreqMhz = 360;
+    settings.drawBufferLines = OS_DRAW_BUFFER_LINES * 2;
+    settings.drawBufferMode = DRAW_BUFFER_DIRECT;
+    settings.backgroundThrottle = 50;
+    m_currentProfile.powerMode = PerformanceMode::PERFORMANCE;
+    applyTuning(settings);
+}
+
+void PerformanceIntegration::performAutoTuning() {
+    TuningInputs inputs = measureTuningInputs();
+    if (!m_autoTuner.update(inputs)) {
+        return;
+    }
+
+    const TuningSettings& settings = m_autoTuner.getSettings();
+    ESP_LOGI(TAG, "Auto-tune (%.1f FPS, %.0f%% CPU, battery %d%%): %d MHz, %d ms refresh, "
+             "%d-line buffer, %d%% background throttle",
+             inputs.fps, inputs.cpuLoad, inputs.batteryPercent, settings.cpuFreqMhz,
+             settings.refreshPeriodMs, settings.drawBufferLines, settings.backgroundThrottle);
+    applyTuning(settings);
+}
+
+TuningInputs PerformanceIntegration::measureTuningInputs() const {
+    HALManager& hal = OS().getHALManager();
+    PowerHAL& power = hal.getPower();
+
+    TuningInputs inputs;
+    inputs.fps = hal.getDisplay().getFPS();
+    inputs.cpuLoad = m_taskScheduler->getCPULoad();
+    inputs.batteryPercent = power.getBatteryLevel();
+    inputs.charging = power.getChargeState() == ChargeState::CHARGING ||
+                      power.getChargeState() == ChargeState::CHARGED;
+
+    size_t total = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    inputs.freeMemoryPercent = total ?
+        static_cast<uint8_t>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) * 100 / total) : 100;
+    return inputs;
+}
+
+void PerformanceIntegration::applyTuning(const TuningSettings& settings) {
+    if (m_powerManager) {
+        m_powerManager->setTargetFrequency(settings.cpuFreqMhz);
+    }
+
+    DisplayHAL& display = OS().getHALManager().getDisplay();
+    display.setRefreshPeriod(settings.refreshPeriodMs);
+
+    // Refresh periods are whole milliseconds; at the default rate keep the
+    // exact OS_FRAME_PERIOD_US rather than pacing at the rounded-down 16 ms
+    uint32_t framePeriodUs = settings.refreshPeriodMs == 1000 / OS_UI_REFRESH_RATE ?
+        OS_FRAME_PERIOD_US : settings.refreshPeriodMs * 1000;
+    OS().getFramePacer().setFramePeriod(framePeriodUs);
+    display.setDrawBufferMode(settings.drawBufferMode, settings.drawBufferLines);
+
+    m_taskScheduler->setBackgroundThrottle(settings.backgroundThrottle);
+
+    m_currentProfile.maxCpuFreqMhz = settings.cpuFreqMhz;
+}
+
+const char* PerformanceIntegration::getPerformanceModeString(SystemPerformanceMode mode) const {
+    switch (mode) {
+        case SystemPerformanceMode::POWER_SAVE: return "POWER_SAVE";
+        case SystemPerformanceMode::BALANCED: return "BALANCED";
+        case SystemPerformanceMode::PERFORMANCE: return "PERFORMANCE";
+        case SystemPerformanceMode::REAL_TIME: return "REAL_TIME";
+        case SystemPerformanceMode::AUTO: return "AUTO";
+        default: return "UNKNOWN";
+    }
+}
@@ -6,6 +6,7 @@
 #include "task_scheduler.h"
 #include "power_manager.h"
 #include "performance_monitor.h"
+#include "auto_tuner.h"
 
 /**
  * @file performance_integration.h
@@ -137,6 +138,12 @@ public:
      */
     void setAutoTuningEnabled(bool enabled) { m_autoTuningEnabled = enabled; }
 
+    /**
+     * @brief Get the AUTO-mode controller
+     * @return Auto tuner with the settings currently applied
+     */
+    const AutoTuner& getAutoTuner() const { return m_autoTuner; }
+
     /**
      * @brief Check if system is maintaining 60Hz performance
      * @return true if maintaining 60Hz consistently
@@ -211,9 +218,24 @@ private:
 
     /**
      * @brief Perform automatic tuning based on current conditions
+     *
+     * Feeds measured FPS, CPU load, battery and free memory to the auto
+     * tuner and applies its settings when they change.
      */
     void performAutoTuning();
 
+    /**
+     * @brief Gather the auto tuner's inputs
+     * @return Current measurements
+     */
+    TuningInputs measureTuningInputs() const;
+
+    /**
+     * @brief Apply clock, refresh, draw buffer and throttle settings
+     * @param settings Settings to apply
+     */
+    void applyTuning(const TuningSettings& settings);
+
     /**
      * @brief Monitor system health
      */
@@ -271,9 +293,10 @@ private:
     SystemHealthStatus m_systemHealth = SystemHealthStatus::GOOD;
 
     // Auto-tuning
+    AutoTuner m_autoTuner;
     bool m_autoTuningEnabled = true;
     uint32_t m_lastTuningTime = 0;
-    uint32_t m_tuningIntervalMs = 10000; // 10 seconds
+    uint32_t m_tuningIntervalMs = OS_AUTO_TUNE_INTERVAL_MS;
 
     // Performance tracking
     float m_performanceScore = 85.0f;
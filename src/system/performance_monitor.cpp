@@ -1,5 +1,7 @@
 #include "performance_monitor.h"
 #include "memory_manager.h"
+#include "os_manager.h"
+#include "trace_recorder.h"
 #include <esp_log.h>
 #include <esp_heap_caps.h>
 #include <esp_system.h>
@@ -24,11 +26,6 @@ os_error_t PerformanceMonitor::initialize() {
     m_cpuStats = {};
     m_systemStats = {};
 
-    // Reserve space for history vectors
-    m_frameStats.fpsHistory.reserve(MAX_HISTORY_SIZE);
-    m_memoryStats.heapHistory.reserve(MAX_HISTORY_SIZE);
-    m_cpuStats.loadHistory.reserve(MAX_HISTORY_SIZE);
-
     // Initialize timestamps
     m_lastUpdateTime = millis();
     m_lastFrameTimestamp = esp_timer_get_time();
@@ -111,10 +108,13 @@ void PerformanceMonitor::recordFrameTime(uint64_t frameTime) {
         // Count dropped frames
         if (currentFPS < 55.0f) {
             m_frameStats.droppedFrames++;
+            PERF_TRACE_INSTANT("frame_drop");
         }
         
         m_frameStats.totalFrames++;
     }
+
+    PERF_TRACE_COUNTER("frame_us", frameTime);
     
     m_frameStats.lastFrameTime = currentTime;
     m_frameCount++;
@@ -167,7 +167,8 @@ void PerformanceMonitor::updateFrameStats() {
         uint32_t elapsed = millis() - (m_lastUpdateTime - m_measurementWindow);
         if (elapsed > 0) {
             float avgFPS = (m_frameCount * 1000.0f) / elapsed;
-            m_frameStats.averageFPS = updateMovingAverage(m_frameStats.fpsHistory, avgFPS, MAX_HISTORY_SIZE);
+            m_frameStats.fpsHistory.push(avgFPS);
+            m_frameStats.averageFPS = m_frameStats.fpsHistory.mean();
         }
         m_frameCount = 0;
     }
@@ -201,8 +202,18 @@ void PerformanceMonitor::updateMemoryStats() {
         m_memoryStats.peakUsage = currentUsage;
     }
     
+    // Pull arena counters from the memory manager
+    if (OS().isInitialized()) {
+        ArenaStats arenaStats = OS().getMemoryManager().getArenaStats();
+        m_memoryStats.arenaUsed = arenaStats.used;
+        m_memoryStats.arenaCapacity = arenaStats.capacity;
+        m_memoryStats.arenaPeakUsed = arenaStats.peakUsed;
+        m_memoryStats.arenaResets = arenaStats.resetCount;
+        m_memoryStats.arenaChunkAllocations = arenaStats.chunkAllocations;
+    }
+    
     // Update history
-    updateMovingAverage(m_memoryStats.heapHistory, m_memoryStats.freeHeap, MAX_HISTORY_SIZE);
+    m_memoryStats.heapHistory.push(m_memoryStats.freeHeap);
 }
 
 void PerformanceMonitor::updateCPUStats() {
@@ -235,7 +246,8 @@ void PerformanceMonitor::updateCPUStats() {
         if (ulTotalRunTime > 0) {
             float cpuLoad = 100.0f - ((float)idleRunTime / (float)ulTotalRunTime * 100.0f);
             m_cpuStats.cpuLoad = cpuLoad;
-            m_cpuStats.averageLoad = updateMovingAverage(m_cpuStats.loadHistory, cpuLoad, MAX_HISTORY_SIZE);
+            m_cpuStats.loadHistory.push(cpuLoad);
+            m_cpuStats.averageLoad = m_cpuStats.loadHistory.mean();
             
             if (cpuLoad > m_cpuStats.maxLoad) {
                 m_cpuStats.maxLoad = cpuLoad;
@@ -328,20 +340,6 @@ void PerformanceMonitor::addAlert(PerformanceAlert::Type type, const char* messa
     ESP_LOGW(TAG, "Performance Alert: %s (severity: %.2f)", message, severity);
 }
 
-float PerformanceMonitor::updateMovingAverage(std::vector<float>& history, float newValue, size_t maxSize) {
-    history.push_back(newValue);
-    if (history.size() > maxSize) {
-        history.erase(history.begin());
-    }
-    
-    float sum = 0.0f;
-    for (float value : history) {
-        sum += value;
-    }
-    
-    return sum / history.size();
-}
-
 char PerformanceMonitor::generatePerformanceGrade() const {
     float score = getPerformanceScore();
     
@@ -388,6 +386,9 @@ void PerformanceMonitor::printPerformanceReport() const {
     ESP_LOGI(TAG, "Current FPS: %.1f", m_frameStats.currentFPS);
     ESP_LOGI(TAG, "Average FPS: %.1f", m_frameStats.averageFPS);
     ESP_LOGI(TAG, "Min/Max FPS: %.1f / %.1f", m_frameStats.minFPS, m_frameStats.maxFPS);
+    HistoryStats fpsHistory = getFPSHistoryStats();
+    ESP_LOGI(TAG, "FPS History P50/P95/P99: %.1f / %.1f / %.1f (%d samples)",
+             fpsHistory.p50, fpsHistory.p95, fpsHistory.p99, (int)fpsHistory.count);
     ESP_LOGI(TAG, "Total Frames: %d", m_frameStats.totalFrames);
     ESP_LOGI(TAG, "Dropped Frames: %d (%.2f%%)", m_frameStats.droppedFrames,
              m_frameStats.totalFrames > 0 ? (float)m_frameStats.droppedFrames / m_frameStats.totalFrames * 100.0f : 0.0f);
@@ -397,6 +398,9 @@ void PerformanceMonitor::printPerformanceReport() const {
     ESP_LOGI(TAG, "Current Load: %.1f%%", m_cpuStats.cpuLoad);
     ESP_LOGI(TAG, "Average Load: %.1f%%", m_cpuStats.averageLoad);
     ESP_LOGI(TAG, "Max Load: %.1f%%", m_cpuStats.maxLoad);
+    HistoryStats loadHistory = getLoadHistoryStats();
+    ESP_LOGI(TAG, "Load P50/P95/P99: %.1f%% / %.1f%% / %.1f%%",
+             loadHistory.p50, loadHistory.p95, loadHistory.p99);
     ESP_LOGI(TAG, "CPU Frequency: %d MHz", m_cpuStats.currentFrequency);
     ESP_LOGI(TAG, "");
     
@@ -412,6 +416,9 @@ void PerformanceMonitor::printPerformanceReport() const {
     ESP_LOGI(TAG, "Peak Usage: %d KB", m_memoryStats.peakUsage / 1024);
     ESP_LOGI(TAG, "Allocations: %d", m_memoryStats.allocationCount);
     ESP_LOGI(TAG, "Deallocations: %d", m_memoryStats.deallocationCount);
+    ESP_LOGI(TAG, "Arenas: %d KB / %d KB (peak %d KB, %d growths)",
+             m_memoryStats.arenaUsed / 1024, m_memoryStats.arenaCapacity / 1024,
+             m_memoryStats.arenaPeakUsed / 1024, m_memoryStats.arenaChunkAllocations);
     ESP_LOGI(TAG, "");
     
     ESP_LOGI(TAG, "=== SYSTEM STATUS ===");
@@ -443,6 +450,19 @@ void PerformanceMonitor::printDashboard() const {
     ESP_LOGI(TAG, "╚══════════════════════════════════════════════════════════════╝");
 }
 
+os_error_t PerformanceMonitor::startTrace(size_t maxEvents) {
+    return TraceRecorder::getInstance().startCapture(maxEvents);
+}
+
+os_error_t PerformanceMonitor::exportTrace(const char* path) {
+    TraceRecorder& tracer = TraceRecorder::getInstance();
+    os_error_t result = tracer.exportChromeTrace(path);
+    if (result == OS_OK && tracer.getDroppedCount() > 0) {
+        ESP_LOGW(TAG, "Trace is incomplete: %d markers dropped", (int)tracer.getDroppedCount());
+    }
+    return result;
+}
+
 void PerformanceMonitor::resetStatistics() {
     ESP_LOGI(TAG, "Resetting performance statistics");
     
@@ -2,6 +2,7 @@
 #define PERFORMANCE_MONITOR_H
 
 #include "os_config.h"
+#include "stats_ring.h"
 #include <vector>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -27,7 +28,7 @@ struct FrameStats {
     uint32_t totalFrames = 0;
     uint32_t droppedFrames = 0;
     uint64_t lastFrameTime = 0;
-    std::vector<float> fpsHistory;
+    StatsRing<float, OS_PERF_HISTORY_SIZE> fpsHistory;
 };
 
 struct MemoryStats {
@@ -41,7 +42,12 @@ struct MemoryStats {
     size_t peakUsage = 0;
     uint32_t allocationCount = 0;
     uint32_t deallocationCount = 0;
-    std::vector<float> heapHistory;
+    size_t arenaUsed = 0;              // Frame + app arena bytes in use
+    size_t arenaCapacity = 0;          // Frame + app arena bytes reserved
+    size_t arenaPeakUsed = 0;
+    uint32_t arenaResets = 0;
+    uint32_t arenaChunkAllocations = 0; // Arena growth events (heap allocations)
+    StatsRing<float, OS_PERF_HISTORY_SIZE> heapHistory;
 };
 
 struct CPUStats {
@@ -51,7 +57,7 @@ struct CPUStats {
     uint32_t currentFrequency = 360;
     uint32_t idleTime = 0;
     uint32_t taskSwitches = 0;
-    std::vector<float> loadHistory;
+    StatsRing<float, OS_PERF_HISTORY_SIZE> loadHistory;
 };
 
 struct SystemStats {
@@ -165,6 +171,24 @@ public:
      */
     const CPUStats& getCPUStats() const { return m_cpuStats; }
 
+    /**
+     * @brief Get distribution of the per-second average FPS history
+     * @return Min/max/mean and P50/P95/P99 over the history window
+     */
+    HistoryStats getFPSHistoryStats() const { return m_frameStats.fpsHistory.stats(); }
+
+    /**
+     * @brief Get distribution of the free heap history
+     * @return Min/max/mean and P50/P95/P99 in bytes
+     */
+    HistoryStats getHeapHistoryStats() const { return m_memoryStats.heapHistory.stats(); }
+
+    /**
+     * @brief Get distribution of the CPU load history
+     * @return Min/max/mean and P50/P95/P99 in percent
+     */
+    HistoryStats getLoadHistoryStats() const { return m_cpuStats.loadHistory.stats(); }
+
     /**
      * @brief Get system statistics
      * @return System statistics structure
@@ -213,6 +237,23 @@ public:
      */
     float getPerformanceScore() const;
 
+    /**
+     * @brief Start recording a timeline of trace markers
+     * @param maxEvents Capture length in markers
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t startTrace(size_t maxEvents = OS_TRACE_CAPTURE_EVENTS);
+
+    /**
+     * @brief Stop recording and write the timeline as Chrome trace JSON
+     *
+     * Open the file in chrome://tracing or ui.perfetto.dev to see which
+     * app update, scheduler task or LVGL flush overran a frame.
+     * @param path Output file, e.g. "/sdcard/trace.json"
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t exportTrace(const char* path);
+
     /**
      * @brief Reset all statistics
      */
@@ -265,15 +306,6 @@ private:
      */
     void addAlert(PerformanceAlert::Type type, const char* message, float severity);
 
-    /**
-     * @brief Calculate moving average
-     * @param history History vector
-     * @param newValue New value to add
-     * @param maxSize Maximum history size
-     * @return Updated average
-     */
-    float updateMovingAverage(std::vector<float>& history, float newValue, size_t maxSize);
-
     // Statistics
     FrameStats m_frameStats;
     MemoryStats m_memoryStats;
@@ -314,7 +346,6 @@ private:
     std::vector<TaskExecutionInfo> m_taskExecutions;
 
     // Configuration constants
-    static constexpr size_t MAX_HISTORY_SIZE = 60; // 1 minute at 1Hz
     static constexpr float TARGET_FPS = 60.0f;
     static constexpr uint32_t ALERT_COOLDOWN_MS = 5000; // 5 seconds between same alerts
     static constexpr const char* TAG = "PerformanceMonitor";
@@ -15,13 +15,16 @@ PowerManager::~PowerManager() {
     shutdown();
 }
 
-os_error_t PowerManager::initialize() {
+os_error_t PowerManager::initialize(EventSystem* events) {
     if (m_initialized) {
         return OS_OK;
     }
 
     ESP_LOGI(TAG, "Initializing Power Manager");
 
+    // Set before the button ISR is installed
+    m_eventSystem = events;
+
     // Initialize GPIO for power management
     os_error_t result = initializeGPIO();
     if (result != OS_OK) {
@@ -282,6 +285,36 @@ void PowerManager::printPowerStats() const {
     ESP_LOGI(TAG, "  Last Activity: %d ms ago", millis() - m_lastActivity);
 }
 
+os_error_t PowerManager::setTargetFrequency(uint32_t frequency) {
+    if (frequency < 80 || frequency > 360) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+
+    m_targetFrequency = frequency;
+    if (frequency == m_currentFrequency) {
+        return OS_OK;
+    }
+
+    // Cap dynamic frequency scaling at the target; the PM driver still
+    // drops to the minimum when nothing holds a CPU lock
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = (int)frequency,
+        .min_freq_mhz = 80,
+        .light_sleep_enable = true
+    };
+
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set CPU frequency to %d MHz: %s", frequency, esp_err_to_name(ret));
+        return OS_ERROR_GENERIC;
+    }
+
+    m_currentFrequency = frequency;
+    m_frequencyChanges++;
+    ESP_LOGD(TAG, "CPU frequency limit %d MHz", frequency);
+    return OS_OK;
+}
+
 os_error_t PowerManager::initializeGPIO() {
     gpio_config_t io_conf = {};
 
@@ -375,11 +408,20 @@ void IRAM_ATTR PowerManager::powerButtonISR(void* arg) {
     PowerManager* pm = static_cast<PowerManager*>(arg);
     uint32_t now = millis();
     
+    // Lock-free queue, delivered to listeners by the main loop
+    EventSystem* events = pm->m_eventSystem;
+    
     if (gpio_get_level(PMS150G_INT_PIN) == 0) {
         // Button pressed
         pm->m_buttonPressed = true;
         pm->m_buttonPressTime = now;
+        if (events) {
+            events->publishFromISR(EVENT_HAL_BUTTON_PRESS, nullptr, 0, PMS150G_INT_PIN);
+        }
     } else {
+        if (events) {
+            events->publishFromISR(EVENT_HAL_BUTTON_RELEASE, nullptr, 0, PMS150G_INT_PIN);
+        }
         // Button released
         if (pm->m_buttonPressed) {
             uint32_t pressDuration = now - pm->m_buttonPressTime;
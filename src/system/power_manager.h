@@ -55,9 +55,10 @@ public:
 
     /**
      * @brief Initialize power management system
+     * @param events Event system the power button ISR publishes to (optional)
      * @return OS_OK on success, error code on failure
      */
-    os_error_t initialize();
+    os_error_t initialize(EventSystem* events = nullptr);
 
     /**
      * @brief Shutdown power management
@@ -294,6 +295,7 @@ private:
     bool m_5vOutput2Enabled = false;
 
     // Button handling
+    EventSystem* m_eventSystem = nullptr;   // Cached for the ISR, which must not call OS()
     volatile ButtonEvent m_buttonEvent = ButtonEvent::NONE;
     uint32_t m_buttonPressTime = 0;
     uint32_t m_lastButtonPress = 0;
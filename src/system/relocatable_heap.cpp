@@ -0,0 +1,295 @@
+#include "relocatable_heap.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <string.h>
+#include <algorithm>
+
+static const char* TAG = "RelocatableHeap";
+
+RelocatableHeap::RelocatableHeap(size_t capacity, size_t maxHandles, uint32_t caps)
+    : m_capacity(capacity) {
+    // Handles carry a 16-bit entry index
+    maxHandles = std::min<size_t>(maxHandles, UINT16_MAX);
+
+    m_base = static_cast<uint8_t*>(heap_caps_aligned_alloc(BLOCK_ALIGNMENT, capacity, caps));
+    if (!m_base) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte relocatable region", capacity);
+        m_capacity = 0;
+        return;
+    }
+
+    m_mutex = xSemaphoreCreateMutex();
+
+    m_entries.resize(maxHandles);
+    m_order.reserve(maxHandles);
+    m_freeEntries.reserve(maxHandles);
+    for (size_t i = maxHandles; i > 0; i--) {
+        m_freeEntries.push_back(static_cast<uint16_t>(i - 1));
+    }
+
+    ESP_LOGI(TAG, "Created relocatable heap: %d KB, %d handles (%s)", capacity / 1024,
+             maxHandles, (caps & MALLOC_CAP_SPIRAM) ? "PSRAM" : "Internal");
+}
+
+RelocatableHeap::~RelocatableHeap() {
+    if (!m_order.empty()) {
+        ESP_LOGW(TAG, "Destroying relocatable heap with %d live blocks", m_order.size());
+    }
+    if (m_base) {
+        heap_caps_free(m_base);
+    }
+    if (m_mutex) {
+        vSemaphoreDelete(m_mutex);
+    }
+}
+
+MemoryHandle RelocatableHeap::allocate(size_t size) {
+    if (!isValid() || size == 0 || size > m_capacity) {
+        return INVALID_MEMORY_HANDLE;
+    }
+    size = (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+
+    if (xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return INVALID_MEMORY_HANDLE;
+    }
+
+    if (m_freeEntries.empty() || m_capacity - m_usedBytes < size) {
+        m_allocationFailures++;
+        xSemaphoreGive(m_mutex);
+        return INVALID_MEMORY_HANDLE;
+    }
+
+    // First fit over the holes between blocks, compacting once if that fails
+    size_t position = 0;
+    size_t offset = 0;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t previousEnd = 0;
+        for (position = 0; position < m_order.size(); position++) {
+            const Entry& entry = m_entries[m_order[position]];
+            if (entry.offset - previousEnd >= size) {
+                break;
+            }
+            previousEnd = entry.offset + entry.size;
+        }
+        offset = previousEnd;
+        if (position < m_order.size() || m_capacity - previousEnd >= size) {
+            break;
+        }
+        if (attempt == 0) {
+            compactLocked(0);
+        } else {
+            offset = SIZE_MAX;
+        }
+    }
+
+    if (offset == SIZE_MAX) {
+        // Pinned blocks keep the free space split
+        m_allocationFailures++;
+        xSemaphoreGive(m_mutex);
+        return INVALID_MEMORY_HANDLE;
+    }
+
+    uint16_t index = m_freeEntries.back();
+    m_freeEntries.pop_back();
+
+    Entry& entry = m_entries[index];
+    entry.offset = offset;
+    entry.size = size;
+    entry.pinCount = 0;
+    entry.inUse = true;
+    m_order.insert(m_order.begin() + position, index);
+    m_usedBytes += size;
+
+    MemoryHandle handle = (static_cast<uint32_t>(entry.generation) << 16) | (index + 1u);
+    xSemaphoreGive(m_mutex);
+    return handle;
+}
+
+bool RelocatableHeap::free(MemoryHandle handle) {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+
+    Entry* entry = lookup(handle);
+    if (!entry || entry->pinCount > 0) {
+        ESP_LOGW(TAG, "Cannot free %s handle 0x%08x", entry ? "pinned" : "stale", handle);
+        xSemaphoreGive(m_mutex);
+        return false;
+    }
+
+    uint16_t index = static_cast<uint16_t>((handle & 0xFFFF) - 1);
+    auto it = std::lower_bound(m_order.begin(), m_order.end(), entry->offset,
+                               [this](uint16_t i, size_t offset) { return m_entries[i].offset < offset; });
+    m_order.erase(it);
+
+    m_usedBytes -= entry->size;
+    entry->inUse = false;
+    // Bump the generation so stale copies of the handle are rejected
+    if (++entry->generation == 0) {
+        entry->generation = 1;
+    }
+    m_freeEntries.push_back(index);
+
+    xSemaphoreGive(m_mutex);
+    return true;
+}
+
+void* RelocatableHeap::pin(MemoryHandle handle) {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return nullptr;
+    }
+
+    void* ptr = nullptr;
+    Entry* entry = lookup(handle);
+    if (entry && entry->pinCount < UINT16_MAX) {
+        entry->pinCount++;
+        ptr = m_base + entry->offset;
+    }
+
+    xSemaphoreGive(m_mutex);
+    return ptr;
+}
+
+void RelocatableHeap::unpin(MemoryHandle handle) {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+
+    Entry* entry = lookup(handle);
+    if (entry && entry->pinCount > 0) {
+        entry->pinCount--;
+    } else {
+        ESP_LOGW(TAG, "Unbalanced unpin of handle 0x%08x", handle);
+    }
+
+    xSemaphoreGive(m_mutex);
+}
+
+size_t RelocatableHeap::getSize(MemoryHandle handle) const {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+
+    const Entry* entry = lookup(handle);
+    size_t size = entry ? entry->size : 0;
+
+    xSemaphoreGive(m_mutex);
+    return size;
+}
+
+size_t RelocatableHeap::compact(uint32_t budgetUs) {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+
+    size_t moved = compactLocked(budgetUs);
+
+    xSemaphoreGive(m_mutex);
+    return moved;
+}
+
+bool RelocatableHeap::isFragmented() const {
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+
+    bool fragmented = largestFreeLocked() < m_capacity - m_usedBytes;
+
+    xSemaphoreGive(m_mutex);
+    return fragmented;
+}
+
+RelocatableHeapStats RelocatableHeap::getStats() const {
+    RelocatableHeapStats stats;
+    if (!isValid() || xSemaphoreTake(m_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return stats;
+    }
+
+    stats.capacity = m_capacity;
+    stats.freeBytes = m_capacity - m_usedBytes;
+    stats.largestFreeBlock = largestFreeLocked();
+    stats.liveBlocks = m_order.size();
+    for (uint16_t index : m_order) {
+        if (m_entries[index].pinCount > 0) {
+            stats.pinnedBlocks++;
+        }
+    }
+    stats.compactionPasses = m_compactionPasses;
+    stats.bytesMoved = m_bytesMoved;
+    stats.allocationFailures = m_allocationFailures;
+
+    xSemaphoreGive(m_mutex);
+    return stats;
+}
+
+RelocatableHeap::Entry* RelocatableHeap::lookup(MemoryHandle handle) {
+    return const_cast<Entry*>(static_cast<const RelocatableHeap*>(this)->lookup(handle));
+}
+
+const RelocatableHeap::Entry* RelocatableHeap::lookup(MemoryHandle handle) const {
+    uint32_t index = handle & 0xFFFF;
+    if (index == 0 || index > m_entries.size()) {
+        return nullptr;
+    }
+
+    const Entry& entry = m_entries[index - 1];
+    if (!entry.inUse || entry.generation != (handle >> 16)) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+size_t RelocatableHeap::compactLocked(uint32_t budgetUs) {
+    int64_t start = esp_timer_get_time();
+    size_t moved = 0;
+    size_t cursor = 0;
+
+    // Blocks only ever move down, so m_order stays sorted by offset
+    for (uint16_t index : m_order) {
+        Entry& entry = m_entries[index];
+        if (entry.pinCount == 0 && entry.offset > cursor) {
+            int64_t moveStart = esp_timer_get_time();
+            if (budgetUs > 0) {
+                int64_t elapsed = moveStart - start;
+                if (elapsed >= budgetUs) {
+                    break;
+                }
+                // Leave blocks the rest of the slice could not copy in place;
+                // smaller blocks behind them can still close later holes
+                if (entry.size > (budgetUs - elapsed) * m_moveBytesPerUs) {
+                    cursor = entry.offset + entry.size;
+                    continue;
+                }
+            }
+
+            memmove(m_base + cursor, m_base + entry.offset, entry.size);
+            entry.offset = cursor;
+            moved += entry.size;
+
+            int64_t moveTime = esp_timer_get_time() - moveStart;
+            if (moveTime > 0) {
+                size_t rate = std::max<size_t>(entry.size / moveTime, 1);
+                m_moveBytesPerUs = (m_moveBytesPerUs * 3 + rate) / 4;
+            }
+        }
+        cursor = entry.offset + entry.size;
+    }
+
+    if (moved > 0) {
+        m_compactionPasses++;
+        m_bytesMoved += moved;
+    }
+    return moved;
+}
+
+size_t RelocatableHeap::largestFreeLocked() const {
+    size_t largest = 0;
+    size_t previousEnd = 0;
+    for (uint16_t index : m_order) {
+        const Entry& entry = m_entries[index];
+        largest = std::max(largest, entry.offset - previousEnd);
+        previousEnd = entry.offset + entry.size;
+    }
+    return std::max(largest, m_capacity - previousEnd);
+}
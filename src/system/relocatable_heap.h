@@ -0,0 +1,178 @@
+#ifndef RELOCATABLE_HEAP_H
+#define RELOCATABLE_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @file relocatable_heap.h
+ * @brief Compactable heap of movable blocks addressed by handles
+ *
+ * Large, long-lived buffers (map tiles, waterfall canvases, ZIM cluster
+ * caches) are allocated from a dedicated PSRAM region and referenced by
+ * handle instead of pointer. A block must be pinned to obtain its address;
+ * unpinned blocks may be slid towards the start of the region by compact(),
+ * which closes the holes left by freed blocks and restores one large
+ * contiguous free span.
+ */
+
+typedef uint32_t MemoryHandle;  // 0 is never a valid handle
+static const MemoryHandle INVALID_MEMORY_HANDLE = 0;
+
+struct RelocatableHeapStats {
+    size_t capacity = 0;
+    size_t freeBytes = 0;
+    size_t largestFreeBlock = 0;
+    size_t liveBlocks = 0;
+    size_t pinnedBlocks = 0;
+    uint32_t compactionPasses = 0;
+    size_t bytesMoved = 0;
+    uint32_t allocationFailures = 0;
+};
+
+class RelocatableHeap {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Region size in bytes
+     * @param maxHandles Maximum number of live blocks
+     * @param caps heap_caps flags for the region
+     */
+    RelocatableHeap(size_t capacity, size_t maxHandles, uint32_t caps);
+    ~RelocatableHeap();
+
+    RelocatableHeap(const RelocatableHeap&) = delete;
+    RelocatableHeap& operator=(const RelocatableHeap&) = delete;
+
+    /**
+     * @brief Check if the backing region was allocated
+     * @return true if usable
+     */
+    bool isValid() const { return m_base != nullptr && m_mutex != nullptr; }
+
+    /**
+     * @brief Allocate a movable block
+     *
+     * If no hole is large enough but the total free space is, the heap is
+     * compacted before giving up.
+     * @param size Size in bytes
+     * @return Handle or INVALID_MEMORY_HANDLE on failure
+     */
+    MemoryHandle allocate(size_t size);
+
+    /**
+     * @brief Free a block
+     * @param handle Block handle
+     * @return false if the handle is stale or the block is still pinned
+     */
+    bool free(MemoryHandle handle);
+
+    /**
+     * @brief Pin a block and get its current address
+     *
+     * The address stays valid until the matching unpin(). Pins nest.
+     * @param handle Block handle
+     * @return Block address or nullptr for a stale handle
+     */
+    void* pin(MemoryHandle handle);
+
+    /**
+     * @brief Release a pin taken with pin()
+     * @param handle Block handle
+     */
+    void unpin(MemoryHandle handle);
+
+    /**
+     * @brief Get the size of a block
+     * @param handle Block handle
+     * @return Size in bytes (rounded up to the block alignment) or 0 for a stale handle
+     */
+    size_t getSize(MemoryHandle handle) const;
+
+    /**
+     * @brief Slide unpinned blocks down to close holes
+     *
+     * With a budget, a block is only moved if it can be copied in the time
+     * that is left, estimated from the copy rate of earlier moves; larger
+     * blocks stay where they are until an unbounded pass.
+     * @param budgetUs Time budget in microseconds (0 = run to completion)
+     * @return Bytes moved
+     */
+    size_t compact(uint32_t budgetUs = 0);
+
+    /**
+     * @brief Check whether compaction would reclaim anything
+     * @return true if the free space is split into more than one span
+     */
+    bool isFragmented() const;
+
+    /**
+     * @brief Get heap statistics
+     * @return Statistics structure
+     */
+    RelocatableHeapStats getStats() const;
+
+private:
+    static constexpr size_t BLOCK_ALIGNMENT = 16;
+    static constexpr size_t INITIAL_MOVE_BYTES_PER_US = 64;  // Conservative PSRAM memmove rate
+
+    struct Entry {
+        size_t offset = 0;
+        size_t size = 0;
+        uint16_t generation = 1;
+        uint16_t pinCount = 0;
+        bool inUse = false;
+    };
+
+    Entry* lookup(MemoryHandle handle);
+    const Entry* lookup(MemoryHandle handle) const;
+    size_t compactLocked(uint32_t budgetUs);
+    size_t largestFreeLocked() const;
+
+    uint8_t* m_base = nullptr;
+    size_t m_capacity = 0;
+    size_t m_usedBytes = 0;
+
+    std::vector<Entry> m_entries;
+    std::vector<uint16_t> m_freeEntries;
+    std::vector<uint16_t> m_order;   // Live entry indices sorted by offset
+
+    uint32_t m_compactionPasses = 0;
+    size_t m_bytesMoved = 0;
+    size_t m_moveBytesPerUs = INITIAL_MOVE_BYTES_PER_US;    // Smoothed measured copy rate
+    uint32_t m_allocationFailures = 0;
+
+    SemaphoreHandle_t m_mutex = nullptr;
+};
+
+/**
+ * @brief RAII pin of a relocatable block
+ */
+class PinnedBlock {
+public:
+    PinnedBlock(RelocatableHeap& heap, MemoryHandle handle)
+        : m_heap(heap), m_handle(handle), m_ptr(heap.pin(handle)) {}
+    ~PinnedBlock() {
+        if (m_ptr) {
+            m_heap.unpin(m_handle);
+        }
+    }
+
+    PinnedBlock(const PinnedBlock&) = delete;
+    PinnedBlock& operator=(const PinnedBlock&) = delete;
+
+    void* get() const { return m_ptr; }
+    template <typename T>
+    T* as() const { return static_cast<T*>(m_ptr); }
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+private:
+    RelocatableHeap& m_heap;
+    MemoryHandle m_handle;
+    void* m_ptr;
+};
+
+#endif // RELOCATABLE_HEAP_H
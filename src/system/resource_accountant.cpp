@@ -0,0 +1,148 @@
+#include "resource_accountant.h"
+#include <esp_log.h>
+#include <algorithm>
+
+static const char* TAG = "ResourceAccountant";
+
+ResourceAccountant& ResourceAccountant::getInstance() {
+    static ResourceAccountant instance;
+    return instance;
+}
+
+AppAccount* ResourceAccountant::openAccount(const std::string& appId) {
+    AppAccount* existing = findAccount(appId);
+    if (existing) {
+        return existing;
+    }
+
+    for (AppAccount& account : m_accounts) {
+        if (account.active) {
+            continue;
+        }
+
+        account.appId = appId;
+        account.cpuTimeUs = 0;
+        account.frameTimeUs = 0;
+        account.eventCallbacks = 0;
+        account.taskRuns = 0;
+        account.allocations.store(0, std::memory_order_relaxed);
+        account.deallocations.store(0, std::memory_order_relaxed);
+        account.liveBytes.store(0, std::memory_order_relaxed);
+        account.cpuPercent = 0.0f;
+        account.allocationsPerSecond = 0.0f;
+        account.frameCost.clear();
+        account.peakBytes = 0;
+        account.windowStartCpuUs = 0;
+        account.windowStartAllocations = 0;
+        account.active = true;
+
+        if (m_windowStart == 0) {
+            m_windowStart = esp_timer_get_time();
+        }
+        return &account;
+    }
+
+    ESP_LOGW(TAG, "No free account for app '%s'", appId.c_str());
+    return nullptr;
+}
+
+void ResourceAccountant::closeAccount(const std::string& appId) {
+    AppAccount* account = findAccount(appId);
+    if (account) {
+        account->active = false;
+    }
+}
+
+AppAccount* ResourceAccountant::findAccount(const std::string& appId) {
+    for (AppAccount& account : m_accounts) {
+        if (account.active && account.appId == appId) {
+            return &account;
+        }
+    }
+    return nullptr;
+}
+
+void ResourceAccountant::endFrame() {
+    // Close the running slice so this frame's cost includes it
+    if (s_current) {
+        AccountScope flush(nullptr);
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t windowUs = now - m_windowStart;
+    bool rollWindow = windowUs >= static_cast<int64_t>(OS_ACCOUNTING_WINDOW_MS) * 1000;
+
+    for (AppAccount& account : m_accounts) {
+        if (!account.active) {
+            continue;
+        }
+
+        account.frameCost.push(static_cast<float>(account.frameTimeUs));
+        account.frameTimeUs = 0;
+
+        int32_t live = account.liveBytes.load(std::memory_order_relaxed);
+        if (live > account.peakBytes) {
+            account.peakBytes = live;
+        }
+
+        if (rollWindow) {
+            uint32_t allocations = account.allocations.load(std::memory_order_relaxed);
+            account.cpuPercent = (account.cpuTimeUs - account.windowStartCpuUs) * 100.0f / windowUs;
+            account.allocationsPerSecond =
+                (allocations - account.windowStartAllocations) * 1000000.0f / windowUs;
+            account.windowStartCpuUs = account.cpuTimeUs;
+            account.windowStartAllocations = allocations;
+        }
+    }
+
+    if (rollWindow) {
+        m_windowStart = now;
+    }
+}
+
+void ResourceAccountant::fillUsage(AppAccount& account, AppResourceUsage& usage) const {
+    int32_t live = account.liveBytes.load(std::memory_order_relaxed);
+
+    usage.appId = account.appId;
+    usage.cpuPercent = account.cpuPercent;
+    usage.cpuTimeUs = account.cpuTimeUs;
+    usage.avgFrameCostUs = account.frameCost.mean();
+    usage.p95FrameCostUs = account.frameCost.percentile(95.0f);
+    usage.liveBytes = live > 0 ? static_cast<size_t>(live) : 0;
+    usage.peakBytes = account.peakBytes > 0 ? static_cast<size_t>(account.peakBytes) : 0;
+    usage.allocations = account.allocations.load(std::memory_order_relaxed);
+    usage.allocationsPerSecond = account.allocationsPerSecond;
+    usage.eventCallbacks = account.eventCallbacks;
+    usage.taskRuns = account.taskRuns;
+}
+
+bool ResourceAccountant::getUsage(const std::string& appId, AppResourceUsage& usage) {
+    AppAccount* account = findAccount(appId);
+    if (!account) {
+        return false;
+    }
+    fillUsage(*account, usage);
+    return true;
+}
+
+std::vector<AppResourceUsage> ResourceAccountant::getAllUsage() {
+    std::vector<AppResourceUsage> all;
+    for (AppAccount& account : m_accounts) {
+        if (account.active) {
+            all.emplace_back();
+            fillUsage(account, all.back());
+        }
+    }
+
+    std::sort(all.begin(), all.end(), [](const AppResourceUsage& a, const AppResourceUsage& b) {
+        return a.cpuPercent > b.cpuPercent;
+    });
+    return all;
+}
+
+void ResourceAccountant::reset() {
+    for (AppAccount& account : m_accounts) {
+        account.active = false;
+    }
+    m_windowStart = 0;
+}
@@ -0,0 +1,228 @@
+#ifndef RESOURCE_ACCOUNTANT_H
+#define RESOURCE_ACCOUNTANT_H
+
+#include "os_config.h"
+#include "stats_ring.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * @file resource_accountant.h
+ * @brief Per-app CPU time, allocation and frame cost accounting for M5Stack Tab5
+ *
+ * Each app gets an account. While an AccountScope for an app is active on
+ * a thread, the CPU time spent there and every MemoryManager allocation
+ * and free are charged to that account. AppManager opens a scope around
+ * each app's lifecycle calls and update(); the EventSystem and
+ * TaskScheduler remember which account was current when a listener or
+ * task was registered and reopen it around each callback, so work an app
+ * schedules is charged to the app. Nested scopes pause the outer one, so
+ * time is never counted twice.
+ *
+ * Frees are charged to whichever app is current when they happen, which
+ * is the allocating app for memory an app releases in its own callbacks
+ * or shutdown().
+ */
+
+struct AppAccount {
+    std::string appId;
+    bool active = false;
+
+    // Charged on the main loop
+    uint64_t cpuTimeUs = 0;
+    uint32_t frameTimeUs = 0;          // This frame so far
+    uint32_t eventCallbacks = 0;
+    uint32_t taskRuns = 0;
+
+    // Charged from any thread running under the account
+    std::atomic<uint32_t> allocations{0};
+    std::atomic<uint32_t> deallocations{0};
+    std::atomic<int32_t> liveBytes{0};
+
+    // Last completed window
+    float cpuPercent = 0.0f;
+    float allocationsPerSecond = 0.0f;
+    StatsRing<float, OS_PERF_HISTORY_SIZE> frameCost;   // us per frame
+    int32_t peakBytes = 0;
+
+    // Window bookkeeping
+    uint64_t windowStartCpuUs = 0;
+    uint32_t windowStartAllocations = 0;
+};
+
+struct AppResourceUsage {
+    std::string appId;
+    float cpuPercent = 0.0f;               // Of main-loop wall time, last window
+    uint64_t cpuTimeUs = 0;                // Since launch
+    float avgFrameCostUs = 0.0f;           // Mean per-frame contribution
+    float p95FrameCostUs = 0.0f;
+    size_t liveBytes = 0;                  // MemoryManager bytes allocated and not yet freed
+    size_t peakBytes = 0;
+    size_t arenaBytes = 0;                 // App arena in use (filled in by AppManager)
+    size_t reportedBytes = 0;              // App's own estimate (filled in by AppManager)
+    uint32_t allocations = 0;
+    float allocationsPerSecond = 0.0f;
+    uint32_t eventCallbacks = 0;
+    uint32_t taskRuns = 0;
+    bool background = false;               // Not the foreground app (filled in by AppManager)
+    bool paused = false;
+
+    /**
+     * @brief Get the app's memory weight
+     *
+     * Measured bytes when the app allocates through the memory manager,
+     * otherwise its own estimate.
+     * @return Bytes attributed to the app
+     */
+    size_t totalBytes() const {
+        size_t measured = liveBytes + arenaBytes;
+        return measured > reportedBytes ? measured : reportedBytes;
+    }
+};
+
+class ResourceAccountant {
+public:
+    /**
+     * @brief Get the process-wide accountant
+     * @return Resource accountant
+     */
+    static ResourceAccountant& getInstance();
+
+    ResourceAccountant() = default;
+    ResourceAccountant(const ResourceAccountant&) = delete;
+    ResourceAccountant& operator=(const ResourceAccountant&) = delete;
+
+    /**
+     * @brief Open (or reopen) the account for an app
+     * @param appId Application identifier
+     * @return Account, or nullptr if OS_MAX_APPS accounts are open
+     */
+    AppAccount* openAccount(const std::string& appId);
+
+    /**
+     * @brief Close an app's account
+     *
+     * The slot is reused by a later app. Listeners or tasks the app left
+     * registered keep charging the slot, so apps should unsubscribe and
+     * cancel in shutdown().
+     * @param appId Application identifier
+     */
+    void closeAccount(const std::string& appId);
+
+    /**
+     * @brief Find an open account
+     * @param appId Application identifier
+     * @return Account or nullptr
+     */
+    AppAccount* findAccount(const std::string& appId);
+
+    /**
+     * @brief Get the account charged on this thread
+     * @return Current account, or nullptr for system work
+     */
+    static AppAccount* current() { return s_current; }
+
+    /**
+     * @brief Charge an allocation to the current account
+     * @param size Bytes allocated
+     */
+    static void chargeAllocation(size_t size) {
+        AppAccount* account = s_current;
+        if (account) {
+            account->allocations.fetch_add(1, std::memory_order_relaxed);
+            account->liveBytes.fetch_add(static_cast<int32_t>(size), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Charge a free to the current account
+     * @param size Bytes freed
+     */
+    static void chargeDeallocation(size_t size) {
+        AppAccount* account = s_current;
+        if (account) {
+            account->deallocations.fetch_add(1, std::memory_order_relaxed);
+            account->liveBytes.fetch_sub(static_cast<int32_t>(size), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Close the frame: record frame costs and roll the rate window
+     */
+    void endFrame();
+
+    /**
+     * @brief Get an app's usage
+     * @param appId Application identifier
+     * @param usage Receives the usage
+     * @return false if the app has no account
+     */
+    bool getUsage(const std::string& appId, AppResourceUsage& usage);
+
+    /**
+     * @brief Get every open account's usage
+     * @return Usage, heaviest CPU first
+     */
+    std::vector<AppResourceUsage> getAllUsage();
+
+    /**
+     * @brief Close all accounts
+     */
+    void reset();
+
+private:
+    friend class AccountScope;
+
+    void fillUsage(AppAccount& account, AppResourceUsage& usage) const;
+
+    AppAccount m_accounts[OS_MAX_APPS];
+    int64_t m_windowStart = 0;
+
+    static inline thread_local AppAccount* s_current = nullptr;
+    static inline thread_local int64_t s_sliceStart = 0;   // When the current account's slice began
+};
+
+/**
+ * @brief Charges this thread's work to an app until the end of the scope
+ *
+ * Entering pauses the enclosing account and leaving resumes it. A scope
+ * for the account that is already current does nothing.
+ */
+class AccountScope {
+public:
+    explicit AccountScope(AppAccount* account) : m_previous(ResourceAccountant::s_current) {
+        m_switched = account != m_previous;
+        if (m_switched) {
+            switchTo(account);
+        }
+    }
+
+    ~AccountScope() {
+        if (m_switched) {
+            switchTo(m_previous);
+        }
+    }
+
+    AccountScope(const AccountScope&) = delete;
+    AccountScope& operator=(const AccountScope&) = delete;
+
+private:
+    static void switchTo(AppAccount* next) {
+        int64_t now = esp_timer_get_time();
+        AppAccount* running = ResourceAccountant::s_current;
+        if (running) {
+            uint32_t elapsed = static_cast<uint32_t>(now - ResourceAccountant::s_sliceStart);
+            running->cpuTimeUs += elapsed;
+            running->frameTimeUs += elapsed;
+        }
+        ResourceAccountant::s_current = next;
+        ResourceAccountant::s_sliceStart = now;
+    }
+
+    AppAccount* m_previous;
+    bool m_switched;
+};
+
+#endif // RESOURCE_ACCOUNTANT_H
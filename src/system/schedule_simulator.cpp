@@ -0,0 +1,108 @@
+#include "schedule_simulator.h"
+#include <esp_log.h>
+#include <cmath>
+
+static const char* TAG = "ScheduleSim";
+
+SimReport ScheduleSimulator::run(const std::vector<SimTaskProfile>& taskSet, SchedulingMode mode,
+                                 uint32_t durationMs, uint32_t seed) {
+    uint32_t clock = 0;
+    uint32_t random = seed ? seed : 1;
+
+    TaskScheduler scheduler;
+    scheduler.setTimeSource([&clock]() { return clock; });
+    scheduler.initialize();
+    scheduler.setSchedulingMode(mode);
+
+    std::vector<uint32_t> taskIds;
+    taskIds.reserve(taskSet.size());
+    for (const SimTaskProfile& profile : taskSet) {
+        const SimTaskProfile* simulated = &profile;
+        TaskFunction function = [&clock, &random, simulated]() {
+            uint32_t extra = 0;
+            if (simulated->jitter > 0) {
+                random = random * 1664525u + 1013904223u;
+                extra = (random >> 16) % (simulated->jitter + 1);
+            }
+            clock += simulated->executionTime + extra;
+        };
+
+        uint32_t id;
+        if (profile.realtime) {
+            id = scheduler.scheduleRealtimeTask(function, profile.period, profile.priority,
+                                                profile.executionTime + profile.jitter,
+                                                profile.name, profile.deadline);
+        } else {
+            id = scheduler.schedulePeriodic(function, profile.period, profile.priority,
+                                            0, profile.name);
+        }
+        taskIds.push_back(id);
+    }
+
+    // Idle ticks advance the clock when nothing was due
+    while (clock < durationMs) {
+        uint32_t before = clock;
+        scheduler.update(0);
+        if (clock == before) {
+            clock++;
+        }
+    }
+
+    SimReport report;
+    report.mode = mode;
+    report.durationMs = durationMs;
+    report.totalMisses = scheduler.getDeadlineMisses();
+    report.rejected = scheduler.getAdmissionRejects();
+    report.realtimeUtilization = scheduler.getRealtimeUtilization();
+
+    for (size_t i = 0; i < taskSet.size(); i++) {
+        SimTaskResult result = {taskSet[i].name, false, 0, 0};
+        const Task* task = taskIds[i] ? scheduler.getTaskInfo(taskIds[i]) : nullptr;
+        if (task) {
+            result.admitted = true;
+            result.executions = task->executionCount;
+            result.deadlineMisses = task->deadlineMisses;
+        }
+        report.tasks.push_back(result);
+    }
+
+    scheduler.shutdown();
+    return report;
+}
+
+std::vector<SimTaskProfile> ScheduleSimulator::recordTaskSet(const TaskScheduler& scheduler) {
+    std::vector<SimTaskProfile> taskSet;
+    scheduler.forEachTask([&taskSet](const Task& task) {
+        if (task.period == 0 || task.state == TaskState::COMPLETED) {
+            return;
+        }
+
+        SimTaskProfile profile;
+        profile.name = task.name;
+        profile.period = task.period;
+        profile.deadline = task.deadline;
+        profile.executionTime = task.executionCount > 0 ?
+            static_cast<uint32_t>(std::ceil(task.avgExecutionTime)) : task.maxRunTime;
+        profile.jitter = 0;
+        profile.priority = task.priority;
+        profile.realtime = task.isRealtime;
+        taskSet.push_back(profile);
+    });
+    return taskSet;
+}
+
+void ScheduleSimulator::printReport(const SimReport& report) {
+    ESP_LOGI(TAG, "=== %s schedule, %d ms simulated ===",
+            report.mode == SchedulingMode::EDF ? "EDF" : "PRIORITY", report.durationMs);
+    ESP_LOGI(TAG, "Deadline misses: %d, rejected: %d, real-time utilization: %d%%",
+            report.totalMisses, report.rejected, report.realtimeUtilization);
+
+    for (const SimTaskResult& task : report.tasks) {
+        if (!task.admitted) {
+            ESP_LOGI(TAG, "  %-16s rejected", task.name ? task.name : "unnamed");
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-16s %6d runs %6d misses", task.name ? task.name : "unnamed",
+                task.executions, task.deadlineMisses);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SCHEDULE_SIMULATOR_H
+#define SCHEDULE_SIMULATOR_H
+
+#include "task_scheduler.h"
+#include <vector>
+
+/**
+ * @file schedule_simulator.h
+ * @brief Deterministic replay of a periodic task set for M5Stack Tab5
+ *
+ * Runs a real TaskScheduler against a virtual millisecond clock. Each
+ * simulated task advances the clock by its recorded run time (plus seeded
+ * jitter) instead of doing work, so a task set recorded on the device can
+ * be replayed under both scheduling modes and the deadline misses
+ * compared. The result is the same for the same task set and seed.
+ */
+
+struct SimTaskProfile {
+    const char* name;
+    uint32_t period;          // ms
+    uint32_t deadline;        // Relative deadline in ms (0 = period)
+    uint32_t executionTime;   // ms per run
+    uint32_t jitter;          // Up to this many extra ms per run (included in the declared max)
+    uint8_t priority;
+    bool realtime;            // Scheduled through scheduleRealtimeTask()
+};
+
+struct SimTaskResult {
+    const char* name;
+    bool admitted;            // false if EDF admission control rejected it
+    uint32_t executions;
+    uint32_t deadlineMisses;
+};
+
+struct SimReport {
+    SchedulingMode mode;
+    uint32_t durationMs;
+    uint32_t totalMisses;
+    uint32_t rejected;
+    uint32_t realtimeUtilization;   // Percent, admitted set at the end of the run
+    std::vector<SimTaskResult> tasks;
+};
+
+class ScheduleSimulator {
+public:
+    /**
+     * @brief Replay a task set in virtual time
+     * @param taskSet Tasks to schedule, in registration order
+     * @param mode Scheduling mode to use
+     * @param durationMs Virtual time to simulate
+     * @param seed Jitter seed
+     * @return Per-task executions and deadline misses
+     */
+    static SimReport run(const std::vector<SimTaskProfile>& taskSet, SchedulingMode mode,
+                         uint32_t durationMs, uint32_t seed = 1);
+
+    /**
+     * @brief Capture the periodic tasks of a live scheduler as a task set
+     *
+     * Uses the measured average run time once a task has run, otherwise
+     * its declared maximum.
+     * @param scheduler Scheduler to record
+     * @return Task set for run()
+     */
+    static std::vector<SimTaskProfile> recordTaskSet(const TaskScheduler& scheduler);
+
+    /**
+     * @brief Log a simulation report
+     * @param report Report from run()
+     */
+    static void printReport(const SimReport& report);
+};
+
+#endif // SCHEDULE_SIMULATOR_H
@@ -0,0 +1,184 @@
+#ifndef STATS_RING_H
+#define STATS_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cmath>
+#include <type_traits>
+
+/**
+ * @file stats_ring.h
+ * @brief Fixed-capacity sample history with running statistics
+ *
+ * Keeps the last Capacity samples in a ring that overwrites the oldest,
+ * plus a sorted copy of the same window. Each push replaces the evicted
+ * sample in the sorted copy by sliding only the elements between the old
+ * and new positions, so min/max/percentiles are O(1) reads and the mean
+ * comes from a running sum. Storage is inline; nothing is allocated.
+ */
+
+struct HistoryStats {
+    size_t count = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+};
+
+template <typename T, size_t Capacity>
+class StatsRing {
+    static_assert(Capacity > 0, "StatsRing capacity must be non-zero");
+    static_assert(std::is_arithmetic<T>::value, "StatsRing holds numeric samples");
+
+public:
+    /**
+     * @brief Add a sample, evicting the oldest when full
+     * @param value Sample (NaN is ignored)
+     */
+    void push(T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (std::isnan(value)) {
+                return;
+            }
+        }
+
+        if (m_count < Capacity) {
+            m_values[(m_head + m_count) % Capacity] = value;
+            insertSorted(m_count, value);
+            m_count++;
+            m_sum += static_cast<Sum>(value);
+            return;
+        }
+
+        T evicted = m_values[m_head];
+        m_values[m_head] = value;
+        m_head = (m_head + 1) % Capacity;
+        replaceSorted(evicted, value);
+
+        if (m_head == 0) {
+            // Once per lap, so float rounding in the running sum cannot accumulate
+            m_sum = 0;
+            for (size_t i = 0; i < Capacity; i++) {
+                m_sum += static_cast<Sum>(m_values[i]);
+            }
+        } else {
+            m_sum += static_cast<Sum>(value);
+            m_sum -= static_cast<Sum>(evicted);
+        }
+    }
+
+    /**
+     * @brief Remove all samples
+     */
+    void clear() {
+        m_head = 0;
+        m_count = 0;
+        m_sum = 0;
+    }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    bool full() const { return m_count == Capacity; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    /**
+     * @brief Get a sample by age
+     * @param index 0 for the oldest sample
+     * @return Sample value
+     */
+    T operator[](size_t index) const { return m_values[(m_head + index) % Capacity]; }
+
+    /**
+     * @brief Get the newest sample
+     * @return Sample value, or 0 if empty
+     */
+    T latest() const { return m_count ? (*this)[m_count - 1] : T(); }
+
+    T min() const { return m_count ? m_sorted[0] : T(); }
+    T max() const { return m_count ? m_sorted[m_count - 1] : T(); }
+
+    /**
+     * @brief Get the mean of the window
+     * @return Mean, or 0 if empty
+     */
+    float mean() const { return m_count ? static_cast<float>(m_sum / static_cast<Sum>(m_count)) : 0.0f; }
+
+    /**
+     * @brief Get a percentile of the window (nearest rank)
+     * @param percent Percentile, 0-100
+     * @return Smallest sample with at least percent% of samples at or below it
+     */
+    T percentile(float percent) const {
+        if (m_count == 0) {
+            return T();
+        }
+        // Multiply before dividing so whole percentages give exact ranks
+        double rank = std::ceil(static_cast<double>(percent) * m_count / 100.0);
+        size_t index = rank > 1.0 ? static_cast<size_t>(rank) - 1 : 0;
+        return m_sorted[index < m_count ? index : m_count - 1];
+    }
+
+    /**
+     * @brief Get all window statistics at once
+     * @return Count, min, max, mean and P50/P95/P99
+     */
+    HistoryStats stats() const {
+        HistoryStats stats;
+        stats.count = m_count;
+        stats.min = static_cast<float>(min());
+        stats.max = static_cast<float>(max());
+        stats.mean = mean();
+        stats.p50 = static_cast<float>(percentile(50.0f));
+        stats.p95 = static_cast<float>(percentile(95.0f));
+        stats.p99 = static_cast<float>(percentile(99.0f));
+        return stats;
+    }
+
+private:
+    typedef typename std::conditional<std::is_floating_point<T>::value, double, int64_t>::type Sum;
+
+    // Insert into the first count sorted elements
+    void insertSorted(size_t count, T value) {
+        size_t i = count;
+        while (i > 0 && m_sorted[i - 1] > value) {
+            m_sorted[i] = m_sorted[i - 1];
+            i--;
+        }
+        m_sorted[i] = value;
+    }
+
+    // Overwrite one occurrence of evicted with value and restore the order
+    void replaceSorted(T evicted, T value) {
+        size_t low = 0;
+        size_t high = m_count;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (m_sorted[middle] < evicted) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        size_t i = low;
+        while (i + 1 < m_count && m_sorted[i + 1] < value) {
+            m_sorted[i] = m_sorted[i + 1];
+            i++;
+        }
+        while (i > 0 && m_sorted[i - 1] > value) {
+            m_sorted[i] = m_sorted[i - 1];
+            i--;
+        }
+        m_sorted[i] = value;
+    }
+
+    T m_values[Capacity] = {};
+    T m_sorted[Capacity] = {};
+    size_t m_head = 0;      // Oldest sample
+    size_t m_count = 0;
+    Sum m_sum = 0;
+};
+
+#endif // STATS_RING_H
@@ -1,9 +1,18 @@
 #include "task_scheduler.h"
+#include "job_executor.h"
+#include "trace_recorder.h"
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <algorithm>
+#include <thread>
 
 static const char* TAG = "TaskScheduler";
 
+// Wrap-safe millisecond comparison
+static inline bool timeBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
 TaskScheduler::~TaskScheduler() {
     shutdown();
 }
@@ -15,8 +24,23 @@ os_error_t TaskScheduler::initialize() {
 
     ESP_LOGI(TAG, "Initializing Task Scheduler");
     
-    m_tasks.reserve(OS_MAX_TASKS);
-    m_lastUpdateTime = millis();
+    m_tasks.assign(OS_MAX_TASKS, Task());
+    m_generations.assign(OS_MAX_TASKS, 0);
+    m_freeSlots.clear();
+    m_freeSlots.reserve(OS_MAX_TASKS);
+    for (size_t slot = OS_MAX_TASKS; slot > 0; slot--) {
+        m_freeSlots.push_back(static_cast<uint16_t>(slot - 1));
+    }
+    m_parkedSlots.clear();
+    m_parkedSlots.reserve(OS_MAX_TASKS);
+    m_activeCount = 0;
+    m_timerHeap.reserve(OS_MAX_TASKS);
+    m_dueTasks.reserve(OS_MAX_TASKS);
+    m_offloadBusy.reset(new std::atomic<bool>[OS_MAX_TASKS]);
+    for (size_t slot = 0; slot < OS_MAX_TASKS; slot++) {
+        m_offloadBusy[slot].store(false, std::memory_order_relaxed);
+    }
+    m_lastUpdateTime = now();
     m_initialized = true;
 
     ESP_LOGI(TAG, "Task Scheduler initialized");
@@ -29,9 +53,24 @@ os_error_t TaskScheduler::shutdown() {
     }
 
     ESP_LOGI(TAG, "Shutting down Task Scheduler");
-    
+
+    // Offloaded runs clear their slot's busy flag when they finish, so the
+    // flags must outlive them; if one never finishes, leak the flags
+    if (!waitForOffloadedRuns(OS_OFFLOAD_DRAIN_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "Offloaded tasks still running after %d ms", OS_OFFLOAD_DRAIN_TIMEOUT_MS);
+        m_offloadBusy.release();
+    }
+    m_offloadBusy.reset();
+
     // Cancel all tasks
     m_tasks.clear();
+    m_generations.clear();
+    m_freeSlots.clear();
+    m_parkedSlots.clear();
+    m_activeCount = 0;
+    m_timerHeap.clear();
+    m_dueTasks.clear();
+    m_idleHandlers.clear();
     m_initialized = false;
 
     ESP_LOGI(TAG, "Task Scheduler shutdown complete");
@@ -43,116 +82,205 @@ os_error_t TaskScheduler::update(uint32_t deltaTime) {
         return OS_ERROR_GENERIC;
     }
 
-    uint32_t currentTime = millis();
+    uint32_t currentTime = now();
     uint32_t frameStartTime = currentTime;
+    uint64_t frameStartUs = esp_timer_get_time();
+    bool budgetExceeded = false;
+
+    bool edf = m_schedulingMode == SchedulingMode::EDF;
+
+    m_inUpdate = true;
+
+    // Pop every due task off the timer heap
+    m_dueTasks.clear();
+    while (!m_timerHeap.empty()) {
+        const Task& next = m_tasks[m_timerHeap.front()];
+        if (timeBefore(currentTime, next.nextExecution)) {
+            break;
+        }
+        bool realtime = edf && next.isRealtime && next.period > 0;
+        uint32_t deadline = next.nextExecution + (next.deadline ? next.deadline : next.period);
+        m_dueTasks.push_back({next.id, next.nextExecution, deadline, next.priority, realtime});
+        heapRemove(m_timerHeap.front());
+    }
 
-    // Sort tasks by priority (higher priority first)
-    std::sort(m_tasks.begin(), m_tasks.end(), 
-              [](const Task& a, const Task& b) {
+    // Run them highest priority first, oldest deadline first within a priority.
+    // In EDF mode real-time tasks go first, earliest absolute deadline first.
+    std::sort(m_dueTasks.begin(), m_dueTasks.end(),
+              [](const DueTask& a, const DueTask& b) {
+                  if (a.realtime != b.realtime) {
+                      return a.realtime;
+                  }
+                  if (a.realtime && a.deadline != b.deadline) {
+                      return timeBefore(a.deadline, b.deadline);
+                  }
                   if (a.priority != b.priority) {
                       return a.priority > b.priority;
                   }
-                  return a.nextExecution < b.nextExecution;
+                  if (a.nextExecution != b.nextExecution) {
+                      return timeBefore(a.nextExecution, b.nextExecution);
+                  }
+                  return a.id < b.id;
               });
 
-    // Execute ready tasks
-    for (auto& task : m_tasks) {
-        if (task.state == TaskState::READY && currentTime >= task.nextExecution) {
-            executeTask(task);
-            
-            // Check if we've exceeded our frame budget
-            uint32_t frameTime = millis() - frameStartTime;
-            if (frameTime > 16) { // ~60fps budget
-                break;
-            }
+    for (const DueTask& due : m_dueTasks) {
+        // An earlier task may have cancelled, suspended or resumed this one
+        Task* task = findTask(due.id);
+        if (!task || task->state != TaskState::READY || task->heapIndex != TASK_NOT_QUEUED) {
+            continue;
+        }
+
+        if (budgetExceeded && !due.realtime) {
+            // Still due; first in line next update. Admitted EDF tasks
+            // are budgeted for and always run.
+            heapPush(slotOf(due.id));
+            continue;
+        }
+
+        executeTask(*task);
+        
+        // Check if we've exceeded our frame budget
+        uint32_t frameTime = now() - frameStartTime;
+        if (frameTime > 16) { // ~60fps budget
+            budgetExceeded = true;
         }
     }
 
+    m_inUpdate = false;
+
     // Clean up completed tasks
     cleanupTasks();
 
     // Update statistics
     updateCPULoad();
+    updateFrameStats(esp_timer_get_time() - frameStartUs);
+    if (budgetExceeded) {
+        m_frameOverruns++;
+    }
 
     return OS_OK;
 }
 
 uint32_t TaskScheduler::scheduleOnce(TaskFunction function, uint8_t priority, 
-                                    uint32_t delay, const char* name) {
-    if (!m_initialized || !function || m_tasks.size() >= OS_MAX_TASKS) {
+                                    uint32_t delay, const char* name,
+                                    TaskAffinity affinity) {
+    if (!m_initialized || !function) {
         return 0;
     }
 
-    Task task;
-    task.id = generateTaskId();
-    task.function = function;
-    task.priority = priority;
-    task.state = TaskState::READY;
-    task.nextExecution = millis() + delay;
-    task.period = 0; // One-shot
-    task.maxRunTime = m_defaultMaxRunTime;
-    task.actualRunTime = 0;
-    task.executionCount = 0;
-    task.name = name;
-    task.autoDelete = true;
+    Task* task = allocateTask();
+    if (!task) {
+        return 0;
+    }
+
+    task->function = std::move(function);
+    task->priority = priority;
+    task->state = TaskState::READY;
+    task->nextExecution = now() + delay;
+    task->period = 0; // One-shot
+    task->maxRunTime = m_defaultMaxRunTime;
+    task->name = name;
+    task->autoDelete = true;
+    task->affinity = affinity;
 
-    m_tasks.push_back(task);
+    heapPush(slotOf(task->id));
 
     #if OS_DEBUG_ENABLED >= 2
     ESP_LOGD(TAG, "Scheduled one-shot task %d '%s' (priority %d, delay %d ms)", 
-            task.id, name ? name : "unnamed", priority, delay);
+            task->id, name ? name : "unnamed", priority, delay);
     #endif
 
-    return task.id;
+    return task->id;
 }
 
 uint32_t TaskScheduler::schedulePeriodic(TaskFunction function, uint32_t period, 
-                                        uint8_t priority, uint32_t delay, const char* name) {
-    if (!m_initialized || !function || period == 0 || m_tasks.size() >= OS_MAX_TASKS) {
+                                        uint8_t priority, uint32_t delay, const char* name,
+                                        TaskAffinity affinity) {
+    if (!m_initialized || !function || period == 0) {
         return 0;
     }
 
-    Task task;
-    task.id = generateTaskId();
-    task.function = function;
-    task.priority = priority;
-    task.state = TaskState::READY;
-    task.nextExecution = millis() + delay;
-    task.period = period;
-    task.maxRunTime = m_defaultMaxRunTime;
-    task.actualRunTime = 0;
-    task.executionCount = 0;
-    task.name = name;
-    task.autoDelete = false;
+    Task* task = allocateTask();
+    if (!task) {
+        return 0;
+    }
 
-    m_tasks.push_back(task);
+    task->function = std::move(function);
+    task->priority = priority;
+    task->state = TaskState::READY;
+    task->nextExecution = now() + delay;
+    task->period = period;
+    task->maxRunTime = m_defaultMaxRunTime;
+    task->name = name;
+    task->autoDelete = false;
+    task->affinity = affinity;
+
+    heapPush(slotOf(task->id));
 
     #if OS_DEBUG_ENABLED >= 2
     ESP_LOGD(TAG, "Scheduled periodic task %d '%s' (priority %d, period %d ms, delay %d ms)", 
-            task.id, name ? name : "unnamed", priority, period, delay);
+            task->id, name ? name : "unnamed", priority, period, delay);
     #endif
 
-    return task.id;
+    return task->id;
+}
+
+uint32_t TaskScheduler::addIdleHandler(IdleFunction function, const char* name) {
+    if (!m_initialized || !function) {
+        return 0;
+    }
+
+    IdleHandler handler;
+    handler.id = generateHandlerId();
+    handler.function = function;
+    handler.name = name;
+    m_idleHandlers.push_back(handler);
+
+    ESP_LOGD(TAG, "Added idle handler %d '%s'", handler.id, name ? name : "unnamed");
+    return handler.id;
+}
+
+bool TaskScheduler::removeIdleHandler(uint32_t handlerId) {
+    auto it = std::find_if(m_idleHandlers.begin(), m_idleHandlers.end(),
+                          [handlerId](const IdleHandler& handler) { return handler.id == handlerId; });
+    if (it == m_idleHandlers.end()) {
+        return false;
+    }
+
+    m_idleHandlers.erase(it);
+    m_nextIdleHandler = 0;
+    return true;
 }
 
 bool TaskScheduler::cancelTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end()) {
-        #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Cancelled task %d '%s'", taskId, it->name ? it->name : "unnamed");
-        #endif
-        m_tasks.erase(it);
-        return true;
+    Task* task = findTask(taskId);
+    if (!task || (task->state == TaskState::COMPLETED && task->autoDelete)) {
+        return false;
     }
-    return false;
+
+    #if OS_DEBUG_ENABLED >= 2
+    ESP_LOGD(TAG, "Cancelled task %d '%s'", taskId, task->name ? task->name : "unnamed");
+    #endif
+
+    if (m_inUpdate) {
+        // The task (or the one calling us) may be mid-callback; remove after the tick
+        heapRemove(slotOf(taskId));
+        task->state = TaskState::COMPLETED;
+        task->autoDelete = true;
+        m_cleanupNeeded = true;
+    } else {
+        releaseTask(slotOf(taskId));
+    }
+    return true;
 }
 
 bool TaskScheduler::suspendTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end() && it->state != TaskState::SUSPENDED) {
-        it->state = TaskState::SUSPENDED;
+    Task* task = findTask(taskId);
+    if (task && task->state != TaskState::SUSPENDED) {
+        heapRemove(slotOf(taskId));
+        task->state = TaskState::SUSPENDED;
         #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Suspended task %d '%s'", taskId, it->name ? it->name : "unnamed");
+        ESP_LOGD(TAG, "Suspended task %d '%s'", taskId, task->name ? task->name : "unnamed");
         #endif
         return true;
     }
@@ -160,11 +288,12 @@ bool TaskScheduler::suspendTask(uint32_t taskId) {
 }
 
 bool TaskScheduler::resumeTask(uint32_t taskId) {
-    auto it = findTask(taskId);
-    if (it != m_tasks.end() && it->state == TaskState::SUSPENDED) {
-        it->state = TaskState::READY;
+    Task* task = findTask(taskId);
+    if (task && task->state == TaskState::SUSPENDED) {
+        task->state = TaskState::READY;
+        heapPush(slotOf(taskId));
         #if OS_DEBUG_ENABLED >= 2
-        ESP_LOGD(TAG, "Resumed task %d '%s'", taskId, it->name ? it->name : "unnamed");
+        ESP_LOGD(TAG, "Resumed task %d '%s'", taskId, task->name ? task->name : "unnamed");
         #endif
         return true;
     }
@@ -172,20 +301,27 @@ bool TaskScheduler::resumeTask(uint32_t taskId) {
 }
 
 const Task* TaskScheduler::getTaskInfo(uint32_t taskId) const {
-    auto it = std::find_if(m_tasks.begin(), m_tasks.end(),
-                          [taskId](const Task& task) { return task.id == taskId; });
-    return (it != m_tasks.end()) ? &(*it) : nullptr;
+    return const_cast<TaskScheduler*>(this)->findTask(taskId);
 }
 
 void TaskScheduler::printStats() const {
     ESP_LOGI(TAG, "=== Task Scheduler Statistics ===");
-    ESP_LOGI(TAG, "Active tasks: %d/%d", m_tasks.size(), OS_MAX_TASKS);
+    ESP_LOGI(TAG, "Active tasks: %d/%d", m_activeCount, OS_MAX_TASKS);
     ESP_LOGI(TAG, "CPU load: %d%%", m_cpuLoad);
     ESP_LOGI(TAG, "Tasks executed: %d", m_tasksExecuted);
     ESP_LOGI(TAG, "Tasks with overrun: %d", m_tasksOverrun);
+    ESP_LOGI(TAG, "Deadline misses: %d", m_deadlineMisses);
+    if (m_schedulingMode == SchedulingMode::EDF) {
+        ESP_LOGI(TAG, "EDF utilization: %d%%/%d%%, %d rejected, %d demoted",
+                getRealtimeUtilization(), OS_EDF_UTILIZATION_BOUND,
+                m_admissionRejects, m_realtimeDemotions);
+    }
 
     ESP_LOGI(TAG, "=== Active Tasks ===");
     for (const auto& task : m_tasks) {
+        if (task.id == 0) {
+            continue;
+        }
         const char* stateStr = "UNKNOWN";
         switch (task.state) {
             case TaskState::READY: stateStr = "READY"; break;
@@ -202,9 +338,143 @@ void TaskScheduler::printStats() const {
     }
 }
 
-std::vector<Task>::iterator TaskScheduler::findTask(uint32_t taskId) {
-    return std::find_if(m_tasks.begin(), m_tasks.end(),
-                       [taskId](const Task& task) { return task.id == taskId; });
+Task* TaskScheduler::findTask(uint32_t taskId) {
+    uint16_t slot = slotOf(taskId);
+    if (taskId == 0 || slot >= m_tasks.size() || m_tasks[slot].id != taskId) {
+        return nullptr;
+    }
+    return &m_tasks[slot];
+}
+
+Task* TaskScheduler::allocateTask() {
+    reclaimParkedSlots();
+    if (m_freeSlots.empty()) {
+        return nullptr;
+    }
+
+    uint16_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    // Generation 0 is never used, so no live ID is 0
+    uint16_t generation = m_generations[slot] + 1;
+    if (generation == 0) {
+        generation = 1;
+    }
+    m_generations[slot] = generation;
+
+    Task& task = m_tasks[slot];
+    task = Task();
+    task.id = (static_cast<uint32_t>(generation) << TASK_ID_SLOT_BITS) | slot;
+    task.owner = ResourceAccountant::current();
+    m_activeCount++;
+    return &task;
+}
+
+void TaskScheduler::releaseTask(uint16_t slot) {
+    Task& task = m_tasks[slot];
+    if (task.heapIndex != TASK_NOT_QUEUED) {
+        heapRemove(slot);
+    }
+
+    // Destroy the callable and any captured state now rather than on reuse.
+    // An offloaded run still in flight holds its own copy.
+    task.function = nullptr;
+    task.id = 0;
+
+    // The busy flag belongs to the slot, so a slot whose run is still in
+    // flight stays parked until the run clears it; reusing it earlier would
+    // make the new task look like its own overrun
+    if (m_offloadBusy && m_offloadBusy[slot].load(std::memory_order_acquire)) {
+        m_parkedSlots.push_back(slot);
+    } else {
+        m_freeSlots.push_back(slot);
+    }
+    m_activeCount--;
+}
+
+void TaskScheduler::reclaimParkedSlots() {
+    for (size_t i = 0; i < m_parkedSlots.size();) {
+        uint16_t slot = m_parkedSlots[i];
+        if (m_offloadBusy[slot].load(std::memory_order_acquire)) {
+            i++;
+            continue;
+        }
+        m_freeSlots.push_back(slot);
+        m_parkedSlots[i] = m_parkedSlots.back();
+        m_parkedSlots.pop_back();
+    }
+}
+
+bool TaskScheduler::heapLess(uint16_t a, uint16_t b) const {
+    const Task& taskA = m_tasks[a];
+    const Task& taskB = m_tasks[b];
+    if (taskA.nextExecution != taskB.nextExecution) {
+        return timeBefore(taskA.nextExecution, taskB.nextExecution);
+    }
+    return taskA.priority > taskB.priority;
+}
+
+void TaskScheduler::heapPush(uint16_t slot) {
+    if (m_tasks[slot].heapIndex != TASK_NOT_QUEUED) {
+        return;
+    }
+    m_timerHeap.push_back(slot);
+    m_tasks[slot].heapIndex = static_cast<uint16_t>(m_timerHeap.size() - 1);
+    heapSiftUp(m_timerHeap.size() - 1);
+}
+
+void TaskScheduler::heapRemove(uint16_t slot) {
+    size_t position = m_tasks[slot].heapIndex;
+    if (position == TASK_NOT_QUEUED) {
+        return;
+    }
+    m_tasks[slot].heapIndex = TASK_NOT_QUEUED;
+
+    uint16_t last = m_timerHeap.back();
+    m_timerHeap.pop_back();
+    if (position < m_timerHeap.size()) {
+        heapPlace(position, last);
+        heapSiftUp(position);
+        heapSiftDown(m_tasks[last].heapIndex);
+    }
+}
+
+void TaskScheduler::heapSiftUp(size_t position) {
+    uint16_t slot = m_timerHeap[position];
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (!heapLess(slot, m_timerHeap[parent])) {
+            break;
+        }
+        heapPlace(position, m_timerHeap[parent]);
+        position = parent;
+    }
+    heapPlace(position, slot);
+}
+
+void TaskScheduler::heapSiftDown(size_t position) {
+    uint16_t slot = m_timerHeap[position];
+    size_t count = m_timerHeap.size();
+    for (;;) {
+        size_t child = position * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && heapLess(m_timerHeap[child + 1], m_timerHeap[child])) {
+            child++;
+        }
+        if (!heapLess(m_timerHeap[child], slot)) {
+            break;
+        }
+        heapPlace(position, m_timerHeap[child]);
+        position = child;
+    }
+    heapPlace(position, slot);
+}
+
+void TaskScheduler::heapPlace(size_t position, uint16_t slot) {
+    m_timerHeap[position] = slot;
+    m_tasks[slot].heapIndex = static_cast<uint16_t>(position);
 }
 
 void TaskScheduler::executeTask(Task& task) {
@@ -212,10 +482,20 @@ void TaskScheduler::executeTask(Task& task) {
         return;
     }
 
+    if (task.affinity != TaskAffinity::MAIN_LOOP && dispatchTask(task)) {
+        return;
+    }
+
     task.state = TaskState::RUNNING;
-    uint32_t startTime = millis();
+    uint32_t release = task.nextExecution;
+    uint32_t startTime = now();
 
     try {
+        PERF_TRACE_SCOPE(task.name ? task.name : "task");
+        AccountScope account(task.owner);
+        if (task.owner) {
+            task.owner->taskRuns++;
+        }
         task.function();
         m_tasksExecuted++;
     } catch (...) {
@@ -223,28 +503,33 @@ void TaskScheduler::executeTask(Task& task) {
                 task.id, task.name ? task.name : "unnamed");
     }
 
-    uint32_t endTime = millis();
+    uint32_t endTime = now();
     uint32_t executionTime = endTime - startTime;
 
-    // Update task statistics
-    task.actualRunTime += executionTime;
-    task.executionCount++;
-
-    // Check for overrun
-    if (executionTime > task.maxRunTime) {
-        m_tasksOverrun++;
-        ESP_LOGW(TAG, "Task %d '%s' overran: %d ms > %d ms limit", 
-                task.id, task.name ? task.name : "unnamed", 
-                executionTime, task.maxRunTime);
-    }
+    accountRun(task, release, executionTime, endTime);
 
-    // Schedule next execution for periodic tasks
+    // Schedule next execution for periodic tasks. The callback may have
+    // suspended or cancelled its own task; that takes precedence.
     if (task.period > 0) {
-        task.nextExecution = endTime + task.period;
-        task.state = TaskState::READY;
-    } else {
+        if (task.isRealtime) {
+            // Release on the period grid so deadlines do not drift; if the
+            // next release has already passed, run once now instead of
+            // bursting through the backlog
+            task.nextExecution = release + task.period;
+            if (timeBefore(task.nextExecution, endTime)) {
+                task.nextExecution = endTime;
+            }
+        } else {
+            task.nextExecution = endTime + releaseInterval(task);
+        }
+        if (task.state == TaskState::RUNNING) {
+            task.state = TaskState::READY;
+            heapPush(slotOf(task.id));
+        }
+    } else if (task.state == TaskState::RUNNING) {
         // One-shot task completed
         task.state = TaskState::COMPLETED;
+        m_cleanupNeeded = true;
     }
 
     // Update total execution time for CPU load calculation
@@ -256,8 +541,179 @@ void TaskScheduler::executeTask(Task& task) {
     #endif
 }
 
+bool TaskScheduler::dispatchTask(Task& task) {
+    if (!m_executor || !m_executor->isRunning()) {
+        return false;
+    }
+
+    // A periodic task whose previous run is still in flight skips this
+    // period rather than piling up copies on the worker
+    std::atomic<bool>* busy = &m_offloadBusy[slotOf(task.id)];
+    bool inFlight = busy->exchange(true, std::memory_order_acq_rel);
+    if (!inFlight) {
+        JobAffinity jobAffinity = JobAffinity::ANY;
+        if (task.affinity == TaskAffinity::REALTIME_CORE) {
+            jobAffinity = JobAffinity::REALTIME;
+        } else if (task.affinity == TaskAffinity::BACKGROUND_CORE) {
+            jobAffinity = JobAffinity::BACKGROUND;
+        }
+
+        // The job owns a copy of the callable (stored inline, no heap) so
+        // cancelling the task cannot destroy it mid-run
+        TaskFunction function = task.function;
+        uint32_t taskId = task.id;
+        bool submitted = m_executor->submit([function, busy, taskId]() {
+            try {
+                function();
+            } catch (...) {
+                ESP_LOGE(TAG, "Offloaded task %d threw an exception", taskId);
+            }
+            busy->store(false, std::memory_order_release);
+        }, jobAffinity);
+
+        if (!submitted) {
+            busy->store(false, std::memory_order_release);
+            return false;
+        }
+
+        m_tasksExecuted++;
+        task.executionCount++;
+    } else {
+        task.overrunCount++;
+        m_tasksOverrun++;
+    }
+
+    if (task.period > 0) {
+        task.nextExecution = now() + releaseInterval(task);
+        heapPush(slotOf(task.id));
+    } else {
+        // One-shots only dispatch once, and a slot is not reused while its
+        // previous task's run is in flight, so they are never in flight here
+        task.state = TaskState::COMPLETED;
+        m_cleanupNeeded = true;
+    }
+
+    return true;
+}
+
+void TaskScheduler::accountRun(Task& task, uint32_t release, uint32_t executionTime, uint32_t endTime) {
+    task.actualRunTime += executionTime;
+    task.executionCount++;
+    if (task.executionCount == 1) {
+        task.avgExecutionTime = executionTime;
+    } else {
+        task.avgExecutionTime = task.avgExecutionTime * 0.875f + executionTime * 0.125f;
+    }
+
+    // Only real-time tasks have a deadline to miss; a late background task
+    // is just late, and a demoted task has lost its guarantee
+    if (task.isRealtime) {
+        uint32_t relativeDeadline = task.deadline ? task.deadline : task.period;
+        if (timeBefore(release + relativeDeadline, endTime)) {
+            task.deadlineMisses++;
+            m_deadlineMisses++;
+        }
+    }
+
+    // Check for overrun
+    if (executionTime <= task.maxRunTime) {
+        task.consecutiveOverruns = 0;
+        return;
+    }
+
+    task.overrunCount++;
+    m_tasksOverrun++;
+    ESP_LOGW(TAG, "Task %d '%s' overran: %d ms > %d ms limit", 
+            task.id, task.name ? task.name : "unnamed", 
+            executionTime, task.maxRunTime);
+
+    // An admitted task that keeps overrunning invalidates the admission
+    // test for everyone else, so it loses its deadline guarantee
+    if (task.isRealtime && m_schedulingMode == SchedulingMode::EDF &&
+        ++task.consecutiveOverruns >= OS_EDF_OVERRUN_BUDGET) {
+        task.isRealtime = false;
+        task.consecutiveOverruns = 0;
+        m_realtimeDemotions++;
+        ESP_LOGW(TAG, "Task %d '%s' demoted from EDF after %d consecutive overruns",
+                task.id, task.name ? task.name : "unnamed", OS_EDF_OVERRUN_BUDGET);
+    }
+}
+
+float TaskScheduler::admissionRunTime(const Task& task) {
+    return task.executionCount > 0 ? task.avgExecutionTime : static_cast<float>(task.maxRunTime);
+}
+
+uint32_t TaskScheduler::getRealtimeUtilization() const {
+    float density = 0.0f;
+    for (const auto& task : m_tasks) {
+        if (task.id != 0 && task.isRealtime && task.period > 0 && task.state != TaskState::COMPLETED) {
+            uint32_t window = task.deadline ? std::min(task.deadline, task.period) : task.period;
+            density += admissionRunTime(task) / window;
+        }
+    }
+    return static_cast<uint32_t>(density * 100.0f + 0.5f);
+}
+
+void TaskScheduler::setSchedulingMode(SchedulingMode mode) {
+    m_schedulingMode = mode;
+
+    uint32_t utilization = getRealtimeUtilization();
+    ESP_LOGI(TAG, "Scheduling mode %s (real-time utilization %d%%)",
+            mode == SchedulingMode::EDF ? "EDF" : "PRIORITY", utilization);
+    if (mode == SchedulingMode::EDF && utilization > OS_EDF_UTILIZATION_BOUND) {
+        ESP_LOGW(TAG, "Existing real-time tasks exceed the %d%% EDF bound; deadlines may be missed",
+                OS_EDF_UTILIZATION_BOUND);
+    }
+}
+
+void TaskScheduler::setBackgroundThrottle(uint8_t percent) {
+    if (percent > OS_MAX_BACKGROUND_THROTTLE) {
+        percent = OS_MAX_BACKGROUND_THROTTLE;
+    }
+    if (percent != m_backgroundThrottle) {
+        ESP_LOGD(TAG, "Background task throttle %d%%", percent);
+    }
+    m_backgroundThrottle = percent;
+}
+
+bool TaskScheduler::waitForOffloadedRuns(uint32_t timeoutMs) {
+    if (!m_offloadBusy) {
+        return true;
+    }
+
+    int64_t deadline = esp_timer_get_time() + static_cast<int64_t>(timeoutMs) * 1000;
+    for (size_t slot = 0; slot < OS_MAX_TASKS; slot++) {
+        while (m_offloadBusy[slot].load(std::memory_order_acquire)) {
+            if (esp_timer_get_time() >= deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+    return true;
+}
+
+uint32_t TaskScheduler::releaseInterval(const Task& task) const {
+    if (m_backgroundThrottle == 0 || task.isRealtime || task.priority >= OS_TASK_PRIORITY_NORMAL) {
+        return task.period;
+    }
+    return task.period * 100 / (100 - m_backgroundThrottle);
+}
+
+void TaskScheduler::forEachTask(const std::function<void(const Task&)>& visitor) const {
+    for (const auto& task : m_tasks) {
+        if (task.id != 0) {
+            visitor(task);
+        }
+    }
+}
+
+uint32_t TaskScheduler::now() const {
+    return m_timeSource ? m_timeSource() : millis();
+}
+
 void TaskScheduler::updateCPULoad() {
-    uint32_t currentTime = millis();
+    uint32_t currentTime = now();
     uint32_t elapsed = currentTime - m_lastUpdateTime;
     
     if (elapsed >= 1000) { // Update every second
@@ -269,66 +725,108 @@ void TaskScheduler::updateCPULoad() {
     }
 }
 
+uint32_t TaskScheduler::runIdle(uint32_t slackUs) {
+    if (m_idleHandlers.empty() || slackUs < OS_IDLE_SLICE_MIN_US) {
+        return 0;
+    }
+
+    uint64_t sliceStart = esp_timer_get_time();
+    uint64_t sliceBudget = std::min<uint64_t>(slackUs, OS_IDLE_SLICE_MAX_US);
+
+    // Round-robin so one busy handler cannot starve the others
+    for (size_t visited = 0; visited < m_idleHandlers.size(); visited++) {
+        uint64_t used = esp_timer_get_time() - sliceStart;
+        if (used + OS_IDLE_SLICE_MIN_US > sliceBudget) {
+            break;
+        }
+
+        IdleHandler& handler = m_idleHandlers[m_nextIdleHandler];
+        m_nextIdleHandler = (m_nextIdleHandler + 1) % m_idleHandlers.size();
+
+        uint64_t start = esp_timer_get_time();
+        handler.function(static_cast<uint32_t>(sliceBudget - used));
+        uint64_t runTime = esp_timer_get_time() - start;
+
+        handler.runCount++;
+        handler.totalTimeUs += runTime;
+    }
+
+    uint32_t spent = static_cast<uint32_t>(esp_timer_get_time() - sliceStart);
+    m_idleTimeUs += spent;
+    return spent;
+}
+
 void TaskScheduler::cleanupTasks() {
-    size_t initialSize = m_tasks.size();
-    m_tasks.erase(
-        std::remove_if(m_tasks.begin(), m_tasks.end(),
-                      [](const Task& task) {
-                          return task.state == TaskState::COMPLETED && task.autoDelete;
-                      }),
-        m_tasks.end());
+    if (!m_cleanupNeeded) {
+        return;
+    }
+    m_cleanupNeeded = false;
+
+    size_t initialCount = m_activeCount;
+    for (size_t slot = 0; slot < m_tasks.size(); slot++) {
+        const Task& task = m_tasks[slot];
+        if (task.id != 0 && task.state == TaskState::COMPLETED && task.autoDelete) {
+            releaseTask(static_cast<uint16_t>(slot));
+        }
+    }
     
-    size_t removedTasks = initialSize - m_tasks.size();
+    size_t removedTasks = initialCount - m_activeCount;
     if (removedTasks > 0) {
         ESP_LOGD(TAG, "Cleaned up %d completed tasks", removedTasks);
     }
 }
 
 uint32_t TaskScheduler::scheduleRealtimeTask(TaskFunction function, uint32_t period,
-                                            uint8_t priority, uint32_t maxRuntime, const char* name) {
-    if (!m_initialized || !function || period == 0 || m_tasks.size() >= OS_MAX_TASKS) {
+                                            uint8_t priority, uint32_t maxRuntime, const char* name,
+                                            uint32_t deadline) {
+    if (!m_initialized || !function || period == 0) {
+        return 0;
+    }
+
+    // Admission control: the declared run time must fit in what is left
+    // under the bound, using measured averages for the admitted tasks
+    if (m_schedulingMode == SchedulingMode::EDF) {
+        uint32_t window = deadline ? std::min(deadline, period) : period;
+        uint32_t required = (maxRuntime * 100 + window - 1) / window;
+        uint32_t utilization = getRealtimeUtilization();
+        if (utilization + required > OS_EDF_UTILIZATION_BOUND) {
+            m_admissionRejects++;
+            ESP_LOGW(TAG, "Rejected real-time task '%s': %d%% + %d%% exceeds %d%% EDF bound",
+                    name ? name : "unnamed", utilization, required, OS_EDF_UTILIZATION_BOUND);
+            return 0;
+        }
+    }
+
+    Task* task = allocateTask();
+    if (!task) {
         return 0;
     }
 
-    Task task;
-    task.id = generateTaskId();
-    task.function = function;
-    task.priority = priority;
-    task.state = TaskState::READY;
-    task.nextExecution = millis();
-    task.period = period;
-    task.maxRunTime = maxRuntime;
-    task.actualRunTime = 0;
-    task.executionCount = 0;
-    task.overrunCount = 0;
-    task.avgExecutionTime = 0.0f;
-    task.name = name;
-    task.autoDelete = false;
-    task.isRealtime = true; // Mark as real-time task
-
-    m_tasks.push_back(task);
+    task->function = std::move(function);
+    task->priority = priority;
+    task->state = TaskState::READY;
+    task->nextExecution = now();
+    task->period = period;
+    task->maxRunTime = maxRuntime;
+    task->name = name;
+    task->autoDelete = false;
+    task->isRealtime = true; // Mark as real-time task
+    task->deadline = deadline;
+
+    heapPush(slotOf(task->id));
 
     ESP_LOGI(TAG, "Scheduled real-time task %d '%s' (priority %d, period %d ms, max runtime %d ms)", 
-            task.id, name ? name : "unnamed", priority, period, maxRuntime);
+            task->id, name ? name : "unnamed", priority, period, maxRuntime);
 
-    return task.id;
+    return task->id;
 }
 
 void TaskScheduler::updateFrameStats(uint64_t frameTime) {
-    uint32_t frameTimeMs = frameTime / 1000;
+    float frameTimeMs = frameTime / 1000.0f;
     
     // Update rolling average
-    m_frameTimeHistory.push_back(frameTimeMs);
-    if (m_frameTimeHistory.size() > 60) {
-        m_frameTimeHistory.erase(m_frameTimeHistory.begin());
-    }
-    
-    // Calculate average
-    uint32_t sum = 0;
-    for (uint32_t time : m_frameTimeHistory) {
-        sum += time;
-    }
-    m_averageFrameTime = (float)sum / m_frameTimeHistory.size();
+    m_frameTimeHistory.push(frameTimeMs);
+    m_averageFrameTime = m_frameTimeHistory.mean();
     
     // Track maximum
     if (frameTimeMs > m_maxFrameTime) {
@@ -341,7 +839,7 @@ void TaskScheduler::optimizeForRealtime() {
     
     // Mark high-priority tasks as real-time
     for (auto& task : m_tasks) {
-        if (task.priority >= OS_TASK_PRIORITY_HIGH) {
+        if (task.id != 0 && task.priority >= OS_TASK_PRIORITY_HIGH) {
             task.isRealtime = true;
             // Reduce max runtime for real-time tasks
             if (task.maxRunTime > 10) {
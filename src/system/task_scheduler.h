@@ -2,9 +2,13 @@
 #define TASK_SCHEDULER_H
 
 #include "os_config.h"
+#include "inplace_function.h"
+#include "stats_ring.h"
+#include "resource_accountant.h"
 #include <functional>
 #include <vector>
-#include <queue>
+#include <memory>
+#include <atomic>
 
 /**
  * @file task_scheduler.h
@@ -12,9 +16,39 @@
  * 
  * Provides cooperative multitasking with priority-based scheduling,
  * periodic tasks, and deferred execution capabilities.
+ *
+ * Ready tasks sit in an indexed min-heap keyed on nextExecution, so each
+ * update() only touches the tasks that are due (O(k log n)); due tasks
+ * run highest priority first.
+ *
+ * Tasks live in a slab of OS_MAX_TASKS slots allocated by initialize().
+ * A task ID packs the slot index with a per-slot generation, so lookup is
+ * an index plus a generation check and a stale ID never matches a reused
+ * slot. Task callables are stored inline, so scheduling, cancelling and
+ * running tasks never touch the heap.
+ *
+ * Tasks default to running inline on the main loop. A task given a core
+ * affinity is dispatched to the JobExecutor when due instead, so heavy
+ * periodic work can run on the other core without blocking update().
+ *
+ * In EDF mode, due real-time tasks run earliest absolute deadline first,
+ * ahead of other tasks and exempt from the frame budget cut-off. New
+ * real-time tasks are only admitted while the summed density of the
+ * real-time set (measured or declared run time over deadline) stays under
+ * OS_EDF_UTILIZATION_BOUND; a task that keeps overrunning its declared
+ * run time is demoted to a normal task.
  */
 
-typedef std::function<void()> TaskFunction;
+class JobExecutor;
+
+typedef InplaceFunction<void(), OS_TASK_FUNCTION_CAPACITY> TaskFunction;
+typedef std::function<void(uint32_t budgetUs)> IdleFunction;
+typedef std::function<uint32_t()> TimeSource;
+
+enum class SchedulingMode : uint8_t {
+    PRIORITY,   // Due tasks by priority; everything stops at the frame budget
+    EDF         // Real-time tasks earliest deadline first, then the rest by priority
+};
 
 enum class TaskState {
     READY,
@@ -24,6 +58,24 @@ enum class TaskState {
     COMPLETED
 };
 
+struct IdleHandler {
+    uint32_t id;
+    IdleFunction function;
+    const char* name;
+    uint32_t runCount = 0;
+    uint64_t totalTimeUs = 0;
+};
+
+enum class TaskAffinity : uint8_t {
+    MAIN_LOOP,        // Run inline in update() (default)
+    ANY_CORE,         // Offload to any executor worker
+    REALTIME_CORE,    // Offload to the realtime worker (core 0)
+    BACKGROUND_CORE   // Offload to the background worker (last core)
+};
+
+static constexpr uint16_t TASK_NOT_QUEUED = 0xFFFF;
+static constexpr uint32_t TASK_ID_SLOT_BITS = 16;   // Task ID = generation << 16 | slot
+
 struct Task {
     uint32_t id;
     TaskFunction function;
@@ -39,6 +91,12 @@ struct Task {
     const char* name;
     bool autoDelete;
     bool isRealtime = false; // Flag for real-time tasks
+    uint32_t deadline = 0;   // Relative deadline in ms (0 = period)
+    uint32_t deadlineMisses = 0; // Counted while the task is real-time
+    uint8_t consecutiveOverruns = 0;
+    uint16_t heapIndex = TASK_NOT_QUEUED;  // Position in the timer heap (scheduler internal)
+    TaskAffinity affinity = TaskAffinity::MAIN_LOOP;
+    AppAccount* owner = nullptr;  // App charged for main-loop runs (account current when scheduled)
 };
 
 class TaskScheduler {
@@ -71,10 +129,12 @@ public:
      * @param priority Task priority (0-3, higher = more important)
      * @param delay Delay before execution in milliseconds
      * @param name Optional task name for debugging
+     * @param affinity Where to run the task
      * @return Task ID or 0 on failure
      */
     uint32_t scheduleOnce(TaskFunction function, uint8_t priority = OS_TASK_PRIORITY_NORMAL, 
-                         uint32_t delay = 0, const char* name = nullptr);
+                         uint32_t delay = 0, const char* name = nullptr,
+                         TaskAffinity affinity = TaskAffinity::MAIN_LOOP);
 
     /**
      * @brief Schedule a periodic task
@@ -83,11 +143,13 @@ public:
      * @param priority Task priority (0-3, higher = more important)
      * @param delay Initial delay before first execution in milliseconds
      * @param name Optional task name for debugging
+     * @param affinity Where to run the task
      * @return Task ID or 0 on failure
      */
     uint32_t schedulePeriodic(TaskFunction function, uint32_t period, 
                              uint8_t priority = OS_TASK_PRIORITY_NORMAL,
-                             uint32_t delay = 0, const char* name = nullptr);
+                             uint32_t delay = 0, const char* name = nullptr,
+                             TaskAffinity affinity = TaskAffinity::MAIN_LOOP);
     
     /**
      * @brief Schedule a real-time periodic task
@@ -96,11 +158,48 @@ public:
      * @param priority Task priority (should be HIGH)
      * @param maxRuntime Maximum execution time in milliseconds
      * @param name Optional task name for debugging
-     * @return Task ID or 0 on failure
+     * @param deadline Relative deadline in milliseconds (0 = period)
+     * @return Task ID or 0 on failure or if EDF admission control rejects it
      */
     uint32_t scheduleRealtimeTask(TaskFunction function, uint32_t period,
                                  uint8_t priority = OS_TASK_PRIORITY_HIGH,
-                                 uint32_t maxRuntime = 5, const char* name = nullptr);
+                                 uint32_t maxRuntime = 5, const char* name = nullptr,
+                                 uint32_t deadline = 0);
+
+    /**
+     * @brief Register background work to run in idle slices
+     *
+     * Idle handlers are run round-robin by runIdle() with the slack left
+     * at the end of a frame (at most OS_IDLE_SLICE_MAX_US) and must return
+     * within the budget they are given.
+     * @param function Idle function receiving its time budget in microseconds
+     * @param name Optional handler name for debugging
+     * @return Handler ID or 0 on failure
+     */
+    uint32_t addIdleHandler(IdleFunction function, const char* name = nullptr);
+
+    /**
+     * @brief Remove an idle handler
+     * @param handlerId Handler ID returned by addIdleHandler()
+     * @return true if the handler was found and removed
+     */
+    bool removeIdleHandler(uint32_t handlerId);
+
+    /**
+     * @brief Run idle handlers in the slack left at the end of a frame
+     *
+     * Called once the frame's work is done and before the loop sleeps;
+     * nothing runs with less than OS_IDLE_SLICE_MIN_US of slack.
+     * @param slackUs Microseconds until the next frame should start
+     * @return Microseconds spent in idle handlers
+     */
+    uint32_t runIdle(uint32_t slackUs);
+
+    /**
+     * @brief Get total time spent in idle handlers
+     * @return Idle handler time in microseconds
+     */
+    uint64_t getIdleTimeUs() const { return m_idleTimeUs; }
 
     /**
      * @brief Cancel a scheduled task
@@ -134,7 +233,7 @@ public:
      * @brief Get number of active tasks
      * @return Number of active tasks
      */
-    size_t getActiveTaskCount() const { return m_tasks.size(); }
+    size_t getActiveTaskCount() const { return m_activeCount; }
 
     /**
      * @brief Get CPU load percentage
@@ -158,6 +257,13 @@ public:
      * @return Maximum frame time in milliseconds
      */
     float getMaxFrameTime() const { return m_maxFrameTime; }
+
+    /**
+     * @brief Get distribution of recent update times
+     * @return Min/max/mean and P50/P95/P99 in milliseconds over the last
+     *         OS_FRAME_HISTORY_SIZE updates
+     */
+    HistoryStats getFrameTimeStats() const { return m_frameTimeHistory.stats(); }
     
     /**
      * @brief Check if scheduler is maintaining 60Hz
@@ -176,19 +282,123 @@ public:
      */
     void optimizeForRealtime();
 
+    /**
+     * @brief Select how due tasks are ordered
+     * @param mode PRIORITY or EDF
+     */
+    void setSchedulingMode(SchedulingMode mode);
+
+    /**
+     * @brief Get the scheduling mode
+     * @return Current scheduling mode
+     */
+    SchedulingMode getSchedulingMode() const { return m_schedulingMode; }
+
+    /**
+     * @brief Slow down background periodic tasks
+     *
+     * Stretches the period of non-real-time tasks below
+     * OS_TASK_PRIORITY_NORMAL so they run at (100 - percent)% of their
+     * rate, freeing CPU for the frame. Takes effect from each task's next
+     * release.
+     * @param percent Rate withheld, clamped to OS_MAX_BACKGROUND_THROTTLE
+     */
+    void setBackgroundThrottle(uint8_t percent);
+
+    /**
+     * @brief Get the background task throttle
+     * @return Percent of background task rate withheld
+     */
+    uint8_t getBackgroundThrottle() const { return m_backgroundThrottle; }
+
+    /**
+     * @brief Get the density of the admitted real-time task set
+     * @return Sum of run time over deadline, in percent
+     */
+    uint32_t getRealtimeUtilization() const;
+
+    /**
+     * @brief Get number of real-time task runs that finished after their deadline
+     * @return Deadline miss count
+     */
+    uint32_t getDeadlineMisses() const { return m_deadlineMisses; }
+
+    /**
+     * @brief Get number of real-time tasks rejected by admission control
+     * @return Rejected task count
+     */
+    uint32_t getAdmissionRejects() const { return m_admissionRejects; }
+
+    /**
+     * @brief Visit every scheduled task
+     * @param visitor Called once per task
+     */
+    void forEachTask(const std::function<void(const Task&)>& visitor) const;
+
+    /**
+     * @brief Replace the millisecond clock
+     *
+     * Lets the schedule simulator drive the scheduler in virtual time.
+     * @param source Clock returning milliseconds, or nullptr for millis()
+     */
+    void setTimeSource(TimeSource source) { m_timeSource = source; }
+
     /**
      * @brief Set maximum execution time for new tasks
      * @param maxTime Maximum execution time in milliseconds
      */
     void setDefaultMaxRunTime(uint32_t maxTime) { m_defaultMaxRunTime = maxTime; }
 
+    /**
+     * @brief Set the executor used for tasks with a core affinity
+     *
+     * Without an executor, or while it is stopped, such tasks run inline.
+     * @param executor Job executor, or nullptr
+     */
+    void setExecutor(JobExecutor* executor) { m_executor = executor; }
+
 private:
+    struct DueTask {
+        uint32_t id;
+        uint32_t nextExecution;
+        uint32_t deadline;      // Absolute; only ordered on for real-time tasks in EDF mode
+        uint8_t priority;
+        bool realtime;
+    };
+
     /**
      * @brief Find task by ID
      * @param taskId Task ID to find
-     * @return Iterator to task or end() if not found
+     * @return Task or nullptr if not found or stale
      */
-    std::vector<Task>::iterator findTask(uint32_t taskId);
+    Task* findTask(uint32_t taskId);
+
+    /**
+     * @brief Take a free slot and give it a fresh ID
+     * @return Reset task with its ID set, or nullptr if the slab is full
+     */
+    Task* allocateTask();
+
+    /**
+     * @brief Return a task's slot to the free list
+     * @param slot Slot index
+     */
+    void releaseTask(uint16_t slot);
+
+    /**
+     * @brief Slot index of a task ID
+     * @param taskId Task ID
+     * @return Slot index
+     */
+    static uint16_t slotOf(uint32_t taskId) { return static_cast<uint16_t>(taskId); }
+
+    // Timer heap on m_tasks slots, earliest nextExecution (then highest priority) on top
+    bool heapLess(uint16_t a, uint16_t b) const;
+    void heapPush(uint16_t slot);
+    void heapRemove(uint16_t slot);
+    void heapSiftUp(size_t position);
+    void heapSiftDown(size_t position);
+    void heapPlace(size_t position, uint16_t slot);
 
     /**
      * @brief Execute a single task
@@ -196,6 +406,54 @@ private:
      */
     void executeTask(Task& task);
 
+    /**
+     * @brief Hand a due task to the job executor
+     * @param task Task with a core affinity
+     * @return false if the task must run inline instead
+     */
+    bool dispatchTask(Task& task);
+
+    /**
+     * @brief Wait until no offloaded run is in flight
+     * @param timeoutMs Timeout in milliseconds
+     * @return false if a run was still in flight at the timeout
+     */
+    bool waitForOffloadedRuns(uint32_t timeoutMs);
+
+    /**
+     * @brief Move parked slots whose offloaded run has finished to the free list
+     */
+    void reclaimParkedSlots();
+
+    /**
+     * @brief Record run time, deadline and overrun statistics after a run
+     * @param task Task that just ran
+     * @param release Release time of the run
+     * @param executionTime Run time in milliseconds
+     * @param endTime Completion time
+     */
+    void accountRun(Task& task, uint32_t release, uint32_t executionTime, uint32_t endTime);
+
+    /**
+     * @brief Interval until a periodic task's next release
+     * @param task Periodic task
+     * @return Period, stretched for throttled background tasks
+     */
+    uint32_t releaseInterval(const Task& task) const;
+
+    /**
+     * @brief Run time used for admission control
+     * @param task Real-time task
+     * @return Measured average once the task has run, else its declared maximum
+     */
+    static float admissionRunTime(const Task& task);
+
+    /**
+     * @brief Current time from the time source
+     * @return Milliseconds
+     */
+    uint32_t now() const;
+
     /**
      * @brief Update CPU load statistics
      */
@@ -207,15 +465,40 @@ private:
     void cleanupTasks();
 
     /**
-     * @brief Generate unique task ID
-     * @return Unique task ID
+     * @brief Generate unique idle handler ID
+     * @return Unique handler ID
      */
-    uint32_t generateTaskId() { return ++m_nextTaskId; }
+    uint32_t generateHandlerId() { return ++m_nextHandlerId; }
 
-    // Task management
-    std::vector<Task> m_tasks;
-    uint32_t m_nextTaskId = 0;
+    // Task management. All containers are sized to OS_MAX_TASKS by
+    // initialize(). Removals are deferred while update() runs, so a task's
+    // callable is not destroyed while it is executing.
+    std::vector<Task> m_tasks;                 // Slab; free slots have id 0
+    std::vector<uint16_t> m_generations;       // Per-slot generation, bumped on reuse
+    std::vector<uint16_t> m_freeSlots;         // Stack of free slot indices
+    std::vector<uint16_t> m_parkedSlots;       // Released slots with an offloaded run in flight
+    std::vector<uint16_t> m_timerHeap;         // Slots of queued READY tasks
+    std::vector<DueTask> m_dueTasks;           // Reused by update()
+    std::unique_ptr<std::atomic<bool>[]> m_offloadBusy; // Per slot, set while an offloaded run is in flight
+    size_t m_activeCount = 0;
+    bool m_inUpdate = false;
+    bool m_cleanupNeeded = false;
+    uint32_t m_nextHandlerId = 0;
     uint32_t m_defaultMaxRunTime = 50; // 50ms default max run time
+    JobExecutor* m_executor = nullptr;
+    TimeSource m_timeSource;
+
+    // Deadline scheduling
+    SchedulingMode m_schedulingMode = SchedulingMode::PRIORITY;
+    uint8_t m_backgroundThrottle = 0;
+    uint32_t m_deadlineMisses = 0;
+    uint32_t m_admissionRejects = 0;
+    uint32_t m_realtimeDemotions = 0;
+
+    // Idle-slice background work
+    std::vector<IdleHandler> m_idleHandlers;
+    size_t m_nextIdleHandler = 0;
+    uint64_t m_idleTimeUs = 0;
 
     // Statistics
     uint32_t m_totalExecutionTime = 0;
@@ -226,7 +509,7 @@ private:
     uint32_t m_frameOverruns = 0;
     
     // Performance monitoring
-    std::vector<uint32_t> m_frameTimeHistory;
+    StatsRing<float, OS_FRAME_HISTORY_SIZE> m_frameTimeHistory;   // ms
     uint64_t m_lastFrameTime = 0;
     float m_averageFrameTime = 16.67f; // Target 60Hz
     float m_maxFrameTime = 0.0f;
@@ -0,0 +1,194 @@
+#include "trace_recorder.h"
+#include <esp_log.h>
+#include <algorithm>
+#include <new>
+#include <inttypes.h>
+
+static const char* TAG = "TraceRecorder";
+
+TraceRecorder& TraceRecorder::getInstance() {
+    static TraceRecorder instance;
+    return instance;
+}
+
+os_error_t TraceRecorder::startCapture(size_t maxEvents) {
+    m_capturing.store(false, std::memory_order_relaxed);
+
+    // Discard markers left over from a previous capture
+    TraceEvent discarded;
+    for (auto& ring : m_rings) {
+        while (ring.pop(discarded)) {
+        }
+    }
+
+    m_events.clear();
+    m_taskLabels.clear();
+    if (maxEvents == 0) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    try {
+        m_events.reserve(maxEvents);
+    } catch (const std::bad_alloc&) {
+        ESP_LOGE(TAG, "Failed to reserve %d trace events", (int)maxEvents);
+        return OS_ERROR_NO_MEMORY;
+    }
+
+    m_maxEvents = maxEvents;
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_captureStart = esp_timer_get_time();
+    m_capturing.store(true, std::memory_order_release);
+
+    ESP_LOGI(TAG, "Trace capture started (%d events max)", (int)maxEvents);
+    return OS_OK;
+}
+
+void TraceRecorder::stopCapture() {
+    if (!m_capturing.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    collect();
+
+    ESP_LOGI(TAG, "Trace capture stopped: %d events, %d dropped",
+            (int)m_events.size(), (int)getDroppedCount());
+}
+
+size_t TraceRecorder::collect() {
+    size_t collected = 0;
+    TraceEvent event;
+
+    for (auto& ring : m_rings) {
+        while (ring.pop(event)) {
+            if (m_events.size() >= m_maxEvents) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            taskName(event.task);
+            m_events.push_back(event);
+            collected++;
+        }
+    }
+
+    return collected;
+}
+
+const char* TraceRecorder::taskName(TaskHandle_t task) {
+    for (const TaskLabel& label : m_taskLabels) {
+        if (label.task == task) {
+            return label.name;
+        }
+    }
+
+    // Resolved while collecting, within a frame of the marker, because the
+    // task may be deleted before the capture is exported
+    const char* name = task ? pcTaskGetName(task) : nullptr;
+    m_taskLabels.push_back({task, intern(name ? name : "unknown")});
+    return m_taskLabels.back().name;
+}
+
+const char* TraceRecorder::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_internMutex);
+
+    for (const std::string& existing : m_internedNames) {
+        if (existing == name) {
+            return existing.c_str();
+        }
+    }
+    m_internedNames.push_back(name);
+    return m_internedNames.back().c_str();
+}
+
+// Write a string as a JSON literal, escaping quotes and control characters
+static void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text ? text : "unnamed"; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            fprintf(file, "\\u%04x", static_cast<unsigned char>(*c));
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool TraceRecorder::writeChromeTrace(FILE* file) {
+    if (!file) {
+        return false;
+    }
+
+    // Rings are drained core by core; the viewer needs each track in time order
+    std::stable_sort(m_events.begin(), m_events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    // Name each task's track
+    bool first = true;
+    for (size_t tid = 0; tid < m_taskLabels.size(); tid++) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",\n", (int)tid);
+        writeJsonString(file, m_taskLabels[tid].name);
+        fprintf(file, "}}");
+        first = false;
+    }
+
+    for (const TraceEvent& event : m_events) {
+        size_t tid = 0;
+        while (tid < m_taskLabels.size() && m_taskLabels[tid].task != event.task) {
+            tid++;
+        }
+        int64_t timestamp = event.timestamp - m_captureStart;
+
+        fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+        writeJsonString(file, event.name);
+        first = false;
+
+        switch (event.phase) {
+            case TracePhase::BEGIN:
+            case TracePhase::END:
+                fprintf(file, ",\"ph\":\"%c\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%d,\"args\":{\"core\":%d}}",
+                        event.phase == TracePhase::BEGIN ? 'B' : 'E', timestamp,
+                        (int)tid, event.core);
+                break;
+            case TracePhase::COUNTER:
+                fprintf(file, ",\"ph\":\"C\",\"ts\":%" PRId64 ",\"pid\":1,\"args\":{\"value\":%" PRId32 "}}",
+                        timestamp, event.value);
+                break;
+            case TracePhase::INSTANT:
+                fprintf(file, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%d}",
+                        timestamp, (int)tid);
+                break;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    return ferror(file) == 0;
+}
+
+os_error_t TraceRecorder::exportChromeTrace(const char* path) {
+    if (!path) {
+        return OS_ERROR_INVALID_PARAM;
+    }
+    stopCapture();
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to open %s for trace export", path);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    bool written = writeChromeTrace(file);
+    fclose(file);
+
+    if (!written) {
+        ESP_LOGE(TAG, "Failed to write trace to %s", path);
+        return OS_ERROR_FILESYSTEM;
+    }
+
+    ESP_LOGI(TAG, "Exported %d trace events to %s", (int)m_events.size(), path);
+    return OS_OK;
+}
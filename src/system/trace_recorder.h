@@ -0,0 +1,222 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "os_config.h"
+#include "mpsc_ring.h"
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+/**
+ * @file trace_recorder.h
+ * @brief Low-overhead timeline tracing for M5Stack Tab5
+ *
+ * Scoped begin/end markers, counters and instant events are timestamped
+ * with esp_timer_get_time() and pushed into a lock-free ring for the
+ * recording core, so markers are safe from ISRs, worker threads and the
+ * main loop alike. While a capture is running the main loop drains the
+ * rings into a capture buffer once per frame; the capture can then be
+ * written to SD card as Chrome trace JSON, which loads directly in
+ * chrome://tracing and ui.perfetto.dev with one track per FreeRTOS task.
+ *
+ * Marker names are stored by pointer and must outlive the capture: use
+ * string literals, or intern() for names built at runtime.
+ *
+ * @code
+ * void ZimReaderApp::update(uint32_t deltaTime) {
+ *     PERF_TRACE_SCOPE("zim_render");
+ *     PERF_TRACE_COUNTER("zim_cache_kb", m_cacheBytes / 1024);
+ * }
+ * @endcode
+ */
+
+enum class TracePhase : uint8_t {
+    BEGIN,
+    END,
+    COUNTER,
+    INSTANT
+};
+
+struct TraceEvent {
+    const char* name = nullptr;
+    int64_t timestamp = 0;      // esp_timer_get_time(), microseconds
+    TaskHandle_t task = nullptr;
+    int32_t value = 0;          // Counter value
+    TracePhase phase = TracePhase::INSTANT;
+    uint8_t core = 0;
+};
+
+class TraceRecorder {
+public:
+    /**
+     * @brief Get the process-wide recorder
+     * @return Trace recorder
+     */
+    static TraceRecorder& getInstance();
+
+    TraceRecorder() = default;
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * @brief Start recording, discarding any previous capture
+     * @param maxEvents Stop collecting after this many events
+     * @return OS_OK on success, OS_ERROR_NO_MEMORY if the buffer cannot be reserved
+     */
+    os_error_t startCapture(size_t maxEvents = OS_TRACE_CAPTURE_EVENTS);
+
+    /**
+     * @brief Stop recording and collect what is still in the rings
+     */
+    void stopCapture();
+
+    /**
+     * @brief Check if markers are being recorded
+     * @return true while a capture is running
+     */
+    bool isCapturing() const { return m_capturing.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Record a marker (any thread, core or ISR)
+     * @param phase Marker type
+     * @param name Marker name (must outlive the capture)
+     * @param value Counter value
+     */
+    __attribute__((always_inline)) inline void record(TracePhase phase, const char* name,
+                                                      int32_t value = 0) {
+        if (!m_capturing.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        TraceEvent event;
+        event.name = name;
+        event.timestamp = esp_timer_get_time();
+        event.task = xTaskGetCurrentTaskHandle();
+        event.value = value;
+        event.phase = phase;
+        event.core = static_cast<uint8_t>(xPortGetCoreID());
+
+        // The core may change before the push if the task migrates; the
+        // rings accept any producer, so that only affects which one is used
+        if (!m_rings[event.core % OS_TRACE_CORES].push(event)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void begin(const char* name) { record(TracePhase::BEGIN, name); }
+    void end(const char* name) { record(TracePhase::END, name); }
+    void counter(const char* name, int32_t value) { record(TracePhase::COUNTER, name, value); }
+    void instant(const char* name) { record(TracePhase::INSTANT, name); }
+
+    /**
+     * @brief Move recorded markers from the rings into the capture (main loop)
+     * @return Number of markers collected
+     */
+    size_t collect();
+
+    /**
+     * @brief Stop the capture and write it as Chrome trace JSON
+     * @param path Output file, e.g. "/sdcard/trace.json"
+     * @return OS_OK on success, error code on failure
+     */
+    os_error_t exportChromeTrace(const char* path);
+
+    /**
+     * @brief Write the capture as Chrome trace JSON
+     * @param file Open output stream
+     * @return true if everything was written
+     */
+    bool writeChromeTrace(FILE* file);
+
+    /**
+     * @brief Get a stable copy of a runtime-built marker name
+     *
+     * Each distinct name is stored once and kept for the life of the
+     * program, so only intern a bounded set (app names, not frame numbers).
+     * @param name Marker name
+     * @return Pointer valid until shutdown
+     */
+    const char* intern(const std::string& name);
+
+    /**
+     * @brief Get collected markers, in collection order
+     * @return Captured events
+     */
+    const std::vector<TraceEvent>& getEvents() const { return m_events; }
+
+    /**
+     * @brief Get markers lost to full rings or a full capture buffer
+     * @return Dropped marker count
+     */
+    uint32_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Get the export name of a task, looked up while the task is alive
+     * @param task Task handle
+     * @return Task name
+     */
+    const char* taskName(TaskHandle_t task);
+
+    MpscRing<TraceEvent, OS_TRACE_EVENTS_PER_CORE> m_rings[OS_TRACE_CORES];
+    std::atomic<bool> m_capturing{false};
+    std::atomic<uint32_t> m_dropped{0};
+
+    // Main loop only
+    std::vector<TraceEvent> m_events;
+    size_t m_maxEvents = 0;
+    int64_t m_captureStart = 0;
+
+    struct TaskLabel {
+        TaskHandle_t task;
+        const char* name;
+    };
+    std::vector<TaskLabel> m_taskLabels;
+
+    std::mutex m_internMutex;
+    std::deque<std::string> m_internedNames;   // Deque keeps c_str() pointers stable
+};
+
+/**
+ * @brief Records a begin marker now and the matching end marker on scope exit
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(name) {
+        TraceRecorder::getInstance().begin(name);
+    }
+    ~TraceScope() { TraceRecorder::getInstance().end(m_name); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+};
+
+// Trace macros for easy integration
+#define PERF_TRACE_CONCAT_INNER(a, b) a##b
+#define PERF_TRACE_CONCAT(a, b) PERF_TRACE_CONCAT_INNER(a, b)
+
+#if OS_ENABLE_TRACING
+#define PERF_TRACE_SCOPE(name) \
+    TraceScope PERF_TRACE_CONCAT(_perf_trace_scope_, __LINE__)(name)
+
+#define PERF_TRACE_COUNTER(name, value) \
+    TraceRecorder::getInstance().counter((name), static_cast<int32_t>(value))
+
+#define PERF_TRACE_INSTANT(name) \
+    TraceRecorder::getInstance().instant(name)
+#else
+#define PERF_TRACE_SCOPE(name) do {} while(0)
+#define PERF_TRACE_COUNTER(name, value) do {} while(0)
+#define PERF_TRACE_INSTANT(name) do {} while(0)
+#endif
+
+#endif // TRACE_RECORDER_H
@@ -27,13 +27,27 @@ os_error_t InputManager::initialize() {
         return result;
     }
 
-    // Subscribe to touch events from HAL
-    SUBSCRIBE_EVENT(EVENT_UI_TOUCH_PRESS, 
-                   [this](const EventData& event) {
-                       if (event.data && event.dataSize >= sizeof(TouchEventData)) {
-                           handleTouchEvent(*(TouchEventData*)event.data);
-                       }
-                   });
+    // Subscribe to touch events from HAL. Each carries its TouchPoint
+    // inline; TouchHAL publishes EVENT_UI_TOUCH_PRESS + TouchEvent, so the
+    // event type gives the kind.
+    const EventType touchEvents[] = {
+        EVENT_UI_TOUCH_PRESS, EVENT_UI_TOUCH_RELEASE, EVENT_UI_TOUCH_MOVE
+    };
+    for (EventType type : touchEvents) {
+        SUBSCRIBE_EVENT(type,
+                       [this](const EventData& event) {
+                           const TouchPoint* point = event.payloadAs<TouchPoint>();
+                           if (!point) {
+                               return;
+                           }
+                           TouchEventData eventData;
+                           eventData.event = static_cast<TouchEvent>(event.type - EVENT_UI_TOUCH_PRESS);
+                           eventData.point = *point;
+                           eventData.timestamp = point->timestamp;
+                           eventData.touchCount = 1;
+                           handleTouchEvent(eventData);
+                       });
+    }
 
     m_initialized = true;
     ESP_LOGI(TAG, "Input Manager initialized");
@@ -73,6 +87,9 @@ void InputManager::handleTouchEvent(const TouchEventData& eventData) {
         return;
     }
 
+    // Touches keep the device from sleeping on inactivity
+    OS().getPowerManager().resetActivityTimer();
+
     switch (eventData.event) {
         case TouchEvent::PRESS:
             s_touched = true;
@@ -1,9 +1,17 @@
 #include "ui_manager.h"
 #include "../system/os_manager.h"
 #include <esp_log.h>
+#include <cstring>
 
 static const char* TAG = "UIManager";
 
+// lv_label_set_text() invalidates the label even when the text is unchanged
+static void setLabelTextIfChanged(lv_obj_t* label, const char* text) {
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
 UIManager::~UIManager() {
     shutdown();
 }
@@ -358,7 +366,7 @@ void UIManager::updateStatusBar() {
         
         char timeStr[16];
         snprintf(timeStr, sizeof(timeStr), "%02d:%02d", hours, minutes);
-        lv_label_set_text(m_timeLabel, timeStr);
+        setLabelTextIfChanged(m_timeLabel, timeStr);
         
         lastTimeUpdate = now;
     }
@@ -368,7 +376,7 @@ void UIManager::updateStatusBar() {
         uint8_t batteryLevel = OS().getHALManager().getPower().getBatteryLevel();
         char batteryStr[16];
         snprintf(batteryStr, sizeof(batteryStr), "%d%%", batteryLevel);
-        lv_label_set_text(m_batteryIcon, batteryStr);
+        setLabelTextIfChanged(m_batteryIcon, batteryStr);
     }
 }
 
@@ -0,0 +1,345 @@
+#include <unity.h>
+#include "../src/system/async_task.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <vector>
+#include <string>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_async_task.cpp
+ * @brief Coroutine task tests: sleeps, event waits, offloaded work, cancellation and timeouts
+ *
+ * The scheduler runs on a virtual clock so sleeps and timeouts are exact;
+ * only the offload tests wait on real worker threads.
+ */
+
+static TaskScheduler* scheduler = nullptr;
+static EventSystem* events = nullptr;
+static JobExecutor* executor = nullptr;
+static AsyncRuntime* runtime = nullptr;
+static uint32_t virtualClock = 0;
+
+static const EventType TEST_EVENT = EVENT_SYSTEM_STARTUP;
+
+// Advance virtual time one millisecond at a time, running the main loop
+static void pump(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        scheduler->update(0);
+        events->processEvents();
+        virtualClock++;
+    }
+    scheduler->update(0);
+}
+
+// Pump until a condition holds or a real-time limit passes (for worker threads)
+template <typename Condition>
+static bool pumpUntil(Condition condition, uint32_t limitMs = 2000) {
+    uint32_t start = millis();
+    while (!condition()) {
+        if (millis() - start > limitMs) {
+            return false;
+        }
+        pump(1);
+    }
+    return true;
+}
+
+// Records when it is destroyed, to check frames are torn down on cancel
+struct DestroyFlag {
+    bool* flag;
+    ~DestroyFlag() { *flag = true; }
+};
+
+void setUp(void) {
+    virtualClock = 0;
+    scheduler = new TaskScheduler();
+    scheduler->setTimeSource([]() { return virtualClock; });
+    scheduler->initialize();
+    events = new EventSystem();
+    events->initialize();
+    executor = new JobExecutor();
+    executor->initialize(2);
+    runtime = new AsyncRuntime();
+    runtime->initialize(*scheduler, events, executor);
+}
+
+void tearDown(void) {
+    delete runtime;
+    delete executor;
+    delete events;
+    delete scheduler;
+    runtime = nullptr;
+    executor = nullptr;
+    events = nullptr;
+    scheduler = nullptr;
+}
+
+static AsyncTask sleeper(std::vector<uint32_t>& wakeTimes) {
+    wakeTimes.push_back(virtualClock);
+    co_await runtime->sleep(10);
+    wakeTimes.push_back(virtualClock);
+    co_await runtime->sleep(0);
+    wakeTimes.push_back(virtualClock);
+    co_await runtime->sleep(25);
+    wakeTimes.push_back(virtualClock);
+}
+
+void test_sleep_resumes_after_delay() {
+    std::vector<uint32_t> wakeTimes;
+    uint32_t id = runtime->spawn(sleeper(wakeTimes), "sleeper");
+    TEST_ASSERT_NOT_EQUAL(0, id);
+    TEST_ASSERT_EQUAL(0, wakeTimes.size());  // Starts on the next update
+
+    pump(50);
+
+    uint32_t expected[] = {0, 10, 11, 36};  // sleep(0) resumes on the next tick
+    TEST_ASSERT_EQUAL(4, wakeTimes.size());
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, wakeTimes.data(), 4);
+    TEST_ASSERT_FALSE(runtime->isActive(id));
+    TEST_ASSERT_EQUAL(0, runtime->getActiveCount());
+}
+
+static AsyncTask eventWaiter(AsyncResult<EventData>& received, uint32_t timeoutMs, int& steps) {
+    received = co_await runtime->waitEvent(TEST_EVENT, timeoutMs);
+    steps++;
+}
+
+void test_wait_event_receives_payload() {
+    AsyncResult<EventData> received;
+    int steps = 0;
+    runtime->spawn(eventWaiter(received, 100, steps));
+    pump(5);
+    TEST_ASSERT_EQUAL(1, events->getListenerCount(TEST_EVENT));
+
+    events->publishValue(TEST_EVENT, static_cast<uint32_t>(0xCAFE));
+    pump(2);
+
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_TRUE(received.ok());
+    TEST_ASSERT_EQUAL(0xCAFE, *received.value.payloadAs<uint32_t>());
+    TEST_ASSERT_EQUAL(0, events->getListenerCount(TEST_EVENT));
+}
+
+void test_wait_event_keeps_first_of_several_events() {
+    AsyncResult<EventData> received;
+    int steps = 0;
+    runtime->spawn(eventWaiter(received, 100, steps));
+    pump(5);
+
+    // Both are dispatched before the coroutine gets to run
+    events->publishValue(TEST_EVENT, static_cast<uint32_t>(1));
+    events->publishValue(TEST_EVENT, static_cast<uint32_t>(2));
+    pump(2);
+
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_TRUE(received.ok());
+    TEST_ASSERT_EQUAL(1, *received.value.payloadAs<uint32_t>());
+}
+
+void test_wait_event_resumes_when_task_table_is_full() {
+    AsyncResult<EventData> received;
+    int steps = 0;
+    runtime->spawn(eventWaiter(received, 100, steps));
+    pump(5);
+
+    // Leave one slot, for a task that publishes the event mid-update, when
+    // cancelling the timeout cannot free a slot for the resume task
+    std::vector<uint32_t> fillers;
+    while (scheduler->getActiveTaskCount() < OS_MAX_TASKS - 1) {
+        fillers.push_back(scheduler->scheduleOnce([]() {}, OS_TASK_PRIORITY_LOW, 10000));
+    }
+    scheduler->scheduleOnce([]() {
+        events->publishValue(TEST_EVENT, static_cast<uint32_t>(7), 0, false);
+    });
+    pump(1);
+
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_TRUE(received.ok());
+    TEST_ASSERT_EQUAL(7, *received.value.payloadAs<uint32_t>());
+
+    // The timeout it was waiting on fires later and finds nothing to do
+    for (uint32_t id : fillers) {
+        scheduler->cancelTask(id);
+    }
+    pump(150);
+    TEST_ASSERT_EQUAL(1, steps);
+}
+
+void test_wait_event_times_out_and_detaches() {
+    AsyncResult<EventData> received;
+    int steps = 0;
+    runtime->spawn(eventWaiter(received, 20, steps));
+
+    pump(15);
+    TEST_ASSERT_EQUAL(0, steps);
+    pump(10);
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_EQUAL(AsyncStatus::TIMEOUT, received.status);
+    TEST_ASSERT_EQUAL(0, events->getListenerCount(TEST_EVENT));
+
+    // A late event no longer reaches the finished coroutine
+    events->publishValue(TEST_EVENT, static_cast<uint32_t>(1));
+    pump(2);
+    TEST_ASSERT_EQUAL(AsyncStatus::TIMEOUT, received.status);
+}
+
+static AsyncTask cancellable(bool& destroyed, int& steps) {
+    DestroyFlag guard{&destroyed};
+    steps++;
+    co_await runtime->sleep(100);
+    steps++;
+    co_await runtime->waitEvent(TEST_EVENT);
+    steps++;
+}
+
+void test_cancel_destroys_suspended_coroutine() {
+    size_t baseTasks = scheduler->getActiveTaskCount();
+
+    bool destroyed = false;
+    int steps = 0;
+    uint32_t sleeping = runtime->spawn(cancellable(destroyed, steps));
+    pump(5);
+    TEST_ASSERT_EQUAL(1, steps);
+
+    TEST_ASSERT_TRUE(runtime->cancel(sleeping));
+    TEST_ASSERT_TRUE(destroyed);
+    TEST_ASSERT_FALSE(runtime->cancel(sleeping));
+    pump(200);
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_EQUAL(baseTasks, scheduler->getActiveTaskCount());
+
+    // Cancelled while waiting on an event: the listener goes too
+    destroyed = false;
+    steps = 0;
+    uint32_t waiting = runtime->spawn(cancellable(destroyed, steps));
+    pump(150);
+    TEST_ASSERT_EQUAL(2, steps);
+    TEST_ASSERT_EQUAL(1, events->getListenerCount(TEST_EVENT));
+
+    TEST_ASSERT_TRUE(runtime->cancel(waiting));
+    TEST_ASSERT_TRUE(destroyed);
+    TEST_ASSERT_EQUAL(0, events->getListenerCount(TEST_EVENT));
+    events->publishValue(TEST_EVENT, static_cast<uint32_t>(1));
+    pump(2);
+    TEST_ASSERT_EQUAL(2, steps);
+}
+
+static AsyncTask selfCancelling(int& steps) {
+    steps++;
+    runtime->cancel(runtime->current());
+    steps++;
+    co_await runtime->sleep(1);
+    steps++;
+}
+
+void test_self_cancel_stops_at_next_suspension() {
+    int steps = 0;
+    uint32_t id = runtime->spawn(selfCancelling(steps));
+    pump(10);
+    TEST_ASSERT_EQUAL(2, steps);
+    TEST_ASSERT_FALSE(runtime->isActive(id));
+}
+
+static AsyncTask offloader(AsyncResult<int>& result, uint32_t workUs, uint32_t timeoutMs, int& steps) {
+    result = co_await runtime->offload([workUs]() {
+        int64_t start = esp_timer_get_time();
+        while (esp_timer_get_time() - start < workUs) {
+        }
+        return JobExecutor::currentWorker() >= 0 ? 42 : -1;
+    }, timeoutMs);
+    steps++;
+
+    // Stale wakeups from a timed-out job must not resume this later wait
+    co_await runtime->sleep(1000);
+    steps++;
+}
+
+void test_offload_runs_on_worker_and_resumes() {
+    AsyncResult<int> result;
+    int steps = 0;
+    runtime->spawn(offloader(result, 1000, 0, steps));
+
+    TEST_ASSERT_TRUE(pumpUntil([&]() { return steps == 1; }));
+    TEST_ASSERT_TRUE(result.ok());
+    TEST_ASSERT_EQUAL(42, result.value);
+}
+
+void test_offload_timeout_ignores_late_completion() {
+    AsyncResult<int> result;
+    int steps = 0;
+    uint32_t id = runtime->spawn(offloader(result, 200000, 5, steps));
+
+    // Virtual time runs far ahead of the 200 ms of real work
+    pump(10);
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_EQUAL(AsyncStatus::TIMEOUT, result.status);
+
+    // Let the job finish and post its wakeup; the coroutine stays asleep
+    uint32_t start = millis();
+    while (millis() - start < 300) {
+        pump(1);
+        virtualClock--;  // Hold virtual time still
+    }
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_TRUE(runtime->isActive(id));
+
+    pump(1000);
+    TEST_ASSERT_EQUAL(2, steps);
+}
+
+static AsyncTask idle() {
+    co_await runtime->sleep(1000);
+}
+
+void test_spawn_limit_and_shutdown() {
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < OS_MAX_ASYNC_TASKS; i++) {
+        ids.push_back(runtime->spawn(idle()));
+        TEST_ASSERT_NOT_EQUAL(0, ids.back());
+    }
+    TEST_ASSERT_EQUAL(0, runtime->spawn(idle()));
+    pump(1);
+
+    runtime->shutdown();
+    TEST_ASSERT_EQUAL(0, runtime->getActiveCount());
+    TEST_ASSERT_EQUAL(0, scheduler->getActiveTaskCount());
+}
+
+int runAsyncTaskTests() {
+    UNITY_BEGIN();
+
+    // Suspension Tests
+    RUN_TEST(test_sleep_resumes_after_delay);
+    RUN_TEST(test_wait_event_receives_payload);
+    RUN_TEST(test_wait_event_keeps_first_of_several_events);
+    RUN_TEST(test_wait_event_resumes_when_task_table_is_full);
+    RUN_TEST(test_offload_runs_on_worker_and_resumes);
+
+    // Cancellation and Timeout Tests
+    RUN_TEST(test_wait_event_times_out_and_detaches);
+    RUN_TEST(test_cancel_destroys_suspended_coroutine);
+    RUN_TEST(test_self_cancel_stops_at_next_suspension);
+    RUN_TEST(test_offload_timeout_ignores_late_completion);
+    RUN_TEST(test_spawn_limit_and_shutdown);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runAsyncTaskTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runAsyncTaskTests();
+}
+#endif
@@ -0,0 +1,278 @@
+#include <unity.h>
+#include "../src/system/auto_tuner.h"
+#include "../src/system/auto_tune_simulator.h"
+#include <vector>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_auto_tuner.cpp
+ * @brief AUTO-mode controller ladder, hysteresis and battery tests with load-trace replays
+ */
+
+static TuningInputs inputsOf(float fps, float cpuLoad, uint8_t battery = 100, bool charging = false,
+                             uint8_t freeMemory = 100) {
+    TuningInputs inputs;
+    inputs.fps = fps;
+    inputs.cpuLoad = cpuLoad;
+    inputs.batteryPercent = battery;
+    inputs.charging = charging;
+    inputs.freeMemoryPercent = freeMemory;
+    return inputs;
+}
+
+// Feed the same measurement for a number of evaluations
+static void feed(AutoTuner& tuner, const TuningInputs& inputs, int evaluations) {
+    for (int i = 0; i < evaluations; i++) {
+        tuner.update(inputs);
+    }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_pressure_raises_clock_before_degrading() {
+    AutoTuner tuner;
+    TEST_ASSERT_EQUAL(240, tuner.getSettings().cpuFreqMhz);
+
+    std::vector<uint8_t> frequencySteps;
+    std::vector<uint8_t> degradeLevels;
+    for (int i = 0; i < 200; i++) {
+        if (tuner.update(inputsOf(40.0f, 95.0f))) {
+            frequencySteps.push_back(tuner.getFrequencyStep());
+            degradeLevels.push_back(tuner.getDegradeLevel());
+        }
+    }
+
+    // 240 -> 320 -> 360 MHz, then each degradation level in turn
+    TEST_ASSERT_EQUAL(2 + AutoTuner::DEGRADE_LEVELS - 1, frequencySteps.size());
+    TEST_ASSERT_EQUAL(3, frequencySteps[0]);
+    TEST_ASSERT_EQUAL(0, degradeLevels[0]);
+    TEST_ASSERT_EQUAL(4, frequencySteps[1]);
+    TEST_ASSERT_EQUAL(0, degradeLevels[1]);
+    for (size_t i = 2; i < frequencySteps.size(); i++) {
+        TEST_ASSERT_EQUAL(4, frequencySteps[i]);
+        TEST_ASSERT_EQUAL(i - 1, degradeLevels[i]);
+    }
+
+    const TuningSettings& settings = tuner.getSettings();
+    TEST_ASSERT_EQUAL(360, settings.cpuFreqMhz);
+    TEST_ASSERT_EQUAL(33, settings.refreshPeriodMs);
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_LINES * 2, settings.drawBufferLines);
+    TEST_ASSERT_EQUAL(75, settings.backgroundThrottle);
+}
+
+void test_headroom_restores_quality_before_lowering_clock() {
+    AutoTuner tuner;
+    feed(tuner, inputsOf(20.0f, 100.0f), 200);
+    TEST_ASSERT_EQUAL(AutoTuner::DEGRADE_LEVELS - 1, tuner.getDegradeLevel());
+
+    std::vector<uint8_t> frequencySteps;
+    std::vector<uint8_t> degradeLevels;
+    for (int i = 0; i < 400; i++) {
+        if (tuner.update(inputsOf(OS_UI_REFRESH_RATE, 20.0f))) {
+            frequencySteps.push_back(tuner.getFrequencyStep());
+            degradeLevels.push_back(tuner.getDegradeLevel());
+        }
+    }
+
+    TEST_ASSERT_EQUAL(AutoTuner::DEGRADE_LEVELS - 1 + AutoTuner::FREQUENCY_STEPS - 1, frequencySteps.size());
+    for (size_t i = 0; i < frequencySteps.size(); i++) {
+        if (i < AutoTuner::DEGRADE_LEVELS - 1) {
+            TEST_ASSERT_EQUAL(4, frequencySteps[i]);
+            TEST_ASSERT_EQUAL(AutoTuner::DEGRADE_LEVELS - 2 - i, degradeLevels[i]);
+        } else {
+            TEST_ASSERT_EQUAL(0, degradeLevels[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL(80, tuner.getSettings().cpuFreqMhz);
+    TEST_ASSERT_EQUAL(1000 / OS_UI_REFRESH_RATE, tuner.getSettings().refreshPeriodMs);
+}
+
+void test_dead_band_and_spikes_hold_settings() {
+    AutoTuner tuner;
+
+    // Between the headroom and pressure bands
+    feed(tuner, inputsOf(OS_UI_REFRESH_RATE, 70.0f), 200);
+    TEST_ASSERT_EQUAL(0, tuner.getChangeCount());
+
+    // Isolated one-sample spikes are smoothed away
+    for (int i = 0; i < 200; i++) {
+        bool spike = (i % 4) == 0;
+        tuner.update(inputsOf(spike ? 48.0f : OS_UI_REFRESH_RATE, spike ? 100.0f : 65.0f));
+    }
+    TEST_ASSERT_EQUAL(0, tuner.getChangeCount());
+
+    // Pressure must persist for the hold count
+    AutoTuneConfig config;
+    tuner.update(inputsOf(20.0f, 100.0f));
+    TEST_ASSERT_EQUAL(0, tuner.getChangeCount());
+    feed(tuner, inputsOf(20.0f, 100.0f), config.upHold - 1);
+    TEST_ASSERT_EQUAL(1, tuner.getChangeCount());
+}
+
+void test_step_down_refused_when_predicted_load_would_saturate() {
+    AutoTuneConfig config;
+    AutoTuner tuner(config);
+
+    // 30% at 240 MHz predicts 45% at 160 MHz: step down
+    feed(tuner, inputsOf(OS_UI_REFRESH_RATE, 30.0f), config.downHold);
+    TEST_ASSERT_EQUAL(160, tuner.getSettings().cpuFreqMhz);
+
+    // 45% at 160 MHz would be 90% at 80 MHz: stay put despite the headroom
+    uint32_t changes = tuner.getChangeCount();
+
+    feed(tuner, inputsOf(OS_UI_REFRESH_RATE, 45.0f), 400);
+    TEST_ASSERT_EQUAL(160, tuner.getSettings().cpuFreqMhz);
+    TEST_ASSERT_EQUAL(changes, tuner.getChangeCount());
+}
+
+void test_battery_limits_apply_immediately() {
+    AutoTuner tuner;
+    feed(tuner, inputsOf(40.0f, 95.0f), 20);
+    TEST_ASSERT_EQUAL(360, tuner.getSettings().cpuFreqMhz);
+
+    // Low battery: one evaluation caps the clock and throttles background work
+    TEST_ASSERT_TRUE(tuner.update(inputsOf(40.0f, 95.0f, 15)));
+    TEST_ASSERT_EQUAL(320, tuner.getSettings().cpuFreqMhz);
+    TEST_ASSERT_TRUE(tuner.getDegradeLevel() >= 2);
+    TEST_ASSERT_EQUAL(50, tuner.getSettings().backgroundThrottle);
+
+    // Critical battery drops the refresh rate as well
+    TEST_ASSERT_TRUE(tuner.update(inputsOf(40.0f, 95.0f, 5)));
+    TEST_ASSERT_EQUAL(160, tuner.getSettings().cpuFreqMhz);
+    TEST_ASSERT_TRUE(tuner.getDegradeLevel() >= 3);
+    TEST_ASSERT_TRUE(tuner.getSettings().refreshPeriodMs > 1000 / OS_UI_REFRESH_RATE);
+
+    // Charging lifts the caps; quality returns through the normal headroom path
+    uint8_t degraded = tuner.getDegradeLevel();
+    tuner.update(inputsOf(OS_UI_REFRESH_RATE, 20.0f, 5, true));
+    TEST_ASSERT_EQUAL(degraded, tuner.getDegradeLevel());
+    feed(tuner, inputsOf(OS_UI_REFRESH_RATE, 20.0f, 5, true), 200);
+    TEST_ASSERT_EQUAL(0, tuner.getDegradeLevel());
+}
+
+void test_large_draw_buffer_needs_free_memory() {
+    AutoTuner tuner;
+    feed(tuner, inputsOf(40.0f, 95.0f, 100, false, 20), 20);
+    TEST_ASSERT_TRUE(tuner.getDegradeLevel() >= 1);
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_LINES, tuner.getSettings().drawBufferLines);
+
+    // Hold the level steady (dead band) and vary only memory
+    TuningInputs steady = inputsOf(tuner.getTargetFps(), 70.0f, 100, false, 40);
+    tuner.update(steady);
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_LINES * 2, tuner.getSettings().drawBufferLines);
+
+    steady.freeMemoryPercent = 25;
+    tuner.update(steady);
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_LINES * 2, tuner.getSettings().drawBufferLines);
+
+    steady.freeMemoryPercent = 15;
+    tuner.update(steady);
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_LINES, tuner.getSettings().drawBufferLines);
+}
+
+void test_recorded_sample_reproduces_measurement() {
+    LoadSample workload = {1000, 2.0f, 0.0f, 80, false, 60};
+    TuningSettings settings;
+    settings.cpuFreqMhz = 160;
+
+    TuningInputs measured = AutoTuneSimulator::measure(workload, settings);
+    LoadSample recorded = AutoTuneSimulator::recordSample(measured, settings, 1000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, workload.frameWorkMcycles, recorded.frameWorkMcycles);
+
+    // Replayed at a different clock, the model predicts the new load
+    settings.cpuFreqMhz = 320;
+    TuningInputs original = AutoTuneSimulator::measure(workload, settings);
+    TuningInputs replayed = AutoTuneSimulator::measure(recorded, settings);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, original.fps, replayed.fps);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, original.cpuLoad, replayed.cpuLoad);
+    TEST_ASSERT_EQUAL(80, replayed.batteryPercent);
+}
+
+void test_replayed_trace_settles_without_oscillation() {
+    // Idle UI, a heavy app with background sync, idle again, then low battery
+    std::vector<LoadSample> trace = {
+        {10000, 0.5f, 5.0f, 90, false, 60},
+        {20000, 4.5f, 40.0f, 85, false, 40},
+        {10000, 0.5f, 5.0f, 80, false, 60},
+        {10000, 0.5f, 5.0f, 15, false, 60},
+    };
+
+    TuneSimReport report = AutoTuneSimulator::run(trace);
+    TEST_ASSERT_EQUAL(50000, report.durationMs);
+    TEST_ASSERT_EQUAL(200, report.evaluations);
+
+    // One reversal per workload change at most, and no limit cycles
+    TEST_ASSERT_TRUE(report.reversals <= 3);
+    TEST_ASSERT_TRUE(report.changes <= 16);
+    TEST_ASSERT_TRUE(report.shortfallPercent < 15.0f);
+    TEST_ASSERT_TRUE(report.meanFrequencyMhz < 300.0f);
+
+    // Low battery with a light load ends slow and throttled
+    TEST_ASSERT_TRUE(report.finalSettings.cpuFreqMhz <= 320);
+    TEST_ASSERT_EQUAL(50, report.finalSettings.backgroundThrottle);
+
+    // Deterministic for a seed
+    TuneSimReport again = AutoTuneSimulator::run(trace);
+    TEST_ASSERT_EQUAL(report.changes, again.changes);
+    TEST_ASSERT_EQUAL_FLOAT(report.meanFps, again.meanFps);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "Replay: %d changes, %d reversals, mean %.1f FPS (min %.1f), %.1f%% short, mean %.0f MHz",
+             (int)report.changes, (int)report.reversals, report.meanFps, report.minFps,
+             report.shortfallPercent, report.meanFrequencyMhz);
+    TEST_MESSAGE(message);
+}
+
+void test_steady_noisy_load_does_not_hunt() {
+    // A load that sits on a step boundary, with heavy jitter, for a minute
+    std::vector<LoadSample> trace = {{60000, 1.8f, 10.0f, 100, true, 60}};
+
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        TuneSimReport report = AutoTuneSimulator::run(trace, AutoTuneConfig(), seed, 20);
+        TEST_ASSERT_TRUE(report.reversals <= 1);
+        TEST_ASSERT_TRUE(report.changes <= 4);
+    }
+}
+
+int runAutoTunerTests() {
+    UNITY_BEGIN();
+
+    // Controller Tests
+    RUN_TEST(test_pressure_raises_clock_before_degrading);
+    RUN_TEST(test_headroom_restores_quality_before_lowering_clock);
+    RUN_TEST(test_dead_band_and_spikes_hold_settings);
+    RUN_TEST(test_step_down_refused_when_predicted_load_would_saturate);
+    RUN_TEST(test_battery_limits_apply_immediately);
+    RUN_TEST(test_large_draw_buffer_needs_free_memory);
+
+    // Replay Tests
+    RUN_TEST(test_recorded_sample_reproduces_measurement);
+    RUN_TEST(test_replayed_trace_settles_without_oscillation);
+    RUN_TEST(test_steady_noisy_load_does_not_hunt);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runAutoTunerTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runAutoTunerTests();
+}
+#endif
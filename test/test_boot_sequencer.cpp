@@ -0,0 +1,182 @@
+#include <unity.h>
+#include "../src/system/boot_sequencer.h"
+#include "../src/system/job_executor.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_boot_sequencer.cpp
+ * @brief Dependency-graph boot ordering, concurrency and failure tests
+ */
+
+static JobExecutor* executor = nullptr;
+
+// Stand-in for a stage blocked on an I2C/SPI probe
+static os_error_t probe(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    return OS_OK;
+}
+
+static bool finishedBefore(const BootSequencer& boot, const char* first, const char* second) {
+    return boot.findStage(first)->endUs <= boot.findStage(second)->startUs;
+}
+
+void setUp(void) {
+    executor = new JobExecutor();
+    executor->initialize(2);
+}
+
+void tearDown(void) {
+    executor->shutdown();
+    delete executor;
+    executor = nullptr;
+}
+
+void test_sequential_run_respects_dependencies() {
+    BootSequencer boot;
+    std::vector<std::string> order;
+
+    // Added out of order on purpose
+    boot.addStage("ui", [&]() { order.push_back("ui"); return OS_OK; }, {"display", "touch"});
+    boot.addStage("touch", [&]() { order.push_back("touch"); return OS_OK; });
+    boot.addStage("display", [&]() { order.push_back("display"); return OS_OK; }, {"events"});
+    boot.addStage("events", [&]() { order.push_back("events"); return OS_OK; });
+
+    TEST_ASSERT_EQUAL(OS_OK, boot.run());
+    TEST_ASSERT_EQUAL(4, order.size());
+    TEST_ASSERT_EQUAL_STRING("ui", order.back().c_str());
+    TEST_ASSERT_TRUE(finishedBefore(boot, "events", "display"));
+
+    for (const BootStageRecord& stage : boot.getTimeline()) {
+        TEST_ASSERT_EQUAL(BootStageState::DONE, stage.state);
+        TEST_ASSERT_EQUAL(-1, stage.worker);
+    }
+}
+
+void test_independent_stages_overlap() {
+    BootSequencer boot;
+    std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<bool> mainOnCaller{false};
+
+    boot.addStage("display", [&]() {
+        mainOnCaller = std::this_thread::get_id() == mainThread;
+        return probe(40);
+    }, {}, BootThread::MAIN);
+    boot.addStage("touch", []() { return probe(40); });
+    boot.addStage("storage", []() { return probe(40); });
+    boot.addStage("ui", []() { return OS_OK; }, {"display", "touch"}, BootThread::MAIN);
+
+    TEST_ASSERT_EQUAL(OS_OK, boot.run(executor));
+    TEST_ASSERT_TRUE(mainOnCaller.load());
+    TEST_ASSERT_TRUE(boot.findStage("touch")->worker >= 0);
+    TEST_ASSERT_TRUE(boot.findStage("storage")->worker >= 0);
+    TEST_ASSERT_TRUE(finishedBefore(boot, "display", "ui"));
+    TEST_ASSERT_TRUE(finishedBefore(boot, "touch", "ui"));
+
+    // Three 40 ms probes in well under the 120 ms a serial boot would take
+    TEST_ASSERT_TRUE(boot.getElapsedUs() < 80000);
+    TEST_ASSERT_TRUE(boot.getStageTimeUs() >= 120000);
+    boot.printTimeline();
+
+    char message[96];
+    snprintf(message, sizeof(message), "Wall %lld us for %lld us of stage time",
+             (long long)boot.getElapsedUs(), (long long)boot.getStageTimeUs());
+    TEST_MESSAGE(message);
+}
+
+void test_ui_does_not_wait_for_slow_stages() {
+    BootSequencer boot;
+
+    boot.addStage("display", []() { return probe(10); }, {}, BootThread::MAIN);
+    boot.addStage("touch", []() { return probe(10); });
+    boot.addStage("storage", []() { return probe(60); });
+    boot.addStage("ui", []() { return OS_OK; }, {"display", "touch"}, BootThread::MAIN);
+    boot.addStage("services", []() { return OS_OK; }, {"storage"});
+
+    TEST_ASSERT_EQUAL(OS_OK, boot.run(executor));
+    TEST_ASSERT_TRUE(boot.findStage("ui")->endUs < boot.findStage("storage")->endUs);
+    TEST_ASSERT_TRUE(finishedBefore(boot, "storage", "services"));
+}
+
+void test_required_failure_skips_dependents() {
+    BootSequencer boot;
+    std::atomic<int> ran{0};
+
+    boot.addStage("touch", []() { return OS_ERROR_HARDWARE; });
+    boot.addStage("ui", [&]() { ran++; return OS_OK; }, {"touch"}, BootThread::MAIN);
+    boot.addStage("first_frame", [&]() { ran++; return OS_OK; }, {"ui"}, BootThread::MAIN);
+    boot.addStage("storage", [&]() { ran++; return OS_OK; });
+
+    TEST_ASSERT_EQUAL(OS_ERROR_HARDWARE, boot.run(executor));
+    TEST_ASSERT_EQUAL(1, ran.load());
+    TEST_ASSERT_EQUAL(BootStageState::FAILED, boot.findStage("touch")->state);
+    TEST_ASSERT_EQUAL(BootStageState::SKIPPED, boot.findStage("ui")->state);
+    TEST_ASSERT_EQUAL(BootStageState::SKIPPED, boot.findStage("first_frame")->state);
+    TEST_ASSERT_EQUAL(BootStageState::DONE, boot.findStage("storage")->state);
+}
+
+void test_optional_failure_does_not_block() {
+    BootSequencer boot;
+
+    boot.addStage("ppa", []() { return OS_ERROR_HARDWARE; }, {}, BootThread::WORKER, false);
+    boot.addStage("hal", []() { return OS_OK; }, {"ppa"}, BootThread::MAIN);
+
+    TEST_ASSERT_EQUAL(OS_OK, boot.run(executor));
+    TEST_ASSERT_EQUAL(BootStageState::FAILED, boot.findStage("ppa")->state);
+    TEST_ASSERT_EQUAL(BootStageState::DONE, boot.findStage("hal")->state);
+}
+
+void test_invalid_graph_runs_nothing() {
+    int ran = 0;
+
+    BootSequencer unknown;
+    unknown.addStage("ui", [&]() { ran++; return OS_OK; }, {"display"});
+    TEST_ASSERT_EQUAL(OS_ERROR_INVALID_PARAM, unknown.run(executor));
+
+    BootSequencer cycle;
+    cycle.addStage("events", [&]() { ran++; return OS_OK; });
+    cycle.addStage("a", [&]() { ran++; return OS_OK; }, {"events", "b"});
+    cycle.addStage("b", [&]() { ran++; return OS_OK; }, {"a"});
+    TEST_ASSERT_EQUAL(OS_ERROR_INVALID_PARAM, cycle.run(executor));
+
+    TEST_ASSERT_EQUAL(0, ran);
+    TEST_ASSERT_EQUAL(OS_ERROR_ALREADY_EXISTS, cycle.addStage("a", []() { return OS_OK; }));
+}
+
+int runBootSequencerTests() {
+    UNITY_BEGIN();
+
+    // Ordering Tests
+    RUN_TEST(test_sequential_run_respects_dependencies);
+    RUN_TEST(test_independent_stages_overlap);
+    RUN_TEST(test_ui_does_not_wait_for_slow_stages);
+
+    // Failure Tests
+    RUN_TEST(test_required_failure_skips_dependents);
+    RUN_TEST(test_optional_failure_does_not_block);
+    RUN_TEST(test_invalid_graph_runs_nothing);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runBootSequencerTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runBootSequencerTests();
+}
+#endif
@@ -0,0 +1,194 @@
+#include <unity.h>
+#include "../src/hal/dirty_region.h"
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_dirty_region.cpp
+ * @brief Invalidated-area alignment, merging and partial refresh statistics tests
+ */
+
+static const uint16_t WIDTH = 1280;
+static const uint16_t HEIGHT = 720;
+static const uint16_t TILE = 20;
+
+static DirtyRegion* region = nullptr;
+
+static DirtyRect rect(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    DirtyRect r;
+    r.x1 = x1;
+    r.y1 = y1;
+    r.x2 = x2;
+    r.y2 = y2;
+    return r;
+}
+
+static void assertRect(const DirtyRect& expected, const DirtyRect& actual) {
+    TEST_ASSERT_EQUAL(expected.x1, actual.x1);
+    TEST_ASSERT_EQUAL(expected.y1, actual.y1);
+    TEST_ASSERT_EQUAL(expected.x2, actual.x2);
+    TEST_ASSERT_EQUAL(expected.y2, actual.y2);
+}
+
+void setUp(void) {
+    region = new DirtyRegion(WIDTH, HEIGHT, TILE);
+}
+
+void tearDown(void) {
+    delete region;
+    region = nullptr;
+}
+
+void test_areas_round_out_to_tiles() {
+    DirtyRect label = rect(10, 25, 60, 44);
+    region->alignToTiles(label);
+    assertRect(rect(10, 20, 60, 59), label);
+
+    // Already aligned areas are left alone
+    DirtyRect strip = rect(0, 40, WIDTH - 1, 59);
+    region->alignToTiles(strip);
+    assertRect(rect(0, 40, WIDTH - 1, 59), strip);
+
+    // Clipped to the screen, including a last tile shorter than the rest
+    DirtyRegion odd(WIDTH, 710, TILE);
+    DirtyRect edge = rect(-5, 705, WIDTH + 10, 709);
+    odd.alignToTiles(edge);
+    assertRect(rect(0, 700, WIDTH - 1, 709), edge);
+
+    region->setTileLines(1);
+    DirtyRect exact = rect(10, 25, 60, 44);
+    region->alignToTiles(exact);
+    assertRect(rect(10, 25, 60, 44), exact);
+}
+
+void test_overlapping_and_touching_areas_merge() {
+    DirtyRect rects[] = {
+        rect(0, 0, 99, 19),         // Overlaps the next one
+        rect(50, 0, 149, 19),
+        rect(150, 0, 199, 19),      // Touches the merged pair on the right
+    };
+    uint8_t joined[3] = {};
+
+    TEST_ASSERT_EQUAL(1, region->merge(rects, joined, 3));
+    TEST_ASSERT_EQUAL(1, joined[0]);
+    TEST_ASSERT_EQUAL(1, joined[1]);
+    TEST_ASSERT_EQUAL(0, joined[2]);
+    assertRect(rect(0, 0, 199, 19), rects[2]);
+}
+
+void test_wasteful_merges_are_skipped() {
+    DirtyRect rects[] = {
+        rect(0, 0, 99, 19),
+        rect(110, 0, 199, 19),      // 10 px gap
+        rect(200, 20, 299, 39),     // Touches the second only at a corner
+    };
+    uint8_t joined[3] = {};
+
+    TEST_ASSERT_EQUAL(3, region->merge(rects, joined, 3));
+    assertRect(rect(0, 0, 99, 19), rects[0]);
+    assertRect(rect(200, 20, 299, 39), rects[2]);
+}
+
+void test_merge_keeps_last_area_last() {
+    // LVGL marks the last unjoined area to flag the end of the frame
+    DirtyRect rects[] = {
+        rect(0, 0, 99, 19),
+        rect(0, 100, 99, 119),
+        rect(0, 200, 99, 219),      // Already joined by LVGL
+        rect(100, 0, 199, 19),
+    };
+    uint8_t joined[4] = {0, 0, 1, 0};
+
+    TEST_ASSERT_EQUAL(2, region->merge(rects, joined, 4));
+    TEST_ASSERT_EQUAL(1, joined[0]);
+    TEST_ASSERT_EQUAL(0, joined[1]);
+    TEST_ASSERT_EQUAL(0, joined[3]);
+    assertRect(rect(0, 0, 199, 19), rects[3]);
+    assertRect(rect(0, 200, 99, 219), rects[2]);
+
+    PartialRefreshStats stats = region->getStats();
+    TEST_ASSERT_EQUAL(3, stats.areasInvalidated);
+    TEST_ASSERT_EQUAL(2, stats.areasRendered);
+}
+
+void test_status_bar_icons_merge() {
+    // Clock, WiFi and battery labels in a 40-line status bar
+    DirtyRect rects[] = {
+        rect(10, 12, 60, 29),
+        rect(1150, 12, 1205, 29),
+        rect(1200, 12, 1270, 29),
+    };
+    uint8_t joined[3] = {};
+
+    int32_t before = 0;
+    for (DirtyRect& r : rects) {
+        before += r.area();
+        region->alignToTiles(r);
+    }
+
+    // The icons merge; the clock is too far away to be worth it
+    TEST_ASSERT_EQUAL(2, region->merge(rects, joined, 3));
+    assertRect(rect(1150, 0, 1270, 39), rects[2]);
+
+    char message[96];
+    snprintf(message, sizeof(message), "3 areas (%ld px) rendered as 2 tile-aligned areas (%ld px)",
+             (long)before, (long)(rects[0].area() + rects[2].area()));
+    TEST_MESSAGE(message);
+}
+
+void test_frame_statistics() {
+    // A status bar strip, then a full-screen redraw in 36 buffer fills
+    region->recordFlush(rect(0, 0, WIDTH - 1, 39), true);
+    for (int y = 0; y < HEIGHT; y += TILE) {
+        region->recordFlush(rect(0, y, WIDTH - 1, y + TILE - 1), y + TILE >= HEIGHT);
+    }
+
+    PartialRefreshStats stats = region->getStats();
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(1, stats.fullFrames);
+    TEST_ASSERT_EQUAL(37, stats.flushes);
+    TEST_ASSERT_EQUAL((uint64_t)WIDTH * (HEIGHT + 40), stats.pixelsFlushed);
+    TEST_ASSERT_EQUAL((uint32_t)WIDTH * HEIGHT, stats.lastFramePixels);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, stats.maxFramePercent);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (100.0f + 100.0f * 40 / HEIGHT) / 2, stats.averageFramePercent);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 18.5f, stats.flushesPerFrame);
+
+    region->resetStats();
+    TEST_ASSERT_EQUAL(0, region->getStats().frames);
+}
+
+int runDirtyRegionTests() {
+    UNITY_BEGIN();
+
+    // Alignment Tests
+    RUN_TEST(test_areas_round_out_to_tiles);
+
+    // Merge Tests
+    RUN_TEST(test_overlapping_and_touching_areas_merge);
+    RUN_TEST(test_wasteful_merges_are_skipped);
+    RUN_TEST(test_merge_keeps_last_area_last);
+    RUN_TEST(test_status_bar_icons_merge);
+
+    // Statistics Tests
+    RUN_TEST(test_frame_statistics);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runDirtyRegionTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runDirtyRegionTests();
+}
+#endif
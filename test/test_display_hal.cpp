@@ -0,0 +1,147 @@
+#include <unity.h>
+#include "../src/hal/display_hal.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <thread>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_display_hal.cpp
+ * @brief Draw buffer mode switching against flushes still in flight
+ *
+ * Runs the real DisplayHAL and LVGL driver, so it needs the device.
+ */
+
+static DisplayHAL* display = nullptr;
+
+// Completes transfers at once, or leaves them in flight while holding
+class HoldingBackend : public FlushBackend {
+public:
+    os_error_t startTransfer(const FlushRequest& request, FlushPipeline& pipeline) override {
+        this->pipeline = &pipeline;
+        if (hold) {
+            heldSequence = request.sequence;
+            held++;
+        } else {
+            pipeline.completeTransfer(request.sequence);
+        }
+        return OS_OK;
+    }
+    const char* getName() const override { return "holding"; }
+
+    FlushPipeline* pipeline = nullptr;
+    bool hold = false;
+    uint32_t heldSequence = 0;
+    int held = 0;
+};
+
+static HoldingBackend* backend = nullptr;
+
+// Flush one small area and return with its transfer still in flight
+static void flushHeldArea() {
+    lv_area_t area = {0, 0, 15, 15};
+    backend->hold = true;
+    _lv_inv_area(display->getLVGLDisplay(), &area);
+    lv_refr_now(display->getLVGLDisplay());
+    backend->hold = false;
+}
+
+void setUp(void) {
+    backend = new HoldingBackend();
+    if (display->getLVGLDisplay()) {
+        display->setDrawBufferMode(DRAW_BUFFER_PARTIAL, OS_DRAW_BUFFER_LINES);
+        display->setFlushBackend(backend);
+    }
+}
+
+void tearDown(void) {
+    if (display->getLVGLDisplay()) {
+        display->setFlushBackend(nullptr);
+    }
+    delete backend;
+    backend = nullptr;
+}
+
+void test_display_initializes() {
+    TEST_ASSERT_EQUAL(OS_OK, display->initialize());
+    TEST_ASSERT_EQUAL(OS_DRAW_BUFFER_MODE, display->getDrawBufferMode());
+}
+
+void test_mode_switch_waits_for_flush_in_flight() {
+    TEST_ASSERT_NOT_NULL(display->getLVGLDisplay());
+    flushHeldArea();
+    TEST_ASSERT_EQUAL(1, backend->held);
+
+    // The transfer finishes on another thread while the switch is waiting
+    std::atomic<int64_t> completedUs{0};
+    std::thread completer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(OS_FLUSH_TIMEOUT_MS / 4));
+        completedUs = esp_timer_get_time();
+        backend->pipeline->completeTransfer(backend->heldSequence);
+    });
+
+    os_error_t result = display->setDrawBufferMode(DRAW_BUFFER_DIRECT);
+    int64_t switchedUs = esp_timer_get_time();
+    completer.join();
+
+    // The old buffers were only replaced once nothing read them
+    TEST_ASSERT_EQUAL(OS_OK, result);
+    TEST_ASSERT_EQUAL(DRAW_BUFFER_DIRECT, display->getDrawBufferMode());
+    TEST_ASSERT_TRUE(completedUs.load() > 0 && completedUs.load() <= switchedUs);
+    TEST_ASSERT_EQUAL(0, display->getFlushStats().timeouts);
+
+    // The new layout renders and flushes
+    TEST_ASSERT_EQUAL(OS_OK, display->forceRefresh());
+    TEST_ASSERT_FALSE(backend->pipeline->isBusy());
+}
+
+void test_mode_switch_keeps_buffers_of_lost_flush() {
+    TEST_ASSERT_NOT_NULL(display->getLVGLDisplay());
+    flushHeldArea();
+    uint32_t timeouts = display->getFlushStats().timeouts;
+
+    // The transfer never completes, so its buffer may still be read
+    TEST_ASSERT_EQUAL(OS_ERROR_TIMEOUT, display->setDrawBufferMode(DRAW_BUFFER_FULL));
+    TEST_ASSERT_EQUAL(DRAW_BUFFER_PARTIAL, display->getDrawBufferMode());
+    TEST_ASSERT_EQUAL(timeouts + 1, display->getFlushStats().timeouts);
+
+    // Its completion turning up later is ignored
+    backend->pipeline->completeTransfer(backend->heldSequence);
+    TEST_ASSERT_EQUAL(OS_OK, display->setDrawBufferMode(DRAW_BUFFER_FULL));
+    TEST_ASSERT_EQUAL(DRAW_BUFFER_FULL, display->getDrawBufferMode());
+}
+
+int runDisplayHALTests() {
+    display = new DisplayHAL();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_display_initializes);
+
+    // Draw Buffer Mode Tests
+    RUN_TEST(test_mode_switch_waits_for_flush_in_flight);
+    RUN_TEST(test_mode_switch_keeps_buffers_of_lost_flush);
+
+    int failures = UNITY_END();
+    display->shutdown();
+    delete display;
+    display = nullptr;
+    return failures;
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runDisplayHALTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runDisplayHALTests();
+}
+#endif
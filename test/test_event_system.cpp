@@ -0,0 +1,464 @@
+#include <unity.h>
+#include "../src/system/event_system.h"
+#include <esp_timer.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_event_system.cpp
+ * @brief Event system dispatch, payload and async queue tests with publish benchmarks
+ */
+
+// Reference dispatch using the previous map + per-publish listener vector,
+// kept for benchmarking
+class MapDispatchTable {
+public:
+    void subscribe(EventType eventType, EventCallback callback, uint8_t priority) {
+        EventListener listener = {};
+        listener.id = ++m_nextId;
+        listener.eventType = eventType;
+        listener.callback = callback;
+        listener.priority = priority;
+        m_listeners[eventType].push_back(listener);
+        std::sort(m_listeners[eventType].begin(), m_listeners[eventType].end(),
+                  [](const EventListener& a, const EventListener& b) {
+                      return a.priority > b.priority;
+                  });
+    }
+
+    size_t publishSync(const EventData& event) {
+        std::vector<EventListener*> listeners;
+        auto it = m_listeners.find(event.type);
+        if (it != m_listeners.end()) {
+            for (auto& listener : it->second) {
+                listeners.push_back(&listener);
+            }
+        }
+        for (auto* listener : listeners) {
+            listener->callback(event);
+            listener->callCount++;
+        }
+        return listeners.size();
+    }
+
+private:
+    std::map<EventType, std::vector<EventListener>> m_listeners;
+    ListenerId m_nextId = 0;
+};
+
+static const uint32_t BENCH_PUBLISHES = 100000;
+static const EventType BENCH_OTHER_TYPES = 24;
+
+// Populate a realistic table: the measured type plus listeners on other
+// system and user-defined types
+template <typename Table>
+static void populateBenchTable(Table& table, EventType eventType, size_t listenerCount,
+                               std::atomic<uint32_t>& sink) {
+    auto measured = [&sink](const EventData& event) {
+        sink.fetch_add(event.senderId, std::memory_order_relaxed);
+    };
+    auto other = [&sink](const EventData&) { sink.fetch_add(1, std::memory_order_relaxed); };
+
+    for (size_t i = 0; i < listenerCount; i++) {
+        table.subscribe(eventType, measured, static_cast<uint8_t>(i * 37));
+    }
+    for (EventType i = 0; i < BENCH_OTHER_TYPES; i++) {
+        EventType otherType = (i % 2) ? EVENT_APP_LAUNCH + i / 2 : EVENT_USER_DEFINED + i;
+        table.subscribe(otherType, other, 100);
+    }
+}
+
+template <typename Table>
+static float benchmarkPublish(Table& table, EventType eventType) {
+    EventData event(eventType, nullptr, 0, 1);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_PUBLISHES; i++) {
+        table.publishSync(event);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    return elapsed > 0 ? (BENCH_PUBLISHES * 1000000.0f) / elapsed : 0.0f;
+}
+
+static EventSystem* events = nullptr;
+
+void setUp(void) {
+    events = new EventSystem();
+    events->initialize();
+}
+
+void tearDown(void) {
+    delete events;
+    events = nullptr;
+}
+
+void test_listeners_called_in_priority_order() {
+    std::vector<int> calls;
+    events->subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) { calls.push_back(1); }, 50);
+    events->subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) { calls.push_back(2); }, 200);
+    events->subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) { calls.push_back(3); }, 50);
+    events->subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) { calls.push_back(4); }, 100);
+
+    TEST_ASSERT_EQUAL(4, events->publishSync(EventData(EVENT_APP_LAUNCH)));
+
+    // Equal priorities keep subscription order
+    int expected[] = {2, 4, 1, 3};
+    TEST_ASSERT_EQUAL(4, calls.size());
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, calls.data(), 4);
+}
+
+void test_dense_and_hashed_event_types() {
+    int denseCalls = 0;
+    int userCalls = 0;
+    int inputCalls = 0;
+    events->subscribe(EVENT_HAL_BATTERY_CHANGE, [&](const EventData&) { denseCalls++; });
+    events->subscribe(EVENT_USER_DEFINED + 7, [&](const EventData&) { userCalls++; });
+    events->subscribe(EVENT_UI_TOUCH_PRESS, [&](const EventData&) { inputCalls++; });
+
+    events->publishSync(EventData(EVENT_HAL_BATTERY_CHANGE));
+    events->publishSync(EventData(EVENT_USER_DEFINED + 7));
+    events->publishSync(EventData(EVENT_UI_TOUCH_PRESS));
+    TEST_ASSERT_EQUAL(0, events->publishSync(EventData(EVENT_HAL_BUTTON_PRESS)));
+    TEST_ASSERT_EQUAL(0, events->publishSync(EventData(EVENT_USER_DEFINED + 8)));
+
+    TEST_ASSERT_EQUAL(1, denseCalls);
+    TEST_ASSERT_EQUAL(1, userCalls);
+    TEST_ASSERT_EQUAL(1, inputCalls);
+    TEST_ASSERT_TRUE(events->hasListeners(EVENT_USER_DEFINED + 7));
+    TEST_ASSERT_FALSE(events->hasListeners(EVENT_USER_DEFINED + 8));
+}
+
+void test_unsubscribe_and_unsubscribe_all() {
+    int calls = 0;
+    ListenerId first = events->subscribe(EVENT_SERVICE_START, [&](const EventData&) { calls++; });
+    events->subscribe(EVENT_SERVICE_START, [&](const EventData&) { calls++; });
+    events->subscribe(EVENT_SERVICE_START, [&](const EventData&) { calls++; });
+
+    TEST_ASSERT_TRUE(events->unsubscribe(first));
+    TEST_ASSERT_FALSE(events->unsubscribe(first));
+    TEST_ASSERT_EQUAL(2, events->getListenerCount(EVENT_SERVICE_START));
+    TEST_ASSERT_EQUAL(2, events->publishSync(EventData(EVENT_SERVICE_START)));
+
+    TEST_ASSERT_EQUAL(2, events->unsubscribeAll(EVENT_SERVICE_START));
+    TEST_ASSERT_FALSE(events->hasListeners(EVENT_SERVICE_START));
+    TEST_ASSERT_EQUAL(0, events->publishSync(EventData(EVENT_SERVICE_START)));
+    TEST_ASSERT_EQUAL(2, calls);
+}
+
+void test_one_shot_listener_fires_once() {
+    int calls = 0;
+    events->subscribe(EVENT_SYSTEM_LOW_MEMORY, [&](const EventData&) { calls++; }, 100, true);
+
+    events->publishSync(EventData(EVENT_SYSTEM_LOW_MEMORY));
+    events->publishSync(EventData(EVENT_SYSTEM_LOW_MEMORY));
+    TEST_ASSERT_TRUE(events->publishAsync(EventData(EVENT_SYSTEM_LOW_MEMORY)));
+    events->processEvents();
+
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_EQUAL(0, events->getListenerCount(EVENT_SYSTEM_LOW_MEMORY));
+}
+
+void test_subscribe_and_unsubscribe_from_callback() {
+    int lateCalls = 0;
+    int victimCalls = 0;
+    ListenerId victim = 0;
+
+    events->subscribe(EVENT_UI_GESTURE, [&](const EventData&) {
+        // Added during dispatch: must not run for the event in flight
+        events->subscribe(EVENT_UI_GESTURE, [&](const EventData&) { lateCalls++; }, 0);
+        events->unsubscribe(victim);
+    }, 200, true);
+    victim = events->subscribe(EVENT_UI_GESTURE, [&](const EventData&) { victimCalls++; }, 100);
+
+    TEST_ASSERT_EQUAL(1, events->publishSync(EventData(EVENT_UI_GESTURE)));
+    TEST_ASSERT_EQUAL(0, victimCalls);
+    TEST_ASSERT_EQUAL(0, lateCalls);
+    TEST_ASSERT_EQUAL(1, events->getListenerCount(EVENT_UI_GESTURE));
+
+    TEST_ASSERT_EQUAL(1, events->publishSync(EventData(EVENT_UI_GESTURE)));
+    TEST_ASSERT_EQUAL(1, lateCalls);
+}
+
+void test_nested_publish_from_callback() {
+    int innerCalls = 0;
+    events->subscribe(EVENT_APP_EXIT, [&](const EventData&) { innerCalls++; });
+    events->subscribe(EVENT_APP_LAUNCH, [&](const EventData&) {
+        events->publishSync(EventData(EVENT_APP_EXIT));
+        events->subscribe(EVENT_USER_DEFINED + 1, [](const EventData&) {});
+    });
+
+    events->publishSync(EventData(EVENT_APP_LAUNCH));
+    TEST_ASSERT_EQUAL(1, innerCalls);
+    TEST_ASSERT_EQUAL(1, events->getListenerCount(EVENT_USER_DEFINED + 1));
+}
+
+void test_ring_is_fifo_and_bounded() {
+    MpscRing<uint32_t, 8> ring;
+    for (uint32_t i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+    }
+    TEST_ASSERT_FALSE(ring.push(99));
+    TEST_ASSERT_EQUAL(8, ring.size());
+
+    // Wrap around several laps
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 40; i++) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL(i, value);
+        TEST_ASSERT_TRUE(ring.push(i + 8));
+    }
+    TEST_ASSERT_EQUAL(8, ring.size());
+}
+
+void test_async_overflow_is_counted() {
+    int calls = 0;
+    events->subscribe(EVENT_HAL_BUTTON_PRESS, [&](const EventData&) { calls++; });
+
+    for (size_t i = 0; i < OS_EVENT_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(events->publishAsync(EventData(EVENT_HAL_BUTTON_PRESS)));
+    }
+    TEST_ASSERT_FALSE(events->publishAsync(EventData(EVENT_HAL_BUTTON_PRESS)));
+    TEST_ASSERT_FALSE(events->publishFromISR(EVENT_HAL_BUTTON_PRESS));
+    TEST_ASSERT_EQUAL(2, events->getDroppedEventCount());
+    TEST_ASSERT_EQUAL(OS_EVENT_QUEUE_SIZE, events->getQueueHighWater());
+
+    while (events->processEvents() > 0) {
+    }
+    TEST_ASSERT_EQUAL(OS_EVENT_QUEUE_SIZE, calls);
+    TEST_ASSERT_EQUAL(0, events->getQueuedEventCount());
+}
+
+void test_inline_payload_survives_copies() {
+    struct Reading {
+        int32_t value;
+        uint16_t channel;
+    };
+
+    EventData original = EventData::withPayload(EVENT_HAL_SENSOR_UPDATE, Reading{-42, 3}, 9);
+    TEST_ASSERT_TRUE(original.inlinePayload);
+    TEST_ASSERT_EQUAL_PTR(original.payload, original.data);
+
+    EventData copy = original;
+    original.setPayload(Reading{7, 1});
+    TEST_ASSERT_EQUAL_PTR(copy.payload, copy.data);
+    TEST_ASSERT_EQUAL(-42, copy.payloadAs<Reading>()->value);
+    TEST_ASSERT_EQUAL(3, copy.payloadAs<Reading>()->channel);
+    TEST_ASSERT_NULL(copy.payloadAs<uint32_t>());
+
+    uint8_t oversized[EVENT_INLINE_PAYLOAD_SIZE + 1] = {};
+    TEST_ASSERT_FALSE(copy.setPayload(oversized, sizeof(oversized)));
+    TEST_ASSERT_EQUAL(sizeof(Reading), copy.dataSize);
+
+    // Borrowed payloads still point at caller memory
+    int external = 5;
+    EventData borrowed(EVENT_USER_DEFINED, &external, sizeof(external));
+    EventData borrowedCopy = borrowed;
+    TEST_ASSERT_EQUAL_PTR(&external, borrowedCopy.data);
+}
+
+void test_async_value_outlives_publisher() {
+    int32_t received = 0;
+    events->subscribe(EVENT_USER_DEFINED + 3, [&](const EventData& event) {
+        const int32_t* value = event.payloadAs<int32_t>();
+        received = value ? *value : -1;
+    });
+
+    {
+        int32_t local = 1234;
+        TEST_ASSERT_EQUAL(1, events->publishValue(EVENT_USER_DEFINED + 3, local));
+        local = 0;
+    }
+    events->processEvents();
+    TEST_ASSERT_EQUAL(1234, received);
+}
+
+void test_first_wins_coalescing() {
+    std::vector<uint32_t> senders;
+    events->subscribe(EVENT_USER_DEFINED + 2, [&](const EventData& event) {
+        senders.push_back(event.senderId);
+    });
+    events->subscribe(EVENT_HAL_BUTTON_PRESS, [&](const EventData& event) {
+        senders.push_back(event.senderId);
+    });
+    TEST_ASSERT_TRUE(events->setCoalescePolicy(EVENT_USER_DEFINED + 2, CoalescePolicy::FIRST_WINS));
+
+    for (uint32_t i = 1; i <= 5; i++) {
+        events->publish(EVENT_USER_DEFINED + 2, nullptr, 0, i);
+        events->publish(EVENT_HAL_BUTTON_PRESS, nullptr, 0, 100 + i);
+    }
+    TEST_ASSERT_EQUAL(6, events->getQueuedEventCount());
+    TEST_ASSERT_EQUAL(4, events->getCoalescedEventCount());
+
+    events->processEvents();
+    TEST_ASSERT_EQUAL(6, senders.size());
+    TEST_ASSERT_EQUAL(1, senders[0]);
+
+    // Once delivered, the next publish queues again
+    events->publish(EVENT_USER_DEFINED + 2, nullptr, 0, 6);
+    TEST_ASSERT_EQUAL(1, events->getQueuedEventCount());
+
+    events->setCoalescePolicy(EVENT_USER_DEFINED + 2, CoalescePolicy::NONE);
+    events->processEvents();
+    events->publish(EVENT_USER_DEFINED + 2, nullptr, 0, 7);
+    events->publish(EVENT_USER_DEFINED + 2, nullptr, 0, 8);
+    TEST_ASSERT_EQUAL(2, events->getQueuedEventCount());
+}
+
+void test_latest_wins_default_policies() {
+    TEST_ASSERT_EQUAL(CoalescePolicy::LATEST_WINS, events->getCoalescePolicy(EVENT_HAL_SENSOR_UPDATE));
+    TEST_ASSERT_EQUAL(CoalescePolicy::LATEST_WINS, events->getCoalescePolicy(EVENT_HAL_BATTERY_CHANGE));
+    TEST_ASSERT_EQUAL(CoalescePolicy::LATEST_WINS, events->getCoalescePolicy(EVENT_UI_TOUCH_MOVE));
+    TEST_ASSERT_EQUAL(CoalescePolicy::NONE, events->getCoalescePolicy(EVENT_HAL_BUTTON_PRESS));
+
+    std::vector<uint8_t> levels;
+    events->subscribe(EVENT_HAL_BATTERY_CHANGE, [&](const EventData& event) {
+        levels.push_back(*event.payloadAs<uint8_t>());
+    });
+
+    // A burst within one frame collapses into a single dispatch of the newest value
+    for (uint8_t level = 90; level > 80; level--) {
+        events->publishValue(EVENT_HAL_BATTERY_CHANGE, level);
+    }
+    TEST_ASSERT_TRUE(events->publishFromISR(EventData::withPayload(EVENT_HAL_BATTERY_CHANGE, (uint8_t)42)));
+    TEST_ASSERT_EQUAL(1, events->getQueuedEventCount());
+
+    events->processEvents();
+    TEST_ASSERT_EQUAL(1, levels.size());
+    TEST_ASSERT_EQUAL(42, levels[0]);
+
+    events->publishValue(EVENT_HAL_BATTERY_CHANGE, (uint8_t)41);
+    events->processEvents();
+    TEST_ASSERT_EQUAL(2, levels.size());
+    TEST_ASSERT_EQUAL(41, levels[1]);
+}
+
+void test_concurrent_producers_deliver_every_event() {
+    const int producers = 4;
+    const uint32_t perProducer = 5000;
+    std::vector<uint32_t> nextExpected(producers, 0);
+    uint32_t outOfOrder = 0;
+    uint32_t received = 0;
+
+    events->subscribe(EVENT_USER_DEFINED, [&](const EventData& event) {
+        uint32_t producer = event.senderId >> 16;
+        uint32_t sequence = event.senderId & 0xFFFF;
+        if (sequence != nextExpected[producer]) {
+            outOfOrder++;
+        }
+        nextExpected[producer] = sequence + 1;
+        received++;
+    });
+
+    std::atomic<int> running{producers};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (uint32_t i = 0; i < perProducer; i++) {
+                // Retry on overflow; the consumer drains concurrently
+                while (!events->publishFromISR(EVENT_USER_DEFINED, nullptr, 0, (p << 16) | i)) {
+                    std::this_thread::yield();
+                }
+            }
+            running--;
+        });
+    }
+
+    while (running.load() > 0 || events->getQueuedEventCount() > 0) {
+        if (events->processEvents() == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    TEST_ASSERT_EQUAL(producers * perProducer, received);
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+}
+
+void test_publish_benchmark_against_map_dispatch() {
+    const size_t listenerCounts[] = {1, 16, 64};
+
+    for (size_t listeners : listenerCounts) {
+        std::atomic<uint32_t> flatSink{0};
+        std::atomic<uint32_t> mapSink{0};
+        EventSystem flat;
+        MapDispatchTable reference;
+        flat.initialize();
+        populateBenchTable(flat, EVENT_HAL_SENSOR_UPDATE, listeners, flatSink);
+        populateBenchTable(reference, EVENT_HAL_SENSOR_UPDATE, listeners, mapSink);
+
+        float flatRate = benchmarkPublish(flat, EVENT_HAL_SENSOR_UPDATE);
+        float mapRate = benchmarkPublish(reference, EVENT_HAL_SENSOR_UPDATE);
+        float flatUserRate = 0.0f;
+        {
+            std::atomic<uint32_t> userSink{0};
+            EventSystem userTable;
+            userTable.initialize();
+            populateBenchTable(userTable, EVENT_USER_DEFINED + 500, listeners, userSink);
+            flatUserRate = benchmarkPublish(userTable, EVENT_USER_DEFINED + 500);
+        }
+
+        char message[160];
+        snprintf(message, sizeof(message),
+                 "%2d listeners: flat %.0f events/s (user type %.0f), map %.0f events/s (%.1fx)",
+                 (int)listeners, flatRate, flatUserRate, mapRate,
+                 mapRate > 0 ? flatRate / mapRate : 0.0f);
+        TEST_MESSAGE(message);
+
+        // Rates are only reported; both tables must have delivered the same events
+        TEST_ASSERT_EQUAL(mapSink.load(), flatSink.load());
+    }
+}
+
+int runEventSystemTests() {
+    UNITY_BEGIN();
+
+    // Dispatch Tests
+    RUN_TEST(test_listeners_called_in_priority_order);
+    RUN_TEST(test_dense_and_hashed_event_types);
+    RUN_TEST(test_unsubscribe_and_unsubscribe_all);
+    RUN_TEST(test_one_shot_listener_fires_once);
+    RUN_TEST(test_subscribe_and_unsubscribe_from_callback);
+    RUN_TEST(test_nested_publish_from_callback);
+
+    // Payload Tests
+    RUN_TEST(test_inline_payload_survives_copies);
+    RUN_TEST(test_async_value_outlives_publisher);
+
+    // Async Queue Tests
+    RUN_TEST(test_ring_is_fifo_and_bounded);
+    RUN_TEST(test_async_overflow_is_counted);
+    RUN_TEST(test_first_wins_coalescing);
+    RUN_TEST(test_latest_wins_default_policies);
+    RUN_TEST(test_concurrent_producers_deliver_every_event);
+
+    // Benchmarks
+    RUN_TEST(test_publish_benchmark_against_map_dispatch);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runEventSystemTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runEventSystemTests();
+}
+#endif
@@ -0,0 +1,277 @@
+#include <unity.h>
+#include "../src/hal/flush_pipeline.h"
+#include <esp_timer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_flush_pipeline.cpp
+ * @brief Asynchronous flush, framebuffer backend and render/transfer overlap tests
+ */
+
+static const uint16_t WIDTH = 64;
+static const uint16_t HEIGHT = 48;
+
+static FlushPipeline* pipeline = nullptr;
+static FramebufferFlushBackend* backend = nullptr;
+static std::atomic<int> readyCount{0};
+
+// Stands in for lv_disp_flush_ready()
+static void onReady(void*) {
+    readyCount++;
+}
+
+// Burn CPU for a fixed time, as LVGL rendering would
+static void busyWait(int64_t us) {
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < us) {
+    }
+}
+
+static FlushRequest makeRequest(int16_t x, int16_t y, int16_t w, int16_t h, const void* pixels) {
+    FlushRequest request;
+    request.x1 = x;
+    request.y1 = y;
+    request.x2 = x + w - 1;
+    request.y2 = y + h - 1;
+    request.pixels = pixels;
+    return request;
+}
+
+// Backend whose transfers never complete, like a DMA interrupt that was lost
+class SilentBackend : public FlushBackend {
+public:
+    os_error_t startTransfer(const FlushRequest& request, FlushPipeline&) override {
+        lastSequence = request.sequence;
+        return OS_OK;
+    }
+    const char* getName() const override { return "silent"; }
+
+    uint32_t lastSequence = 0;
+};
+
+// Render strips into the draw buffers and flush each one, the way LVGL
+// does; with one buffer it must wait for each transfer before drawing again
+static int64_t renderStrips(int buffers, int strips, int64_t renderUs) {
+    const int16_t lines = HEIGHT / 4;
+    std::vector<uint16_t> drawBuffers[2];
+    for (std::vector<uint16_t>& buffer : drawBuffers) {
+        buffer.assign(WIDTH * lines, 0);
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < strips; i++) {
+        std::vector<uint16_t>& buffer = drawBuffers[i % buffers];
+        if (buffers == 1) {
+            pipeline->waitForTransfer();
+        }
+
+        busyWait(renderUs);
+        std::fill(buffer.begin(), buffer.end(), (uint16_t)i);
+
+        FlushRequest request = makeRequest(0, (i % 4) * lines, WIDTH, lines, buffer.data());
+        request.lastInFrame = i % 4 == 3;
+        pipeline->submit(request);
+    }
+    pipeline->waitForTransfer();
+    return esp_timer_get_time() - start;
+}
+
+void setUp(void) {
+    readyCount = 0;
+    backend = new FramebufferFlushBackend(WIDTH, HEIGHT, sizeof(uint16_t));
+    backend->start();
+    pipeline = new FlushPipeline();
+    pipeline->initialize(backend, onReady, nullptr, sizeof(uint16_t));
+}
+
+void tearDown(void) {
+    delete pipeline;
+    pipeline = nullptr;
+    delete backend;
+    backend = nullptr;
+}
+
+void test_area_lands_in_framebuffer() {
+    uint16_t pixels[3 * 2] = {1, 2, 3, 4, 5, 6};
+
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(makeRequest(5, 7, 3, 2, pixels)));
+    TEST_ASSERT_TRUE(pipeline->waitForTransfer());
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+
+    const uint16_t* framebuffer = reinterpret_cast<const uint16_t*>(backend->getFramebuffer());
+    TEST_ASSERT_EQUAL(1, framebuffer[7 * WIDTH + 5]);
+    TEST_ASSERT_EQUAL(3, framebuffer[7 * WIDTH + 7]);
+    TEST_ASSERT_EQUAL(4, framebuffer[8 * WIDTH + 5]);
+    TEST_ASSERT_EQUAL(6, framebuffer[8 * WIDTH + 7]);
+    TEST_ASSERT_EQUAL(0, framebuffer[7 * WIDTH + 8]);
+    TEST_ASSERT_EQUAL(0, framebuffer[9 * WIDTH + 5]);
+}
+
+void test_strided_area_lands_in_framebuffer() {
+    // Direct mode hands over a window of a full-screen buffer
+    std::vector<uint16_t> screen(WIDTH * HEIGHT, 0);
+    for (int y = 10; y < 13; y++) {
+        for (int x = 20; x < 24; x++) {
+            screen[y * WIDTH + x] = (uint16_t)(y * 100 + x);
+        }
+    }
+
+    FlushRequest request = makeRequest(20, 10, 4, 3, &screen[10 * WIDTH + 20]);
+    request.stride = WIDTH;
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(request));
+    TEST_ASSERT_TRUE(pipeline->waitForTransfer());
+
+    const uint16_t* framebuffer = reinterpret_cast<const uint16_t*>(backend->getFramebuffer());
+    TEST_ASSERT_EQUAL(1020, framebuffer[10 * WIDTH + 20]);
+    TEST_ASSERT_EQUAL(1223, framebuffer[12 * WIDTH + 23]);
+    TEST_ASSERT_EQUAL(0, framebuffer[12 * WIDTH + 24]);
+    TEST_ASSERT_EQUAL(4 * 3 * sizeof(uint16_t), pipeline->getStats().bytes);
+}
+
+void test_submit_returns_while_transfer_in_flight() {
+    // 64x48x2 bytes at 0.5 MB/s is about 12 ms on the link
+    std::vector<uint16_t> pixels(WIDTH * HEIGHT, 0x1234);
+    backend->setBandwidth(0.5f);
+
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(makeRequest(0, 0, WIDTH, HEIGHT, pixels.data())));
+    int64_t submitUs = esp_timer_get_time() - start;
+
+    TEST_ASSERT_TRUE(submitUs < 3000);
+    TEST_ASSERT_TRUE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(0, readyCount.load());
+
+    TEST_ASSERT_TRUE(pipeline->waitForTransfer());
+    TEST_ASSERT_FALSE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+    TEST_ASSERT_TRUE(esp_timer_get_time() - start >= 12000);
+}
+
+void test_rejected_area_releases_buffer() {
+    uint16_t pixels[4] = {};
+
+    TEST_ASSERT_EQUAL(OS_ERROR_INVALID_PARAM, pipeline->submit(makeRequest(WIDTH - 1, 0, 2, 2, pixels)));
+    TEST_ASSERT_FALSE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+    TEST_ASSERT_EQUAL(0, pipeline->getStats().transfers);
+}
+
+void test_lost_completion_times_out() {
+    SilentBackend silent;
+    uint16_t pixels[4] = {};
+    pipeline->initialize(&silent, onReady, nullptr, sizeof(uint16_t));
+
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(makeRequest(0, 0, 2, 2, pixels)));
+    TEST_ASSERT_FALSE(pipeline->waitForTransfer(20));
+    TEST_ASSERT_FALSE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+
+    // A completion arriving after the timeout is not reported twice
+    pipeline->completeTransfer(silent.lastSequence);
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+
+    FlushStats stats = pipeline->getStats();
+    TEST_ASSERT_EQUAL(1, stats.timeouts);
+    TEST_ASSERT_EQUAL(0, stats.transfers);
+    pipeline->shutdown();
+}
+
+void test_late_completion_does_not_release_next_transfer() {
+    SilentBackend silent;
+    uint16_t pixels[4] = {};
+    pipeline->initialize(&silent, onReady, nullptr, sizeof(uint16_t));
+
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(makeRequest(0, 0, 2, 2, pixels)));
+    uint32_t abandoned = silent.lastSequence;
+    TEST_ASSERT_FALSE(pipeline->waitForTransfer(20));
+    TEST_ASSERT_EQUAL(OS_OK, pipeline->submit(makeRequest(0, 0, 2, 2, pixels)));
+    TEST_ASSERT_NOT_EQUAL(abandoned, silent.lastSequence);
+
+    // The first transfer's completion turns up while the second is in flight
+    pipeline->completeTransfer(abandoned);
+    TEST_ASSERT_TRUE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(1, readyCount.load());
+
+    pipeline->completeTransfer(silent.lastSequence);
+    TEST_ASSERT_FALSE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(2, readyCount.load());
+    TEST_ASSERT_EQUAL(1, pipeline->getStats().transfers);
+    pipeline->shutdown();
+}
+
+void test_stats_count_transfers_and_frames() {
+    renderStrips(2, 8, 0);
+
+    FlushStats stats = pipeline->getStats();
+    TEST_ASSERT_EQUAL(8, stats.transfers);
+    TEST_ASSERT_EQUAL(2, stats.frames);
+    TEST_ASSERT_EQUAL(2 * WIDTH * HEIGHT * sizeof(uint16_t), stats.bytes);
+    TEST_ASSERT_EQUAL(8, readyCount.load());
+    TEST_ASSERT_EQUAL(0, stats.timeouts);
+}
+
+void test_double_buffering_overlaps_render_and_transfer() {
+    // Each strip takes ~3 ms on the link and 4 ms to render
+    const int strips = 16;
+    backend->setBandwidth(WIDTH * (HEIGHT / 4) * sizeof(uint16_t) / 3000.0f);
+
+    int64_t singleUs = renderStrips(1, strips, 4000);
+    FlushStats single = pipeline->getStats();
+
+    pipeline->resetStats();
+    int64_t doubleUs = renderStrips(2, strips, 4000);
+    FlushStats twin = pipeline->getStats();
+
+    TEST_ASSERT_EQUAL(strips, single.transfers);
+    TEST_ASSERT_EQUAL(strips, twin.transfers);
+    TEST_ASSERT_TRUE(single.overlapPercent < 20.0f);
+    TEST_ASSERT_TRUE(twin.overlapPercent > 80.0f);
+    TEST_ASSERT_TRUE(doubleUs < singleUs * 4 / 5);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "Single buffer %lld us (%.0f%% overlap), double buffer %lld us (%.0f%% overlap), %.2f MB/s",
+             (long long)singleUs, single.overlapPercent, (long long)doubleUs, twin.overlapPercent,
+             twin.throughputMBps);
+    TEST_MESSAGE(message);
+}
+
+int runFlushPipelineTests() {
+    UNITY_BEGIN();
+
+    // Transfer Tests
+    RUN_TEST(test_area_lands_in_framebuffer);
+    RUN_TEST(test_strided_area_lands_in_framebuffer);
+    RUN_TEST(test_submit_returns_while_transfer_in_flight);
+    RUN_TEST(test_rejected_area_releases_buffer);
+    RUN_TEST(test_lost_completion_times_out);
+    RUN_TEST(test_late_completion_does_not_release_next_transfer);
+
+    // Overlap Tests
+    RUN_TEST(test_stats_count_transfers_and_frames);
+    RUN_TEST(test_double_buffering_overlaps_render_and_transfer);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runFlushPipelineTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runFlushPipelineTests();
+}
+#endif
@@ -0,0 +1,210 @@
+#include <unity.h>
+#include "../src/system/frame_pacer.h"
+#include <esp_timer.h>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_frame_pacer.cpp
+ * @brief Main-loop phase budget, deferral and frame deadline tests
+ */
+
+static const uint32_t PERIOD_US = 10000;
+
+static FramePacer* pacer = nullptr;
+
+// Burn CPU for a fixed time, as a subsystem update would
+static void busyWait(int64_t us) {
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < us) {
+    }
+}
+
+// Run one phase if the pacer lets it, returning the delta it was given or -1
+static int32_t runPhase(FramePhase phase, int64_t workUs) {
+    uint32_t delta = 0;
+    if (!pacer->beginPhase(phase, delta)) {
+        return -1;
+    }
+    busyWait(workUs);
+    pacer->endPhase(phase);
+    return static_cast<int32_t>(delta);
+}
+
+void setUp(void) {
+    pacer = new FramePacer(PERIOD_US);
+}
+
+void tearDown(void) {
+    delete pacer;
+    pacer = nullptr;
+}
+
+void test_critical_phases_run_when_over_budget() {
+    pacer->beginFrame(10);
+    TEST_ASSERT_EQUAL(10, runPhase(FramePhase::HAL, PERIOD_US + 1000));
+    TEST_ASSERT_EQUAL(0, pacer->getRemainingUs());
+    TEST_ASSERT_EQUAL(10, runPhase(FramePhase::UI, 100));
+    TEST_ASSERT_EQUAL(0, pacer->endFrame());
+
+    FramePacerStats stats = pacer->getStats();
+    TEST_ASSERT_EQUAL(1, stats.frames);
+    TEST_ASSERT_EQUAL(1, stats.overBudgetFrames);
+
+    FramePhaseStats hal = pacer->getPhaseStats(FramePhase::HAL);
+    TEST_ASSERT_EQUAL(1, hal.runs);
+    TEST_ASSERT_EQUAL(1, hal.overruns);
+    TEST_ASSERT_TRUE(hal.timing.max >= PERIOD_US + 1000);
+}
+
+void test_deferred_phase_receives_accumulated_delta() {
+    pacer->setPhaseBudget(FramePhase::SERVICES, 2000, true, 4);
+
+    // First run gives the pacer a cost estimate
+    pacer->beginFrame(10);
+    TEST_ASSERT_EQUAL(10, runPhase(FramePhase::SERVICES, 3000));
+    busyWait(pacer->endFrame());
+
+    // Two frames where the HAL leaves too little time
+    for (int i = 0; i < 2; i++) {
+        pacer->beginFrame(10);
+        runPhase(FramePhase::HAL, PERIOD_US - 1000);
+        TEST_ASSERT_EQUAL(-1, runPhase(FramePhase::SERVICES, 3000));
+        busyWait(pacer->endFrame());
+    }
+
+    // A quiet frame catches up with everything it missed
+    pacer->beginFrame(10);
+    TEST_ASSERT_EQUAL(30, runPhase(FramePhase::SERVICES, 3000));
+    pacer->endFrame();
+
+    FramePhaseStats services = pacer->getPhaseStats(FramePhase::SERVICES);
+    TEST_ASSERT_EQUAL(2, services.runs);
+    TEST_ASSERT_EQUAL(2, services.deferrals);
+    TEST_ASSERT_EQUAL(0, services.forcedRuns);
+    TEST_ASSERT_EQUAL(2, services.overruns);
+}
+
+void test_deferral_is_bounded() {
+    pacer->setPhaseBudget(FramePhase::APPS, 2000, true, 2);
+
+    pacer->beginFrame(10);
+    runPhase(FramePhase::APPS, 3000);
+    busyWait(pacer->endFrame());
+
+    int ran = 0;
+    for (int i = 0; i < 6; i++) {
+        pacer->beginFrame(10);
+        runPhase(FramePhase::HAL, PERIOD_US);
+        if (runPhase(FramePhase::APPS, 100) >= 0) {
+            ran++;
+        }
+        busyWait(pacer->endFrame());
+    }
+
+    // Skipped twice, forced on the third frame, and so on
+    FramePhaseStats apps = pacer->getPhaseStats(FramePhase::APPS);
+    TEST_ASSERT_EQUAL(2, ran);
+    TEST_ASSERT_EQUAL(4, apps.deferrals);
+    TEST_ASSERT_EQUAL(2, apps.forcedRuns);
+}
+
+void test_frames_align_to_deadlines() {
+    int64_t first = esp_timer_get_time();
+    pacer->beginFrame(0);
+    busyWait(3000);
+    uint32_t sleepUs = pacer->endFrame();
+    TEST_ASSERT_TRUE(sleepUs <= PERIOD_US - 3000);
+    TEST_ASSERT_TRUE(sleepUs > PERIOD_US - 4000);
+
+    // Starting late shortens the next wait instead of shifting the schedule
+    busyWait(sleepUs + 2000);
+    pacer->beginFrame(10);
+    busyWait(1000);
+    sleepUs = pacer->endFrame();
+    int64_t nextStart = esp_timer_get_time() + sleepUs;
+    TEST_ASSERT_INT_WITHIN(300, first + 2 * PERIOD_US, nextStart);
+
+    TEST_ASSERT_EQUAL(0, pacer->getStats().missedDeadlines);
+}
+
+void test_missed_deadline_resets_schedule() {
+    pacer->beginFrame(0);
+    pacer->endFrame();
+
+    // A stall of several periods does not produce a burst of zero-wait frames
+    busyWait(PERIOD_US * 3);
+    pacer->beginFrame(30);
+    busyWait(1000);
+    uint32_t sleepUs = pacer->endFrame();
+    TEST_ASSERT_TRUE(sleepUs > PERIOD_US - 2000);
+
+    FramePacerStats stats = pacer->getStats();
+    TEST_ASSERT_EQUAL(1, stats.missedDeadlines);
+    TEST_ASSERT_EQUAL(1, stats.frameInterval.count);
+    TEST_ASSERT_TRUE(stats.frameInterval.max >= PERIOD_US * 3);
+}
+
+void test_paced_loop_holds_frame_rate() {
+    // Bursty work: most frames light, every fifth heavy, services always wanting time
+    pacer->setPhaseBudget(FramePhase::SERVICES, 2000, true, 4);
+    int64_t start = esp_timer_get_time();
+    const int frames = 30;
+
+    for (int i = 0; i < frames; i++) {
+        pacer->beginFrame(PERIOD_US / 1000);
+        runPhase(FramePhase::HAL, i % 5 == 4 ? 8000 : 2000);
+        runPhase(FramePhase::SERVICES, 2500);
+        busyWait(pacer->endFrame());
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    FramePacerStats stats = pacer->getStats();
+    FramePhaseStats services = pacer->getPhaseStats(FramePhase::SERVICES);
+
+    TEST_ASSERT_INT_WITHIN(PERIOD_US / 2, (int64_t)frames * PERIOD_US, elapsed);
+    TEST_ASSERT_EQUAL(0, stats.overBudgetFrames);
+    TEST_ASSERT_EQUAL(0, stats.missedDeadlines);
+    TEST_ASSERT_EQUAL(frames / 5, services.deferrals);
+    TEST_ASSERT_TRUE(stats.frameInterval.max < PERIOD_US + 500);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%d frames in %lld us: interval p50 %.0f max %.0f, %lu deferrals",
+             frames, (long long)elapsed, stats.frameInterval.p50, stats.frameInterval.max,
+             (unsigned long)services.deferrals);
+    TEST_MESSAGE(message);
+}
+
+int runFramePacerTests() {
+    UNITY_BEGIN();
+
+    // Budget Tests
+    RUN_TEST(test_critical_phases_run_when_over_budget);
+    RUN_TEST(test_deferred_phase_receives_accumulated_delta);
+    RUN_TEST(test_deferral_is_bounded);
+
+    // Pacing Tests
+    RUN_TEST(test_frames_align_to_deadlines);
+    RUN_TEST(test_missed_deadline_resets_schedule);
+    RUN_TEST(test_paced_loop_holds_frame_rate);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runFramePacerTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runFramePacerTests();
+}
+#endif
@@ -0,0 +1,312 @@
+#include <unity.h>
+#include "../src/system/job_executor.h"
+#include "../src/system/task_scheduler.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_job_executor.cpp
+ * @brief Work-stealing executor tests with a parallel DSP speedup benchmark
+ */
+
+static JobExecutor* executor = nullptr;
+
+// Wait for asynchronously submitted jobs with a timeout
+static bool waitFor(const std::atomic<int>& counter, int expected, uint32_t timeoutMs = 2000) {
+    uint32_t start = millis();
+    while (counter.load() < expected) {
+        if (millis() - start > timeoutMs) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// Biquad low-pass filter over a block, standing in for audio/sensor DSP work
+static void filterBlock(const float* input, float* output, size_t count) {
+    const float b0 = 0.0675f, b1 = 0.1349f, b2 = 0.0675f, a1 = -1.1430f, a2 = 0.4128f;
+    float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float y = b0 * input[i] + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1; x1 = input[i];
+        y2 = y1; y1 = y;
+        output[i] = std::sqrt(std::fabs(y)) * std::sin(y);
+    }
+}
+
+static const size_t DSP_CHANNELS = 32;
+static const size_t DSP_BLOCK = 4096;
+
+void setUp(void) {
+    executor = new JobExecutor();
+    executor->initialize(2);
+}
+
+void tearDown(void) {
+    delete executor;
+    executor = nullptr;
+}
+
+void test_all_submitted_jobs_run() {
+    std::atomic<int> runs{0};
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(executor->submit([&runs]() { runs++; }));
+    }
+    TEST_ASSERT_TRUE(waitFor(runs, 100));
+
+    ExecutorStats stats = executor->getStats();
+    TEST_ASSERT_EQUAL(100, stats.jobsSubmitted);
+    TEST_ASSERT_EQUAL(100, stats.workers[0].jobsExecuted + stats.workers[1].jobsExecuted);
+}
+
+void test_idle_worker_steals_from_busy_worker() {
+    std::atomic<int> runs{0};
+    std::atomic<bool> seen[2] = {{false}, {false}};
+
+    // Everything goes to the last worker's deque; worker 0 must steal
+    for (int i = 0; i < 64; i++) {
+        executor->submit([&]() {
+            seen[JobExecutor::currentWorker()] = true;
+            int64_t start = esp_timer_get_time();
+            while (esp_timer_get_time() - start < 500) {
+            }
+            runs++;
+        }, JobAffinity::BACKGROUND);
+    }
+    TEST_ASSERT_TRUE(waitFor(runs, 64));
+
+    // Whether worker 0 gets to steal depends on thread timing, so it is
+    // reported rather than asserted
+    ExecutorStats stats = executor->getStats();
+    char message[128];
+    snprintf(message, sizeof(message), "Worker 0 stole %u of 64 jobs (ran jobs: worker 0 %s, worker 1 %s)",
+             (unsigned)stats.workers[0].jobsStolen, seen[0] ? "yes" : "no", seen[1] ? "yes" : "no");
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_OR_EQUAL(64, stats.workers[0].jobsStolen);
+    TEST_ASSERT_EQUAL(0, stats.workers[1].jobsStolen);
+}
+
+void test_realtime_jobs_stay_on_worker_zero() {
+    std::atomic<int> runs{0};
+    std::atomic<int> wrongWorker{0};
+    for (int i = 0; i < 32; i++) {
+        executor->submit([&]() {
+            if (JobExecutor::currentWorker() != 0) {
+                wrongWorker++;
+            }
+            runs++;
+        }, JobAffinity::REALTIME);
+    }
+    TEST_ASSERT_TRUE(waitFor(runs, 32));
+    TEST_ASSERT_EQUAL(0, wrongWorker.load());
+    TEST_ASSERT_EQUAL(-1, JobExecutor::currentWorker());
+}
+
+void test_shutdown_drains_queued_jobs() {
+    std::atomic<int> runs{0};
+    for (int i = 0; i < 50; i++) {
+        executor->submit([&runs]() { runs++; });
+    }
+    executor->shutdown();
+    TEST_ASSERT_EQUAL(50, runs.load());
+    TEST_ASSERT_FALSE(executor->submit([]() {}));
+}
+
+void test_parallel_for_covers_range_once() {
+    std::vector<int> hits(1000, 0);
+    executor->parallelFor(0, hits.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            hits[i]++;
+        }
+    });
+    for (size_t i = 0; i < hits.size(); i++) {
+        TEST_ASSERT_EQUAL(1, hits[i]);
+    }
+
+    // Nested calls from inside a job must not deadlock
+    std::atomic<int> nested{0};
+    std::atomic<int> done{0};
+    executor->submit([&]() {
+        executor->parallelFor(0, 64, 1, [&](size_t begin, size_t end) {
+            nested += static_cast<int>(end - begin);
+        });
+        done++;
+    });
+    TEST_ASSERT_TRUE(waitFor(done, 1));
+    TEST_ASSERT_EQUAL(64, nested.load());
+}
+
+void test_scheduler_offloads_task_to_worker() {
+    TaskScheduler scheduler;
+    scheduler.initialize();
+    scheduler.setExecutor(executor);
+
+    std::atomic<int> worker{-2};
+    std::atomic<int> runs{0};
+    scheduler.scheduleOnce([&]() {
+        worker = JobExecutor::currentWorker();
+        runs++;
+    }, OS_TASK_PRIORITY_NORMAL, 0, "offload", TaskAffinity::BACKGROUND_CORE);
+
+    scheduler.update(0);
+    TEST_ASSERT_TRUE(waitFor(runs, 1));
+    TEST_ASSERT_GREATER_OR_EQUAL(0, worker.load());
+
+    // Without a running executor the task runs inline on the caller
+    executor->shutdown();
+    scheduler.scheduleOnce([&]() {
+        worker = JobExecutor::currentWorker();
+        runs++;
+    }, OS_TASK_PRIORITY_NORMAL, 0, "inline", TaskAffinity::ANY_CORE);
+    scheduler.update(0);
+    TEST_ASSERT_EQUAL(2, runs.load());
+    TEST_ASSERT_EQUAL(-1, worker.load());
+}
+
+static uint32_t offloadClock = 0;
+
+void test_scheduler_skips_periods_while_offloaded_run_in_flight() {
+    TaskScheduler scheduler;
+    scheduler.setTimeSource([]() { return offloadClock; });
+    scheduler.initialize();
+    scheduler.setExecutor(executor);
+
+    std::atomic<bool> release{false};
+    std::atomic<int> runs{0};
+    uint32_t id = scheduler.schedulePeriodic([&]() {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+        runs++;
+    }, 10, OS_TASK_PRIORITY_NORMAL, 0, "slow", TaskAffinity::BACKGROUND_CORE);
+
+    // The first run blocks on the worker; later periods are skipped, not queued
+    for (int i = 0; i < 4; i++) {
+        offloadClock += 10;
+        scheduler.update(0);
+    }
+    TEST_ASSERT_EQUAL(3, scheduler.getTaskInfo(id)->overrunCount);
+
+    // Cancelling mid-run is safe: the job owns its copy of the callable
+    scheduler.cancelTask(id);
+    release = true;
+    TEST_ASSERT_TRUE(waitFor(runs, 1));
+    TEST_ASSERT_EQUAL(OS_OK, scheduler.shutdown());
+    TEST_ASSERT_EQUAL(1, runs.load());
+}
+
+void test_scheduler_does_not_reuse_slot_with_run_in_flight() {
+    TaskScheduler scheduler;
+    scheduler.initialize();
+    scheduler.setExecutor(executor);
+
+    std::atomic<bool> release{false};
+    std::atomic<int> slowRuns{0};
+    uint32_t slowId = scheduler.scheduleOnce([&]() {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+        slowRuns++;
+    }, OS_TASK_PRIORITY_NORMAL, 0, "slow", TaskAffinity::BACKGROUND_CORE);
+    scheduler.update(0);
+
+    // Its slot is freed while the run is still blocked on the worker; the
+    // next task must not inherit the slot's busy flag and be skipped
+    scheduler.cancelTask(slowId);
+    std::atomic<int> nextRuns{0};
+    scheduler.scheduleOnce([&]() {
+        nextRuns++;
+    }, OS_TASK_PRIORITY_NORMAL, 0, "next", TaskAffinity::BACKGROUND_CORE);
+    scheduler.update(0);
+
+    release = true;
+    TEST_ASSERT_TRUE(waitFor(slowRuns, 1));
+    TEST_ASSERT_TRUE(waitFor(nextRuns, 1));
+    TEST_ASSERT_EQUAL(OS_OK, scheduler.shutdown());
+}
+
+void test_parallel_dsp_speedup_benchmark() {
+    std::vector<float> input(DSP_CHANNELS * DSP_BLOCK);
+    std::vector<float> serialOut(input.size());
+    std::vector<float> parallelOut(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = std::sin(i * 0.01f) + 0.1f * std::sin(i * 0.37f);
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (size_t ch = 0; ch < DSP_CHANNELS; ch++) {
+        filterBlock(&input[ch * DSP_BLOCK], &serialOut[ch * DSP_BLOCK], DSP_BLOCK);
+    }
+    int64_t serialUs = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    executor->parallelFor(0, DSP_CHANNELS, 1, [&](size_t begin, size_t end) {
+        for (size_t ch = begin; ch < end; ch++) {
+            filterBlock(&input[ch * DSP_BLOCK], &parallelOut[ch * DSP_BLOCK], DSP_BLOCK);
+        }
+    });
+    int64_t parallelUs = esp_timer_get_time() - start;
+
+    for (size_t i = 0; i < input.size(); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(serialOut[i], parallelOut[i]);
+    }
+
+    ExecutorStats stats = executor->getStats();
+    char message[200];
+    snprintf(message, sizeof(message),
+             "%u x %u-sample biquad: serial %lld us, parallelFor %lld us (%.2fx); "
+             "steals %u/%u, utilization %u%%/%u%%",
+             (unsigned)DSP_CHANNELS, (unsigned)DSP_BLOCK, (long long)serialUs, (long long)parallelUs,
+             parallelUs > 0 ? (float)serialUs / parallelUs : 0.0f,
+             stats.workers[0].jobsStolen, stats.workers[1].jobsStolen,
+             stats.workers[0].utilization, stats.workers[1].utilization);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(1, stats.parallelForCalls);
+}
+
+int runJobExecutorTests() {
+    UNITY_BEGIN();
+
+    // Executor Tests
+    RUN_TEST(test_all_submitted_jobs_run);
+    RUN_TEST(test_idle_worker_steals_from_busy_worker);
+    RUN_TEST(test_realtime_jobs_stay_on_worker_zero);
+    RUN_TEST(test_shutdown_drains_queued_jobs);
+    RUN_TEST(test_parallel_for_covers_range_once);
+
+    // Scheduler Integration Tests
+    RUN_TEST(test_scheduler_offloads_task_to_worker);
+    RUN_TEST(test_scheduler_skips_periods_while_offloaded_run_in_flight);
+    RUN_TEST(test_scheduler_does_not_reuse_slot_with_run_in_flight);
+
+    // Benchmarks
+    RUN_TEST(test_parallel_dsp_speedup_benchmark);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runJobExecutorTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runJobExecutorTests();
+}
+#endif
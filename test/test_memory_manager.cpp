@@ -0,0 +1,1032 @@
+#include <unity.h>
+#include "../src/system/memory_manager.h"
+#include "../src/system/task_scheduler.h"
+#include <esp_timer.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_memory_manager.cpp
+ * @brief Memory pool and memory manager tests with allocation microbenchmarks
+ */
+
+// Reference pool using the previous linear bitmap scan, kept for benchmarking
+class LinearScanPool {
+public:
+    LinearScanPool(size_t blockSize, size_t blockCount)
+        : m_blockSize(blockSize), m_totalBlocks(blockCount), m_freeBlocks(blockCount),
+          m_memory(blockSize * blockCount), m_blockUsed(blockCount, false) {}
+
+    void* allocate() {
+        if (m_freeBlocks == 0) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < m_totalBlocks; i++) {
+            if (!m_blockUsed[i]) {
+                m_blockUsed[i] = true;
+                m_freeBlocks--;
+                return m_memory.data() + (i * m_blockSize);
+            }
+        }
+        return nullptr;
+    }
+
+    bool deallocate(void* ptr) {
+        size_t offset = static_cast<uint8_t*>(ptr) - m_memory.data();
+        size_t blockIndex = offset / m_blockSize;
+        if (blockIndex >= m_totalBlocks || !m_blockUsed[blockIndex]) {
+            return false;
+        }
+        m_blockUsed[blockIndex] = false;
+        m_freeBlocks++;
+        return true;
+    }
+
+private:
+    size_t m_blockSize;
+    size_t m_totalBlocks;
+    size_t m_freeBlocks;
+    std::vector<uint8_t> m_memory;
+    std::vector<bool> m_blockUsed;
+};
+
+static const size_t BENCH_BLOCK_SIZE = 16;
+static const size_t BENCH_BLOCK_COUNT = 128;
+static const uint32_t BENCH_ITERATIONS = 200000;
+
+// Keep the pool nearly full and churn the last free block - the worst case
+// for a scan that always starts at index 0
+template <typename Pool>
+static float benchmarkNearlyFullPool(Pool& pool) {
+    std::vector<void*> held;
+    for (size_t i = 0; i < BENCH_BLOCK_COUNT - 1; i++) {
+        held.push_back(pool.allocate());
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        void* ptr = pool.allocate();
+        pool.deallocate(ptr);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    for (void* ptr : held) {
+        pool.deallocate(ptr);
+    }
+
+    return elapsed > 0 ? (BENCH_ITERATIONS * 1000000.0f) / elapsed : 0.0f;
+}
+
+static const int STRESS_THREADS = 4;
+static const uint32_t STRESS_BATCHES = 2000;
+static const uint32_t STRESS_BATCH_OPS = 32;
+static const size_t STRESS_LIVE_BLOCKS = 4;
+
+struct StressResult {
+    float opsPerSecond;
+    float p50NsPerOp;
+    float p99NsPerOp;
+    float maxNsPerOp;
+    uint32_t failures;
+};
+
+// Each thread churns a small window of random 8-256 byte allocations, timing
+// batches of alloc/free pairs (single ops are below esp_timer resolution)
+static StressResult stressManager(MemoryManager& manager) {
+    std::vector<std::vector<uint32_t>> batchTimes(STRESS_THREADS);
+    std::atomic<uint32_t> failures{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            uint32_t seed = 0x9E3779B9u * (t + 1);
+            void* live[STRESS_LIVE_BLOCKS] = {};
+            std::vector<uint32_t>& times = batchTimes[t];
+            times.reserve(STRESS_BATCHES);
+
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+
+            for (uint32_t batch = 0; batch < STRESS_BATCHES; batch++) {
+                int64_t start = esp_timer_get_time();
+                for (uint32_t op = 0; op < STRESS_BATCH_OPS; op++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    size_t slot = (seed >> 8) % STRESS_LIVE_BLOCKS;
+                    if (live[slot]) {
+                        manager.deallocate(live[slot]);
+                    }
+                    live[slot] = manager.allocate(8 + ((seed >> 16) % 249));
+                    if (!live[slot]) {
+                        failures++;
+                    }
+                }
+                times.push_back(static_cast<uint32_t>(esp_timer_get_time() - start));
+            }
+
+            for (void* ptr : live) {
+                manager.deallocate(ptr);
+            }
+            manager.flushThreadCache();
+        });
+    }
+
+    int64_t start = esp_timer_get_time();
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    std::vector<uint32_t> all;
+    for (const auto& times : batchTimes) {
+        all.insert(all.end(), times.begin(), times.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    const float nsPerBatchUs = 1000.0f / STRESS_BATCH_OPS;
+    StressResult result;
+    uint32_t totalOps = STRESS_THREADS * STRESS_BATCHES * STRESS_BATCH_OPS;
+    result.opsPerSecond = elapsed > 0 ? (totalOps * 1000000.0f) / elapsed : 0.0f;
+    result.p50NsPerOp = all[all.size() / 2] * nsPerBatchUs;
+    result.p99NsPerOp = all[(all.size() * 99) / 100] * nsPerBatchUs;
+    result.maxNsPerOp = all.back() * nsPerBatchUs;
+    result.failures = failures.load();
+    return result;
+}
+
+static const size_t TRACKER_LIVE_BLOCKS = 512;
+static const uint32_t TRACKER_ITERATIONS = 20000;
+
+static MemoryBlock makeBlock(void* ptr, size_t size) {
+    MemoryBlock block = {};
+    block.ptr = ptr;
+    block.size = size;
+    block.inUse = true;
+    return block;
+}
+
+// Free the oldest live allocation and track a new one, as deallocate()/allocate() do
+template <typename RemoveFn, typename InsertFn>
+static float benchmarkTrackerChurn(RemoveFn removeBlock, InsertFn insertBlock,
+                                   std::vector<uintptr_t>& live) {
+    uintptr_t nextAddress = live.back() + 32;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < TRACKER_ITERATIONS; i++) {
+        size_t slot = i % live.size();
+        removeBlock(reinterpret_cast<void*>(live[slot]));
+        live[slot] = nextAddress;
+        insertBlock(makeBlock(reinterpret_cast<void*>(nextAddress), 32));
+        nextAddress += 32;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    return elapsed > 0 ? (TRACKER_ITERATIONS * 1000000.0f) / elapsed : 0.0f;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_pool_allocates_every_block_once() {
+    MemoryPool pool(BENCH_BLOCK_SIZE, BENCH_BLOCK_COUNT);
+    std::vector<void*> blocks;
+
+    for (size_t i = 0; i < BENCH_BLOCK_COUNT; i++) {
+        void* ptr = pool.allocate();
+        TEST_ASSERT_NOT_NULL(ptr);
+        TEST_ASSERT_TRUE(pool.owns(ptr));
+        blocks.push_back(ptr);
+    }
+
+    TEST_ASSERT_EQUAL(0, pool.getFreeBlocks());
+    TEST_ASSERT_NULL(pool.allocate());
+
+    // Blocks come out in address order and never overlap
+    for (size_t i = 1; i < blocks.size(); i++) {
+        TEST_ASSERT_EQUAL(BENCH_BLOCK_SIZE,
+                          static_cast<char*>(blocks[i]) - static_cast<char*>(blocks[i - 1]));
+    }
+
+    for (void* ptr : blocks) {
+        TEST_ASSERT_TRUE(pool.deallocate(ptr));
+    }
+    TEST_ASSERT_EQUAL(BENCH_BLOCK_COUNT, pool.getFreeBlocks());
+}
+
+void test_pool_reuses_most_recently_freed_block() {
+    MemoryPool pool(64, 8);
+
+    void* a = pool.allocate();
+    void* b = pool.allocate();
+    TEST_ASSERT_TRUE(pool.deallocate(a));
+
+    void* c = pool.allocate();
+    TEST_ASSERT_EQUAL_PTR(a, c);
+
+    pool.deallocate(b);
+    pool.deallocate(c);
+}
+
+void test_pool_rejects_double_free() {
+    MemoryPool pool(BENCH_BLOCK_SIZE, 4);
+
+    void* ptr = pool.allocate();
+    TEST_ASSERT_TRUE(pool.deallocate(ptr));
+    TEST_ASSERT_FALSE(pool.deallocate(ptr));
+    TEST_ASSERT_EQUAL(4, pool.getFreeBlocks());
+
+    // The free list must still hand out each block exactly once
+    void* blocks[4];
+    for (int i = 0; i < 4; i++) {
+        blocks[i] = pool.allocate();
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+    }
+    TEST_ASSERT_NULL(pool.allocate());
+}
+
+void test_pool_rejects_foreign_and_misaligned_pointers() {
+    MemoryPool pool(BENCH_BLOCK_SIZE, 4);
+    uint8_t stackBuffer[BENCH_BLOCK_SIZE];
+
+    void* ptr = pool.allocate();
+    TEST_ASSERT_FALSE(pool.owns(stackBuffer));
+    TEST_ASSERT_FALSE(pool.deallocate(stackBuffer));
+    TEST_ASSERT_FALSE(pool.deallocate(static_cast<char*>(ptr) + 1));
+    TEST_ASSERT_FALSE(pool.deallocate(nullptr));
+    TEST_ASSERT_TRUE(pool.deallocate(ptr));
+}
+
+void test_pool_benchmark_against_linear_scan() {
+    MemoryPool freeListPool(BENCH_BLOCK_SIZE, BENCH_BLOCK_COUNT);
+    LinearScanPool linearPool(BENCH_BLOCK_SIZE, BENCH_BLOCK_COUNT);
+
+    float freeListRate = benchmarkNearlyFullPool(freeListPool);
+    float linearRate = benchmarkNearlyFullPool(linearPool);
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "16B x 128 pool, 127 held: free-list %.0f allocs/s, linear scan %.0f allocs/s (%.1fx)",
+             freeListRate, linearRate, linearRate > 0 ? freeListRate / linearRate : 0.0f);
+    TEST_MESSAGE(message);
+
+    // Timing is only reported; the functional checks live in the pool tests
+    TEST_ASSERT_EQUAL(0, freeListPool.getUsedBlocks());
+}
+
+void test_tracker_insert_find_remove() {
+    static AllocationTracker<true, 64> tracker;
+    uint8_t buffer[4 * 40];
+
+    for (int i = 0; i < 40; i++) {
+        TEST_ASSERT_TRUE(tracker.insert(makeBlock(buffer + i * 4, i + 1)));
+    }
+    TEST_ASSERT_EQUAL(40, tracker.size());
+    TEST_ASSERT_FALSE(tracker.insert(makeBlock(buffer, 99)));
+
+    for (int i = 0; i < 40; i++) {
+        const MemoryBlock* block = tracker.find(buffer + i * 4);
+        TEST_ASSERT_NOT_NULL(block);
+        TEST_ASSERT_EQUAL(i + 1, block->size);
+    }
+
+    // Remove every other entry; backward shifting must keep the rest reachable
+    for (int i = 0; i < 40; i += 2) {
+        MemoryBlock removed;
+        TEST_ASSERT_TRUE(tracker.remove(buffer + i * 4, &removed));
+        TEST_ASSERT_EQUAL(i + 1, removed.size);
+    }
+    for (int i = 0; i < 40; i++) {
+        TEST_ASSERT_EQUAL(i % 2 == 1, tracker.find(buffer + i * 4) != nullptr);
+    }
+    TEST_ASSERT_FALSE(tracker.remove(buffer));
+    TEST_ASSERT_EQUAL(20, tracker.size());
+
+    size_t visited = 0;
+    tracker.forEach([&](const MemoryBlock&) { visited++; });
+    TEST_ASSERT_EQUAL(20, visited);
+}
+
+void test_tracker_rejects_inserts_when_full() {
+    static AllocationTracker<true, 16> tracker;
+    uint8_t buffer[4 * 16];
+
+    size_t inserted = 0;
+    while (inserted < 16 && tracker.insert(makeBlock(buffer + inserted * 4, 4))) {
+        inserted++;
+    }
+    TEST_ASSERT_EQUAL(tracker.capacity(), inserted);
+    TEST_ASSERT_TRUE(tracker.remove(buffer));
+    TEST_ASSERT_TRUE(tracker.insert(makeBlock(buffer, 4)));
+}
+
+void test_tracker_disabled_keeps_pointers_only() {
+    static AllocationTracker<false, 1024> tracker;
+    int value = 0;
+    int foreign = 0;
+
+    TEST_ASSERT_FALSE(tracker.enabled);
+    TEST_ASSERT_TRUE(tracker.insert(makeBlock(&value, sizeof(value))));
+    TEST_ASSERT_NULL(tracker.find(&value));
+    TEST_ASSERT_EQUAL(1, tracker.size());
+
+    // Release builds must still refuse to free memory they never handed out
+    TEST_ASSERT_FALSE(tracker.remove(&foreign));
+    TEST_ASSERT_TRUE(tracker.remove(&value));
+    TEST_ASSERT_FALSE(tracker.remove(&value));
+    TEST_ASSERT_EQUAL(0, tracker.size());
+    TEST_ASSERT_LESS_THAN(sizeof(AllocationTracker<true, 1024>), sizeof(tracker));
+}
+
+void test_manager_heap_allocations_are_tracked() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    // Larger than the biggest pool block, so served from the heap
+    void* ptr = manager.allocate(20000, __FILE__, __LINE__);
+    TEST_ASSERT_NOT_NULL(ptr);
+    TEST_ASSERT_EQUAL(1, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(1, manager.checkLeaks());
+    TEST_ASSERT_TRUE(manager.deallocate(ptr));
+    TEST_ASSERT_EQUAL(0, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(0, manager.getTotalAllocated());
+}
+
+void test_manager_tracking_overflow_keeps_allocations() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    // Fill the tracking table and go past it; the extra blocks must still be served
+    const size_t count = OS_MAX_TRACKED_ALLOCATIONS;
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < count; i++) {
+        void* ptr = manager.allocate(20000);
+        TEST_ASSERT_NOT_NULL(ptr);
+        blocks.push_back(ptr);
+    }
+    TEST_ASSERT_GREATER_THAN(0, manager.getTrackingOverflows());
+    TEST_ASSERT_EQUAL(count, manager.getActiveAllocations());
+
+    int foreign = 0;
+    TEST_ASSERT_FALSE(manager.deallocate(&foreign));
+
+    for (void* ptr : blocks) {
+        TEST_ASSERT_TRUE(manager.deallocate(ptr));
+    }
+    TEST_ASSERT_EQUAL(0, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(0, manager.getTotalAllocated());
+}
+
+void test_arena_bump_allocation_and_alignment() {
+    MemoryArena arena("test", 1024, MALLOC_CAP_DEFAULT);
+
+    uint8_t* a = static_cast<uint8_t*>(arena.allocate(3, 1));
+    uint8_t* b = static_cast<uint8_t*>(arena.allocate(8, 8));
+    uint32_t* c = arena.create<uint32_t>(42u);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(b) % 8);
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(c) % alignof(uint32_t));
+    TEST_ASSERT_EQUAL(42, *c);
+    TEST_ASSERT_TRUE(b > a && b - a < 16);
+
+    // Reset rewinds to the start of the same chunk
+    arena.reset();
+    TEST_ASSERT_EQUAL(0, arena.getUsed());
+    TEST_ASSERT_EQUAL_PTR(a, arena.allocate(3, 1));
+    TEST_ASSERT_EQUAL(1, arena.getStats().chunkAllocations);
+}
+
+void test_arena_grows_and_merges_on_reset() {
+    MemoryArena arena("test", 256, MALLOC_CAP_DEFAULT);
+
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_NOT_NULL(arena.allocate(100));
+    }
+    TEST_ASSERT_NOT_NULL(arena.allocate(4096)); // Oversized request gets its own chunk
+    TEST_ASSERT_GREATER_THAN(1, arena.getStats().chunkAllocations);
+    size_t capacity = arena.getStats().capacity;
+
+    // The next frame fits in the single merged chunk without growing again
+    arena.reset();
+    uint32_t chunks = arena.getStats().chunkAllocations;
+    TEST_ASSERT_EQUAL(capacity, arena.getStats().capacity);
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_NOT_NULL(arena.allocate(100));
+    }
+    TEST_ASSERT_NOT_NULL(arena.allocate(4096));
+    TEST_ASSERT_EQUAL(chunks, arena.getStats().chunkAllocations);
+    TEST_ASSERT_GREATER_OR_EQUAL(arena.getUsed(), arena.getStats().peakUsed);
+
+    arena.release();
+    TEST_ASSERT_EQUAL(0, arena.getStats().capacity);
+}
+
+void test_arena_std_allocator_adapters() {
+    MemoryArena arena("test", 4096, MALLOC_CAP_DEFAULT);
+
+    ArenaVector<int> values{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 100; i++) {
+        values.push_back(i);
+    }
+    TEST_ASSERT_EQUAL(100, values.size());
+    TEST_ASSERT_EQUAL(99, values.back());
+
+    ArenaString text{ArenaAllocator<char>(arena)};
+    text = "frame scratch strings are long enough to skip the small-string buffer";
+    text += " and land in the arena";
+    TEST_ASSERT_EQUAL_PTR(&arena, text.get_allocator().arena());
+    TEST_ASSERT_GREATER_THAN(values.size() * sizeof(int), arena.getUsed());
+}
+
+void test_manager_app_arenas() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    MemoryArena* arena = manager.getAppArena("demo");
+    TEST_ASSERT_NOT_NULL(arena);
+    TEST_ASSERT_EQUAL_PTR(arena, manager.getAppArena("demo"));
+    TEST_ASSERT_EQUAL_STRING("demo", arena->getName());
+    TEST_ASSERT_NOT_NULL(arena->allocate(1000));
+    TEST_ASSERT_NOT_NULL(manager.getFrameArena().allocate(200));
+
+    ArenaStats stats = manager.getArenaStats();
+    TEST_ASSERT_GREATER_OR_EQUAL(1200, stats.used);
+    TEST_ASSERT_EQUAL(2, stats.allocationCount);
+
+    // Frame end only rewinds the frame arena
+    manager.endFrame();
+    TEST_ASSERT_EQUAL(0, manager.getFrameArena().getUsed());
+    TEST_ASSERT_GREATER_OR_EQUAL(1000, arena->getUsed());
+
+    // Releasing an app arena frees it but keeps its counters in the totals
+    manager.releaseAppArena("demo");
+    stats = manager.getArenaStats();
+    TEST_ASSERT_EQUAL(0, stats.used);
+    TEST_ASSERT_EQUAL(2, stats.allocationCount);
+}
+
+static const size_t RELOC_BLOCK_SIZE = 32 * 1024;
+static const size_t RELOC_BLOCK_COUNT = 32;
+
+// Fill a 1MB heap with 32KB blocks, stamp each with its index and free every other one
+static void fragmentRelocatableHeap(RelocatableHeap& heap, std::vector<MemoryHandle>& kept) {
+    std::vector<MemoryHandle> handles;
+    for (size_t i = 0; i < RELOC_BLOCK_COUNT; i++) {
+        MemoryHandle handle = heap.allocate(RELOC_BLOCK_SIZE);
+        PinnedBlock block(heap, handle);
+        memset(block.get(), static_cast<int>(i), RELOC_BLOCK_SIZE);
+        handles.push_back(handle);
+    }
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (i % 2 == 0) {
+            heap.free(handles[i]);
+        } else {
+            kept.push_back(handles[i]);
+        }
+    }
+}
+
+static bool blockHasStamp(RelocatableHeap& heap, MemoryHandle handle, uint8_t stamp) {
+    PinnedBlock block(heap, handle);
+    const uint8_t* bytes = block.as<uint8_t>();
+    return bytes && bytes[0] == stamp && bytes[RELOC_BLOCK_SIZE - 1] == stamp;
+}
+
+void test_relocatable_handles_and_pinning() {
+    RelocatableHeap heap(64 * 1024, 8, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_TRUE(heap.isValid());
+
+    MemoryHandle handle = heap.allocate(100);
+    TEST_ASSERT_NOT_EQUAL(INVALID_MEMORY_HANDLE, handle);
+    TEST_ASSERT_EQUAL(112, heap.getSize(handle));
+
+    void* first = heap.pin(handle);
+    void* second = heap.pin(handle);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_PTR(first, second);
+    TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(first) % 16);
+
+    // Pinned blocks cannot be freed until every pin is released
+    TEST_ASSERT_FALSE(heap.free(handle));
+    heap.unpin(handle);
+    TEST_ASSERT_FALSE(heap.free(handle));
+    heap.unpin(handle);
+    TEST_ASSERT_TRUE(heap.free(handle));
+
+    // The slot is recycled under a new generation; the old handle stays dead
+    MemoryHandle reused = heap.allocate(100);
+    TEST_ASSERT_NOT_EQUAL(handle, reused);
+    TEST_ASSERT_NULL(heap.pin(handle));
+    TEST_ASSERT_FALSE(heap.free(handle));
+    TEST_ASSERT_TRUE(heap.free(reused));
+}
+
+void test_relocatable_compaction_restores_largest_block() {
+    RelocatableHeap heap(RELOC_BLOCK_SIZE * RELOC_BLOCK_COUNT, 64, MALLOC_CAP_DEFAULT);
+    std::vector<MemoryHandle> kept;
+    fragmentRelocatableHeap(heap, kept);
+
+    RelocatableHeapStats before = heap.getStats();
+    TEST_ASSERT_TRUE(heap.isFragmented());
+    TEST_ASSERT_EQUAL(RELOC_BLOCK_SIZE, before.largestFreeBlock);
+
+    size_t moved = heap.compact();
+    RelocatableHeapStats after = heap.getStats();
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "Largest free block %d KB -> %d KB of %d KB free, %d KB moved",
+             (int)(before.largestFreeBlock / 1024), (int)(after.largestFreeBlock / 1024),
+             (int)(after.freeBytes / 1024), (int)(moved / 1024));
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_FALSE(heap.isFragmented());
+    TEST_ASSERT_EQUAL(after.freeBytes, after.largestFreeBlock);
+    for (size_t i = 0; i < kept.size(); i++) {
+        TEST_ASSERT_TRUE(blockHasStamp(heap, kept[i], static_cast<uint8_t>(i * 2 + 1)));
+    }
+}
+
+void test_relocatable_compaction_skips_pinned_blocks() {
+    RelocatableHeap heap(RELOC_BLOCK_SIZE * RELOC_BLOCK_COUNT, 64, MALLOC_CAP_DEFAULT);
+    std::vector<MemoryHandle> kept;
+    fragmentRelocatableHeap(heap, kept);
+
+    MemoryHandle pinnedHandle = kept[kept.size() / 2];
+    void* pinned = heap.pin(pinnedHandle);
+    heap.compact();
+
+    // The pinned block stays put and splits the free space in two
+    TEST_ASSERT_EQUAL_PTR(pinned, heap.pin(pinnedHandle));
+    TEST_ASSERT_EQUAL(1, heap.getStats().pinnedBlocks);
+    TEST_ASSERT_TRUE(heap.isFragmented());
+    heap.unpin(pinnedHandle);
+    heap.unpin(pinnedHandle);
+
+    heap.compact();
+    TEST_ASSERT_FALSE(heap.isFragmented());
+    TEST_ASSERT_TRUE(blockHasStamp(heap, pinnedHandle, static_cast<uint8_t>(kept.size() / 2 * 2 + 1)));
+}
+
+void test_relocatable_budget_leaves_blocks_too_large_to_move() {
+    RelocatableHeap heap(RELOC_BLOCK_SIZE * RELOC_BLOCK_COUNT, 64, MALLOC_CAP_DEFAULT);
+    std::vector<MemoryHandle> kept;
+    fragmentRelocatableHeap(heap, kept);
+
+    // A 32KB block cannot be copied in 1us, so a 1us slice must not start it
+    TEST_ASSERT_EQUAL(0, heap.compact(1));
+    TEST_ASSERT_EQUAL(0, heap.getStats().bytesMoved);
+    TEST_ASSERT_TRUE(heap.isFragmented());
+
+    TEST_ASSERT_GREATER_THAN(0, heap.compact());
+    TEST_ASSERT_FALSE(heap.isFragmented());
+}
+
+void test_relocatable_allocate_compacts_when_needed() {
+    RelocatableHeap heap(RELOC_BLOCK_SIZE * RELOC_BLOCK_COUNT, 64, MALLOC_CAP_DEFAULT);
+    std::vector<MemoryHandle> kept;
+    fragmentRelocatableHeap(heap, kept);
+
+    // No hole fits 64KB until the heap is compacted
+    MemoryHandle big = heap.allocate(2 * RELOC_BLOCK_SIZE);
+    TEST_ASSERT_NOT_EQUAL(INVALID_MEMORY_HANDLE, big);
+    TEST_ASSERT_GREATER_THAN(0, heap.getStats().bytesMoved);
+
+    // More than the total free space fails outright
+    TEST_ASSERT_EQUAL(INVALID_MEMORY_HANDLE, heap.allocate(heap.getStats().freeBytes + 1));
+}
+
+void test_relocatable_compaction_in_idle_slices() {
+    MemoryManager manager;
+    TaskScheduler scheduler;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+    TEST_ASSERT_EQUAL(OS_OK, scheduler.initialize());
+
+    RelocatableHeap* heap = manager.getRelocatableHeap();
+    TEST_ASSERT_NOT_NULL(heap);
+    std::vector<MemoryHandle> kept;
+    fragmentRelocatableHeap(*heap, kept);
+    TEST_ASSERT_TRUE(heap->isFragmented());
+
+    scheduler.addIdleHandler([&manager](uint32_t budgetUs) {
+        manager.compactRelocatable(budgetUs);
+    }, "mem_compact");
+
+    // Each frame's slack hands compaction a bounded slice until the heap is whole
+    int frames = 0;
+    while (heap->isFragmented() && frames < 100) {
+        scheduler.update(16);
+        scheduler.runIdle(OS_IDLE_SLICE_MAX_US);
+        frames++;
+    }
+
+    TEST_ASSERT_FALSE(heap->isFragmented());
+    TEST_ASSERT_GREATER_THAN(0, scheduler.getIdleTimeUs());
+    for (MemoryHandle handle : kept) {
+        heap->free(handle);
+    }
+}
+
+#ifdef ARDUINO
+static const char* PROFILE_TEST_PATH = OS_STORAGE_MOUNT_POINT "/test_alloc_profile.bin";
+#else
+static const char* PROFILE_TEST_PATH = "test_alloc_profile.bin";
+#endif
+
+static const AllocationSiteStats* findProfiledSite(const AllocationSnapshot& snapshot, int line) {
+    for (const auto& site : snapshot.sites) {
+        if (site.line == line) {
+            return &site;
+        }
+    }
+    return nullptr;
+}
+
+void test_profiler_size_buckets() {
+    TEST_ASSERT_EQUAL(0, AllocationProfiler::sizeBucket(1));
+    TEST_ASSERT_EQUAL(0, AllocationProfiler::sizeBucket(16));
+    TEST_ASSERT_EQUAL(1, AllocationProfiler::sizeBucket(17));
+    TEST_ASSERT_EQUAL(6, AllocationProfiler::sizeBucket(1024));
+    TEST_ASSERT_EQUAL(PROFILER_SIZE_BUCKETS - 1, AllocationProfiler::sizeBucket(1024 * 1024));
+}
+
+void test_profiler_aggregates_by_call_site() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+    AllocationProfiler& profiler = manager.getProfiler();
+    TEST_ASSERT_EQUAL(OS_OK, profiler.start());
+
+    std::vector<void*> kept;
+    for (int i = 0; i < 10; i++) {
+        kept.push_back(manager.allocate(24, "site_a.cpp", 10));
+    }
+    for (int i = 0; i < 5; i++) {
+        void* ptr = manager.allocate(20000, "site_b.cpp", 20);
+        manager.deallocate(ptr);
+    }
+
+    AllocationSnapshot snapshot = profiler.snapshot();
+    const AllocationSiteStats* siteA = findProfiledSite(snapshot, 10);
+    const AllocationSiteStats* siteB = findProfiledSite(snapshot, 20);
+    TEST_ASSERT_NOT_NULL(siteA);
+    TEST_ASSERT_NOT_NULL(siteB);
+    TEST_ASSERT_EQUAL_STRING("site_a.cpp", siteA->file);
+    TEST_ASSERT_EQUAL(10, siteA->allocCount);
+    TEST_ASSERT_EQUAL(240, siteA->liveBytes());
+    TEST_ASSERT_EQUAL(10, siteA->sizeHistogram[AllocationProfiler::sizeBucket(24)]);
+    TEST_ASSERT_EQUAL(5, siteB->allocCount);
+    TEST_ASSERT_EQUAL(5, siteB->freeCount);
+    TEST_ASSERT_EQUAL(0, siteB->liveBytes());
+
+    profiler.stop();
+    for (void* ptr : kept) {
+        manager.deallocate(ptr);
+    }
+}
+
+void test_profiler_sampling_weights_samples() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+    AllocationProfiler& profiler = manager.getProfiler();
+    TEST_ASSERT_EQUAL(OS_OK, profiler.start(4));
+
+    std::vector<void*> kept;
+    for (int i = 0; i < 64; i++) {
+        kept.push_back(manager.allocate(48, "sampled.cpp", 7));
+    }
+
+    // 16 samples, each standing in for 4 allocations
+    AllocationSnapshot snapshot = profiler.snapshot();
+    const AllocationSiteStats* site = findProfiledSite(snapshot, 7);
+    TEST_ASSERT_NOT_NULL(site);
+    TEST_ASSERT_EQUAL(64, site->allocCount);
+    TEST_ASSERT_EQUAL(64 * 48, site->allocBytes);
+
+    for (void* ptr : kept) {
+        manager.deallocate(ptr);
+    }
+    snapshot = profiler.snapshot();
+    site = findProfiledSite(snapshot, 7);
+    TEST_ASSERT_EQUAL(0, site->liveBytes());
+    profiler.stop();
+}
+
+void test_profiler_snapshot_diff() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+    AllocationProfiler& profiler = manager.getProfiler();
+    TEST_ASSERT_EQUAL(OS_OK, profiler.start());
+
+    void* before = manager.allocate(100, "boot.cpp", 1);
+    AllocationSnapshot first = profiler.snapshot();
+
+    // Simulated app launch: one leaked buffer, one transient
+    void* leaked = manager.allocate(4000, "app.cpp", 2);
+    void* transient = manager.allocate(64, "app.cpp", 3);
+    manager.deallocate(transient);
+    AllocationSnapshot second = profiler.snapshot();
+
+    std::vector<AllocationSiteDelta> deltas = AllocationProfiler::diff(first, second);
+    TEST_ASSERT_EQUAL(2, deltas.size());
+    TEST_ASSERT_EQUAL(2, deltas[0].line);
+    TEST_ASSERT_EQUAL(4000, deltas[0].liveBytesDelta);
+    TEST_ASSERT_EQUAL(3, deltas[1].line);
+    TEST_ASSERT_EQUAL(0, deltas[1].liveBytesDelta);
+    TEST_ASSERT_EQUAL(1, deltas[1].allocCountDelta);
+    AllocationProfiler::logDiff("test", first, second, 4);
+
+    profiler.stop();
+    manager.deallocate(before);
+    manager.deallocate(leaked);
+}
+
+void test_profiler_binary_dump() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+    AllocationProfiler& profiler = manager.getProfiler();
+    TEST_ASSERT_EQUAL(OS_OK, profiler.start());
+
+    void* ptr = manager.allocate(300, "dump.cpp", 42);
+    AllocationSnapshot snapshot = profiler.snapshot();
+    TEST_ASSERT_EQUAL(OS_OK, AllocationProfiler::dumpToFile(PROFILE_TEST_PATH, snapshot));
+
+    FILE* file = fopen(PROFILE_TEST_PATH, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    uint8_t header[24];
+    TEST_ASSERT_EQUAL(sizeof(header), fread(header, 1, sizeof(header), file));
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fclose(file);
+    remove(PROFILE_TEST_PATH);
+
+    uint32_t siteCount;
+    memcpy(&siteCount, header + 16, sizeof(siteCount));
+    TEST_ASSERT_EQUAL_MEMORY("APRF", header, 4);
+    TEST_ASSERT_EQUAL(1, siteCount);
+    TEST_ASSERT_EQUAL(24 + 28 + PROFILER_SIZE_BUCKETS * 4 + 2 + strlen("dump.cpp"), fileSize);
+
+    TEST_ASSERT_EQUAL(OS_ERROR_FILESYSTEM, AllocationProfiler::dumpToFile("/nonexistent/dir/x.bin", snapshot));
+
+    profiler.stop();
+    manager.deallocate(ptr);
+}
+
+void test_manager_thread_cache_reuses_block() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    void* a = manager.allocate(24);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL(1, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(64, manager.getTotalAllocated());
+    TEST_ASSERT_TRUE(manager.deallocate(a));
+    TEST_ASSERT_EQUAL(0, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(0, manager.getTotalAllocated());
+
+    // The freed block sits on top of the thread cache and comes straight back
+    void* b = manager.allocate(40);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_TRUE(manager.deallocate(b));
+    manager.flushThreadCache();
+}
+
+void test_manager_cache_rejects_double_free() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    void* ptr = manager.allocate(16);
+    TEST_ASSERT_TRUE(manager.deallocate(ptr));
+    TEST_ASSERT_FALSE(manager.deallocate(ptr));
+
+    // A double free must not put the block in the cache twice
+    void* a = manager.allocate(16);
+    void* b = manager.allocate(16);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    manager.deallocate(a);
+    manager.deallocate(b);
+    manager.flushThreadCache();
+}
+
+void test_manager_cross_thread_free() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    std::vector<void*> blocks;
+    std::thread producer([&]() {
+        for (int i = 0; i < 64; i++) {
+            blocks.push_back(manager.allocate(16));
+        }
+    });
+    producer.join();
+
+    TEST_ASSERT_EQUAL(64, manager.getActiveAllocations());
+    for (void* ptr : blocks) {
+        TEST_ASSERT_NOT_NULL(ptr);
+        TEST_ASSERT_TRUE(manager.deallocate(ptr));
+    }
+    TEST_ASSERT_EQUAL(0, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(0, manager.checkLeaks());
+}
+
+void test_manager_flush_returns_cached_blocks() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    // Exiting threads hand their caches back, this thread flushes explicitly
+    std::thread worker([&]() {
+        void* ptr = manager.allocate(16);
+        manager.deallocate(ptr);
+    });
+    worker.join();
+
+    void* ptr = manager.allocate(16);
+    manager.deallocate(ptr);
+    manager.flushThreadCache();
+
+    // With every cache empty the whole 16-byte pool is available again
+    std::vector<void*> blocks;
+    void* block;
+    while ((block = manager.allocateFromPool(0)) != nullptr) {
+        blocks.push_back(block);
+    }
+    TEST_ASSERT_EQUAL(128, blocks.size());
+    for (void* b : blocks) {
+        manager.deallocateFromPool(b, 0);
+    }
+}
+
+void test_tracker_benchmark_against_linear_search() {
+    static AllocationTracker<true, 1024> tracker;
+    std::vector<MemoryBlock> linear;
+    std::vector<uintptr_t> live;
+    linear.reserve(TRACKER_LIVE_BLOCKS);
+
+    for (size_t i = 0; i < TRACKER_LIVE_BLOCKS; i++) {
+        uintptr_t address = 0x48000000u + i * 32;
+        live.push_back(address);
+        tracker.insert(makeBlock(reinterpret_cast<void*>(address), 32));
+        linear.push_back(makeBlock(reinterpret_cast<void*>(address), 32));
+    }
+
+    std::vector<uintptr_t> hashLive = live;
+    float hashRate = benchmarkTrackerChurn(
+        [&](void* ptr) { tracker.remove(ptr); },
+        [&](const MemoryBlock& block) { tracker.insert(block); }, hashLive);
+
+    // The previous findBlock(): linear search plus vector erase
+    float linearRate = benchmarkTrackerChurn(
+        [&](void* ptr) {
+            auto it = std::find_if(linear.begin(), linear.end(),
+                                   [ptr](const MemoryBlock& block) { return block.ptr == ptr; });
+            linear.erase(it);
+        },
+        [&](const MemoryBlock& block) { linear.push_back(block); }, live);
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "%d live blocks: hash table %.0f frees/s, linear search %.0f frees/s (%.1fx)",
+             (int)TRACKER_LIVE_BLOCKS, hashRate, linearRate,
+             linearRate > 0 ? hashRate / linearRate : 0.0f);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(TRACKER_LIVE_BLOCKS, tracker.size());
+    TEST_ASSERT_EQUAL(TRACKER_LIVE_BLOCKS, linear.size());
+}
+
+void test_arena_benchmark_against_heap_vectors() {
+    const uint32_t frames = 2000;
+    const size_t buffersPerFrame = 8;
+    const size_t floatsPerBuffer = 512;
+    MemoryArena arena("bench", 64 * 1024, MALLOC_CAP_DEFAULT);
+    volatile float sink = 0.0f;
+
+    // Typical per-frame pattern: a handful of transient sample/spectrum buffers
+    int64_t start = esp_timer_get_time();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < buffersPerFrame; i++) {
+            std::vector<float> buffer(floatsPerBuffer, 1.0f);
+            sink = sink + buffer[i];
+        }
+    }
+    int64_t heapTime = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < buffersPerFrame; i++) {
+            ArenaVector<float> buffer(floatsPerBuffer, 1.0f, ArenaAllocator<float>(arena));
+            sink = sink + buffer[i];
+        }
+        arena.reset();
+    }
+    int64_t arenaTime = esp_timer_get_time() - start;
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "%d frames x %d buffers: heap vectors %lld us, arena vectors %lld us, %d arena growths",
+             (int)frames, (int)buffersPerFrame, (long long)heapTime, (long long)arenaTime,
+             (int)arena.getStats().chunkAllocations);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(1, arena.getStats().chunkAllocations);
+}
+
+void test_manager_threaded_stress_benchmark() {
+    MemoryManager manager;
+    TEST_ASSERT_EQUAL(OS_OK, manager.initialize());
+
+    manager.setThreadCacheEnabled(false);
+    StressResult locked = stressManager(manager);
+    manager.setThreadCacheEnabled(true);
+    StressResult cached = stressManager(manager);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%d threads, mutex only: %.0f ops/s, per-op p50 %.0f ns, p99 %.0f ns, max %.0f ns",
+             STRESS_THREADS, locked.opsPerSecond, locked.p50NsPerOp, locked.p99NsPerOp, locked.maxNsPerOp);
+    TEST_MESSAGE(message);
+    snprintf(message, sizeof(message),
+             "%d threads, thread caches: %.0f ops/s, per-op p50 %.0f ns, p99 %.0f ns, max %.0f ns",
+             STRESS_THREADS, cached.opsPerSecond, cached.p50NsPerOp, cached.p99NsPerOp, cached.maxNsPerOp);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(0, locked.failures);
+    TEST_ASSERT_EQUAL(0, cached.failures);
+    TEST_ASSERT_EQUAL(0, manager.getActiveAllocations());
+    TEST_ASSERT_EQUAL(0, manager.getTotalAllocated());
+}
+
+int runMemoryManagerTests(void) {
+    UNITY_BEGIN();
+
+    // Memory Pool Tests
+    RUN_TEST(test_pool_allocates_every_block_once);
+    RUN_TEST(test_pool_reuses_most_recently_freed_block);
+    RUN_TEST(test_pool_rejects_double_free);
+    RUN_TEST(test_pool_rejects_foreign_and_misaligned_pointers);
+
+    // Allocation Tracker Tests
+    RUN_TEST(test_tracker_insert_find_remove);
+    RUN_TEST(test_tracker_rejects_inserts_when_full);
+    RUN_TEST(test_tracker_disabled_keeps_pointers_only);
+
+    // Arena Tests
+    RUN_TEST(test_arena_bump_allocation_and_alignment);
+    RUN_TEST(test_arena_grows_and_merges_on_reset);
+    RUN_TEST(test_arena_std_allocator_adapters);
+
+    // Relocatable Heap Tests
+    RUN_TEST(test_relocatable_handles_and_pinning);
+    RUN_TEST(test_relocatable_compaction_restores_largest_block);
+    RUN_TEST(test_relocatable_compaction_skips_pinned_blocks);
+    RUN_TEST(test_relocatable_budget_leaves_blocks_too_large_to_move);
+    RUN_TEST(test_relocatable_allocate_compacts_when_needed);
+    RUN_TEST(test_relocatable_compaction_in_idle_slices);
+
+    // Allocation Profiler Tests
+    RUN_TEST(test_profiler_size_buckets);
+    RUN_TEST(test_profiler_aggregates_by_call_site);
+    RUN_TEST(test_profiler_sampling_weights_samples);
+    RUN_TEST(test_profiler_snapshot_diff);
+    RUN_TEST(test_profiler_binary_dump);
+
+    // Memory Manager Tests
+    RUN_TEST(test_manager_app_arenas);
+    RUN_TEST(test_manager_heap_allocations_are_tracked);
+    RUN_TEST(test_manager_tracking_overflow_keeps_allocations);
+    RUN_TEST(test_manager_thread_cache_reuses_block);
+    RUN_TEST(test_manager_cache_rejects_double_free);
+    RUN_TEST(test_manager_cross_thread_free);
+    RUN_TEST(test_manager_flush_returns_cached_blocks);
+
+    // Benchmarks
+    RUN_TEST(test_pool_benchmark_against_linear_scan);
+    RUN_TEST(test_tracker_benchmark_against_linear_search);
+    RUN_TEST(test_arena_benchmark_against_heap_vectors);
+    RUN_TEST(test_manager_threaded_stress_benchmark);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runMemoryManagerTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runMemoryManagerTests();
+}
+#endif
@@ -0,0 +1,301 @@
+#include <unity.h>
+#include "../src/hal/ppa_queue.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_ppa_queue.cpp
+ * @brief PPA command queue ordering, fence, batch and callback tests
+ */
+
+static PpaCommandQueue* queue = nullptr;
+static std::atomic<bool> gateOpen{true};
+static std::vector<uint32_t> executed;      // Written by the worker only
+static std::atomic<int> callbackCount{0};
+static esp_err_t lastCallbackResult = ESP_OK;
+static bool signaledInCallback = false;
+
+// Stands in for the pixel work; holds the worker while the gate is closed
+static esp_err_t recordOperation(const ppa_operation_t& op) {
+    while (!gateOpen.load()) {
+        std::this_thread::yield();
+    }
+    executed.push_back(op.color);
+    return op.type == PPA_OP_FILL ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+static void onComplete(ppa_fence_t fence, esp_err_t result, void* userData) {
+    lastCallbackResult = result;
+    signaledInCallback = static_cast<PpaCommandQueue*>(userData)->isSignaled(fence);
+    callbackCount++;
+}
+
+static void onResult(ppa_fence_t, esp_err_t result, void*) {
+    lastCallbackResult = result;
+}
+
+// Burn CPU for a fixed time, as LVGL rasterizing text would
+static void busyWait(int64_t us) {
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < us) {
+    }
+}
+
+static ppa_operation_t makeOp(uint32_t tag, ppa_op_type_t type = PPA_OP_FILL) {
+    ppa_operation_t op = {};
+    op.type = type;
+    op.color = tag;
+    return op;
+}
+
+void setUp(void) {
+    gateOpen = true;
+    executed.clear();
+    callbackCount = 0;
+    lastCallbackResult = ESP_OK;
+    signaledInCallback = false;
+    queue = new PpaCommandQueue();
+    queue->start(recordOperation, 4);
+}
+
+void tearDown(void) {
+    gateOpen = true;
+    delete queue;
+    queue = nullptr;
+}
+
+void test_submit_returns_before_operation_runs() {
+    gateOpen = false;
+    ppa_operation_t op = makeOp(1);
+    ppa_fence_t fence = PPA_FENCE_NONE;
+
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(&op, 1, nullptr, nullptr, 100, &fence));
+    TEST_ASSERT_NOT_EQUAL(PPA_FENCE_NONE, fence);
+    TEST_ASSERT_FALSE(queue->isSignaled(fence));
+    TEST_ASSERT_EQUAL(1, queue->getPendingCount());
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, queue->wait(fence, 10));
+
+    gateOpen = true;
+    TEST_ASSERT_EQUAL(ESP_OK, queue->wait(fence, 1000));
+    TEST_ASSERT_TRUE(queue->isSignaled(fence));
+    TEST_ASSERT_EQUAL(0, queue->getPendingCount());
+}
+
+void test_operations_run_in_submission_order() {
+    ppa_fence_t fences[10];
+    for (uint32_t i = 0; i < 10; i++) {
+        ppa_operation_t op = makeOp(i);
+        TEST_ASSERT_EQUAL(ESP_OK, queue->submit(&op, 1, nullptr, nullptr, 1000, &fences[i]));
+        if (i > 0) {
+            TEST_ASSERT_GREATER_THAN(fences[i - 1], fences[i]);
+        }
+    }
+
+    // The last fence covers everything before it
+    TEST_ASSERT_EQUAL(ESP_OK, queue->wait(fences[9], 1000));
+    TEST_ASSERT_TRUE(queue->isSignaled(fences[0]));
+    TEST_ASSERT_EQUAL(10, executed.size());
+    for (uint32_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(i, executed[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, queue->wait(fences[9] + 1, 0));
+}
+
+void test_batch_shares_one_fence_and_reports_first_error() {
+    ppa_operation_t ops[] = {makeOp(1), makeOp(2, PPA_OP_BLIT), makeOp(3)};
+    ppa_fence_t fence = PPA_FENCE_NONE;
+
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(ops, 3, onComplete, queue, 1000, &fence));
+    TEST_ASSERT_EQUAL(ESP_OK, queue->wait(fence, 1000));
+
+    TEST_ASSERT_EQUAL(3, executed.size());
+    TEST_ASSERT_EQUAL(1, callbackCount.load());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, lastCallbackResult);
+
+    PpaQueueStats stats = queue->getStats();
+    TEST_ASSERT_EQUAL(1, stats.submissions);
+    TEST_ASSERT_EQUAL(3, stats.operations);
+    TEST_ASSERT_EQUAL(1, stats.failed);
+
+    // A batch larger than the queue can never fit
+    ppa_operation_t many[5] = {};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, queue->submit(many, 5, nullptr, nullptr, 0, nullptr));
+}
+
+void test_callback_runs_before_fence_is_signaled() {
+    ppa_operation_t op = makeOp(1);
+    ppa_fence_t fence = PPA_FENCE_NONE;
+
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(&op, 1, onComplete, queue, 1000, &fence));
+    TEST_ASSERT_EQUAL(ESP_OK, queue->wait(fence, 1000));
+    TEST_ASSERT_EQUAL(1, callbackCount.load());
+    TEST_ASSERT_EQUAL(ESP_OK, lastCallbackResult);
+    TEST_ASSERT_FALSE(signaledInCallback);
+}
+
+void test_full_queue_waits_for_room() {
+    gateOpen = false;
+    ppa_operation_t ops[4] = {makeOp(1), makeOp(2), makeOp(3), makeOp(4)};
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(ops, 4, nullptr, nullptr, 100, nullptr));
+
+    // The worker holds the first; three queued plus two more do not fit
+    ppa_operation_t extra[2] = {makeOp(5), makeOp(6)};
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, queue->submit(extra, 2, nullptr, nullptr, 10, nullptr));
+
+    std::thread opener([]() {
+        busyWait(20000);
+        gateOpen = true;
+    });
+    ppa_fence_t fence = PPA_FENCE_NONE;
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(extra, 2, nullptr, nullptr, 1000, &fence));
+    opener.join();
+
+    TEST_ASSERT_EQUAL(ESP_OK, queue->wait(fence, 1000));
+    TEST_ASSERT_EQUAL(6, executed.size());
+    TEST_ASSERT_EQUAL(2, queue->getStats().fullWaits);
+}
+
+void test_stop_runs_queued_operations() {
+    gateOpen = false;
+    ppa_operation_t ops[3] = {makeOp(1), makeOp(2), makeOp(3)};
+    ppa_fence_t fence = PPA_FENCE_NONE;
+    TEST_ASSERT_EQUAL(ESP_OK, queue->submit(ops, 3, nullptr, nullptr, 100, &fence));
+
+    std::thread opener([]() {
+        busyWait(10000);
+        gateOpen = true;
+    });
+    queue->stop();
+    opener.join();
+
+    TEST_ASSERT_EQUAL(3, executed.size());
+    TEST_ASSERT_TRUE(queue->isSignaled(fence));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, queue->submit(ops, 1, nullptr, nullptr, 0, nullptr));
+}
+
+void test_queued_blits_through_ppa_hal() {
+    const uint16_t size = 64;
+    std::vector<uint16_t> source(size * size);
+    std::vector<uint16_t> target(size * size, 0);
+    ppa_image_t src = {source.data(), size, size, PPA_FORMAT_RGB565, false};
+    ppa_image_t dst = {target.data(), size, size, PPA_FORMAT_RGB565, false};
+
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_init());
+
+    // Red square with a green centre, then copied into the target
+    ppa_operation_t ops[] = {
+        ppa_fill_op(&src, {0, 0, size, size}, 0xFFFF0000),
+        ppa_fill_op(&src, {16, 16, 32, 32}, 0xFF00FF00),
+        ppa_blit_op(&src, {0, 0, size, size}, &dst, 0, 0),
+    };
+    ppa_fence_t fence = PPA_FENCE_NONE;
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_submit_batch(ops, 3, nullptr, nullptr, &fence));
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_wait_fence(fence, 1000));
+    TEST_ASSERT_TRUE(ppa_hal_fence_signaled(fence));
+
+    TEST_ASSERT_EQUAL_HEX16(0xF800, target[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x07E0, target[32 * size + 32]);
+
+    // An operation that does not fit its target fails without stopping the queue
+    ppa_operation_t bad = ppa_fill_op(&dst, {60, 60, 8, 8}, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_submit(&bad, onResult, nullptr, &fence));
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_wait_completion(1000));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, lastCallbackResult);
+    TEST_ASSERT_EQUAL(PPA_STATUS_IDLE, ppa_hal_get_status());
+
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_deinit());
+}
+
+void test_cpu_keeps_working_while_blits_run() {
+    const uint16_t width = 640;
+    const uint16_t height = 360;
+    const int blits = 16;
+    std::vector<uint16_t> source(width * height, 0x1234);
+    std::vector<uint16_t> target(width * height);
+    ppa_image_t src = {source.data(), width, height, PPA_FORMAT_RGB565, false};
+    ppa_image_t dst = {target.data(), height, width, PPA_FORMAT_RGB565, false};
+
+    ppa_transform_t turn = PPA_TRANSFORM_INIT();
+    turn.rotation = PPA_SRM_ROTATION_ANGLE_90;
+    ppa_operation_t op = ppa_transform_op(&src, {0, 0, width, height}, &dst, 0, 0, &turn);
+
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_init());
+
+    // Give the CPU as much rasterizing as the blits take
+    std::vector<ppa_operation_t> batch(blits, op);
+    ppa_fence_t fence = PPA_FENCE_NONE;
+    int64_t start = esp_timer_get_time();
+    ppa_hal_submit_batch(batch.data(), blits, nullptr, nullptr, &fence);
+    ppa_hal_wait_fence(fence, 5000);
+    int64_t rasterUs = esp_timer_get_time() - start;
+
+    // One at a time: each blit, then the rasterizing that follows it
+    start = esp_timer_get_time();
+    for (int i = 0; i < blits; i++) {
+        ppa_fence_t fence = PPA_FENCE_NONE;
+        ppa_hal_submit(&op, nullptr, nullptr, &fence);
+        ppa_hal_wait_fence(fence, 1000);
+        busyWait(rasterUs / blits);
+    }
+    int64_t serialUs = esp_timer_get_time() - start;
+
+    // Pipelined: queue them all and rasterize meanwhile
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_submit_batch(batch.data(), blits, nullptr, nullptr, &fence));
+    busyWait(rasterUs);
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_wait_fence(fence, 5000));
+    int64_t pipelinedUs = esp_timer_get_time() - start;
+
+    TEST_ASSERT_EQUAL(ESP_OK, ppa_hal_deinit());
+
+    char message[96];
+    snprintf(message, sizeof(message), "%d blits + %lld us rasterizing: serial %lld us, pipelined %lld us",
+             blits, (long long)rasterUs, (long long)serialUs, (long long)pipelinedUs);
+    TEST_MESSAGE(message);
+
+    // Blits only overlap rasterizing with a second core (or the PPA itself);
+    // on one core queuing them must at least cost nothing extra
+    TEST_ASSERT_LESS_OR_EQUAL(serialUs + serialUs / 10, pipelinedUs);
+}
+
+int runPpaQueueTests() {
+    UNITY_BEGIN();
+
+    // Fence Tests
+    RUN_TEST(test_submit_returns_before_operation_runs);
+    RUN_TEST(test_operations_run_in_submission_order);
+    RUN_TEST(test_batch_shares_one_fence_and_reports_first_error);
+    RUN_TEST(test_callback_runs_before_fence_is_signaled);
+
+    // Queue Tests
+    RUN_TEST(test_full_queue_waits_for_room);
+    RUN_TEST(test_stop_runs_queued_operations);
+
+    // PPA HAL Tests
+    RUN_TEST(test_queued_blits_through_ppa_hal);
+    RUN_TEST(test_cpu_keeps_working_while_blits_run);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runPpaQueueTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runPpaQueueTests();
+}
+#endif
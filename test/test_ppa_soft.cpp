@@ -0,0 +1,350 @@
+#include <unity.h>
+#include "../src/hal/ppa_soft.h"
+#include <esp_timer.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_ppa_soft.cpp
+ * @brief Software PPA kernel tests against naive references, with throughput in MPixels/s
+ */
+
+static const uint16_t SCREEN_WIDTH = 1280;
+static const uint16_t SCREEN_HEIGHT = 720;
+
+static uint32_t seed = 1;
+
+void setUp(void) {
+    seed = 1;
+}
+
+void tearDown(void) {
+}
+
+static uint32_t nextRandom() {
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+template <typename T>
+static std::vector<T> randomImage(size_t pixels) {
+    std::vector<T> image(pixels);
+    for (T& pixel : image) {
+        pixel = (T)(nextRandom() | (nextRandom() << 16));
+    }
+    return image;
+}
+
+static uint32_t channel(uint32_t pixel, int shift, int bits) {
+    return (pixel >> shift) & ((1u << bits) - 1);
+}
+
+// Run a kernel repeatedly for about 100 ms and report MPixels/s
+template <typename Kernel>
+static float measureMpps(const char* name, uint32_t pixelsPerRun, Kernel kernel) {
+    int runs = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed = 0;
+    do {
+        kernel();
+        runs++;
+        elapsed = esp_timer_get_time() - start;
+    } while (elapsed < 100000);
+
+    float mpps = (float)pixelsPerRun * runs / elapsed;
+    char message[96];
+    snprintf(message, sizeof(message), "%-28s %8.1f MPixels/s", name, mpps);
+    TEST_MESSAGE(message);
+    return mpps;
+}
+
+void test_color_packing() {
+    TEST_ASSERT_EQUAL_HEX32(0xF800, ppa_soft_pack_color(0xFFFF0000, 2));
+    TEST_ASSERT_EQUAL_HEX32(0x07E0, ppa_soft_pack_color(0xFF00FF00, 2));
+    TEST_ASSERT_EQUAL_HEX32(0x001F, ppa_soft_pack_color(0xFF0000FF, 2));
+    TEST_ASSERT_EQUAL_HEX32(0x123456, ppa_soft_pack_color(0x80123456, 3));
+    TEST_ASSERT_EQUAL_HEX32(0x80123456, ppa_soft_pack_color(0x80123456, 4));
+    TEST_ASSERT_EQUAL_HEX32(0x80, ppa_soft_pack_color(0x80123456, 1));
+}
+
+void test_fill_covers_only_the_rect() {
+    const uint16_t stride = 37;
+    const uint16_t rows = 9;
+
+    // Every start alignment and odd/even width of RGB565, plus the other sizes
+    for (uint8_t bpp = 1; bpp <= 4; bpp++) {
+        for (uint16_t x = 0; x < 3; x++) {
+            for (uint16_t width = 1; width < 6; width++) {
+                std::vector<uint8_t> image(stride * rows * bpp, 0xAA);
+                uint32_t pixel = ppa_soft_pack_color(0xFF3399CC, bpp);
+                ppa_soft_fill(&image[(stride + x) * bpp], stride, width, 5, bpp, pixel);
+
+                for (uint16_t py = 0; py < rows; py++) {
+                    for (uint16_t px = 0; px < stride; px++) {
+                        bool inside = py >= 1 && py < 6 && px >= x && px < x + width;
+                        for (uint8_t b = 0; b < bpp; b++) {
+                            uint8_t expected = inside ? (uint8_t)(pixel >> (b * 8)) : 0xAA;
+                            TEST_ASSERT_EQUAL_HEX8(expected, image[(py * stride + px) * bpp + b]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void test_rgb565_blend_matches_reference() {
+    const uint16_t width = 61;
+    std::vector<uint16_t> bg = randomImage<uint16_t>(width);
+    std::vector<uint16_t> fg = randomImage<uint16_t>(width);
+    std::vector<uint16_t> out(width);
+
+    const int shifts[] = {11, 5, 0};
+    const int bits[] = {5, 6, 5};
+    for (uint32_t alpha = 0; alpha < 256; alpha += 17) {
+        ppa_soft_blend(out.data(), width, bg.data(), width, fg.data(), width, width, 1, 2,
+                       alpha, 255, false, 0, 0, 0);
+        for (uint16_t x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                float expected = (channel(fg[x], shifts[c], bits[c]) * alpha +
+                                  channel(bg[x], shifts[c], bits[c]) * (255.0f - alpha)) / 255.0f;
+                // 5-bit alpha costs up to two steps on the 6-bit green channel
+                TEST_ASSERT_FLOAT_WITHIN(2.0f, expected, (float)channel(out[x], shifts[c], bits[c]));
+            }
+        }
+    }
+
+    // Opaque and transparent foregrounds are exact
+    ppa_soft_blend(out.data(), width, bg.data(), width, fg.data(), width, width, 1, 2, 255, 255,
+                   false, 0, 0, 0);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(fg.data(), out.data(), width);
+    ppa_soft_blend(out.data(), width, bg.data(), width, fg.data(), width, width, 1, 2, 0, 255,
+                   false, 0, 0, 0);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(bg.data(), out.data(), width);
+}
+
+void test_argb8888_blend_uses_pixel_alpha() {
+    uint32_t bg[] = {0xFF000000, 0xFF204060, 0x00FFFFFF, 0xFF102030};
+    uint32_t fg[] = {0xFFFFFFFF, 0x80A0C0E0, 0xFF112233, 0x00FFFFFF};
+    uint32_t out[4];
+
+    ppa_soft_blend(out, 4, bg, 4, fg, 4, 4, 1, 4, 255, 255, false, 0, 0, 0);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, out[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xFF112233, out[2]);
+    TEST_ASSERT_EQUAL_HEX32(0xFF102030, out[3]);
+
+    // Half-transparent over opaque: channels halfway, still opaque
+    TEST_ASSERT_EQUAL_HEX32(0xFF, out[1] >> 24);
+    TEST_ASSERT_UINT32_WITHIN(1, 0x60, channel(out[1], 16, 8));
+    TEST_ASSERT_UINT32_WITHIN(1, 0x80, channel(out[1], 8, 8));
+    TEST_ASSERT_UINT32_WITHIN(1, 0xA0, channel(out[1], 0, 8));
+
+    // Blending in place
+    ppa_soft_blend(bg, 4, bg, 4, fg, 4, 4, 1, 4, 255, 255, false, 0, 0, 0);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(out, bg, 4);
+}
+
+void test_color_key_makes_foreground_transparent() {
+    uint16_t bg[] = {0x1234, 0x07E0, 0x4321};
+    uint16_t fg[] = {0x07E0, 0x07E0, 0xFFFF};   // Green is the key
+    uint16_t out[3];
+
+    ppa_soft_blend(out, 3, bg, 3, fg, 3, 3, 1, 2, 255, 255, true, 0x00F000, 0x00FFFF, 0xFF0000);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, out[0]);   // Background shows through
+    TEST_ASSERT_EQUAL_HEX16(0xF800, out[1]);   // Both keyed: default color
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, out[2]);
+}
+
+void test_nearest_scaling_replicates_pixels() {
+    uint16_t src[] = {1, 2, 3, 4, 5, 6};    // 3x2
+    uint16_t out[6 * 4];
+
+    ppa_soft_scale(out, 6, 6, 4, src, 3, 3, 2, 2, PPA_SOFT_FILTER_NEAREST);
+    const uint16_t expected[] = {
+        1, 1, 2, 2, 3, 3,
+        1, 1, 2, 2, 3, 3,
+        4, 4, 5, 5, 6, 6,
+        4, 4, 5, 5, 6, 6,
+    };
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, out, 24);
+
+    // Downscaling by two picks one pixel of each pair
+    uint16_t half[3];
+    ppa_soft_scale(half, 3, 3, 1, expected, 6, 6, 2, 2, PPA_SOFT_FILTER_NEAREST);
+    TEST_ASSERT_EQUAL_UINT16(2, half[1]);
+}
+
+void test_bilinear_scaling_interpolates() {
+    // Black to white across two pixels, doubled: the middle pixels are a quarter in
+    uint32_t src[] = {0xFF000000, 0xFFFFFFFF};
+    uint32_t out[4];
+    ppa_soft_scale(out, 4, 4, 1, src, 2, 2, 1, 4, PPA_SOFT_FILTER_BILINEAR);
+    TEST_ASSERT_EQUAL_HEX32(0xFF000000, out[0]);
+    TEST_ASSERT_UINT32_WITHIN(1, 0x40, channel(out[1], 0, 8));
+    TEST_ASSERT_UINT32_WITHIN(1, 0xBF, channel(out[2], 0, 8));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, out[3]);
+
+    // A flat RGB565 image stays flat at any size
+    std::vector<uint16_t> flat(50 * 30, 0x5AEB);
+    std::vector<uint16_t> scaled(77 * 13);
+    ppa_soft_scale(scaled.data(), 77, 77, 13, flat.data(), 50, 50, 30, 2, PPA_SOFT_FILTER_BILINEAR);
+    for (uint16_t pixel : scaled) {
+        TEST_ASSERT_EQUAL_HEX16(0x5AEB, pixel);
+    }
+}
+
+void test_rotation_matches_reference() {
+    // Odd sizes so tiles are partial, with a wider stride on both sides
+    const uint16_t width = 45;
+    const uint16_t height = 70;
+    const uint32_t srcStride = width + 3;
+    std::vector<uint32_t> src = randomImage<uint32_t>(srcStride * height);
+
+    for (uint8_t turns = 0; turns < 4; turns++) {
+        for (int mirror = 0; mirror < 4; mirror++) {
+            bool mirrorX = mirror & 1;
+            bool mirrorY = mirror & 2;
+            uint16_t dstWidth = turns & 1 ? height : width;
+            uint16_t dstHeight = turns & 1 ? width : height;
+            uint32_t dstStride = dstWidth + 5;
+            std::vector<uint32_t> dst(dstStride * dstHeight);
+
+            ppa_soft_rotate(dst.data(), dstStride, src.data(), srcStride, width, height, 4,
+                            turns, mirrorX, mirrorY);
+
+            for (uint16_t y = 0; y < dstHeight; y++) {
+                for (uint16_t x = 0; x < dstWidth; x++) {
+                    uint16_t rx = mirrorX ? dstWidth - 1 - x : x;
+                    uint16_t ry = mirrorY ? dstHeight - 1 - y : y;
+                    uint16_t sx = rx, sy = ry;
+                    switch (turns) {
+                        case 1: sx = width - 1 - ry; sy = rx; break;
+                        case 2: sx = width - 1 - rx; sy = height - 1 - ry; break;
+                        case 3: sx = ry; sy = height - 1 - rx; break;
+                    }
+                    TEST_ASSERT_EQUAL_HEX32(src[sy * srcStride + sx], dst[y * dstStride + x]);
+                }
+            }
+        }
+    }
+
+    // Counter-clockwise: the top-right corner ends up top-left
+    uint16_t corners[] = {1, 2, 3, 4};  // 2x2
+    uint16_t turned[4];
+    ppa_soft_rotate(turned, 2, corners, 2, 2, 2, 2, 1, false, false);
+    TEST_ASSERT_EQUAL_UINT16(2, turned[0]);
+    TEST_ASSERT_EQUAL_UINT16(4, turned[1]);
+}
+
+void test_rgb888_rotation_and_blend() {
+    uint8_t src[] = {1, 2, 3, 4, 5, 6};  // Two pixels in a row
+    uint8_t turned[6];
+    ppa_soft_rotate(turned, 1, src, 2, 2, 1, 3, 1, false, false);
+    const uint8_t expected[] = {4, 5, 6, 1, 2, 3};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, turned, 6);
+
+    uint8_t bg[] = {0, 0, 0, 200, 200, 200};
+    uint8_t fg[] = {255, 255, 255, 0, 0, 0};
+    uint8_t out[6];
+    ppa_soft_blend(out, 2, bg, 2, fg, 2, 2, 1, 3, 128, 255, false, 0, 0, 0);
+    TEST_ASSERT_UINT8_WITHIN(1, 128, out[0]);
+    TEST_ASSERT_UINT8_WITHIN(1, 100, out[3]);
+}
+
+void test_throughput() {
+    const uint32_t pixels = (uint32_t)SCREEN_WIDTH * SCREEN_HEIGHT;
+    std::vector<uint16_t> screen = randomImage<uint16_t>(pixels);
+    std::vector<uint16_t> layer = randomImage<uint16_t>(pixels);
+    std::vector<uint16_t> out(pixels);
+    std::vector<uint32_t> screen32 = randomImage<uint32_t>(pixels);
+    std::vector<uint32_t> layer32 = randomImage<uint32_t>(pixels);
+    std::vector<uint32_t> out32(pixels);
+    std::vector<uint16_t> quarter = randomImage<uint16_t>(pixels / 4);
+
+    float fill = measureMpps("RGB565 fill", pixels, [&]() {
+        ppa_soft_fill(out.data(), SCREEN_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT, 2, 0x1234);
+    });
+    float blend = measureMpps("RGB565 blend", pixels, [&]() {
+        ppa_soft_blend(out.data(), SCREEN_WIDTH, screen.data(), SCREEN_WIDTH, layer.data(), SCREEN_WIDTH,
+                       SCREEN_WIDTH, SCREEN_HEIGHT, 2, 160, 255, false, 0, 0, 0);
+    });
+    measureMpps("ARGB8888 blend", pixels, [&]() {
+        ppa_soft_blend(out32.data(), SCREEN_WIDTH, screen32.data(), SCREEN_WIDTH, layer32.data(), SCREEN_WIDTH,
+                       SCREEN_WIDTH, SCREEN_HEIGHT, 4, 160, 255, false, 0, 0, 0);
+    });
+    measureMpps("RGB565 2x nearest", pixels, [&]() {
+        ppa_soft_scale(out.data(), SCREEN_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT, quarter.data(), SCREEN_WIDTH / 2,
+                       SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, 2, PPA_SOFT_FILTER_NEAREST);
+    });
+    measureMpps("RGB565 2x bilinear", pixels, [&]() {
+        ppa_soft_scale(out.data(), SCREEN_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT, quarter.data(), SCREEN_WIDTH / 2,
+                       SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, 2, PPA_SOFT_FILTER_BILINEAR);
+    });
+    measureMpps("RGB565 rotate 180", pixels, [&]() {
+        ppa_soft_rotate(out.data(), SCREEN_WIDTH, screen.data(), SCREEN_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT,
+                        2, 2, false, false);
+    });
+    float rotate = measureMpps("RGB565 rotate 90", pixels, [&]() {
+        ppa_soft_rotate(out.data(), SCREEN_HEIGHT, screen.data(), SCREEN_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT,
+                        2, 1, false, false);
+    });
+
+    // Without tiling, for comparison
+    float untiled = measureMpps("RGB565 rotate 90 untiled", pixels, [&]() {
+        for (uint32_t y = 0; y < SCREEN_WIDTH; y++) {
+            for (uint32_t x = 0; x < SCREEN_HEIGHT; x++) {
+                out[y * SCREEN_HEIGHT + x] = screen[x * SCREEN_WIDTH + SCREEN_WIDTH - 1 - y];
+            }
+        }
+    });
+
+    char message[96];
+    snprintf(message, sizeof(message), "Tiled rotation %.1fx untiled", rotate / untiled);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_TRUE(fill > 0.0f && blend > 0.0f && rotate > 0.0f);
+}
+
+int runPpaSoftTests() {
+    UNITY_BEGIN();
+
+    // Fill Tests
+    RUN_TEST(test_color_packing);
+    RUN_TEST(test_fill_covers_only_the_rect);
+
+    // Blend Tests
+    RUN_TEST(test_rgb565_blend_matches_reference);
+    RUN_TEST(test_argb8888_blend_uses_pixel_alpha);
+    RUN_TEST(test_color_key_makes_foreground_transparent);
+
+    // Scale-Rotate-Mirror Tests
+    RUN_TEST(test_nearest_scaling_replicates_pixels);
+    RUN_TEST(test_bilinear_scaling_interpolates);
+    RUN_TEST(test_rotation_matches_reference);
+    RUN_TEST(test_rgb888_rotation_and_blend);
+
+    // Benchmark
+    RUN_TEST(test_throughput);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runPpaSoftTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runPpaSoftTests();
+}
+#endif
@@ -0,0 +1,261 @@
+#include <unity.h>
+#include "../src/system/resource_accountant.h"
+#include "../src/system/event_system.h"
+#include "../src/system/task_scheduler.h"
+#include <esp_timer.h>
+#include <cstdio>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_resource_accountant.cpp
+ * @brief Per-app CPU time, allocation and frame cost attribution tests
+ */
+
+static ResourceAccountant* accountant = nullptr;
+
+// Burn CPU for a fixed time, as an app's update() would
+static void busyWait(int64_t us) {
+    int64_t start = esp_timer_get_time();
+    while (esp_timer_get_time() - start < us) {
+    }
+}
+
+void setUp(void) {
+    accountant = &ResourceAccountant::getInstance();
+    accountant->reset();
+}
+
+void tearDown(void) {
+    accountant->reset();
+}
+
+void test_scope_charges_elapsed_time_to_app() {
+    AppAccount* app = accountant->openAccount("app");
+    TEST_ASSERT_NOT_NULL(app);
+    TEST_ASSERT_EQUAL_PTR(app, accountant->openAccount("app"));
+
+    busyWait(500);   // System work, charged to nobody
+    {
+        AccountScope scope(app);
+        TEST_ASSERT_EQUAL_PTR(app, ResourceAccountant::current());
+        busyWait(2000);
+    }
+    TEST_ASSERT_NULL(ResourceAccountant::current());
+    accountant->endFrame();
+
+    TEST_ASSERT_TRUE(app->cpuTimeUs >= 2000);
+    TEST_ASSERT_TRUE(app->cpuTimeUs < 2500);
+    TEST_ASSERT_EQUAL(1, app->frameCost.size());
+    TEST_ASSERT_EQUAL_FLOAT((float)app->cpuTimeUs, app->frameCost.latest());
+    TEST_ASSERT_EQUAL(0, app->frameTimeUs);
+}
+
+void test_nested_scopes_do_not_double_count() {
+    AppAccount* outer = accountant->openAccount("outer");
+    AppAccount* inner = accountant->openAccount("inner");
+
+    int64_t start = esp_timer_get_time();
+    {
+        AccountScope outerScope(outer);
+        busyWait(1000);
+        {
+            AccountScope innerScope(inner);
+            busyWait(2000);
+            {
+                // Re-entering the current account is a no-op
+                AccountScope again(inner);
+                busyWait(500);
+            }
+            TEST_ASSERT_EQUAL_PTR(inner, ResourceAccountant::current());
+        }
+        TEST_ASSERT_EQUAL_PTR(outer, ResourceAccountant::current());
+        busyWait(1000);
+    }
+    int64_t wall = esp_timer_get_time() - start;
+
+    TEST_ASSERT_TRUE(inner->cpuTimeUs >= 2500);
+    TEST_ASSERT_TRUE(outer->cpuTimeUs >= 2000);
+    TEST_ASSERT_TRUE(outer->cpuTimeUs < 2500);
+    TEST_ASSERT_TRUE((int64_t)(outer->cpuTimeUs + inner->cpuTimeUs) <= wall);
+}
+
+void test_allocations_charged_to_current_app() {
+    AppAccount* app = accountant->openAccount("app");
+
+    ResourceAccountant::chargeAllocation(4096);
+    TEST_ASSERT_EQUAL(0, app->allocations.load());
+
+    {
+        AccountScope scope(app);
+        ResourceAccountant::chargeAllocation(1000);
+        ResourceAccountant::chargeAllocation(3000);
+        ResourceAccountant::chargeDeallocation(1000);
+    }
+    accountant->endFrame();
+
+    AppResourceUsage usage;
+    TEST_ASSERT_TRUE(accountant->getUsage("app", usage));
+    TEST_ASSERT_EQUAL(2, usage.allocations);
+    TEST_ASSERT_EQUAL(3000, usage.liveBytes);
+    TEST_ASSERT_EQUAL(3000, usage.peakBytes);
+    TEST_ASSERT_EQUAL(3000, usage.totalBytes());
+
+    // Measured bytes win over an app's own estimate only when larger
+    usage.reportedBytes = 8000;
+    TEST_ASSERT_EQUAL(8000, usage.totalBytes());
+    usage.arenaBytes = 6000;
+    TEST_ASSERT_EQUAL(9000, usage.totalBytes());
+
+    TEST_ASSERT_FALSE(accountant->getUsage("missing", usage));
+}
+
+void test_listener_charged_to_subscribing_app() {
+    EventSystem events;
+    events.initialize();
+    AppAccount* app = accountant->openAccount("app");
+
+    uint32_t calls = 0;
+    {
+        AccountScope scope(app);
+        events.subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) {
+            calls++;
+            busyWait(1000);
+        });
+    }
+    events.subscribe(EVENT_APP_LAUNCH, [&calls](const EventData&) { calls++; });
+
+    // Published by the system, outside any app scope
+    events.publishSync(EventData(EVENT_APP_LAUNCH));
+    events.publishSync(EventData(EVENT_APP_LAUNCH));
+
+    TEST_ASSERT_EQUAL(4, calls);
+    TEST_ASSERT_EQUAL(2, app->eventCallbacks);
+    TEST_ASSERT_TRUE(app->cpuTimeUs >= 2000);
+    TEST_ASSERT_NULL(ResourceAccountant::current());
+    events.shutdown();
+}
+
+void test_task_charged_to_scheduling_app() {
+    TaskScheduler scheduler;
+    scheduler.initialize();
+    AppAccount* app = accountant->openAccount("app");
+
+    bool ran = false;
+    {
+        AccountScope scope(app);
+        scheduler.scheduleOnce([&ran]() {
+            ran = true;
+            busyWait(1000);
+        });
+    }
+    scheduler.scheduleOnce([]() {});
+
+    scheduler.update(0);
+    TEST_ASSERT_TRUE(ran);
+    TEST_ASSERT_EQUAL(1, app->taskRuns);
+    TEST_ASSERT_TRUE(app->cpuTimeUs >= 1000);
+    TEST_ASSERT_NULL(ResourceAccountant::current());
+    scheduler.shutdown();
+}
+
+void test_window_rates_and_usage_order() {
+    AppAccount* light = accountant->openAccount("light");
+    AppAccount* heavy = accountant->openAccount("heavy");
+
+    // Frames until the rate window rolls over
+    int64_t start = esp_timer_get_time();
+    int frames = 0;
+    while (esp_timer_get_time() - start < OS_ACCOUNTING_WINDOW_MS * 1000 + 20000) {
+        {
+            AccountScope scope(light);
+            ResourceAccountant::chargeAllocation(64);
+            busyWait(1000);
+        }
+        {
+            AccountScope scope(heavy);
+            busyWait(3000);
+        }
+        busyWait(1000);   // System work
+        accountant->endFrame();
+        frames++;
+    }
+
+    std::vector<AppResourceUsage> usage = accountant->getAllUsage();
+    TEST_ASSERT_EQUAL(2, usage.size());
+    TEST_ASSERT_EQUAL_STRING("heavy", usage[0].appId.c_str());
+    TEST_ASSERT_EQUAL_STRING("light", usage[1].appId.c_str());
+
+    // 3 of every 5 ms and 1 of every 5 ms, give or take the loop overhead
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 60.0f, usage[0].cpuPercent);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, 20.0f, usage[1].cpuPercent);
+    TEST_ASSERT_FLOAT_WITHIN(500.0f, 3000.0f, usage[0].avgFrameCostUs);
+    TEST_ASSERT_TRUE(usage[0].p95FrameCostUs >= usage[0].avgFrameCostUs * 0.9f);
+
+    // One allocation per ~5 ms frame
+    TEST_ASSERT_FLOAT_WITHIN(60.0f, 200.0f, usage[1].allocationsPerSecond);
+    TEST_ASSERT_EQUAL(0.0f, usage[0].allocationsPerSecond);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%d frames: heavy %.1f%% CPU, light %.1f%% CPU, %.0f allocs/s",
+             frames, usage[0].cpuPercent, usage[1].cpuPercent, usage[1].allocationsPerSecond);
+    TEST_MESSAGE(message);
+}
+
+void test_closed_account_slot_reused_clean() {
+    for (int i = 0; i < OS_MAX_APPS; i++) {
+        char appId[16];
+        snprintf(appId, sizeof(appId), "app%d", i);
+        TEST_ASSERT_NOT_NULL(accountant->openAccount(appId));
+    }
+    TEST_ASSERT_NULL(accountant->openAccount("extra"));
+
+    AppAccount* old = accountant->findAccount("app0");
+    {
+        AccountScope scope(old);
+        ResourceAccountant::chargeAllocation(128);
+        busyWait(100);
+    }
+    accountant->closeAccount("app0");
+    TEST_ASSERT_NULL(accountant->findAccount("app0"));
+
+    AppAccount* reused = accountant->openAccount("extra");
+    TEST_ASSERT_EQUAL_PTR(old, reused);
+    TEST_ASSERT_EQUAL(0, reused->cpuTimeUs);
+    TEST_ASSERT_EQUAL(0, reused->allocations.load());
+    TEST_ASSERT_EQUAL(0, reused->liveBytes.load());
+}
+
+int runResourceAccountantTests() {
+    UNITY_BEGIN();
+
+    // Attribution Tests
+    RUN_TEST(test_scope_charges_elapsed_time_to_app);
+    RUN_TEST(test_nested_scopes_do_not_double_count);
+    RUN_TEST(test_allocations_charged_to_current_app);
+    RUN_TEST(test_listener_charged_to_subscribing_app);
+    RUN_TEST(test_task_charged_to_scheduling_app);
+
+    // Reporting Tests
+    RUN_TEST(test_window_rates_and_usage_order);
+    RUN_TEST(test_closed_account_slot_reused_clean);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runResourceAccountantTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runResourceAccountantTests();
+}
+#endif
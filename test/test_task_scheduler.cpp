@@ -0,0 +1,619 @@
+#include <unity.h>
+#include "../src/system/task_scheduler.h"
+#include "../src/system/schedule_simulator.h"
+#include <esp_timer.h>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <cmath>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_task_scheduler.cpp
+ * @brief Task scheduler ordering, lifecycle and EDF tests with per-tick overhead benchmark
+ */
+
+// Reference scheduler using the previous sort-everything-and-scan update(),
+// kept for benchmarking
+class LinearScanScheduler {
+public:
+    void schedulePeriodic(TaskFunction function, uint32_t period, uint8_t priority, uint32_t delay) {
+        Task task = {};
+        task.id = ++m_nextId;
+        task.function = function;
+        task.priority = priority;
+        task.state = TaskState::READY;
+        task.nextExecution = millis() + delay;
+        task.period = period;
+        m_tasks.push_back(task);
+    }
+
+    void update() {
+        uint32_t currentTime = millis();
+        std::sort(m_tasks.begin(), m_tasks.end(),
+                  [](const Task& a, const Task& b) {
+                      if (a.priority != b.priority) {
+                          return a.priority > b.priority;
+                      }
+                      return a.nextExecution < b.nextExecution;
+                  });
+        for (auto& task : m_tasks) {
+            if (task.state == TaskState::READY && currentTime >= task.nextExecution) {
+                task.function();
+                task.executionCount++;
+                task.nextExecution = millis() + task.period;
+            }
+        }
+    }
+
+private:
+    std::vector<Task> m_tasks;
+    uint32_t m_nextId = 0;
+};
+
+static const size_t BENCH_TASKS = 64;
+static const uint32_t BENCH_DURATION_MS = 500;
+
+// Busy-wait so time advances on both the target and the host
+static void waitMs(uint32_t ms) {
+    uint32_t start = millis();
+    while (millis() - start < ms) {
+    }
+}
+
+// 64 periodic tasks with 10-640 ms periods; most ticks find few tasks due
+template <typename Scheduler>
+static float benchmarkTickOverhead(Scheduler& scheduler, uint32_t& executions) {
+    executions = 0;
+    for (size_t i = 0; i < BENCH_TASKS; i++) {
+        scheduler.schedulePeriodic([&executions]() { executions++; },
+                                   10 * (1 + i % 64), i % 4, i % 10);
+    }
+
+    uint32_t ticks = 0;
+    int64_t busyUs = 0;
+    uint32_t start = millis();
+    while (millis() - start < BENCH_DURATION_MS) {
+        int64_t tickStart = esp_timer_get_time();
+        scheduler.update();
+        busyUs += esp_timer_get_time() - tickStart;
+        ticks++;
+    }
+
+    return ticks > 0 ? (busyUs * 1000.0f) / ticks : 0.0f;
+}
+
+// Adapter so the benchmark template can drive TaskScheduler::update(deltaTime)
+class BenchTaskScheduler : public TaskScheduler {
+public:
+    BenchTaskScheduler() { initialize(); }
+    void update() { TaskScheduler::update(0); }
+};
+
+// Mixed task set: the low-priority audio task has the tightest deadline
+static const std::vector<SimTaskProfile> EDF_TASK_SET = {
+    {"audio", 10, 0, 2, 1, OS_TASK_PRIORITY_LOW, true},
+    {"touch", 20, 0, 3, 0, OS_TASK_PRIORITY_NORMAL, true},
+    {"sensor", 50, 0, 6, 2, OS_TASK_PRIORITY_HIGH, true},
+    {"logger", 100, 0, 3, 1, OS_TASK_PRIORITY_CRITICAL, false},
+};
+
+static TaskScheduler* scheduler = nullptr;
+static uint32_t virtualClock = 0;
+
+// Count heap allocations so tests can check hot paths stay off the heap
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        abort();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void setUp(void) {
+    scheduler = new TaskScheduler();
+    scheduler->initialize();
+}
+
+void tearDown(void) {
+    delete scheduler;
+    scheduler = nullptr;
+}
+
+void test_due_tasks_run_in_priority_order() {
+    std::vector<int> order;
+    scheduler->scheduleOnce([&]() { order.push_back(1); }, OS_TASK_PRIORITY_LOW);
+    scheduler->scheduleOnce([&]() { order.push_back(2); }, OS_TASK_PRIORITY_HIGH);
+    scheduler->scheduleOnce([&]() { order.push_back(3); }, OS_TASK_PRIORITY_NORMAL);
+    scheduler->scheduleOnce([&]() { order.push_back(4); }, OS_TASK_PRIORITY_HIGH);
+    scheduler->scheduleOnce([&]() { order.push_back(5); }, OS_TASK_PRIORITY_HIGH, 1000);
+
+    scheduler->update(0);
+
+    int expected[] = {2, 4, 3, 1};
+    TEST_ASSERT_EQUAL(4, order.size());
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, order.data(), 4);
+
+    // One-shots are removed, the delayed one is still waiting
+    TEST_ASSERT_EQUAL(1, scheduler->getActiveTaskCount());
+}
+
+void test_periodic_task_is_rescheduled() {
+    int runs = 0;
+    uint32_t id = scheduler->schedulePeriodic([&]() { runs++; }, 5);
+
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, runs);
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, runs);
+
+    waitMs(6);
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(2, runs);
+
+    const Task* info = scheduler->getTaskInfo(id);
+    TEST_ASSERT_NOT_NULL(info);
+    TEST_ASSERT_EQUAL(2, info->executionCount);
+    TEST_ASSERT_EQUAL(TaskState::READY, info->state);
+}
+
+void test_suspend_resume_and_cancel() {
+    int runs = 0;
+    uint32_t periodic = scheduler->schedulePeriodic([&]() { runs++; }, 1);
+    uint32_t once = scheduler->scheduleOnce([&]() { runs += 100; });
+
+    TEST_ASSERT_TRUE(scheduler->suspendTask(periodic));
+    TEST_ASSERT_TRUE(scheduler->cancelTask(once));
+    TEST_ASSERT_FALSE(scheduler->cancelTask(once));
+    TEST_ASSERT_NULL(scheduler->getTaskInfo(once));
+
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(0, runs);
+
+    TEST_ASSERT_TRUE(scheduler->resumeTask(periodic));
+    TEST_ASSERT_FALSE(scheduler->resumeTask(periodic));
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, runs);
+}
+
+void test_tasks_modify_scheduler_from_callbacks() {
+    int victimRuns = 0;
+    int childRuns = 0;
+    int selfRuns = 0;
+    uint32_t victim = 0;
+    uint32_t self = 0;
+
+    // Runs first: cancels a due task, schedules a new one, cancels itself
+    self = scheduler->schedulePeriodic([&]() {
+        selfRuns++;
+        scheduler->cancelTask(victim);
+        scheduler->scheduleOnce([&]() { childRuns++; });
+        scheduler->cancelTask(self);
+    }, 1, OS_TASK_PRIORITY_HIGH);
+    victim = scheduler->schedulePeriodic([&]() { victimRuns++; }, 1, OS_TASK_PRIORITY_LOW);
+
+    // Filler so slots get moved around when the cancelled tasks are removed
+    for (int i = 0; i < 8; i++) {
+        scheduler->schedulePeriodic([]() {}, 1000, OS_TASK_PRIORITY_NORMAL, 1000);
+    }
+
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, selfRuns);
+    TEST_ASSERT_EQUAL(0, victimRuns);
+    TEST_ASSERT_EQUAL(0, childRuns);
+    TEST_ASSERT_NULL(scheduler->getTaskInfo(self));
+    TEST_ASSERT_NULL(scheduler->getTaskInfo(victim));
+    TEST_ASSERT_EQUAL(9, scheduler->getActiveTaskCount());
+
+    waitMs(2);
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, selfRuns);
+    TEST_ASSERT_EQUAL(1, childRuns);
+    TEST_ASSERT_EQUAL(8, scheduler->getActiveTaskCount());
+}
+
+void test_task_limit_is_enforced() {
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < OS_MAX_TASKS; i++) {
+        ids.push_back(scheduler->schedulePeriodic([]() {}, 100 + i));
+        TEST_ASSERT_NOT_EQUAL(0, ids.back());
+    }
+    TEST_ASSERT_EQUAL(0, scheduler->scheduleOnce([]() {}));
+
+    // Removing from the middle keeps lookups consistent
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        TEST_ASSERT_TRUE(scheduler->cancelTask(ids[i]));
+    }
+    for (size_t i = 1; i < ids.size(); i += 2) {
+        const Task* info = scheduler->getTaskInfo(ids[i]);
+        TEST_ASSERT_NOT_NULL(info);
+        TEST_ASSERT_EQUAL(ids[i], info->id);
+        TEST_ASSERT_EQUAL(100 + i, info->period);
+    }
+    TEST_ASSERT_EQUAL(OS_MAX_TASKS / 2, scheduler->getActiveTaskCount());
+}
+
+void test_stale_ids_do_not_match_reused_slots() {
+    int oldRuns = 0;
+    int newRuns = 0;
+    uint32_t oldId = scheduler->schedulePeriodic([&]() { oldRuns++; }, 10);
+    TEST_ASSERT_TRUE(scheduler->cancelTask(oldId));
+
+    // The freed slot is reused with a new generation
+    uint32_t newId = scheduler->schedulePeriodic([&]() { newRuns++; }, 10);
+    TEST_ASSERT_EQUAL(oldId & 0xFFFF, newId & 0xFFFF);
+    TEST_ASSERT_NOT_EQUAL(oldId, newId);
+
+    TEST_ASSERT_NULL(scheduler->getTaskInfo(oldId));
+    TEST_ASSERT_FALSE(scheduler->cancelTask(oldId));
+    TEST_ASSERT_FALSE(scheduler->suspendTask(oldId));
+    TEST_ASSERT_NULL(scheduler->getTaskInfo(0));
+
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(0, oldRuns);
+    TEST_ASSERT_EQUAL(1, newRuns);
+}
+
+void test_cancel_destroys_captured_state() {
+    std::shared_ptr<int> state = std::make_shared<int>(0);
+    uint32_t id = scheduler->schedulePeriodic([state]() { (*state)++; }, 10);
+    TEST_ASSERT_EQUAL(2, state.use_count());
+
+    scheduler->update(0);
+    TEST_ASSERT_EQUAL(1, *state);
+
+    TEST_ASSERT_TRUE(scheduler->cancelTask(id));
+    TEST_ASSERT_EQUAL(1, state.use_count());
+}
+
+void test_scheduling_does_not_allocate() {
+    int runs = 0;
+    int* counter = &runs;
+    uint32_t base = 7;
+
+    // Warm up so lazily grown containers are already at capacity
+    scheduler->cancelTask(scheduler->scheduleOnce([counter]() { (*counter)++; }));
+    scheduler->update(0);
+
+    size_t before = allocationCount;
+    for (int round = 0; round < 100; round++) {
+        uint32_t once = scheduler->scheduleOnce([counter, base]() { *counter += base; });
+        uint32_t periodic = scheduler->schedulePeriodic([counter]() { (*counter)++; }, 1000);
+        scheduler->update(0);
+        TEST_ASSERT_NULL(scheduler->getTaskInfo(once));
+        TEST_ASSERT_NOT_NULL(scheduler->getTaskInfo(periodic));
+        TEST_ASSERT_TRUE(scheduler->cancelTask(periodic));
+    }
+    size_t allocations = allocationCount - before;
+
+    TEST_ASSERT_EQUAL(100 * 8, runs);
+    TEST_ASSERT_EQUAL(0, allocations);
+}
+
+void test_background_throttle_stretches_low_priority_periods() {
+    int background = 0;
+    int normal = 0;
+    virtualClock = 0;
+    scheduler->setTimeSource([]() { return virtualClock; });
+
+    scheduler->schedulePeriodic([&]() { background++; }, 10, OS_TASK_PRIORITY_LOW);
+    scheduler->schedulePeriodic([&]() { normal++; }, 10, OS_TASK_PRIORITY_NORMAL);
+
+    scheduler->setBackgroundThrottle(50);
+    TEST_ASSERT_EQUAL(50, scheduler->getBackgroundThrottle());
+    for (virtualClock = 0; virtualClock < 1000; virtualClock++) {
+        scheduler->update(0);
+    }
+    TEST_ASSERT_EQUAL(100, normal);
+    TEST_ASSERT_EQUAL(50, background);
+
+    // Clamped so background work always progresses; zero restores the rate
+    scheduler->setBackgroundThrottle(100);
+    TEST_ASSERT_EQUAL(OS_MAX_BACKGROUND_THROTTLE, scheduler->getBackgroundThrottle());
+    scheduler->setBackgroundThrottle(0);
+    background = 0;
+    for (; virtualClock < 2000; virtualClock++) {
+        scheduler->update(0);
+    }
+    TEST_ASSERT_INT_WITHIN(1, 100, background);
+}
+
+void test_edf_runs_earliest_deadline_first() {
+    std::vector<int> order;
+    virtualClock = 0;
+    scheduler->setTimeSource([]() { return virtualClock; });
+
+    scheduler->scheduleRealtimeTask([&]() { order.push_back(1); }, 100, OS_TASK_PRIORITY_HIGH, 1);
+    scheduler->scheduleRealtimeTask([&]() { order.push_back(2); }, 10, OS_TASK_PRIORITY_LOW, 1);
+    scheduler->scheduleOnce([&]() { order.push_back(3); }, OS_TASK_PRIORITY_CRITICAL);
+
+    scheduler->update(0);
+    int priorityOrder[] = {3, 1, 2};
+    TEST_ASSERT_EQUAL_INT_ARRAY(priorityOrder, order.data(), 3);
+
+    // Both real-time tasks due again at t=100; the 10 ms deadline wins
+    order.clear();
+    virtualClock = 100;
+    scheduler->setSchedulingMode(SchedulingMode::EDF);
+    scheduler->scheduleOnce([&]() { order.push_back(3); }, OS_TASK_PRIORITY_CRITICAL);
+    scheduler->update(0);
+    int edfOrder[] = {2, 1, 3};
+    TEST_ASSERT_EQUAL_INT_ARRAY(edfOrder, order.data(), 3);
+}
+
+void test_edf_admission_control() {
+    scheduler->setSchedulingMode(SchedulingMode::EDF);
+
+    TEST_ASSERT_NOT_EQUAL(0, scheduler->scheduleRealtimeTask([]() {}, 10, OS_TASK_PRIORITY_HIGH, 5));
+    TEST_ASSERT_EQUAL(50, scheduler->getRealtimeUtilization());
+
+    // 50% + 30% is over the bound; a tighter deadline counts against it too
+    TEST_ASSERT_EQUAL(0, scheduler->scheduleRealtimeTask([]() {}, 10, OS_TASK_PRIORITY_HIGH, 3));
+    TEST_ASSERT_EQUAL(0, scheduler->scheduleRealtimeTask([]() {}, 100, OS_TASK_PRIORITY_HIGH, 3,
+                                                         nullptr, 10));
+    TEST_ASSERT_NOT_EQUAL(0, scheduler->scheduleRealtimeTask([]() {}, 100, OS_TASK_PRIORITY_HIGH, 10));
+    TEST_ASSERT_EQUAL(2, scheduler->getAdmissionRejects());
+    TEST_ASSERT_EQUAL(60, scheduler->getRealtimeUtilization());
+}
+
+void test_edf_demotes_task_after_overrun_budget() {
+    virtualClock = 0;
+    scheduler->setTimeSource([]() { return virtualClock; });
+    scheduler->setSchedulingMode(SchedulingMode::EDF);
+
+    // Declares 1 ms but takes 4 ms, finishing 2 ms past its deadline
+    uint32_t id = scheduler->scheduleRealtimeTask([]() { virtualClock += 4; }, 10,
+                                                  OS_TASK_PRIORITY_HIGH, 1, "hog", 2);
+    TEST_ASSERT_NOT_EQUAL(0, id);
+
+    for (int i = 0; i < OS_EDF_OVERRUN_BUDGET; i++) {
+        TEST_ASSERT_TRUE(scheduler->getTaskInfo(id)->isRealtime);
+        scheduler->update(0);
+        virtualClock = (i + 1) * 10;
+    }
+
+    const Task* info = scheduler->getTaskInfo(id);
+    TEST_ASSERT_FALSE(info->isRealtime);
+    TEST_ASSERT_EQUAL(OS_EDF_OVERRUN_BUDGET, info->overrunCount);
+    TEST_ASSERT_EQUAL(OS_EDF_OVERRUN_BUDGET, info->deadlineMisses);
+    TEST_ASSERT_EQUAL(0, scheduler->getRealtimeUtilization());
+}
+
+void test_deadline_misses_count_only_realtime_tasks() {
+    virtualClock = 0;
+    scheduler->setTimeSource([]() { return virtualClock; });
+
+    // Both take 15 ms per 10 ms period; only the real-time one has a deadline
+    uint32_t background = scheduler->schedulePeriodic([]() { virtualClock += 15; }, 10,
+                                                      OS_TASK_PRIORITY_LOW, 0, "bg");
+    uint32_t realtime = scheduler->scheduleRealtimeTask([]() { virtualClock += 15; }, 10,
+                                                        OS_TASK_PRIORITY_HIGH, 20, "rt");
+    for (int i = 0; i < 4; i++) {
+        virtualClock += 10;
+        scheduler->update(0);
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, scheduler->getTaskInfo(background)->executionCount);
+    TEST_ASSERT_EQUAL(0, scheduler->getTaskInfo(background)->deadlineMisses);
+    TEST_ASSERT_GREATER_THAN(0, scheduler->getTaskInfo(realtime)->deadlineMisses);
+    TEST_ASSERT_EQUAL(scheduler->getTaskInfo(realtime)->deadlineMisses, scheduler->getDeadlineMisses());
+}
+
+void test_simulation_replays_deterministically() {
+    SimReport first = ScheduleSimulator::run(EDF_TASK_SET, SchedulingMode::EDF, 2000, 42);
+    SimReport second = ScheduleSimulator::run(EDF_TASK_SET, SchedulingMode::EDF, 2000, 42);
+
+    TEST_ASSERT_EQUAL(first.tasks.size(), second.tasks.size());
+    for (size_t i = 0; i < first.tasks.size(); i++) {
+        TEST_ASSERT_EQUAL(first.tasks[i].executions, second.tasks[i].executions);
+        TEST_ASSERT_EQUAL(first.tasks[i].deadlineMisses, second.tasks[i].deadlineMisses);
+    }
+    TEST_ASSERT_EQUAL(200, first.tasks[0].executions);
+
+    // A live scheduler's task set can be recorded (with measured run
+    // times once the tasks have run) and replayed
+    scheduler->scheduleRealtimeTask([]() {}, 10, OS_TASK_PRIORITY_HIGH, 2, "rt");
+    scheduler->schedulePeriodic([]() {}, 20, OS_TASK_PRIORITY_LOW, 0, "bg");
+    scheduler->scheduleOnce([]() {});
+    scheduler->update(0);
+    std::vector<SimTaskProfile> recorded = ScheduleSimulator::recordTaskSet(*scheduler);
+    TEST_ASSERT_EQUAL(2, recorded.size());
+    SimReport replay = ScheduleSimulator::run(recorded, SchedulingMode::EDF, 1000);
+    TEST_ASSERT_EQUAL(0, replay.totalMisses);
+}
+
+void test_edf_simulation_against_priority_scheduling() {
+    SimReport priority = ScheduleSimulator::run(EDF_TASK_SET, SchedulingMode::PRIORITY, 10000, 7);
+    SimReport edf = ScheduleSimulator::run(EDF_TASK_SET, SchedulingMode::EDF, 10000, 7);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "10 s replay, %u%% real-time load: priority %u deadline misses (audio %u), EDF %u",
+             edf.realtimeUtilization, priority.totalMisses, priority.tasks[0].deadlineMisses,
+             edf.totalMisses);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(0, edf.rejected);
+    TEST_ASSERT_EQUAL(0, edf.totalMisses);
+    TEST_ASSERT_GREATER_THAN(0, priority.tasks[0].deadlineMisses);
+}
+
+// Nearest-rank percentile of an unsorted window, for checking StatsRing
+static float referencePercentile(std::vector<float> window, float percent) {
+    std::sort(window.begin(), window.end());
+    size_t rank = (size_t)std::ceil(percent * window.size() / 100.0);
+    return window[rank > 0 ? rank - 1 : 0];
+}
+
+void test_stats_ring_matches_sorted_window() {
+    StatsRing<float, 60> ring;
+    std::vector<float> samples;
+    uint32_t random = 12345;
+
+    for (int i = 0; i < 500; i++) {
+        random = random * 1664525u + 1013904223u;
+        float sample = (random >> 8) % 1000 / 10.0f;  // Includes duplicates
+        size_t allocationsBefore = allocationCount;
+        ring.push(sample);
+        TEST_ASSERT_EQUAL(allocationsBefore, allocationCount);
+
+        samples.push_back(sample);
+        size_t first = samples.size() > 60 ? samples.size() - 60 : 0;
+        std::vector<float> window(samples.begin() + first, samples.end());
+
+        float sum = 0.0f;
+        for (float value : window) {
+            sum += value;
+        }
+        TEST_ASSERT_EQUAL(window.size(), ring.size());
+        TEST_ASSERT_EQUAL_FLOAT(window.front(), ring[0]);
+        TEST_ASSERT_EQUAL_FLOAT(sample, ring.latest());
+        TEST_ASSERT_EQUAL_FLOAT(*std::min_element(window.begin(), window.end()), ring.min());
+        TEST_ASSERT_EQUAL_FLOAT(*std::max_element(window.begin(), window.end()), ring.max());
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, sum / window.size(), ring.mean());
+
+        HistoryStats stats = ring.stats();
+        TEST_ASSERT_EQUAL_FLOAT(referencePercentile(window, 50.0f), stats.p50);
+        TEST_ASSERT_EQUAL_FLOAT(referencePercentile(window, 95.0f), stats.p95);
+        TEST_ASSERT_EQUAL_FLOAT(referencePercentile(window, 99.0f), stats.p99);
+    }
+}
+
+void test_stats_ring_edge_cases() {
+    StatsRing<uint32_t, 4> counts;
+    TEST_ASSERT_EQUAL(0, counts.max());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, counts.mean());
+
+    counts.push(4000000000u);
+    counts.push(4000000000u);
+    TEST_ASSERT_EQUAL_FLOAT(4.0e9f, counts.mean());  // No 32-bit overflow in the sum
+    for (uint32_t i = 1; i <= 4; i++) {
+        counts.push(i);
+    }
+    TEST_ASSERT_TRUE(counts.full());
+    TEST_ASSERT_EQUAL(1, counts.min());
+    TEST_ASSERT_EQUAL(4, counts.max());
+    TEST_ASSERT_EQUAL(2, counts.percentile(50.0f));
+    TEST_ASSERT_EQUAL(4, counts.percentile(99.0f));
+    TEST_ASSERT_EQUAL(1, counts.percentile(0.0f));
+
+    StatsRing<float, 8> times;
+    times.push(1.0f);
+    times.push(NAN);
+    times.push(3.0f);
+    TEST_ASSERT_EQUAL(2, times.size());
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, times.mean());
+
+    times.clear();
+    TEST_ASSERT_TRUE(times.empty());
+    times.push(5.0f);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, times.min());
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, times.stats().p99);
+}
+
+void test_frame_time_stats_track_updates() {
+    scheduler->schedulePeriodic([]() {
+        int64_t start = esp_timer_get_time();
+        while (esp_timer_get_time() - start < 1000) {
+        }
+    }, 1, OS_TASK_PRIORITY_NORMAL);
+
+    for (int i = 0; i < 20; i++) {
+        delay(1);
+        scheduler->update(1);
+    }
+
+    HistoryStats stats = scheduler->getFrameTimeStats();
+    TEST_ASSERT_EQUAL(20, stats.count);
+    TEST_ASSERT_TRUE(stats.min <= stats.p50);
+    TEST_ASSERT_TRUE(stats.p50 <= stats.p95);
+    TEST_ASSERT_TRUE(stats.p95 <= stats.p99);
+    TEST_ASSERT_TRUE(stats.p99 <= stats.max);
+    TEST_ASSERT_TRUE(stats.max >= 1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(stats.mean, scheduler->getAverageFrameTime());
+    TEST_ASSERT_EQUAL_FLOAT(stats.max, scheduler->getMaxFrameTime());
+}
+
+void test_tick_overhead_benchmark_against_linear_scan() {
+    uint32_t heapRuns = 0;
+    uint32_t linearRuns = 0;
+    BenchTaskScheduler heapScheduler;
+    LinearScanScheduler linearScheduler;
+
+    float heapNs = benchmarkTickOverhead(heapScheduler, heapRuns);
+    float linearNs = benchmarkTickOverhead(linearScheduler, linearRuns);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "64 periodic tasks: timer heap %.0f ns/tick (%u runs), linear scan %.0f ns/tick (%u runs), %.1fx",
+             heapNs, heapRuns, linearNs, linearRuns, heapNs > 0 ? linearNs / heapNs : 0.0f);
+    TEST_MESSAGE(message);
+
+    // Timing is only reported; both schedulers must have run their tasks
+    TEST_ASSERT_GREATER_THAN(0, heapRuns);
+    TEST_ASSERT_GREATER_THAN(0, linearRuns);
+}
+
+int runTaskSchedulerTests() {
+    UNITY_BEGIN();
+
+    // Scheduling Tests
+    RUN_TEST(test_due_tasks_run_in_priority_order);
+    RUN_TEST(test_periodic_task_is_rescheduled);
+    RUN_TEST(test_suspend_resume_and_cancel);
+    RUN_TEST(test_tasks_modify_scheduler_from_callbacks);
+    RUN_TEST(test_task_limit_is_enforced);
+    RUN_TEST(test_stale_ids_do_not_match_reused_slots);
+    RUN_TEST(test_cancel_destroys_captured_state);
+    RUN_TEST(test_scheduling_does_not_allocate);
+    RUN_TEST(test_background_throttle_stretches_low_priority_periods);
+
+    // EDF Tests
+    RUN_TEST(test_edf_runs_earliest_deadline_first);
+    RUN_TEST(test_edf_admission_control);
+    RUN_TEST(test_edf_demotes_task_after_overrun_budget);
+    RUN_TEST(test_deadline_misses_count_only_realtime_tasks);
+    RUN_TEST(test_simulation_replays_deterministically);
+    RUN_TEST(test_edf_simulation_against_priority_scheduling);
+
+    // Frame Statistics Tests
+    RUN_TEST(test_stats_ring_matches_sorted_window);
+    RUN_TEST(test_stats_ring_edge_cases);
+    RUN_TEST(test_frame_time_stats_track_updates);
+
+    // Benchmarks
+    RUN_TEST(test_tick_overhead_benchmark_against_linear_scan);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runTaskSchedulerTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runTaskSchedulerTests();
+}
+#endif
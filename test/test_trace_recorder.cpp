@@ -0,0 +1,255 @@
+#include <unity.h>
+#include "../src/system/trace_recorder.h"
+#include "../src/system/job_executor.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @file test_trace_recorder.cpp
+ * @brief Trace marker recording, cross-core collection and Chrome trace export tests
+ */
+
+static TraceRecorder* tracer = nullptr;
+
+// Count occurrences of a substring
+static size_t countOf(const std::string& text, const char* pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos;
+         pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+// Export the current capture and read it back
+static void exportToString(std::string& json) {
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(tracer->writeChromeTrace(file));
+
+    json.clear();
+    rewind(file);
+    char buffer[256];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        json.append(buffer, read);
+    }
+    fclose(file);
+}
+
+void setUp(void) {
+    tracer = &TraceRecorder::getInstance();
+}
+
+void tearDown(void) {
+    tracer->stopCapture();
+}
+
+void test_markers_ignored_without_capture() {
+    tracer->startCapture(16);
+    tracer->stopCapture();
+    size_t before = tracer->getEvents().size();
+
+    {
+        PERF_TRACE_SCOPE("idle");
+        PERF_TRACE_INSTANT("idle_instant");
+    }
+    tracer->collect();
+    TEST_ASSERT_EQUAL(before, tracer->getEvents().size());
+}
+
+void test_scopes_counters_and_instants_recorded_in_order() {
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(64));
+    {
+        PERF_TRACE_SCOPE("outer");
+        PERF_TRACE_COUNTER("queue_depth", 7);
+        {
+            PERF_TRACE_SCOPE("inner");
+            PERF_TRACE_INSTANT("flush");
+        }
+    }
+    tracer->stopCapture();
+
+    const std::vector<TraceEvent>& events = tracer->getEvents();
+    TEST_ASSERT_EQUAL(6, events.size());
+
+    const char* names[] = {"outer", "queue_depth", "inner", "flush", "inner", "outer"};
+    TracePhase phases[] = {TracePhase::BEGIN, TracePhase::COUNTER, TracePhase::BEGIN,
+                           TracePhase::INSTANT, TracePhase::END, TracePhase::END};
+    for (size_t i = 0; i < events.size(); i++) {
+        TEST_ASSERT_EQUAL_STRING(names[i], events[i].name);
+        TEST_ASSERT_TRUE(events[i].phase == phases[i]);
+        if (i > 0) {
+            TEST_ASSERT_TRUE(events[i].timestamp >= events[i - 1].timestamp);
+        }
+    }
+    TEST_ASSERT_EQUAL(7, events[1].value);
+    TEST_ASSERT_EQUAL(0, tracer->getDroppedCount());
+}
+
+void test_workers_record_concurrently() {
+    const int JOBS = 64;
+    const int SCOPES_PER_JOB = 4;
+
+    JobExecutor executor;
+    executor.initialize(2);
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(4096));
+
+    std::atomic<int> done{0};
+    for (int i = 0; i < JOBS; i++) {
+        executor.submit([&done]() {
+            for (int s = 0; s < SCOPES_PER_JOB; s++) {
+                PERF_TRACE_SCOPE("work");
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    // Collect while workers are still recording, as the main loop does
+    uint32_t start = millis();
+    while (done.load() < JOBS && millis() - start < 2000) {
+        tracer->collect();
+    }
+    executor.shutdown();
+    tracer->stopCapture();
+
+    // Every marker is either collected or counted as dropped; the executor's
+    // own "job" scopes are recorded alongside the workload's
+    size_t work = 0;
+    size_t begins = 0;
+    size_t ends = 0;
+    for (const TraceEvent& event : tracer->getEvents()) {
+        if (strcmp(event.name, "work") == 0) {
+            work++;
+        }
+        begins += event.phase == TracePhase::BEGIN;
+        ends += event.phase == TracePhase::END;
+    }
+    TEST_ASSERT_EQUAL(JOBS, done.load());
+    TEST_ASSERT_EQUAL(JOBS * SCOPES_PER_JOB * 2 + JOBS * 2,
+                      tracer->getEvents().size() + tracer->getDroppedCount());
+    if (tracer->getDroppedCount() == 0) {
+        TEST_ASSERT_EQUAL(JOBS * SCOPES_PER_JOB * 2, work);
+        TEST_ASSERT_EQUAL(begins, ends);
+    }
+}
+
+void test_full_ring_and_capture_limit_count_drops() {
+    // More markers than one ring holds, with no collect in between
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(OS_TRACE_EVENTS_PER_CORE * 4));
+    for (int i = 0; i < OS_TRACE_EVENTS_PER_CORE + 10; i++) {
+        PERF_TRACE_INSTANT("burst");
+    }
+    tracer->stopCapture();
+    TEST_ASSERT_EQUAL(OS_TRACE_EVENTS_PER_CORE, tracer->getEvents().size());
+    TEST_ASSERT_EQUAL(10, tracer->getDroppedCount());
+
+    // Capture buffer limit
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(8));
+    for (int i = 0; i < 20; i++) {
+        PERF_TRACE_INSTANT("burst");
+    }
+    tracer->stopCapture();
+    TEST_ASSERT_EQUAL(8, tracer->getEvents().size());
+    TEST_ASSERT_EQUAL(12, tracer->getDroppedCount());
+}
+
+void test_chrome_trace_export() {
+    const char* appName = tracer->intern(std::string("app \"zim\""));
+    TEST_ASSERT_EQUAL_PTR(appName, tracer->intern("app \"zim\""));
+
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(64));
+    {
+        PERF_TRACE_SCOPE("frame");
+        {
+            TraceScope app(appName);
+            PERF_TRACE_COUNTER("frame_us", 16667);
+        }
+        PERF_TRACE_INSTANT("frame_drop");
+    }
+    tracer->stopCapture();
+
+    std::string json;
+    exportToString(json);
+    TEST_ASSERT_EQUAL(0, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    TEST_ASSERT_EQUAL(json.size() - 4, json.rfind("\n]}\n"));
+
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"ph\":\"M\""));
+    TEST_ASSERT_EQUAL(2, countOf(json, "\"ph\":\"B\""));
+    TEST_ASSERT_EQUAL(2, countOf(json, "\"ph\":\"E\""));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"ph\":\"C\""));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"ph\":\"i\""));
+    TEST_ASSERT_EQUAL(1, countOf(json, "\"args\":{\"value\":16667}"));
+    TEST_ASSERT_EQUAL(2, countOf(json, "\"name\":\"app \\\"zim\\\"\""));
+
+    // Balanced brackets and no trailing comma before the closing bracket
+    TEST_ASSERT_EQUAL(countOf(json, "{"), countOf(json, "}"));
+    TEST_ASSERT_EQUAL(std::string::npos, json.find(",\n]"));
+
+    // Timestamps are relative to the capture start
+    TEST_ASSERT_EQUAL(std::string::npos, json.find("\"ts\":-"));
+}
+
+void test_marker_overhead() {
+    const int ITERATIONS = 200;
+
+    TEST_ASSERT_EQUAL(OS_OK, tracer->startCapture(ITERATIONS * 2));
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < ITERATIONS; i++) {
+        PERF_TRACE_SCOPE("bench");
+    }
+    int64_t recording = esp_timer_get_time() - start;
+    tracer->stopCapture();
+    TEST_ASSERT_EQUAL(ITERATIONS * 2, tracer->getEvents().size());
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < ITERATIONS; i++) {
+        PERF_TRACE_SCOPE("bench");
+    }
+    int64_t idle = esp_timer_get_time() - start;
+
+    char message[128];
+    snprintf(message, sizeof(message), "Trace scope: %.3f us capturing, %.3f us idle",
+             (double)recording / ITERATIONS, (double)idle / ITERATIONS);
+    TEST_MESSAGE(message);
+}
+
+int runTraceRecorderTests() {
+    UNITY_BEGIN();
+
+    // Recording Tests
+    RUN_TEST(test_markers_ignored_without_capture);
+    RUN_TEST(test_scopes_counters_and_instants_recorded_in_order);
+    RUN_TEST(test_workers_record_concurrently);
+    RUN_TEST(test_full_ring_and_capture_limit_count_drops);
+
+    // Export Tests
+    RUN_TEST(test_chrome_trace_export);
+
+    // Performance Tests
+    RUN_TEST(test_marker_overhead);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);  // Wait for serial connection
+    runTraceRecorderTests();
+}
+
+void loop() {
+    // Empty - tests run once in setup
+}
+#else
+int main() {
+    return runTraceRecorderTests();
+}
+#endif
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+M5Stack Tab5 Allocation Profile Viewer
+Reads binary profiles written by AllocationProfiler::dumpToFile() and prints
+per-call-site tables, size histograms, or the difference between two dumps.
+
+Usage:
+    alloc_profile.py profile.bin [--top N] [--sort live|bytes|count] [--histogram]
+    alloc_profile.py --diff before.bin after.bin [--top N]
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"APRF"
+HEADER = struct.Struct("<4sHHIIII")
+SITE_FIXED = struct.Struct("<IIIQQ")
+
+
+def bucket_label(index, bucket_count):
+    if index == bucket_count - 1:
+        return f">{format_size(16 << (index - 1))}"
+    return f"<={format_size(16 << index)}"
+
+
+def format_size(value):
+    for unit in ("B", "KB", "MB"):
+        if abs(value) < 1024 or unit == "MB":
+            return f"{value:.0f}{unit}" if unit == "B" else f"{value:.1f}{unit}"
+        value /= 1024.0
+
+
+def load_profile(path):
+    with open(path, "rb") as handle:
+        data = handle.read()
+
+    magic, version, bucket_count, sample_rate, timestamp, site_count, dropped = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError(f"{path}: not an allocation profile")
+    if version != 1:
+        raise ValueError(f"{path}: unsupported profile version {version}")
+
+    offset = HEADER.size
+    histogram = struct.Struct(f"<{bucket_count}I")
+    sites = []
+    for _ in range(site_count):
+        line, alloc_count, free_count, alloc_bytes, free_bytes = SITE_FIXED.unpack_from(data, offset)
+        offset += SITE_FIXED.size
+        buckets = list(histogram.unpack_from(data, offset))
+        offset += histogram.size
+        (name_length,) = struct.unpack_from("<H", data, offset)
+        offset += 2
+        name = data[offset:offset + name_length].decode("utf-8", "replace")
+        offset += name_length
+
+        sites.append({
+            "site": f"{name}:{line}",
+            "alloc_count": alloc_count,
+            "free_count": free_count,
+            "alloc_bytes": alloc_bytes,
+            "free_bytes": free_bytes,
+            "live_bytes": alloc_bytes - free_bytes,
+            "live_count": alloc_count - free_count,
+            "histogram": buckets,
+        })
+
+    return {
+        "sample_rate": sample_rate,
+        "timestamp": timestamp,
+        "dropped": dropped,
+        "bucket_count": bucket_count,
+        "sites": sites,
+    }
+
+
+SORT_KEYS = {
+    "live": lambda site: site["live_bytes"],
+    "bytes": lambda site: site["alloc_bytes"],
+    "count": lambda site: site["alloc_count"],
+}
+
+
+def print_profile(profile, top, sort, show_histogram):
+    print(f"Profile at {profile['timestamp'] / 1000.0:.1f}s, 1:{profile['sample_rate']} sampling, "
+          f"{len(profile['sites'])} sites, {profile['dropped']} dropped samples")
+    print(f"{'live':>10} {'live#':>7} {'allocated':>10} {'allocs':>8}  site")
+
+    sites = sorted(profile["sites"], key=SORT_KEYS[sort], reverse=True)[:top]
+    for site in sites:
+        print(f"{format_size(site['live_bytes']):>10} {site['live_count']:>7} "
+              f"{format_size(site['alloc_bytes']):>10} {site['alloc_count']:>8}  {site['site']}")
+        if show_histogram:
+            buckets = [f"{bucket_label(i, profile['bucket_count'])}:{count}"
+                       for i, count in enumerate(site["histogram"]) if count]
+            print(f"{'':>39}{' '.join(buckets)}")
+
+
+def print_diff(before, after, top):
+    previous = {site["site"]: site for site in before["sites"]}
+    deltas = []
+    for site in after["sites"]:
+        old = previous.get(site["site"])
+        delta = {
+            "site": site["site"],
+            "alloc_count": site["alloc_count"] - (old["alloc_count"] if old else 0),
+            "alloc_bytes": site["alloc_bytes"] - (old["alloc_bytes"] if old else 0),
+            "live_bytes": site["live_bytes"] - (old["live_bytes"] if old else 0),
+        }
+        if delta["alloc_count"] or delta["live_bytes"]:
+            deltas.append(delta)
+
+    deltas.sort(key=lambda delta: delta["live_bytes"], reverse=True)
+    elapsed = (after["timestamp"] - before["timestamp"]) / 1000.0
+    total = sum(delta["live_bytes"] for delta in deltas)
+    print(f"{len(deltas)} sites changed over {elapsed:.1f}s, live bytes {total:+d}")
+    print(f"{'live':>10} {'allocated':>10} {'allocs':>8}  site")
+    for delta in deltas[:top]:
+        print(f"{delta['live_bytes']:>+10} {delta['alloc_bytes']:>+10} {delta['alloc_count']:>+8}  {delta['site']}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Inspect M5Tab5 allocation profiles")
+    parser.add_argument("profiles", nargs="+", help="profile file (two with --diff)")
+    parser.add_argument("--diff", action="store_true", help="show changes from the first to the second profile")
+    parser.add_argument("--top", type=int, default=20, help="number of sites to show")
+    parser.add_argument("--sort", choices=sorted(SORT_KEYS), default="live", help="sort order for a single profile")
+    parser.add_argument("--histogram", action="store_true", help="show size buckets per site")
+    args = parser.parse_args()
+
+    try:
+        if args.diff:
+            if len(args.profiles) != 2:
+                parser.error("--diff needs exactly two profiles")
+            print_diff(load_profile(args.profiles[0]), load_profile(args.profiles[1]), args.top)
+        else:
+            for path in args.profiles:
+                print_profile(load_profile(path), args.top, args.sort, args.histogram)
+    except (OSError, ValueError, struct.error) as error:
+        print(f"error: {error}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())